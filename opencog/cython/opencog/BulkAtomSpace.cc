@@ -0,0 +1,123 @@
+/*
+ * opencog/cython/opencog/BulkAtomSpace.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atomspace/AttentionValue.h>
+#include <opencog/atomspace/SimpleTruthValue.h>
+
+#include "BulkAtomSpace.h"
+
+using namespace opencog;
+
+size_t bulk::get_tv(AtomSpace* as, const long* uuids, size_t n,
+                    double* mean, double* confidence)
+{
+    size_t valid = 0;
+    for (size_t i = 0; i < n; i++) {
+        Handle h(uuids[i]);
+        if (not as->isValidHandle(h)) {
+            mean[i] = confidence[i] = 0.0;
+            continue;
+        }
+        TruthValuePtr tv = as->getTV(h);
+        mean[i] = tv->getMean();
+        confidence[i] = tv->getConfidence();
+        valid++;
+    }
+    return valid;
+}
+
+size_t bulk::set_tv(AtomSpace* as, const long* uuids, size_t n,
+                    const double* mean, const double* confidence)
+{
+    size_t valid = 0;
+    for (size_t i = 0; i < n; i++) {
+        Handle h(uuids[i]);
+        if (not as->isValidHandle(h)) continue;
+        as->setTV(h, SimpleTruthValue::createTV(mean[i],
+                SimpleTruthValue::confidenceToCount(confidence[i])));
+        valid++;
+    }
+    return valid;
+}
+
+size_t bulk::get_av(AtomSpace* as, const long* uuids, size_t n,
+                    short* sti, short* lti, unsigned short* vlti)
+{
+    size_t valid = 0;
+    for (size_t i = 0; i < n; i++) {
+        Handle h(uuids[i]);
+        if (not as->isValidHandle(h)) {
+            sti[i] = lti[i] = 0;
+            vlti[i] = 0;
+            continue;
+        }
+        AttentionValuePtr av = as->getAV(h);
+        sti[i] = av->getSTI();
+        lti[i] = av->getLTI();
+        vlti[i] = av->getVLTI();
+        valid++;
+    }
+    return valid;
+}
+
+size_t bulk::set_av(AtomSpace* as, const long* uuids, size_t n,
+                    const short* sti, const short* lti,
+                    const unsigned short* vlti)
+{
+    size_t valid = 0;
+    for (size_t i = 0; i < n; i++) {
+        Handle h(uuids[i]);
+        if (not as->isValidHandle(h)) continue;
+        as->setAV(h, createAV(sti[i], lti[i], vlti[i]));
+        valid++;
+    }
+    return valid;
+}
+
+size_t bulk::add_nodes(AtomSpace* as, Type t,
+                       const std::vector<std::string>& names, long* out)
+{
+    for (size_t i = 0; i < names.size(); i++)
+        out[i] = as->addNode(t, names[i]).value();
+    return names.size();
+}
+
+size_t bulk::add_links(AtomSpace* as, Type t, const long* outgoing,
+                       size_t arity, size_t n, long* out)
+{
+    size_t valid = 0;
+    HandleSeq oset(arity);
+    for (size_t i = 0; i < n; i++) {
+        bool ok = true;
+        for (size_t j = 0; j < arity and ok; j++) {
+            oset[j] = Handle(outgoing[i * arity + j]);
+            ok = as->isValidHandle(oset[j]);
+        }
+        if (not ok) {
+            out[i] = -1;
+            continue;
+        }
+        out[i] = as->addLink(t, oset).value();
+        valid++;
+    }
+    return valid;
+}
@@ -0,0 +1,73 @@
+/*
+ * opencog/cython/opencog/BulkAtomSpace.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BULK_ATOMSPACE_H
+#define _OPENCOG_BULK_ATOMSPACE_H
+
+#include <string>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+
+/**
+ * Array versions of the AtomSpace accessors, for the opencog.bulk Python
+ * module. They work on plain C arrays, which the module takes straight
+ * from the buffers of its arguments (NumPy arrays, array.array, ...),
+ * and they don't touch any Python object, so that they can run without
+ * the GIL.
+ *
+ * Atoms are given by UUID. Invalid UUIDs are skipped by the setters; the
+ * getters return 0 for them. Each function returns the number of valid
+ * atoms.
+ */
+namespace bulk
+{
+
+size_t get_tv(AtomSpace*, const long* uuids, size_t n,
+              double* mean, double* confidence);
+size_t set_tv(AtomSpace*, const long* uuids, size_t n,
+              const double* mean, const double* confidence);
+
+size_t get_av(AtomSpace*, const long* uuids, size_t n,
+              short* sti, short* lti, unsigned short* vlti);
+size_t set_av(AtomSpace*, const long* uuids, size_t n,
+              const short* sti, const short* lti, const unsigned short* vlti);
+
+/** Add a node of each name, and put their UUIDs in out. */
+size_t add_nodes(AtomSpace*, Type, const std::vector<std::string>& names,
+                 long* out);
+
+/**
+ * Add n links of the given arity; the outgoing set of link i is
+ * outgoing[i*arity .. (i+1)*arity). Links with an invalid atom in their
+ * outgoing set are not added, and get -1 in out.
+ */
+size_t add_links(AtomSpace*, Type, const long* outgoing, size_t arity,
+                 size_t n, long* out);
+
+} // namespace bulk
+} // namespace opencog
+
+#endif // _OPENCOG_BULK_ATOMSPACE_H
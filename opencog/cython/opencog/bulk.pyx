@@ -0,0 +1,128 @@
+# Array versions of the AtomSpace accessors, for MindAgents and Requests
+# that touch many atoms per call.
+#
+# Atoms are given by UUID (atom.h.value()). The arrays may be anything
+# that exposes a contiguous buffer of the right item type: NumPy arrays
+# (numpy.int64, numpy.float64, numpy.int16, numpy.uint16) or array.array
+# ('l', 'd', 'h', 'H'). They are read and written in place, without
+# copying, and the GIL is released while the AtomSpace is accessed.
+#
+# Example:
+#     uuids = numpy.array([a.h.value() for a in atoms], dtype=numpy.int64)
+#     sti = numpy.empty(len(atoms), dtype=numpy.int16)
+#     lti = numpy.empty_like(sti)
+#     vlti = numpy.empty(len(atoms), dtype=numpy.uint16)
+#     get_av(atomspace, uuids, sti, lti, vlti)
+#     sti += 10
+#     set_av(atomspace, uuids, sti, lti, vlti)
+
+from libcpp.vector cimport vector
+
+from opencog.atomspace cimport cAtomSpace, AtomSpace
+
+cdef extern from "<string>" namespace "std":
+    cdef cppclass string:
+        string()
+        string(char *)
+
+ctypedef unsigned short Type
+
+cdef extern from "BulkAtomSpace.h" namespace "opencog::bulk":
+    size_t c_get_tv "opencog::bulk::get_tv" (cAtomSpace*, const long*, size_t,
+        double*, double*) nogil
+    size_t c_set_tv "opencog::bulk::set_tv" (cAtomSpace*, const long*, size_t,
+        const double*, const double*) nogil
+    size_t c_get_av "opencog::bulk::get_av" (cAtomSpace*, const long*, size_t,
+        short*, short*, unsigned short*) nogil
+    size_t c_set_av "opencog::bulk::set_av" (cAtomSpace*, const long*, size_t,
+        const short*, const short*, const unsigned short*) nogil
+    size_t c_add_nodes "opencog::bulk::add_nodes" (cAtomSpace*, Type,
+        vector[string]&, long*) nogil
+    size_t c_add_links "opencog::bulk::add_links" (cAtomSpace*, Type,
+        const long*, size_t, size_t, long*) nogil
+
+
+cdef _check_sizes(size_t n, sizes):
+    for s in sizes:
+        if s < n:
+            raise ValueError("array of %d items given for %d atoms" % (s, n))
+
+
+def get_tv(AtomSpace atomspace, long[::1] uuids,
+           double[::1] mean, double[::1] confidence):
+    """ Fill mean and confidence with the TVs of the atoms.
+    Return the number of valid atoms. """
+    cdef size_t n = uuids.shape[0], r
+    _check_sizes(n, (mean.shape[0], confidence.shape[0]))
+    if n == 0: return 0
+    with nogil:
+        r = c_get_tv(atomspace.atomspace, &uuids[0], n,
+                     &mean[0], &confidence[0])
+    return r
+
+def set_tv(AtomSpace atomspace, long[::1] uuids,
+           double[::1] mean, double[::1] confidence):
+    """ Set the TVs of the atoms to simple TVs of the given mean and
+    confidence. Return the number of valid atoms. """
+    cdef size_t n = uuids.shape[0], r
+    _check_sizes(n, (mean.shape[0], confidence.shape[0]))
+    if n == 0: return 0
+    with nogil:
+        r = c_set_tv(atomspace.atomspace, &uuids[0], n,
+                     &mean[0], &confidence[0])
+    return r
+
+def get_av(AtomSpace atomspace, long[::1] uuids,
+           short[::1] sti, short[::1] lti, unsigned short[::1] vlti):
+    """ Fill sti, lti and vlti with the AVs of the atoms.
+    Return the number of valid atoms. """
+    cdef size_t n = uuids.shape[0], r
+    _check_sizes(n, (sti.shape[0], lti.shape[0], vlti.shape[0]))
+    if n == 0: return 0
+    with nogil:
+        r = c_get_av(atomspace.atomspace, &uuids[0], n,
+                     &sti[0], &lti[0], &vlti[0])
+    return r
+
+def set_av(AtomSpace atomspace, long[::1] uuids,
+           short[::1] sti, short[::1] lti, unsigned short[::1] vlti):
+    """ Set the AVs of the atoms. Return the number of valid atoms. """
+    cdef size_t n = uuids.shape[0], r
+    _check_sizes(n, (sti.shape[0], lti.shape[0], vlti.shape[0]))
+    if n == 0: return 0
+    with nogil:
+        r = c_set_av(atomspace.atomspace, &uuids[0], n,
+                     &sti[0], &lti[0], &vlti[0])
+    return r
+
+def add_nodes(AtomSpace atomspace, Type t, names, long[::1] out):
+    """ Add a node of type t for each name, and put their UUIDs in out. """
+    cdef vector[string] c_names
+    cdef bytes name
+    cdef size_t n = len(names), r
+    _check_sizes(n, (out.shape[0],))
+    if n == 0: return 0
+    c_names.reserve(n)
+    for name in names:
+        c_names.push_back(string(name))
+    with nogil:
+        r = c_add_nodes(atomspace.atomspace, t, c_names, &out[0])
+    return r
+
+def add_links(AtomSpace atomspace, Type t, long[::1] outgoing, size_t arity,
+              long[::1] out):
+    """ Add len(outgoing) / arity links of type t; the outgoing set of
+    link i is outgoing[i*arity:(i+1)*arity]. Put their UUIDs in out, or -1
+    for the links holding an invalid UUID, which are not added.
+    Return the number of links added. """
+    if arity == 0: return 0
+    cdef size_t n = outgoing.shape[0] / arity, r
+    if n * arity != <size_t> outgoing.shape[0]:
+        raise ValueError("%d UUIDs given for links of arity %d"
+                         % (outgoing.shape[0], arity))
+    _check_sizes(n, (out.shape[0],))
+    if n == 0: return 0
+    with nogil:
+        r = c_add_links(atomspace.atomspace, t, &outgoing[0], arity, n,
+                        &out[0])
+    return r
@@ -35,7 +35,15 @@
 using namespace opencog;
 
 ImportanceUpdatingAgent::ImportanceUpdatingAgent(CogServer& cs) :
-    Agent(cs)
+    Agent(cs),
+    stimulusProfile(cs.systemActivityTable().profiler().entry(
+        "agent/" + info().id + "/stimulus")),
+    wagesProfile(cs.systemActivityTable().profiler().entry(
+        "agent/" + info().id + "/wages")),
+    atomsProfile(cs.systemActivityTable().profiler().entry(
+        "agent/" + info().id + "/atoms")),
+    fundsProfile(cs.systemActivityTable().profiler().entry(
+        "agent/" + info().id + "/funds"))
 {
     // init starting wages/rents. these should quickly change and reach
     // stable values, which adapt to the system dynamics
@@ -169,6 +177,8 @@ void ImportanceUpdatingAgent::run()
      * (no pointer to CogServer there) */
     if (!initialEstimateMade) init();
 
+    ProfileScope stimulusScope(stimulusProfile);
+
     /* Calculate attentional focus sizes */
     updateAttentionalFocusSizes(a);
 
@@ -181,15 +191,19 @@ void ImportanceUpdatingAgent::run()
 
     /* Update stimulus totals */
     updateTotalStimulus(agents);
+    stimulusScope.stop();
 
     /* Update atoms: Collect rent, pay wages */
     log->info("Collecting rent and paying wages");
 
+    ProfileScope wagesScope(wagesProfile);
     getHandlesToUpdate(a,hs);
 
     /* Calculate STI/LTI atom wages for each agent */
     calculateAtomWages(a, agents);
+    wagesScope.stop();
 
+    ProfileScope atomsScope(atomsProfile);
     for (Handle handle : hs) {
         updateAtomSTI(a, agents, handle);
         updateAtomLTI(a, agents, handle);
@@ -212,18 +226,22 @@ void ImportanceUpdatingAgent::run()
 		minSTISeen = maxSTISeen;
 	}
 
+    atomsScope.stop();
+
     a->updateMaxSTI(maxSTISeen);
     a->updateMinSTI(minSTISeen);
     log->debug("Max STI seen is %d, recentMaxSTI is now %d", maxSTISeen, a->getMaxSTI());
     log->debug("Min STI seen is %d, recentMinSTI is now %d", minSTISeen, a->getMinSTI());
 
     /* Check AtomSpace funds are within bounds */
+    ProfileScope fundsScope(fundsProfile);
     checkAtomSpaceFunds(a);
 
     if (lobeSTIOutOfBounds) {
         log->debug("Lobe STI was out of bounds, updating STI rent");
         updateSTIRent(a);
     }
+    fundsScope.stop();
     /* Not sure whether LTI rent should be updated */
     //if (lobeLTIOutOfBounds) {
     //    log->debug("Lobe LTI was out of bounds, updating LTI rent");
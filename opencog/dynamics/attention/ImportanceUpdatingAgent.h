@@ -32,6 +32,7 @@
 #include <opencog/atomspace/AttentionValue.h>
 #include <opencog/server/CogServer.h>
 #include <opencog/server/Agent.h>
+#include <opencog/server/Profiler.h>
 #include <opencog/util/Logger.h>
 #include <opencog/util/RandGen.h>
 #include <opencog/util/recent_val.h>
@@ -129,6 +130,12 @@ public:
 
 private:
 
+    //! Profile of the phases of run(), see the 'profile' command.
+    ProfileEntry& stimulusProfile;
+    ProfileEntry& wagesProfile;
+    ProfileEntry& atomsProfile;
+    ProfileEntry& fundsProfile;
+
     AttentionValue::sti_t STIAtomRent; //!< Current atom STI rent.
     AttentionValue::sti_t STIMaxAtomRent; //!< Maximum allowed atom STI rent.
     opencog::recent_val<AttentionValue::sti_t> STITransitionalAtomRent; //!< Decaying rent
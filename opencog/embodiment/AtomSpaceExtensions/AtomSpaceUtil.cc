@@ -25,11 +25,14 @@
 
 #include <algorithm>
 #include <cctype>
+#include <memory>
+#include <mutex>
 #include <stack>
 
 #include <boost/algorithm/string.hpp>
 
 #include <opencog/util/misc.h>
+#include <opencog/util/mt19937ar.h>
 #include <opencog/util/Logger.h>
 #include <opencog/util/oc_assert.h>
 #include <opencog/util/random.h>
@@ -391,7 +394,31 @@ bool AtomSpaceUtil::getHasSaidValueAtTime(AtomSpace &atomSpace,
                      "timestamp - delay must be positive");
     unsigned long tl = timestamp - delay;
     unsigned long tu = timestamp;
-    Temporal temp(tl, tu);
+    return matchHasSaid(atomSpace, Temporal(tl, tu), from_h, to_h,
+                        message, include_to, NULL);
+}
+
+void AtomSpaceUtil::getHasSaidTimestamps(AtomSpace &atomSpace,
+        const Temporal& temp,
+        Handle from_h,
+        Handle to_h,
+        const std::string& message,
+        std::vector<unsigned long>& timestamps,
+        bool include_to)
+{
+    matchHasSaid(atomSpace, temp, from_h, to_h, message, include_to,
+                 &timestamps);
+    std::sort(timestamps.begin(), timestamps.end());
+}
+
+bool AtomSpaceUtil::matchHasSaid(AtomSpace &atomSpace,
+        const Temporal& temp,
+        Handle from_h,
+        Handle to_h,
+        const std::string& message,
+        bool include_to,
+        std::vector<unsigned long>* timestamps)
+{
     std::list<HandleTemporalPair> ret;
     timeServer().getTimeInfo(back_inserter(ret), Handle::UNDEFINED, temp,
                           TemporalTable::STARTS_WITHIN);
@@ -445,13 +472,19 @@ bool AtomSpaceUtil::getHasSaidValueAtTime(AtomSpace &atomSpace,
                            );
 
         does_fit_template dft(*say_template, &atomSpace, true);
-        //iterate over the atom list to see if such a message has been said
+        //iterate over the atom list to see if such a message has been said,
+        //collecting the start times if requested
+        bool found = false;
         for (std::list<HandleTemporalPair>::const_iterator ret_it = ret.begin();
                 ret_it != ret.end(); ++ret_it) {
-            if (dft(ret_it->getHandle()))
-                return true;
+            if (dft(ret_it->getHandle())) {
+                if (timestamps == NULL)
+                    return true;
+                found = true;
+                timestamps->push_back(ret_it->getTemporal()->getLowerBound());
+            }
         }
-        return false;
+        return found;
     }
 }
 
@@ -849,33 +882,21 @@ Handle AtomSpaceUtil::addGenericPropertyPred(AtomSpace& atomSpace,
 Handle AtomSpaceUtil::getMostRecentEvaluationLink(AtomSpace& atomSpace,
         const std::string& predicateNodeName )
 {
-    std::vector<HandleTemporalPair> timestamps;
-    getAllEvaluationLinks( atomSpace, timestamps, predicateNodeName );
+    Handle predicateNode = atomSpace.getHandle(PREDICATE_NODE,
+                                               predicateNodeName);
+    Handle atTimeLink = Handle::UNDEFINED;
+    if ( predicateNode != Handle::UNDEFINED ) {
+        atTimeLink = timeServer().getLatestAtTimeLink(predicateNode);
+    }
 
-    if ( timestamps.size() == 0 ) {
+    if ( atTimeLink == Handle::UNDEFINED ) {
         logger().debug(
                      "AtomSpaceUtil - Found no entries for PredicateNode '%s' in TimeServer.",
                      predicateNodeName.c_str());
         return Handle::UNDEFINED;
     }
 
-    int mostRecentIndex = 0;
-    Temporal *mostRecent = timestamps[mostRecentIndex].getTemporal();
-    for (unsigned int i = 1; i < timestamps.size(); i++) {
-        if (*(timestamps[i].getTemporal()) > *mostRecent) {
-            mostRecent = timestamps[i].getTemporal();
-            mostRecentIndex = i;
-        } // if
-    } // for
-
-    Handle selectedHandle = timestamps[mostRecentIndex].getHandle();
-    if ( selectedHandle == Handle::UNDEFINED) {
-        logger().debug("AtomSpaceUtil - Timeserver returned NULL handle "
-                "for PredicateNode '%s'", predicateNodeName.c_str());
-        return Handle::UNDEFINED;
-    }
-
-    return selectedHandle;
+    return atomSpace.getOutgoing(atTimeLink, 1);
 }
 std::vector<Handle> AtomSpaceUtil::getInheritanceLinks(AtomSpace & atomSpace, Handle hFirstOutgoing)
 {
@@ -1148,7 +1169,7 @@ float AtomSpaceUtil::getCurrentModulatorLevel(AtomSpace & atomSpace,
                                               const std::string & modulatorName)
 
 {
-    float errorValue = randGen().randfloat();   // If error happens, return this value anyway.
+    float errorValue = getThreadRandGen().randfloat();   // If error happens, return this value anyway.
 
     // Get the Handle to GroundSchemaNode
     std::string modulatorUpdater = modulatorName + "ModulatorUpdater";
@@ -1214,7 +1235,8 @@ float AtomSpaceUtil::getCurrentModulatorLevel(AtomSpace & atomSpace,
 //
 //    Handle hExecutionOutputLink = *iExecutionOutputLink;
 
-    // Get all the SimilarityLink that contains the ExecutionOutputLink
+    // Get the latest SimilarityLink that contains the ExecutionOutputLink,
+    // from the index of the TimeServer
     //
     // AtTimeLink
     //     TimeNode "timestamp"
@@ -1222,55 +1244,10 @@ float AtomSpaceUtil::getCurrentModulatorLevel(AtomSpace & atomSpace,
     //         NumberNode "modulator_value"
     //         ExecutionOutputLink
     //            ...
+    Handle hLatestAtTimeLink = timeServer().getLatestAtTimeLink(hExecutionOutputLink);
 
-    std::vector<Handle> similarityLinkSet;
-
-    getIncomingSet(back_inserter(similarityLinkSet), hExecutionOutputLink, SIMILARITY_LINK, false);
-
-    logger().debug("AtomSpaceUtil::%s - Get %d SimilarityLink that holds modulator updater (ExecutionOutputLink)",
-                   __FUNCTION__,
-                   similarityLinkSet.size()
-                  );
-
-    // Get all the HandleTemporalPairs of SimilarityLink
-    std::vector<HandleTemporalPair> handleTemporalPairs;
-
-    for (Handle hSimilarityLink : similarityLinkSet) {
-        timeServer().getTimeInfo( back_inserter(handleTemporalPairs),
-                                               hSimilarityLink
-                                             );
-    }
-
-    logger().debug("AtomSpaceUtil::%s - Get %d HandleTemporalPairs of SimilarityLink that holds the modulator updater (ExecutionOutputLink)",
-                   __FUNCTION__,
-                   handleTemporalPairs.size()
-                  );
-
-    // Pick up the HandleTemporalPair with latest temporal (greatest temporal)
-    // Note:
-    //     1. We assume the SimilarityLink contains a NumberNode without checking,
-    //        if not there's a chance that it would find a latest SimilarityLink without a NUmberNode,
-    //        this might cause some problem
-    //     2. you can use std::sort and HandleTemporalPairEntry::SortComparison to sort the whole HandleTemporalPairs
-    std::vector<HandleTemporalPair>::iterator iHandleTemporalPair;
-    std::vector<HandleTemporalPair>::iterator iLatestHandleTemporalPair;
-
-    iHandleTemporalPair = handleTemporalPairs.begin();
-    iLatestHandleTemporalPair = handleTemporalPairs.begin();
-
-    while ( iHandleTemporalPair != handleTemporalPairs.end() ) {
-
-        if ( HandleTemporalPairEntry::handleTemporalPairCompare
-                (&*iHandleTemporalPair,
-                 &*iLatestHandleTemporalPair) > 0 ) {
-            iLatestHandleTemporalPair = iHandleTemporalPair;
-        }
-
-        iHandleTemporalPair ++;
-    }
-
-    if ( iLatestHandleTemporalPair == handleTemporalPairs.end() ) {
-        logger().warn("AtomSpaceUtil::%s - Failed to find the latest HandleTemporalPair that contains '%s'. Return random value: %f",
+    if ( hLatestAtTimeLink == Handle::UNDEFINED ) {
+        logger().warn("AtomSpaceUtil::%s - Failed to find the latest SimilarityLink that contains '%s'. Return random value: %f",
                       __FUNCTION__,
                       atomSpace.atomAsString(hExecutionOutputLink).c_str(),
                       errorValue
@@ -1279,7 +1256,7 @@ float AtomSpaceUtil::getCurrentModulatorLevel(AtomSpace & atomSpace,
     }
 
     // Get the latest NumberNode
-    Handle hLatestSimilarityLink = iLatestHandleTemporalPair->getHandle();
+    Handle hLatestSimilarityLink = atomSpace.getOutgoing(hLatestAtTimeLink, 1);
 
     if ( atomSpace.getArity(hLatestSimilarityLink) != 2 ) {
         logger().warn("AtomSpaceUtil::%s - The arity of SimilarityLink holding the modulator value (NumberNode) and modulator updater (ExecutionOutputLink) should be exactly 2. But Got %d.",
@@ -1315,7 +1292,7 @@ float AtomSpaceUtil::getCurrentModulatorLevel(AtomSpace & atomSpace,
 float AtomSpaceUtil::getCurrentDemandLevel(AtomSpace & atomSpace,
                                            const std::string & demandName)
 {
-    float errorValue = randGen().randfloat();   // If error happens, return this value anyway.
+    float errorValue = getThreadRandGen().randfloat();   // If error happens, return this value anyway.
 
     // Get the Handle to GroundSchemaNode
     std::string demandUpdater = demandName + "DemandUpdater";
@@ -1369,7 +1346,8 @@ float AtomSpaceUtil::getCurrentDemandLevel(AtomSpace & atomSpace,
 
     Handle hExecutionOutputLink = *iExecutionOutputLink;
 
-    // Get all the SimilarityLink that contains the ExecutionOutputLink
+    // Get the latest SimilarityLink that contains the ExecutionOutputLink,
+    // from the index of the TimeServer
     //
     // AtTimeLink
     //     TimeNode "timestamp"
@@ -1377,55 +1355,10 @@ float AtomSpaceUtil::getCurrentDemandLevel(AtomSpace & atomSpace,
     //         NumberNode "demand_level"
     //         ExecutionOutputLink
     //            ...
+    Handle hLatestAtTimeLink = timeServer().getLatestAtTimeLink(hExecutionOutputLink);
 
-    std::vector<Handle> similarityLinkSet;
-
-    getIncomingSet(back_inserter(similarityLinkSet), hExecutionOutputLink, SIMILARITY_LINK, false);
-
-    logger().debug("AtomSpaceUtil::%s - Get %d SimilarityLink that holds demand updater (ExecutionOutputLink)",
-                   __FUNCTION__,
-                   similarityLinkSet.size()
-                  );
-
-    // Get all the HandleTemporalPairs of SimilarityLink
-    std::vector<HandleTemporalPair> handleTemporalPairs;
-
-    for (Handle hSimilarityLink : similarityLinkSet) {
-        timeServer().getTimeInfo( back_inserter(handleTemporalPairs),
-                                               hSimilarityLink
-                                             );
-    }
-
-    logger().debug("AtomSpaceUtil::%s - Get %d HandleTemporalPairs of SimilarityLink that holds the demand updater (ExecutionOutputLink)",
-                   __FUNCTION__,
-                   handleTemporalPairs.size()
-                  );
-
-    // Pick up the HandleTemporalPair with latest temporal (greatest temporal)
-    // Note:
-    //     1. We assume the SimilarityLink contains a NumberNode without checking,
-    //        if not there's a chance that it would find a latest SimilarityLink without a NUmberNode,
-    //        this might cause some problem
-    //     2. you can use std::sort and HandleTemporalPairEntry::SortComparison to sort the whole HandleTemporalPairs
-    std::vector<HandleTemporalPair>::iterator iHandleTemporalPair;
-    std::vector<HandleTemporalPair>::iterator iLatestHandleTemporalPair;
-
-    iHandleTemporalPair = handleTemporalPairs.begin();
-    iLatestHandleTemporalPair = handleTemporalPairs.begin();
-
-    while ( iHandleTemporalPair != handleTemporalPairs.end() ) {
-
-        if ( HandleTemporalPairEntry::handleTemporalPairCompare
-                (&*iHandleTemporalPair,
-                 &*iLatestHandleTemporalPair) > 0 ) {
-            iLatestHandleTemporalPair = iHandleTemporalPair;
-        }
-
-        iHandleTemporalPair ++;
-    }
-
-    if ( iLatestHandleTemporalPair == handleTemporalPairs.end() ) {
-        logger().warn("AtomSpaceUtil::%s - Failed to find the latest HandleTemporalPair that contains '%s'. Return random value: %f",
+    if ( hLatestAtTimeLink == Handle::UNDEFINED ) {
+        logger().warn("AtomSpaceUtil::%s - Failed to find the latest SimilarityLink that contains '%s'. Return random value: %f",
                       __FUNCTION__,
                       atomSpace.atomAsString(hExecutionOutputLink).c_str(),
                       errorValue
@@ -1434,7 +1367,7 @@ float AtomSpaceUtil::getCurrentDemandLevel(AtomSpace & atomSpace,
     }
 
     // Get the latest NumberNode
-    Handle hLatestSimilarityLink = iLatestHandleTemporalPair->getHandle();
+    Handle hLatestSimilarityLink = atomSpace.getOutgoing(hLatestAtTimeLink, 1);
 
     if ( atomSpace.getArity(hLatestSimilarityLink) != 2 ) {
         logger().warn("AtomSpaceUtil::%s - The arity of SimilarityLink holding the demand level (NumberNode) and demand updater (ExecutionOutputLink) should be exactly 2. But Got %d.",
@@ -1834,40 +1767,14 @@ Handle AtomSpaceUtil::getMostRecentIsHoldingAtTimeLink(AtomSpace& atomSpace,
         return Handle::UNDEFINED;
     } // if
 
-    std::vector<Handle> handles;
-    getIncSet( back_inserter(handles),
-                            IS_HOLDING_PREDICATE_NAME,
-                            PREDICATE_NODE, EVALUATION_LINK, true );
-
-    std::vector<HandleTemporalPair> timestamps;
-    for ( unsigned int i = 0; i < handles.size(); ++i ) {
-        Handle listLink = atomSpace.getOutgoing(handles[i], 1);
-        if ( listLink != Handle::UNDEFINED ) {
-            // get only holder's eval-links
-            if ( atomSpace.getOutgoing(listLink, 0) == holderHandle ) {
-                timeServer().getTimeInfo( back_inserter( timestamps ),
-                                       handles[i]);
-            }
-        }
-    }
-
-    // get the most recent eval link
-    if ( timestamps.size( ) > 0 ) {
-        int mostRecentIndex = 0;
-        Temporal *mostRecent = timestamps[mostRecentIndex].getTemporal();
-        for (unsigned int i = 1; i < timestamps.size(); i++) {
-            if (*(timestamps[i].getTemporal()) > *mostRecent) {
-                mostRecent = timestamps[i].getTemporal();
-                mostRecentIndex = i;
-            }
-        }
-
-        logger().debug("AtomSpaceUtil - The most recent holded object %ul",
-                      timestamps[mostRecentIndex].getTemporal()->getUpperBound() );
+    Handle isHoldingPredicate = atomSpace.getHandle( PREDICATE_NODE,
+                                IS_HOLDING_PREDICATE_NAME );
+    if ( isHoldingPredicate == Handle::UNDEFINED ) {
+        return Handle::UNDEFINED;
+    } // if
 
-        return timeServer().getAtTimeLink(timestamps[mostRecentIndex]);
-    }
-    return Handle::UNDEFINED;
+    // get the most recent eval link of the holder
+    return timeServer().getLatestAtTimeLink(isHoldingPredicate, holderHandle);
 }
 
 Handle AtomSpaceUtil::getMostRecentIsHoldingLink(AtomSpace& atomSpace,
@@ -2201,6 +2108,27 @@ Handle AtomSpaceUtil::getMostRecentAgentActionLink(AtomSpace& atomSpace,
 {
     // reference: http://wiki.opencog.org/w/PerceptionActionInterface
 
+    // The latest action of the agent, whatever its time, is indexed by
+    // the TimeServer; only the temporal queries need a scan.
+    if ( temporal == UNDEFINED_TEMPORAL ) {
+        Handle agentHandle = getAgentHandle( atomSpace, agentId );
+        Handle predicateNodeHandle = atomSpace.getHandle( PREDICATE_NODE,
+                                     ACTION_DONE_PREDICATE_NAME );
+        if ( agentHandle == Handle::UNDEFINED ||
+                predicateNodeHandle == Handle::UNDEFINED ) {
+            return Handle::UNDEFINED;
+        } // if
+
+        Handle atTimeLink = timeServer().getLatestAtTimeLink(
+                                predicateNodeHandle, agentHandle );
+        if ( atTimeLink == Handle::UNDEFINED ) {
+            return Handle::UNDEFINED;
+        } // if
+
+        Handle evalLink = atomSpace.getOutgoing(atTimeLink, 1);
+        return atomSpace.getOutgoing(evalLink, 1);
+    } // if
+
     Handle latestActionDoneLink = Handle::UNDEFINED;
     std::string agentType = "unknown";
 
@@ -3830,3 +3758,14 @@ void AtomSpaceUtil::deleteFrameInstance( AtomSpace& atomSpace, Handle frameInsta
     } // for
 
 }
+
+RandGen& AtomSpaceUtil::getThreadRandGen( )
+{
+    static std::mutex seedMutex;
+    static thread_local std::unique_ptr<MT19937RandGen> rng;
+    if ( !rng ) {
+        std::lock_guard<std::mutex> lock( seedMutex );
+        rng.reset( new MT19937RandGen( randGen().randint( ) ) );
+    } // if
+    return *rng;
+}
@@ -32,6 +32,8 @@
  * Class with util methods for related to AtomSpace manipulation
  */
 
+#include <opencog/util/RandGen.h>
+
 #include <opencog/atomspace/AtomSpace.h>
 
 #include <opencog/spatial/math/Vector3.h>
@@ -131,6 +133,20 @@ private:
                                               AtomSpace & as,
                                               Handle atTimeLink);
 
+    /**
+     * Look for the say actions of from_h with the given message starting
+     * within temp. Return true as soon as one is found if timestamps is
+     * NULL, otherwise append the start times of all of them to
+     * timestamps. See getHasSaidValueAtTime for the other arguments.
+     */
+    static bool matchHasSaid(AtomSpace &atomSpace,
+                             const Temporal& temp,
+                             Handle from_h,
+                             Handle to_h,
+                             const std::string& message,
+                             bool include_to,
+                             std::vector<unsigned long>* timestamps);
+
 public:
 
     /**
@@ -468,6 +484,28 @@ public:
                                       const std::string& message,
                                       bool include_to = false);
 
+    /**
+     * Fill timestamps with the times (in increasing order) at which an
+     * avatar started to say a given message within temp. This allows to
+     * compute the truth value of has_said over a whole interval at once
+     * instead of sampling it with getHasSaidValueAtTime.
+     *
+     * @param atomSpace    atomSpace to search
+     * @param temp         time interval where the say actions must start
+     * @param from_h       Handle of the source of the message
+     * @param to_h         Handle of the destination of the message
+     * @param message      message
+     * @param timestamps   output, the start times of the say actions found
+     * @param include_to   see getHasSaidValueAtTime
+     */
+    static void getHasSaidTimestamps(AtomSpace &atomSpace,
+                                     const Temporal& temp,
+                                     Handle from_h,
+                                     Handle to_h,
+                                     const std::string& message,
+                                     std::vector<unsigned long>& timestamps,
+                                     bool include_to = false);
+
     /**
      * Return the lastest handle ( with the latest timestamp ) among a handle set
      */
@@ -1284,6 +1322,14 @@ public:
      */
     static void deleteFrameInstance( AtomSpace& atomSpace, Handle frameInstance );
 
+    /**
+     * The random generator of the calling thread, seeded from randGen()
+     * the first time the thread uses it. The world evaluations draw from
+     * it rather than from randGen(), which cannot be shared between
+     * threads, so that fitness estimations can run concurrently.
+     */
+    static RandGen& getThreadRandGen( );
+
 };
 
 
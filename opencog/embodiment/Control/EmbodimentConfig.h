@@ -241,6 +241,20 @@ protected:
             //or from the start (the empty combo_tree) (value true)
             "HC_NEW_EXEMPLAR_INITIALIZES_CENTER",
                                             "true",
+
+            //number of threads used by hillclimbing to estimate the
+            //fitness of the candidates of a neighborhood
+            "HC_FITNESS_ESTIMATION_THREADS", "1",
+
+            //max number of fitness estimations kept in the hillclimbing
+            //cache (0 to disable it), the cache is cleared whenever a new
+            //exemplar comes
+            "HC_ESTIMATOR_CACHE_SIZE",      "500000",
+
+            //if true the fitness estimator stops replaying the exemplars
+            //of a candidate as soon as it cannot beat the best candidate
+            //estimated so far in hillclimbing
+            "HC_EARLY_TERMINATION",         "false",
             
             //signed integer that indicates the size of
             //1) while operators
@@ -26,8 +26,12 @@
 
 #ifndef WIN32
 #include <unistd.h>
+#include <sys/wait.h>
+#include <signal.h>
 #endif
 
+#include <fstream>
+
 #include <boost/lexical_cast.hpp>
 
 #include <opencog/embodiment/Control/LoggerFactory.h>
@@ -99,9 +103,98 @@ void Spawner::releaseOacPort(const string& petId)
     }
 }
 
+pid_t Spawner::launchOac(const string& petId, const string& command)
+{
+#ifndef WIN32
+    // the shell takes care of the redirections of the command line and
+    // is then replaced by it. The command is built before forking, since
+    // the child may only make async-signal-safe calls until exec
+    string execCommand = "exec " + command;
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", execCommand.c_str(), (char*) NULL);
+        _exit(127);
+    }
+    if (pid > 0) {
+        petId2PidMap[petId] = pid;
+    }
+    return pid;
+#else
+    return system((command + " &").c_str()) ? -1 : 0;
+#endif
+}
+
+void Spawner::reapOacs()
+{
+#ifndef WIN32
+    // only wait for the OACs launched here, other children of the process
+    // are left to whoever started them
+    std::map<string, pid_t>::iterator it = petId2PidMap.begin();
+    while (it != petId2PidMap.end()) {
+        int status;
+        pid_t pid = waitpid(it->second, &status, WNOHANG);
+        if (pid == 0) {
+            ++it;
+            continue;
+        }
+        if (pid > 0) {
+            logger().info("Spawner - OAC %s (pid %d) exited with status %d.",
+                          it->first.c_str(), pid, status);
+        } else {
+            // e.g. ECHILD, the process is not ours to wait for anymore
+            logger().warn("Spawner - Lost track of OAC %s (pid %d).",
+                          it->first.c_str(), it->second);
+        }
+        petId2PidMap.erase(it++);
+    }
+#endif
+}
+
+std::string Spawner::getMemoryReport()
+{
+    reapOacs();
+
+    long pageKb = 4;
+#ifndef WIN32
+    pageKb = sysconf(_SC_PAGESIZE) / 1024;
+#endif
+
+    std::stringstream report;
+    unsigned long totalResident = 0, totalShared = 0;
+    for (std::map<string, pid_t>::const_iterator it = petId2PidMap.begin();
+         it != petId2PidMap.end(); ++it) {
+        // see proc(5), the fields are in pages
+        std::ifstream statm(("/proc/" + boost::lexical_cast<string>(it->second)
+                             + "/statm").c_str());
+        unsigned long size = 0, resident = 0, shared = 0;
+        if (!(statm >> size >> resident >> shared)) {
+            report << it->first << " " << it->second << " unavailable\n";
+            continue;
+        }
+        resident *= pageKb;
+        shared *= pageKb;
+        totalResident += resident;
+        totalShared += shared;
+        report << it->first << " " << it->second
+               << " resident=" << resident << "kB"
+               << " shared=" << shared << "kB"
+               << " private=" << resident - shared << "kB\n";
+    }
+    unsigned long pets = petId2PidMap.size();
+    report << "total pets=" << pets
+           << " resident=" << totalResident << "kB"
+           << " private=" << totalResident - totalShared << "kB";
+    if (pets > 0) {
+        report << " private per pet=" << (totalResident - totalShared) / pets << "kB";
+    }
+    return report.str();
+}
+
 bool Spawner::processNextMessage(Message *message)
 {
 
+    reapOacs();
+
     string cmdLine = message->getPlainTextRepresentation();
     string command;
     std::queue<string> args;
@@ -132,6 +225,7 @@ bool Spawner::processNextMessage(Message *message)
         //logger().warn("Trying to load an OAC that is already available: %s\n", petID.c_str());
         // TODO: send the LOAD SUCCESS message back
         //}
+        // the command line is run in the background by launchOac
         std::stringstream command_ss;
         //char str[512];
         int oacPort = allocateOacPort(agentID);
@@ -167,9 +261,9 @@ bool Spawner::processNextMessage(Message *message)
                 if(config().get_bool("ENABLE_UNITY_CONNECTOR")) {
                     // This is a hack. To redirect "PROXY_ID" setting to agent id.
                     // There are also some tweaks in OAC code.
-                    command_ss << message->getFrom() << " " << cmdSuffix << " &";
+                    command_ss << message->getFrom() << " " << cmdSuffix;
                 } else {
-                    command_ss << cmdSuffix << " &";
+                    command_ss << cmdSuffix;
                 }
 
             }
@@ -193,16 +287,16 @@ bool Spawner::processNextMessage(Message *message)
                 cmdPrefix += " --depth=";
                 cmdPrefix += config().get("MASSIF_DEPTH");
                 cmdPrefix += " ";
-                cmdSuffix += " > oac.valgrind.massif 2>&1 &";
+                cmdSuffix += " > oac.valgrind.massif 2>&1";
             }
             command_ss << cmdPrefix << "./oac " << agentArgs << " ";
 
 			if(config().get_bool("ENABLE_UNITY_CONNECTOR")) {
 				// This is a hack. To redirect "PROXY_ID" setting to agent id.
 				// There are also some tweaks in OAC code.
-				command_ss << message->getFrom() << " " << cmdSuffix << " &";
+				command_ss << message->getFrom() << " " << cmdSuffix;
 			} else {
-				command_ss << cmdSuffix << " &";
+				command_ss << cmdSuffix;
 			}
         }
         logger().info("Starting OAC for %s %s %s (%s) at NE port %d; Shell port %d; ZeroMQ publish port %d; (command: %s)", 
@@ -217,13 +311,15 @@ bool Spawner::processNextMessage(Message *message)
                      );
 
         if (!config().get_bool("MANUAL_OAC_LAUNCH")) {
-            int rc = system(command_ss.str().c_str( ) );
-            if (rc) {
+            pid_t pid = launchOac(agentID, command_ss.str());
+            if (pid < 0) {
                 cerr << "Ohhhh Nooooo Mr. Bill !!!!!!!!" << endl;
                 _exit(1);
             }
+            logger().info("Spawner - OAC %s started with pid %d.",
+                          agentID.c_str(), pid);
         } else {
-            printf("\nSpawner Command: %s\n", command_ss.str().c_str());
+            printf("\nSpawner Command: %s &\n", command_ss.str().c_str());
         }
     } else if (command == "UNLOAD_AGENT") {
         const string& agentID = args.front();
@@ -240,6 +336,12 @@ bool Spawner::processNextMessage(Message *message)
         sendMessage(saveExit);
 
         releaseOacPort(agentID);
+    } else if (command == "MEMORY_REPORT") {
+        // resident memory of the running OACs, sent back to the requester
+        string report = getMemoryReport();
+        logger().info("Spawner - memory report:\n%s", report.c_str());
+        StringMessage reply(getID(), message->getFrom(), report);
+        sendMessage(reply);
     } else {
         logger().warn("Unknown command <%s>. Discarding it", command.c_str());
     }
@@ -26,6 +26,7 @@
 #define SPAWNER_H
 
 #include <exception>
+#include <sys/types.h>
 #include <opencog/util/Logger.h>
 #include <opencog/util/exceptions.h>
 #include <opencog/embodiment/Control/EmbodimentConfig.h>
@@ -33,6 +34,12 @@
 
 namespace opencog { namespace messaging {
 
+/**
+ * Launches one OAC process per pet, on request of the router. Each OAC is
+ * a whole CogServer with its own AtomSpace, TimeServer and SpaceServer,
+ * so pets don't share any memory besides the code; MEMORY_REPORT tells
+ * how much each of them costs.
+ */
 class Spawner : public MessageCogServer
 {
 
@@ -40,6 +47,19 @@ private:
     int minOacPort, maxOacPort;
     std::map<int, std::string> port2PetIdMap;
     std::map<std::string, int> petId2PortMap;
+    std::map<std::string, pid_t> petId2PidMap;
+
+    /**
+     * Runs the given shell command line in a child process (replaced by
+     * the command through exec, so that the pid is the one of the OAC)
+     * and records its pid for the given pet id. Returns -1 on failure.
+     */
+    pid_t launchOac(const std::string& petId, const std::string& command);
+
+    /**
+     * Collects the OAC processes launched by launchOac that have exited.
+     */
+    void reapOacs();
 
 public:
 
@@ -68,6 +88,14 @@ public:
      */
     void releaseOacPort(const std::string& petId);
 
+    /**
+     * Returns one line per OAC launched by this spawner with its pid and
+     * its resident memory (total, shared with other processes and
+     * private, in kB) followed by the totals. The private part is what
+     * each additional pet costs.
+     */
+    std::string getMemoryReport();
+
 }; // class
 
 } } // namespace opencog::messaging
@@ -156,9 +156,8 @@ void DefaultAgentModeHandler::handleCommand( const std::string& name, const std:
                 logger().debug("DefaultAgentModeHandler - Setting visibility for tiles range %d - %d", range[j], range[j+1] );
                 for ( k = range[j]; k <= range[j+1]; ++k ) {
                     try {
-                        const spatial::VisibilityMap::TilePtr& tile = visibilityMap->getTile( row, k );
                         logger().debug("DefaultAgentModeHandler - Setting visibility for tile row: %d col: %d", row, k );
-                        tile->setVisibility( true );
+                        visibilityMap->setVisibility( row, k, true );
                     } catch ( opencog::NotFoundException& ex ) {
                         logger().error("DefaultAgentModeHandler - There was an attempt to access an invalid tile row: %d col: %d", row, k );
                     } // catch
@@ -57,6 +57,32 @@ using namespace opencog::pai;
 AtomSpace* Inquery::atomSpace= 0;
 SpaceServer::SpaceMap* Inquery::spaceMap = 0;
 
+map<string, ParamValue> Inquery::valueCache;
+map<string, vector<ParamValue> > Inquery::valuesCache;
+map<string, set<spatial::SPATIAL_RELATION> > Inquery::relationsCache;
+
+// when a cache grows bigger than this, it is cleared
+#define INQUERY_CACHE_MAX_SIZE 100000
+
+namespace
+{
+    template<typename T>
+    T cachedInquery(map<string, T>& cache, const string& key,
+                    T (*inquery)(const vector<ParamValue>&), const vector<ParamValue>& stateOwnerList)
+    {
+        typename map<string, T>::const_iterator it = cache.find(key);
+        if (it != cache.end())
+            return it->second;
+
+        if (cache.size() >= INQUERY_CACHE_MAX_SIZE)
+            cache.clear();
+
+        T result = inquery(stateOwnerList);
+        cache.insert(typename map<string, T>::value_type(key, result));
+        return result;
+    }
+}
+
 
  void Inquery::init(AtomSpace* _atomSpace)
  {
@@ -72,6 +98,47 @@ SpaceServer::SpaceMap* Inquery::spaceMap = 0;
  void Inquery::reSetSpaceMap()
  {
      spaceMap = &(spaceServer().getLatestMap());
+     clearCache();
+ }
+
+ void Inquery::clearCache()
+ {
+     valueCache.clear();
+     valuesCache.clear();
+     relationsCache.clear();
+ }
+
+ string Inquery::getCacheKey(const char* inqueryName, const vector<ParamValue>& stateOwnerList)
+ {
+     string key = opencog::toString(spaceMap->getRevision()) + " " + inqueryName;
+
+     vector<ParamValue>::const_iterator it;
+     for (it = stateOwnerList.begin(); it != stateOwnerList.end(); ++ it)
+     {
+         // the type of the value as well, a vector and an entity may have the same string
+         key += " " + opencog::toString(it->which()) + ActionParameter::ParamValueToString(*it);
+     }
+
+     return key;
+ }
+
+ bool Inquery::getPosition(const ParamValue& value, spatial::BlockVector& pos)
+ {
+     const Entity* entity = boost::get<Entity>(&value);
+     if (entity)
+     {
+         pos = spaceMap->getObjectLocation(entity->id);
+         return true;
+     }
+
+     const Vector* v = boost::get<Vector>(&value);
+     if (v)
+     {
+         pos = SpaceServer::SpaceMapPoint(v->x,v->y,v->z);
+         return true;
+     }
+
+     return false;
  }
 
  Handle Inquery::getStateOwnerHandle(ParamValue &stateOwnerParamValue)
@@ -393,6 +460,11 @@ ParamValue Inquery::getParamValueFromHandle(string var, Handle& valueH)
 }
 
 ParamValue Inquery::inqueryDistance(const vector<ParamValue>& stateOwnerList)
+{
+    return cachedInquery(valueCache, getCacheKey("Distance", stateOwnerList), &Inquery::_inqueryDistance, stateOwnerList);
+}
+
+ParamValue Inquery::_inqueryDistance(const vector<ParamValue>& stateOwnerList)
 {
     double d = DOUBLE_MAX;
     ParamValue var1 = stateOwnerList.front();
@@ -499,6 +571,11 @@ ParamValue Inquery::inqueryIsStandable(const vector<ParamValue>& stateOwnerList)
 }
 
 ParamValue Inquery::inqueryExistPath(const vector<ParamValue>& stateOwnerList)
+{
+    return cachedInquery(valueCache, getCacheKey("existPath", stateOwnerList), &Inquery::_inqueryExistPath, stateOwnerList);
+}
+
+ParamValue Inquery::_inqueryExistPath(const vector<ParamValue>& stateOwnerList)
 {
     ParamValue var1 = stateOwnerList.front();
     ParamValue var2 = stateOwnerList.back();
@@ -543,7 +620,79 @@ ParamValue Inquery::inqueryExistPath(const vector<ParamValue>& stateOwnerList)
         return "false";
 }
 
+vector<ParamValue> Inquery::inqueryExistPaths(const ParamValue& from, const vector<ParamValue>& toList)
+{
+    vector<ParamValue> values(toList.size(), ParamValue("false"));
+    vector<ParamValue> stateOwnerList;
+    stateOwnerList.push_back(from);
+    stateOwnerList.push_back(from);
+
+    spatial::BlockVector pos1;
+    bool fromStandable = getPosition(from, pos1) && spaceMap->checkStandable(pos1);
+
+    // the positions to search a path to, and the toList indexes they are for
+    vector<spatial::BlockVector> targets;
+    vector<size_t> targetIndexes;
+    vector<string> keys(toList.size());
+
+    for (size_t i = 0; i < toList.size(); i ++)
+    {
+        stateOwnerList.back() = toList[i];
+        keys[i] = getCacheKey("existPath", stateOwnerList);
+
+        map<string, ParamValue>::const_iterator cached = valueCache.find(keys[i]);
+        if (cached != valueCache.end())
+        {
+            values[i] = cached->second;
+            keys[i].clear(); // no need to cache it again
+            continue;
+        }
+
+        spatial::BlockVector pos2;
+        if ( (! fromStandable) || (! getPosition(toList[i], pos2)) || (! spaceMap->checkStandable(pos2)))
+            continue;
+
+        // the same as inqueryExistPath, two adjacent positions are only checked for a direct move
+        if (SpaceServer::SpaceMap::isTwoPositionsAdjacent(pos1, pos2))
+        {
+            if (spatial::Pathfinder3D::checkNeighbourAccessable(spaceMap, pos1, pos2.x - pos1.x, pos2.y - pos1.y, pos2.z - pos1.z))
+                values[i] = "true";
+            continue;
+        }
+
+        targets.push_back(pos2);
+        targetIndexes.push_back(i);
+    }
+
+    if (targets.size() != 0)
+    {
+        vector<bool> reachable;
+        spatial::Pathfinder3D::findReachableTargets(spaceMap, pos1, targets, reachable);
+        for (size_t t = 0; t < targets.size(); t ++)
+        {
+            if (reachable[t])
+                values[targetIndexes[t]] = "true";
+        }
+    }
+
+    if (valueCache.size() + toList.size() >= INQUERY_CACHE_MAX_SIZE)
+        valueCache.clear();
+
+    for (size_t i = 0; i < toList.size(); i ++)
+    {
+        if (! keys[i].empty())
+            valueCache[keys[i]] = values[i];
+    }
+
+    return values;
+}
+
 vector<ParamValue> Inquery::inqueryNearestAccessiblePosition(const vector<ParamValue>& stateOwnerList)
+{
+    return cachedInquery(valuesCache, getCacheKey("nearestAccessiblePosition", stateOwnerList), &Inquery::_inqueryNearestAccessiblePosition, stateOwnerList);
+}
+
+vector<ParamValue> Inquery::_inqueryNearestAccessiblePosition(const vector<ParamValue>& stateOwnerList)
 {
     ParamValue var1 = stateOwnerList.front();
     ParamValue var2 = stateOwnerList.back();
@@ -582,6 +731,11 @@ vector<ParamValue> Inquery::inqueryNearestAccessiblePosition(const vector<ParamV
 }
 
 vector<ParamValue> Inquery::inqueryBestAccessiblePosition(const vector<ParamValue>& stateOwnerList)
+{
+    return cachedInquery(valuesCache, getCacheKey("bestAccessiblePosition", stateOwnerList), &Inquery::_inqueryBestAccessiblePosition, stateOwnerList);
+}
+
+vector<ParamValue> Inquery::_inqueryBestAccessiblePosition(const vector<ParamValue>& stateOwnerList)
 {
     ParamValue var1 = stateOwnerList.front();
     ParamValue var2 = stateOwnerList.back();
@@ -620,6 +774,11 @@ vector<ParamValue> Inquery::inqueryBestAccessiblePosition(const vector<ParamValu
 }
 
 vector<ParamValue> Inquery::inqueryAdjacentAccessPosition(const vector<ParamValue>& stateOwnerList)
+{
+    return cachedInquery(valuesCache, getCacheKey("adjacentAccessPosition", stateOwnerList), &Inquery::_inqueryAdjacentAccessPosition, stateOwnerList);
+}
+
+vector<ParamValue> Inquery::_inqueryAdjacentAccessPosition(const vector<ParamValue>& stateOwnerList)
 {
     vector<ParamValue> values;
     ParamValue var1 = stateOwnerList.front();
@@ -958,6 +1117,11 @@ ParamValue Inquery::inqueryIsInFrontOf(const vector<ParamValue>& stateOwnerList)
 }
 
 set<spatial::SPATIAL_RELATION> Inquery::getSpatialRelations(const vector<ParamValue>& stateOwnerList)
+{
+    return cachedInquery(relationsCache, getCacheKey("spatialRelations", stateOwnerList), &Inquery::_getSpatialRelations, stateOwnerList);
+}
+
+set<spatial::SPATIAL_RELATION> Inquery::_getSpatialRelations(const vector<ParamValue>& stateOwnerList)
 {
     set<spatial::SPATIAL_RELATION> empty;
     if (stateOwnerList.size() < 2)
@@ -52,6 +52,16 @@ protected:
     static SpaceServer::SpaceMap* spaceMap;
     static set<spatial::SPATIAL_RELATION> getSpatialRelations(const vector<ParamValue>& stateOwnerList);
 
+    // The planner asks the same expensive inqueries again and again while it tries different bindings,
+    // so their results are cached until the end of the planning.
+    // The key is the revision of the spaceMap, the inquery name and the state owners, see getCacheKey(),
+    // so a result is never used for another map state, and clones of the same map share their results.
+    static map<string, ParamValue> valueCache;
+    static map<string, vector<ParamValue> > valuesCache;
+    static map<string, set<spatial::SPATIAL_RELATION> > relationsCache;
+
+    static string getCacheKey(const char* inqueryName, const vector<ParamValue>& stateOwnerList);
+
 public:
 
     static void init(AtomSpace* _atomSpace);
@@ -62,8 +72,11 @@ public:
     static void setSpaceMap(SpaceServer::SpaceMap* _spaceMap);
 
     // After planning, please reset the spaceMap back to the real one via calling this function
+    // It also clears the cache of the inquery results
     static void reSetSpaceMap();
 
+    static void clearCache();
+
     // only apply when getStateOwner is Entity or string
     static Handle getStateOwnerHandle(ParamValue &stateOwnerParamValue);
 
@@ -85,6 +98,10 @@ public:
     static ParamValue inqueryIsStandable(const vector<ParamValue>& stateOwnerList);
     static ParamValue inqueryExistPath(const vector<ParamValue>& stateOwnerList);
 
+    // inqueryExistPath from one position or entity to each of the toList, with one path search for all of them.
+    // The results are cached, so the following inqueryExistPath calls for them are free.
+    static vector<ParamValue> inqueryExistPaths(const ParamValue& from, const vector<ParamValue>& toList);
+
     // return a vector of all the possible values for grounding a variable in a rule
     // if cannot find proper value, return a empty vector
     static vector<ParamValue> inqueryNearestAccessiblePosition(const vector<ParamValue>& stateOwnerList);
@@ -159,6 +176,17 @@ public:
  private:
     static  HandleSeq _findCandidatesByPatternMatching(RuleNode *ruleNode, vector<int> &stateIndexes, vector<string>& varNames);
 
+    // the uncached inqueries
+    static ParamValue _inqueryDistance(const vector<ParamValue>& stateOwnerList);
+    static ParamValue _inqueryExistPath(const vector<ParamValue>& stateOwnerList);
+    static vector<ParamValue> _inqueryNearestAccessiblePosition(const vector<ParamValue>& stateOwnerList);
+    static vector<ParamValue> _inqueryBestAccessiblePosition(const vector<ParamValue>& stateOwnerList);
+    static vector<ParamValue> _inqueryAdjacentAccessPosition(const vector<ParamValue>& stateOwnerList);
+    static set<spatial::SPATIAL_RELATION> _getSpatialRelations(const vector<ParamValue>& stateOwnerList);
+
+    // the position of an entity in the spaceMap, or of a vector
+    static bool getPosition(const ParamValue& value, spatial::BlockVector& pos);
+
 
 };
 
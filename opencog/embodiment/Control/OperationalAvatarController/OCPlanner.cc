@@ -38,6 +38,7 @@
 
 #include <stdlib.h>
 #include <map>
+#include <algorithm>
 #include <math.h>
 #include <cstdio>
 #include <sstream>
@@ -3502,6 +3503,11 @@ bool OCPlanner::selectValueForGroundingNumericState(Rule* rule, ParamGroundedMap
 ParamValue OCPlanner::selectBestNumericValueFromCandidates(Rule* rule, float basic_cost, vector<CostHeuristic>& costHeuristics, ParamGroundedMapInARule& currentbindings,
                                                            string varName, vector<ParamValue>& values, Rule *orginalRule, bool checkPrecons)
 {
+    if (orginalRule)
+        inqueryExistPathsForCandidates(orginalRule, currentbindings, varName, values);
+    else
+        inqueryExistPathsForCandidates(rule, currentbindings, varName, values);
+
     // check how many preconditions will be satisfied
     RuleNode* tmpRuleNode = new RuleNode(rule,0);
     tmpRuleNode->currentAllBindings = currentbindings;
@@ -3581,6 +3587,53 @@ ParamValue OCPlanner::selectBestNumericValueFromCandidates(Rule* rule, float bas
     return bestValue;
 }
 
+void OCPlanner::inqueryExistPathsForCandidates(Rule* rule, ParamGroundedMapInARule& currentbindings, string varName, vector<ParamValue>& values)
+{
+    if (values.size() < 2)
+        return;
+
+    vector<State*>::iterator preconIt;
+    for (preconIt = rule->preconditionList.begin(); preconIt != rule->preconditionList.end(); ++ preconIt)
+    {
+        State* precon = (State*)(*preconIt);
+        if (precon->inqueryStateFun != &Inquery::inqueryExistPath)
+            continue;
+
+        // the paths to inquery, grouped by their start
+        vector<ParamValue> froms;
+        vector< vector<ParamValue> > tos;
+
+        vector<ParamValue>::iterator vit;
+        for (vit = values.begin(); vit != values.end(); ++ vit)
+        {
+            currentbindings.insert(std::pair<string, ParamValue>(varName,*vit));
+            State* groundedState = Rule::groundAStateByRuleParamMap(precon, currentbindings, false, false);
+            currentbindings.erase(varName);
+
+            if (groundedState == 0)
+                continue;
+
+            ParamValue& from = groundedState->stateOwnerList.front();
+            vector<ParamValue>::iterator fromIt = std::find(froms.begin(), froms.end(), from);
+            if (fromIt == froms.end())
+            {
+                froms.push_back(from);
+                tos.push_back(vector<ParamValue>());
+                fromIt = froms.end() - 1;
+            }
+            tos[fromIt - froms.begin()].push_back(groundedState->stateOwnerList.back());
+
+            delete groundedState;
+        }
+
+        for (unsigned int i = 0; i < froms.size(); ++ i)
+        {
+            if (tos[i].size() > 1)
+                Inquery::inqueryExistPaths(froms[i], tos[i]);
+        }
+    }
+}
+
 // this function should be called after completely finished grounding a rule.but it is before the effect taking place.
 void OCPlanner::recordOrginalParamValuesAfterGroundARule(RuleNode* ruleNode)
 {
@@ -465,6 +465,10 @@ protected:
      ParamValue selectBestNumericValueFromCandidates(Rule* rule, float basic_cost, vector<CostHeuristic>& costHeuristics, ParamGroundedMapInARule& currentbindings,
                                                      string varName, vector<ParamValue>& values, Rule* orginalRule = 0, bool checkPrecons = true);
 
+     // answer the existPath preconditions of this rule for all the candidate values of varName at once,
+     // so that checking the preconditions for each value only gets the cached results
+     void inqueryExistPathsForCandidates(Rule* rule, ParamGroundedMapInARule& currentbindings, string varName, vector<ParamValue>& values);
+
      // to create the curUngroundedVariables list in a rule node
      // and the list is in the order of grounding priority (which variables should be gounded first, and for each variable which states should be satisfied first)
      void findAllUngroundedVariablesInARuleNode(RuleNode *ruleNode);
@@ -37,6 +37,23 @@ class BasicPredicateUpdater
 
 public:
 
+    /**
+     * What the predicates of an updater depend on. PredicatesUpdater only
+     * gives an updater the objects whose dependencies changed since the
+     * previous update.
+     */
+    enum Dependency
+    {
+        // the object was not known before, e.g. for predicates of its type
+        OBJECT_APPEARED = 1,
+        // the length, width or height of the object
+        OBJECT_SIZE = 2,
+        // the position or bounding box of the object in the latest space map
+        OBJECT_LOCATION = 4,
+
+        ANY_DEPENDENCY = OBJECT_APPEARED | OBJECT_SIZE | OBJECT_LOCATION
+    };
+
     /*
      * Constructor and destructor;
      */
@@ -67,6 +84,12 @@ public:
      */
     virtual void update(Handle object, Handle pet, unsigned long timestamp); 
 
+    /**
+     * Return the Dependency flags of the predicates of this updater. By
+     * default an updater depends on everything, so it gets all the objects.
+     */
+    virtual unsigned int getDependencies() const { return ANY_DEPENDENCY; }
+
     /**
      * Return true if there is already a is_X predicate created for the given
      * object handle.
@@ -37,6 +37,8 @@ public:
 
     void update(Handle object, Handle pet, unsigned long timestamp );
 
+    unsigned int getDependencies() const { return OBJECT_APPEARED; }
+
 
 }; // class
 
@@ -47,6 +47,8 @@ public:
 
     void update(Handle object, Handle pet, unsigned long timestamp );
 
+    unsigned int getDependencies() const { return OBJECT_APPEARED | OBJECT_SIZE; }
+
 }; // class
 
 } } // namespace opencog::oac
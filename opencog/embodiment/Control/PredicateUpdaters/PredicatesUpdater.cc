@@ -21,8 +21,14 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <boost/bind.hpp>
+
 #include <opencog/embodiment/AtomSpaceExtensions/atom_types.h>
+#include <opencog/embodiment/AtomSpaceExtensions/AtomSpaceUtil.h>
 #include <opencog/embodiment/Control/EmbodimentConfig.h>
+#include <opencog/spacetime/SpaceTime.h>
+#include <opencog/spacetime/SpaceServer.h>
+#include <opencog/spatial/3DSpaceMap/Entity3D.h>
 
 #include "PredicatesUpdater.h"
 #include "SpatialPredicateUpdater.h"
@@ -57,10 +63,15 @@ PredicatesUpdater::PredicatesUpdater(AtomSpace &_atomSpace, const std::string &_
         updaters.push_back(new SpatialPredicateUpdater(atomSpace));
 
     petPsychePredicatesUpdater = new PetPsychePredicatesUpdater(atomSpace);
+
+    removedAtomConnection = atomSpace.removeAtomSignal(
+        boost::bind(&PredicatesUpdater::atomRemoved, this, _1));
 }
 
 PredicatesUpdater::~PredicatesUpdater()
 {
+    removedAtomConnection.disconnect();
+
     for (BasicPredicateUpdater* updater : updaters) {
         delete updater;
     }
@@ -76,10 +87,66 @@ void PredicatesUpdater::update(std::vector<Handle> & objects, octime_t timestamp
         petHandle = atomSpace.getHandle(HUMANOID_NODE, petId);
     } 
 
-    for (BasicPredicateUpdater * updater : updaters)
-        updater->update(objects, petHandle, timestamp);
+    // what changed for each object since the previous update
+    std::vector<unsigned int> changes;
+    for (Handle object : objects)
+        changes.push_back(updateObjectState(object));
+
+    std::vector<Handle> changedObjects;
+    for (BasicPredicateUpdater * updater : updaters) {
+        unsigned int dependencies = updater->getDependencies();
+
+        changedObjects.clear();
+        for (unsigned int i = 0; i < objects.size(); ++i) {
+            if (changes[i] & dependencies)
+                changedObjects.push_back(objects[i]);
+        }
+
+        if (!changedObjects.empty())
+            updater->update(changedObjects, petHandle, timestamp);
+    }
 
     if (objects.size() > 0) {
         petPsychePredicatesUpdater->update(Handle::UNDEFINED, petHandle, timestamp);
     }
 }
+
+unsigned int PredicatesUpdater::updateObjectState(Handle object)
+{
+    ObjectState state;
+    state.length = state.width = state.height = 0.0;
+    AtomSpaceUtil::getSizeInfo(atomSpace, object, state.length, state.width, state.height);
+
+    state.onMap = false;
+    if (spaceServer().isLatestMapValid()) {
+        const spatial::Entity3D* entity = spaceServer().getLatestMap().getEntity(object);
+        if (entity) {
+            state.onMap = true;
+            state.boundingBox = entity->getBoundingBox();
+        }
+    }
+
+    std::map<Handle, ObjectState>::iterator it = objectStates.find(object);
+    if (it == objectStates.end()) {
+        objectStates.insert(std::map<Handle, ObjectState>::value_type(object, state));
+        return BasicPredicateUpdater::ANY_DEPENDENCY;
+    }
+
+    unsigned int changes = 0;
+    ObjectState& previous = it->second;
+    if (state.length != previous.length || state.width != previous.width ||
+            state.height != previous.height)
+        changes |= BasicPredicateUpdater::OBJECT_SIZE;
+
+    if (state.onMap != previous.onMap ||
+            (state.onMap && state.boundingBox != previous.boundingBox))
+        changes |= BasicPredicateUpdater::OBJECT_LOCATION;
+
+    previous = state;
+    return changes;
+}
+
+void PredicatesUpdater::atomRemoved(AtomPtr atom)
+{
+    objectStates.erase(atom->getHandle());
+}
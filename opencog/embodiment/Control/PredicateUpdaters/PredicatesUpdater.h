@@ -31,9 +31,13 @@
 #include "BasicPredicateUpdater.h"
 #include <opencog/embodiment/Control/AvatarInterface.h>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/spatial/3DSpaceMap/Block3DMapUtil.h>
 
+#include <map>
 #include <vector>
 
+#include <boost/signals2.hpp>
+
 using namespace opencog;
 
 namespace opencog { namespace oac {
@@ -41,7 +45,7 @@ namespace opencog { namespace oac {
 class PredicatesUpdater
 {
 
-private:
+protected:
 
     /**
      * holds all predicate updaters to be called when the update action
@@ -53,6 +57,35 @@ private:
     AtomSpace &atomSpace;
     std::string petId;
 
+    /**
+     * What the updaters depend on for an object, as it was at the previous
+     * update (see BasicPredicateUpdater::Dependency)
+     */
+    struct ObjectState
+    {
+        double length;
+        double width;
+        double height;
+        bool onMap;
+        spatial::AxisAlignedBox boundingBox;
+    };
+
+    std::map<Handle, ObjectState> objectStates;
+
+private:
+
+    /**
+     * Record the current state of the object and return the Dependency
+     * flags of what changed since the previous update.
+     */
+    unsigned int updateObjectState(Handle object);
+
+    /**
+     * Forget the state of the objects removed from the AtomSpace
+     */
+    boost::signals2::connection removedAtomConnection;
+    void atomRemoved(AtomPtr atom);
+
 public:
 
     PredicatesUpdater(AtomSpace &_atomSpace, const std::string &_petId);
@@ -63,6 +96,10 @@ public:
      * Update the predicates based on the objects that were created or changed 
      * via a PVPMessage processed by the PAI component.
      *
+     * Each updater only gets the objects whose changes it depends on, so
+     * the cost of an update follows the number of changes rather than the
+     * number of objects in the world.
+     *
      * @param objects A std::vector containing the handles of all OBJECT_NODES
      *                that were updated
      * @param timestamp The current timestamp in the virtual world.
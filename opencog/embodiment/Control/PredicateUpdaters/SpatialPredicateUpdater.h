@@ -58,6 +58,8 @@ public:
 
     void update(std::vector<Handle> & objects, Handle pet, unsigned long timestamp);
 
+    unsigned int getDependencies() const { return OBJECT_APPEARED | OBJECT_SIZE | OBJECT_LOCATION; }
+
 private:
 
     unsigned long lastTimestamp; 
@@ -0,0 +1,120 @@
+/*
+ * opencog/embodiment/Control/Procedure/ComboCompiler.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <sstream>
+
+#include <moses/comboreduct/interpreter/interpreter.h>
+#include <opencog/util/exceptions.h>
+
+#include "ComboCompiler.h"
+
+namespace opencog { namespace Procedure {
+
+using namespace combo;
+using world::WorldWrapperBase;
+
+namespace {
+
+bool to_bool(const vertex& v)
+{
+    if (v == id::logical_true)
+        return true;
+    if (v != id::logical_false) {
+        std::stringstream stream(std::stringstream::out);
+        stream << "Boolean operand expected. Got '" << v << "'";
+        throw ComboException(TRACE_INFO, "ComboCompiler - %s.",
+                             stream.str().c_str());
+    }
+    return false;
+}
+
+std::vector<compiled_expression> compile_children(combo_tree::iterator it,
+                                                  WorldWrapperBase& ww,
+                                                  const vertex_seq& arguments)
+{
+    std::vector<compiled_expression> children;
+    for (combo_tree::sibling_iterator sib = it.begin(); sib != it.end(); ++sib)
+        children.push_back(compile_expression(sib, ww, arguments));
+    return children;
+}
+
+} // ~anonymous namespace
+
+compiled_expression compile_expression(combo_tree::iterator it,
+                                       WorldWrapperBase& ww,
+                                       const vertex_seq& arguments)
+{
+    const vertex& v = *it;
+
+    if (const argument* a = boost::get<argument>(&v)) {
+        // same convention as RunningComboProcedure::eval_anything, a
+        // negative index is a negated boolean argument
+        arity_t idx = a->idx;
+        if (idx > 0)
+            return [&arguments, idx]() { return arguments[idx - 1]; };
+        return [&arguments, idx]() { return negate_vertex(arguments[-idx - 1]); };
+    }
+    else if (is_perception(v)) {
+        return [&ww, it]() { return ww.evalPerception(it); };
+    }
+    else if (const indefinite_object* io = boost::get<indefinite_object>(&v)) {
+        indefinite_object obj = *io;
+        return [&ww, obj]() { return ww.evalIndefiniteObject(obj); };
+    }
+    else if (is_definite_object(v) || is_action_symbol(v) || is_contin(v)
+             || v == id::logical_true || v == id::logical_false) {
+        vertex c = v;
+        return [c]() { return c; };
+    }
+    else if (v == id::logical_and) {
+        std::vector<compiled_expression> children =
+            compile_children(it, ww, arguments);
+        return [children]() -> vertex {
+            for (const compiled_expression& child : children)
+                if (!to_bool(child()))
+                    return id::logical_false;
+            return id::logical_true;
+        };
+    }
+    else if (v == id::logical_or) {
+        std::vector<compiled_expression> children =
+            compile_children(it, ww, arguments);
+        return [children]() -> vertex {
+            for (const compiled_expression& child : children)
+                if (to_bool(child()))
+                    return id::logical_true;
+            return id::logical_false;
+        };
+    }
+    else if (v == id::logical_not && it.number_of_children() == 1) {
+        compiled_expression child =
+            compile_expression(it.begin(), ww, arguments);
+        return [child]() -> vertex {
+            return to_bool(child()) ? id::logical_false : id::logical_true;
+        };
+    }
+    // anything else is left to the mixed interpreter, as it is done by
+    // RunningComboProcedure::eval_anything
+    return [it]() { mixed_interpreter mi; return mi(it); };
+}
+
+}} // ~namespace opencog::Procedure
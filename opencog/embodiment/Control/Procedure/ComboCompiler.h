@@ -0,0 +1,59 @@
+/*
+ * opencog/embodiment/Control/Procedure/ComboCompiler.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _COMBO_COMPILER_H
+#define _COMBO_COMPILER_H
+
+#include <functional>
+#include <vector>
+
+#include <moses/comboreduct/combo/vertex.h>
+#include <opencog/embodiment/WorldWrapper/WorldWrapper.h>
+
+namespace opencog { namespace Procedure {
+
+/**
+ * A non-action combo expression (the condition of a boolean_while or
+ * action_boolean_if, the count of a repeat_n, ...) lowered into a tree
+ * of closures.
+ *
+ * The tree is walked and the vertices dispatched on once, at compile
+ * time, instead of each time the expression is evaluated. Arguments are
+ * bound to their slot, constants are folded into the closure, and
+ * logical_and/logical_or short-circuit. Perceptions and indefinite
+ * objects are forwarded to the world wrapper (which may memoize them,
+ * see CachingWorldWrapper). Any other operator falls back to the mixed
+ * interpreter over the original subtree.
+ *
+ * The compiled expression refers to the tree it has been compiled from,
+ * to the world wrapper and to the arguments, which must therefore
+ * outlive it (and the subtree must not be modified).
+ */
+typedef std::function<combo::vertex()> compiled_expression;
+
+compiled_expression compile_expression(combo::combo_tree::iterator it,
+                                       world::WorldWrapperBase& ww,
+                                       const std::vector<combo::vertex>& arguments);
+
+}} // ~namespace opencog::Procedure
+
+#endif
@@ -39,12 +39,14 @@ using namespace std;
 
 using world::PAIWorldWrapper;
 
-ComboInterpreter::ComboInterpreter(PAI& p) : _ww(new PAIWorldWrapper(p)), _next(0)
+ComboInterpreter::ComboInterpreter(PAI& p)
+    : _ww(new CachingWorldWrapper(new PAIWorldWrapper(p))), _next(0)
 {
 }
 
 ComboInterpreter::~ComboInterpreter()
 {
+    delete _ww;
 }
 
 void ComboInterpreter::run(messaging::NetworkElement *ne)
@@ -54,6 +56,9 @@ void ComboInterpreter::run(messaging::NetworkElement *ne)
 
     std::set<RunningProcedureId> done;
 
+    // the world may have changed since the last run
+    _ww->clear();
+
 #if 0 // According to cpu time profiling, lazy_selector is taking too much time.
     lazy_selector* sel;
     if (!config().get_bool("AUTOMATED_SYSTEM_TESTS")) {
@@ -32,6 +32,7 @@
 #include <opencog/server/CogServer.h>
 #include <opencog/embodiment/Control/PerceptionActionInterface/PAI.h>
 #include <opencog/embodiment/WorldWrapper/PAIWorldWrapper.h>
+#include <opencog/embodiment/WorldWrapper/CachingWorldWrapper.h>
 #include <opencog/embodiment/Control/MessagingSystem/NetworkElement.h>
 
 #include "RunningProcedureId.h"
@@ -41,6 +42,7 @@ namespace opencog { namespace Procedure {
 
 using namespace pai;
 using world::WorldWrapperBase;
+using world::CachingWorldWrapper;
 
 typedef std::map<RunningProcedureId, RunningComboProcedure> Map;
 typedef std::vector<Map::iterator> Vec;
@@ -100,7 +102,10 @@ protected:
     typedef std::map<RunningProcedureId, combo::vertex> ResultMap;
 
 //    WorldWrapper::PAIWorldWrapper _ww;
-    WorldWrapperBase * _ww;
+    // memoizes the perceptions evaluated by the procedures during a
+    // single run, so that procedures sharing perceptions (or looping
+    // over the same condition) query the world only once per cycle
+    CachingWorldWrapper * _ww;
     Map _map;
     Vec _vec;
     Set _failed;
@@ -43,11 +43,11 @@ using namespace pai;
 RunningComboProcedure::RunningComboProcedure(WorldWrapperBase& ww,
         const combo::combo_tree& tr,
         const vertex_seq& arguments,
-        bool dsdp)
+        bool dsdp, bool doesCompile)
         : _ww(ww), _tr(tr), _arguments(arguments), _it(_tr.begin()),
         _hasBegun(false),
         _failed(boost::logic::indeterminate), _inCompound(false),
-        _doesSendDefinitePlan(dsdp)
+        _doesSendDefinitePlan(dsdp), _doesCompile(doesCompile)
 {
     finished = false;
 }
@@ -56,7 +56,8 @@ RunningComboProcedure::RunningComboProcedure(const RunningComboProcedure& rhs)
         : _ww(rhs._ww), _tr(rhs._tr), _arguments(rhs._arguments), _it(_tr.begin()),
         _hasBegun(false), _planSent(false),
         _failed(boost::logic::indeterminate), _inCompound(false),
-        _doesSendDefinitePlan(rhs._doesSendDefinitePlan)
+        _doesSendDefinitePlan(rhs._doesSendDefinitePlan),
+        _doesCompile(rhs._doesCompile)
 {
     if (_hasBegun != false || (!rhs._tr.empty() && rhs._it != rhs._tr.begin())) {
         std::stringstream stream (std::stringstream::out);
@@ -115,6 +116,23 @@ vertex RunningComboProcedure::eval_anything(sib_it it)
     }
 }
 
+vertex RunningComboProcedure::eval_condition(sib_it it)
+{
+    if (!_doesCompile)
+        return eval_anything(it);
+
+    const vertex* key = &*it;
+    std::map<const vertex*, compiled_expression>::iterator ci = _compiled.find(key);
+    if (ci == _compiled.end())
+        ci = _compiled.insert(make_pair(key, compile_expression(it, _ww, _arguments))).first;
+    return ci->second();
+}
+
+void RunningComboProcedure::reset_compiled()
+{
+    _compiled.clear();
+}
+
 void RunningComboProcedure::cycle() throw(ActionPlanSendingFailure,
                                           AssertionException,
                                           std::bad_exception)
@@ -186,7 +204,7 @@ void RunningComboProcedure::cycle() throw(ActionPlanSendingFailure,
         } else if (*_it == id::action_boolean_if) {
             try {
                 //vertex res = eval_throws_binding(empty, _it.begin(), this);
-                vertex res = eval_anything(_it.begin());
+                vertex res = eval_condition(_it.begin());
                 if (res == id::logical_true) {
                     _it = ++_it.begin();
                 } else if (res == id::logical_false) {
@@ -215,7 +233,7 @@ void RunningComboProcedure::cycle() throw(ActionPlanSendingFailure,
                 moveOn();
             } else {
                 try {
-                    vertex res = eval_anything(_it.begin());
+                    vertex res = eval_condition(_it.begin());
                     if (res == id::logical_true) {
                         _it = ++_it.begin();
                     } else {
@@ -238,11 +256,13 @@ void RunningComboProcedure::cycle() throw(ActionPlanSendingFailure,
             _it = _it.begin();
         } else if (*_it == id::action_success) {
             _tr = combo::combo_tree(*_it);
+            reset_compiled();
             _it = _tr.begin();
             moveOn();
 
         } else if (*_it == id::action_failure) {
             _tr = combo::combo_tree(*_it);
+            reset_compiled();
             _it = _tr.begin();
 
             logger().error(
@@ -259,7 +279,7 @@ void RunningComboProcedure::cycle() throw(ActionPlanSendingFailure,
         } else if (*_it == id::repeat_n) {
             if (_stack.empty() || _stack.top().first != _it) {
                 try {
-                    vertex res = eval_anything(_it.begin());
+                    vertex res = eval_condition(_it.begin());
                     OC_ASSERT(is_contin(res));
                     _stack.push(make_pair(_it, get_contin(res)));
                 } catch (...) {
@@ -380,6 +400,7 @@ void RunningComboProcedure::cycle() throw(ActionPlanSendingFailure,
 
 void RunningComboProcedure::stop() {
     _tr = combo::combo_tree(combo::id::null_vertex);
+    reset_compiled();
     _it = _tr.end();
 }
 
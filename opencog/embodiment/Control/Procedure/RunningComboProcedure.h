@@ -37,6 +37,7 @@
  */
 
 #include <stack>
+#include <map>
 #include <exception>
 #include <boost/logic/tribool.hpp>
 
@@ -48,6 +49,8 @@
 #include <opencog/embodiment/WorldWrapper/WorldWrapper.h>
 #include <opencog/embodiment/Control/PerceptionActionInterface/PAI.h>
 
+#include "ComboCompiler.h"
+
 namespace opencog { namespace Procedure {
 
 using namespace pai;
@@ -68,9 +71,13 @@ struct RunningComboProcedure {
     combo::vertex eval_indefinite_object(combo::indefinite_object);
 
     //construct an rp from a worldwrapper and a tree
+    //if doesCompile is true the conditions of the control structures
+    //are compiled (see ComboCompiler.h) the first time they are met
+    //instead of being interpreted at each evaluation
     RunningComboProcedure(WorldWrapperBase& ww, const combo::combo_tree& tr,
                           const std::vector<combo::vertex>& arguments,
-                          bool doesSendDefinitePlan = true);
+                          bool doesSendDefinitePlan = true,
+                          bool doesCompile = true);
 
     // Copy ctor - fatal runtime error if the rhs has already begun running
     RunningComboProcedure(const RunningComboProcedure&);
@@ -144,6 +151,13 @@ protected:
     void expand_and_evaluate_subtree(combo::combo_tree::iterator it);
 
     combo::vertex eval_anything(sib_it it);
+
+    /// evaluate the condition of a control structure, compiling it the
+    /// first time if _doesCompile is true
+    combo::vertex eval_condition(sib_it it);
+
+    /// must be called whenever _tr is replaced
+    void reset_compiled();
 private:
     /**
      * true if the combo interpreter evaluates the indefinite aguments
@@ -156,6 +170,11 @@ private:
      */
     bool _doesSendDefinitePlan;
 
+    bool _doesCompile;
+    //compiled conditions indexed by the address of their root vertex,
+    //which is stable as long as _tr is not replaced
+    std::map<const combo::vertex*, compiled_expression> _compiled;
+
     mutable bool finished;
 };
 
@@ -0,0 +1,209 @@
+/*
+ * opencog/embodiment/Control/Procedure/combo-procedure-benchmark.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Measure the number of combo procedures per second run the way the
+// ComboInterpreter runs them (one cycle of each ready procedure per
+// interpreter run), first interpreted against the world wrapper as it
+// used to be, then with compiled conditions and the perceptions
+// memoized within each run.
+//
+// The world is simulated: plans finish immediately and each perception
+// costs a configurable amount of busy work, standing for the spaceMap
+// and atomspace queries done by the PAIWorldWrapper.
+//
+// usage: combo-procedure-benchmark [-n procedures] [-c cost]
+//                                  [procedure-file]
+//
+// The procedure file holds one combo procedure per line, a default set
+// is used if none is given.
+
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencog/util/Logger.h>
+#include <opencog/embodiment/WorldWrapper/CachingWorldWrapper.h>
+#include <opencog/embodiment/AvatarComboVocabulary/AvatarComboVocabulary.h>
+
+#include "RunningComboProcedure.h"
+
+using namespace std;
+using namespace opencog;
+using namespace opencog::combo;
+using namespace opencog::world;
+using namespace opencog::Procedure;
+
+static const char* defaultProcedures[] = {
+    "repeat_n(20 action_boolean_if(and(exists_edible near(self nearest_edible) not(is_moving(owner))) sit jump_up))",
+    "repeat_n(20 action_boolean_if(or(is_moving(owner) near(self owner)) jump_up sit))",
+    "repeat_n(20 and_seq(action_boolean_if(near(self nearest_edible) sit jump_up) action_boolean_if(exists_edible jump_up sit)))",
+    NULL
+};
+
+/**
+ * Simulated world, every plan succeeds immediately
+ */
+class BenchmarkWorldWrapper : public WorldWrapperBase
+{
+public:
+    BenchmarkWorldWrapper(unsigned int cost)
+        : _cost(cost), _perceptions(0), _plans(0) {}
+
+    bool isPlanFinished() const { return true; }
+    bool isPlanFailed() const { return false; }
+
+    bool sendSequential_and(sib_it from, sib_it to) {
+        ++_plans;
+        return true;
+    }
+
+    combo::vertex evalPerception(pre_it per, combo::variable_unifier& vu) {
+        ++_perceptions;
+        // busy work standing for the world queries
+        volatile unsigned int x = 0;
+        for (unsigned int i = 0; i < _cost; i++)
+            x += i;
+        // a deterministic value so both runs take the same branches
+        return bool_to_vertex(combo_tree(per).size() % 2 == 1);
+    }
+
+    combo::vertex evalIndefiniteObject(indefinite_object io,
+                                       combo::variable_unifier& vu) {
+        return definite_object("object");
+    }
+
+    unsigned long getPerceptions() const { return _perceptions; }
+    unsigned long getPlans() const { return _plans; }
+
+private:
+    unsigned int _cost;
+    unsigned long _perceptions;
+    unsigned long _plans;
+};
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// run n copies of each procedure until they are all finished, return
+// the time spent
+static double run(WorldWrapperBase& ww, CachingWorldWrapper* cache,
+                  const vector<combo_tree>& procedures, unsigned int n,
+                  bool doesCompile)
+{
+    vector<combo::vertex> arguments;
+    vector<RunningComboProcedure*> rps;
+    for (unsigned int i = 0; i < n; i++)
+        for (const combo_tree& tr : procedures)
+            rps.push_back(new RunningComboProcedure(ww, tr, arguments,
+                                                    true, doesCompile));
+
+    double start = now();
+    bool done = false;
+    while (!done) {
+        // one interpreter run
+        if (cache)
+            cache->clear();
+        done = true;
+        for (RunningComboProcedure* rp : rps) {
+            if (rp->isReady()) {
+                rp->cycle();
+                done = false;
+            } else if (!rp->isFinished()) {
+                done = false;
+            }
+        }
+    }
+    double elapsed = now() - start;
+
+    for (RunningComboProcedure* rp : rps)
+        delete rp;
+    return elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int n = 100;
+    unsigned int cost = 10000;
+    int c;
+    while ((c = getopt(argc, argv, "n:c:")) != -1) {
+        switch (c) {
+        case 'n': n = atoi(optarg); break;
+        case 'c': cost = atoi(optarg); break;
+        default:
+            cerr << "usage: " << argv[0]
+                 << " [-n procedures] [-c cost] [procedure-file]" << endl;
+            return 1;
+        }
+    }
+
+    logger().setPrintToStdoutFlag(false);
+    logger().setLevel(Logger::ERROR);
+
+    vector<combo_tree> procedures;
+    if (optind < argc) {
+        ifstream in(argv[optind]);
+        string line;
+        while (getline(in, line)) {
+            if (line.empty() || line[0] == '#')
+                continue;
+            stringstream ss(line);
+            combo_tree tr;
+            AvatarCombo::operator>>(ss, tr);
+            procedures.push_back(tr);
+        }
+    } else {
+        for (const char** p = defaultProcedures; *p; ++p) {
+            stringstream ss(*p);
+            combo_tree tr;
+            AvatarCombo::operator>>(ss, tr);
+            procedures.push_back(tr);
+        }
+    }
+    unsigned int total = n * procedures.size();
+
+    BenchmarkWorldWrapper interpretedWorld(cost);
+    double t1 = run(interpretedWorld, NULL, procedures, n, false);
+
+    CachingWorldWrapper compiledWorld(new BenchmarkWorldWrapper(cost));
+    double t2 = run(compiledWorld, &compiledWorld, procedures, n, true);
+    const BenchmarkWorldWrapper& bww =
+        dynamic_cast<const BenchmarkWorldWrapper&>(compiledWorld.getWorldWrapper());
+
+    cout << total << " procedures, perception cost " << cost << endl;
+    cout << "interpreted: " << total / t1 << " procedures/s, "
+         << interpretedWorld.getPerceptions() << " perceptions evaluated, "
+         << interpretedWorld.getPlans() << " plans" << endl;
+    cout << "compiled:    " << total / t2 << " procedures/s, "
+         << bww.getPerceptions() << " perceptions evaluated, "
+         << bww.getPlans() << " plans" << endl;
+    return 0;
+}
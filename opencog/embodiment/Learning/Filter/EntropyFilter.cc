@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 //just for debug and profiling
 #include <time.h>
 
@@ -81,7 +83,6 @@ EntropyFilter::EntropyFilter(const std::string& self_id,
         _atomSpace(atomSpace), _elementary_perceptions(ep),
         _idos(idos), _dos(dos), _ms(ms), _atas(atas),
         _input_arg_types(input_arg_types),
-        _total_time(0),
         _indefToDef(id::avatar_indefinite_object_count, "")
 {
 
@@ -90,13 +91,12 @@ EntropyFilter::EntropyFilter(const std::string& self_id,
     //init _hasSaidDelay
     _hasSaidDelay = WorldWrapperUtil::getHasSaidDelay();
 
-    //init perceptToTime
+    //init the perception timeline
 
     //build operand set (perception tree children)
     build_operand_set();
 
-    //build perceptToTime
-    //(or perceptToBoolTime depending on whether optimization is enabled)
+    //build the perception columns
     for (perception_set_const_it psi = _elementary_perceptions.begin();
             psi != _elementary_perceptions.end(); ++psi) {
         build_and_insert_atomic_perceptions(*psi);
@@ -151,6 +151,33 @@ void EntropyFilter::updatePerceptToTime(const Temporal& temp,
     unsigned long tu = temp.getUpperBound();
     long diff = (long)tu - (long)tl;
     OC_ASSERT(diff >= 0, "diff = %d is not positive or null", diff);
+    unsigned int ex = _timeline.addExemplar(tl, tu);
+    _exemplarArguments.push_back(al);
+    evaluateExemplar(ex);
+}
+
+void EntropyFilter::updatePerceptToTime(unsigned long tl, unsigned long tu,
+                                        const argument_list& al)
+{
+    updatePerceptToTime(Temporal(tl, tu), al);
+}
+
+void EntropyFilter::evaluateExemplar(unsigned int ex)
+{
+    //only the perceptions that have not been evaluated over that
+    //exemplar yet are considered
+    std::vector<PerceptionTimeline::column_id> columns;
+    for (PerceptionTimeline::column_id c = 0;
+         c < _timeline.getColumnCount(); ++c)
+        if (_timeline.getCoverage(c) == ex)
+            columns.push_back(c);
+    if (columns.empty())
+        return;
+
+    const PerceptionTimeline::interval& exemplar = _timeline.getExemplar(ex);
+    const argument_list& al = _exemplarArguments[ex];
+    unsigned long tl = exemplar.first;
+    unsigned long tu = exemplar.second;
     //get the list of spaceMap that occurs in that range
     std::vector<HandleTemporalPair> htps;
     //get the first map at tl or if not before tl
@@ -168,7 +195,7 @@ void EntropyFilter::updatePerceptToTime(const Temporal& temp,
 
     const SpaceServer::SpaceMap* pre_sm = NULL; //previous spaceMap
     //used for isMoving
-    //for each spaceMap update _perceptToTime
+    //for each spaceMap update the timeline
     for (std::vector<HandleTemporalPair>::const_iterator htp_it = htps.begin();
             htp_it != htps.end(); ++htp_it) {
         //determine spaceMap
@@ -180,7 +207,6 @@ void EntropyFilter::updatePerceptToTime(const Temporal& temp,
         //if the space map started before the exemplar start time
         //ltl is the exemplar start time instead
         //and there is no next spaceMap then ltu is the exemplar stop time
-        Temporal ltemp = *htp_it->getTemporal();
         unsigned long ltl = htp_it->getTemporal()->getLowerBound();
         if (ltl < tl)
             ltl = tl;
@@ -191,205 +217,16 @@ void EntropyFilter::updatePerceptToTime(const Temporal& temp,
             ltu = htp_it_next->getTemporal()->getLowerBound();
             OC_ASSERT(ltu <= tu, "The start time of the last spaceMap must occur at or before the exemplar stop time");
         } else ltu = tu;
-        unsigned long ldiff = ltu - ltl;
 #ifdef ISMOVING_OPTIMIZE
         //compute isMoving for all object, if the object does not
         //belong to the map yet it goes with true, because we don't
         //have previous value of the predicate at this point
         for (const definite_object& obj : _dos)
             setIsMoving(obj, pre_sm, sm);
-        //eval each perception
-        for (combo_tree_bool_time_map_it vti = _perceptToBoolTime.begin();
-                vti != _perceptToBoolTime.end(); ++vti)
-#else
-        for (combo_tree_time_map_it vti = _perceptToTime.begin();
-                vti != _perceptToTime.end(); ++vti)
 #endif
-        {
-            bool isMovOptPossible = false; //isMoving optimization
-            //is potentially possible
-            combo_tree tmp = vti->first; //a copy is performed because the argument
-            //might be changed
-            pre_it head_it = tmp.begin();
-            vertex head = *head_it;
-            //evaluate perception operand
-            for (sib_it opra = head_it.begin(); opra != head_it.end(); ++opra) {
-                //evaluate perception operand if indefinite object
-                if (is_indefinite_object(*opra)) {
-                    indefinite_object io = get_indefinite_object(*opra);
-                    avatar_indefinite_object_enum ioe = get_enum(io);
-                    //check if the indefinite object is in _indefToDef cache
-                    if (_indefToDef[(unsigned int)ioe] == "") {
-                        *opra =
-                            WorldWrapperUtil::evalIndefiniteObject(smh,
-                                                                   ltl,
-                                                                   _atomSpace,
-                                                                   _self_id,
-                                                                   _owner_id,
-                                                                   io,
-                                                                   true /*isInThePast*/);
-                        //only non random indefinite objects go in the cache
-                        if (!is_random(io)) {
-                            OC_ASSERT(is_definite_object(*opra),
-                                             "opra must contain a definite_object");
-                            _indefToDef[(unsigned int)ioe] = get_definite_object(*opra);
-                        } else { //is moving optimization cannot work with random object
-                            isMovOptPossible = false;
-                        }
-                    } else *opra = vertex(_indefToDef[(unsigned int)ioe]);
-                }
-                //if operand is function argument
-                else if (is_argument(*opra))
-                    *opra = al[get_argument(*opra).abs_idx_from_zero()];
-            }
-#ifdef ISMOVING_OPTIMIZE
-            //check if the perception is is_moving then look at _isMoving
-            if (head == get_instance(id::is_moving)) {
-                OC_ASSERT(head_it.has_one_child(),
-                                 "is_moving must have only one child");
-                //eval the new perception
-                std::pair<bool, unsigned long>& p = vti->second;
-                //look into the isMoving cache
-                OC_ASSERT(is_definite_object(*head_it.begin()),
-                                 "the argument of is_moving must be a definite object");
-                p.first = getIsMoving(get_definite_object(*head_it.begin()));
-                if (p.first)
-                    p.second += ldiff;
-            }
-            //hasSaid is particular because we must cut the time in
-            //hasSaidDelay time intervals between the start and the end of
-            //the spaceMap
-            else if (head == get_instance(id::has_said)) {
-                OC_ASSERT(_hasSaidDelay > 0,
-                                 "_hasSaidDelay cannot be null otherwise that may provoke an infinite loop");
-                for (unsigned long i = ltu; i > ltl; i -= _hasSaidDelay) {
-                    if (combo::vertex_to_bool(WorldWrapperUtil::evalPerception(
-                                              smh,
-                                              i,
-                                              _atomSpace,
-                                              _self_id,
-                                              _owner_id,
-                                              head_it,
-                                              true))) {
-                        unsigned long idiff;
-                        if (i - _hasSaidDelay > ltl)
-                            idiff = _hasSaidDelay;
-                        else idiff = i - ltl;
-                        std::pair<bool, unsigned long>& p = vti->second;
-                        p.second += idiff;
-                    }
-                }
-            }
-            //this code is very badly optimized it should be optimized later
-            else if (head == get_instance(id::is_last_agent_action)) {
-
-                //debug print
-                //std::cout << "PERCEPTION IS_LAST_AGENT_ACTION : " << combo_tree(head_it) << std::endl;
-                //~debug print
-
-                unsigned int t = ltl;
-
-                //retreive all actions of the agent involved in the perception
-                //in time interval of the SpaceMap
-                std::list<HandleTemporalPair> htp;
-                timeServer().getTimeInfo(back_inserter(htp),
-                                       Handle::UNDEFINED,
-                                       Temporal(ltl, ltu), TemporalTable::ENDS_WITHIN);
-
-                pre_it head_child_it = head_it.begin();
-                Handle action_done_h = _atomSpace.getHandle(PREDICATE_NODE,
-                                       ACTION_DONE_PREDICATE_NAME);
-                Handle agent_h =
-                    WorldWrapperUtil::toHandle(_atomSpace, get_definite_object(*head_child_it),
-                                               _self_id, _owner_id);
-                //define template to match
-                atom_tree* no_arg_actionDone = makeVirtualAtom(EVALUATION_LINK,
-                                               makeVirtualAtom(action_done_h, NULL),
-                                               makeVirtualAtom(LIST_LINK, makeVirtualAtom(agent_h, NULL), NULL),
-                                               NULL);
-                does_fit_template dft(*no_arg_actionDone, &_atomSpace, false);
-                for (std::list<HandleTemporalPair>::const_iterator i = htp.begin();
-                        i != htp.end(); ++i) {
-                    Handle evalLink_h = i->getHandle();
-                    //check if evalLink_h match the template
-                    if (dft(evalLink_h)) {
-                        unsigned long cur_tu = i->getTemporal()->getUpperBound();
-                        if (combo::vertex_to_bool(WorldWrapperUtil::evalPerception(
-                                                  smh,
-                                                  cur_tu,
-                                                  _atomSpace,
-                                                  _self_id,
-                                                  _owner_id,
-                                                  head_it,
-                                                  true))) {
-                            std::pair<bool, unsigned long>& p = vti->second;
-                            p.second += cur_tu - t;
-                        }
-                        t = cur_tu + 1;
-                    }
-                }
-            }
-            //check if we can use the previous value rather than computing
-            //a new one
-            else {
-                bool canUsePreviousValue;
-                if (isMovOptPossible && doesInvolveMoving(head)) {
-                    canUsePreviousValue = true;
-                    for (sib_it opra = head_it.begin();
-                         opra != head_it.end() && canUsePreviousValue; ++opra)
-                        canUsePreviousValue =
-                            !getIsMoving(get_definite_object(*opra));
-                } else canUsePreviousValue = false;
-                //eval the new perception
-                std::pair<bool, unsigned long>& p = vti->second;
-                if (!canUsePreviousValue) {
-                    p.first =
-                        combo::vertex_to_bool(WorldWrapperUtil::evalPerception(smh,
-                                              ltl,
-                                              _atomSpace,
-                                              _self_id,
-                                              _owner_id,
-                                              head_it,
-                                              true));
-                }
-                if (p.first)    // use the previous value (isMoving
-                                // optimization)
-                    p.second += ldiff;
-            }
-
-#else //~ISMOVING_OPTIMIZE
-
-            if (head == get_instance(id::has_said)) {
-                for (unsigned long i = ltu; i > ltl; i -= _hasSaidDelay) {
-                    if (combo::vertex_to_bool(WorldWrapperUtil::evalPerception(
-                                              smh,
-                                              i,
-                                              _atomSpace,
-                                              _self_id,
-                                              _owner_id,
-                                              head_it,
-                                              true))) {
-                        unsigned long idiff;
-                        if (i - _hasSaidDelay > ltl)
-                            idiff = _hasSaidDelay;
-                        else idiff = i - ltl;
-                        vti->second += idiff;
-                    }
-                }
-            } else {
-                if (combo::vertex_to_bool(WorldWrapperUtil::evalPerception(
-                                          smh,
-                                          ltl,
-                                          _atomSpace,
-                                          _self_id,
-                                          _owner_id,
-                                          head_it,
-                                          true)))
-                    vti->second += ldiff;
-            }
-
-#endif
-        }
+        //eval each perception
+        for (PerceptionTimeline::column_id c : columns)
+            evalPerceptionOverMap(c, smh, ltl, ltu, al, pre_sm == NULL);
         //get the pointer of the previous spaceMap for the next iterator,
         //for isMoving
         pre_sm = &sm;
@@ -397,13 +234,212 @@ void EntropyFilter::updatePerceptToTime(const Temporal& temp,
         for (unsigned int i = 0; i < _indefToDef.size(); i++)
             _indefToDef[i] = "";
     }
-    _total_time += diff;
+    for (PerceptionTimeline::column_id c : columns)
+        _timeline.close(c);
 }
 
-void EntropyFilter::updatePerceptToTime(unsigned long tl, unsigned long tu,
-                                        const argument_list& al)
+void EntropyFilter::evalPerceptionOverMap(PerceptionTimeline::column_id c,
+                                          Handle smh,
+                                          unsigned long ltl,
+                                          unsigned long ltu,
+                                          const argument_list& al,
+                                          bool isFirstMap)
 {
-    updatePerceptToTime(Temporal(tl, tu), al);
+    bool isMovOptPossible = false; //isMoving optimization
+    //is potentially possible
+    combo_tree tmp = _timeline.getPercept(c); //a copy is performed because
+    //the argument might be changed
+    pre_it head_it = tmp.begin();
+    vertex head = *head_it;
+    //evaluate perception operand
+    for (sib_it opra = head_it.begin(); opra != head_it.end(); ++opra) {
+        //evaluate perception operand if indefinite object
+        if (is_indefinite_object(*opra)) {
+            indefinite_object io = get_indefinite_object(*opra);
+            avatar_indefinite_object_enum ioe = get_enum(io);
+            //check if the indefinite object is in _indefToDef cache
+            if (_indefToDef[(unsigned int)ioe] == "") {
+                *opra =
+                    WorldWrapperUtil::evalIndefiniteObject(smh,
+                                                           ltl,
+                                                           _atomSpace,
+                                                           _self_id,
+                                                           _owner_id,
+                                                           io,
+                                                           true /*isInThePast*/);
+                //only non random indefinite objects go in the cache
+                if (!is_random(io)) {
+                    OC_ASSERT(is_definite_object(*opra),
+                                     "opra must contain a definite_object");
+                    _indefToDef[(unsigned int)ioe] = get_definite_object(*opra);
+                } else { //is moving optimization cannot work with random object
+                    isMovOptPossible = false;
+                }
+            } else *opra = vertex(_indefToDef[(unsigned int)ioe]);
+        }
+        //if operand is function argument
+        else if (is_argument(*opra))
+            *opra = al[get_argument(*opra).abs_idx_from_zero()];
+    }
+
+#ifdef ISMOVING_OPTIMIZE
+    //check if the perception is is_moving then look at _isMoving
+    if (head == get_instance(id::is_moving)) {
+        OC_ASSERT(head_it.has_one_child(),
+                         "is_moving must have only one child");
+        //look into the isMoving cache
+        OC_ASSERT(is_definite_object(*head_it.begin()),
+                         "the argument of is_moving must be a definite object");
+        _timeline.record(c, ltl, ltu,
+                         getIsMoving(get_definite_object(*head_it.begin())));
+        return;
+    }
+#endif
+    //hasSaid is particular because it is true during _hasSaidDelay
+    //after each say action, so its change points are determined
+    //directly by the say actions that occur during the spaceMap
+    if (head == get_instance(id::has_said)) {
+        recordHasSaid(c, smh, ltl, ltu, head_it);
+    }
+    //this code is very badly optimized it should be optimized later
+    else if (head == get_instance(id::is_last_agent_action)) {
+
+        //debug print
+        //std::cout << "PERCEPTION IS_LAST_AGENT_ACTION : " << combo_tree(head_it) << std::endl;
+        //~debug print
+
+        unsigned long t = ltl;
+
+        //retreive all actions of the agent involved in the perception
+        //in time interval of the SpaceMap
+        std::list<HandleTemporalPair> htp;
+        timeServer().getTimeInfo(back_inserter(htp),
+                               Handle::UNDEFINED,
+                               Temporal(ltl, ltu), TemporalTable::ENDS_WITHIN);
+        //getTimeInfo does not sort its results, and the timeline must be
+        //recorded in chronological order
+        htp.sort([](const HandleTemporalPair& a, const HandleTemporalPair& b) {
+                     return a.getTemporal()->getUpperBound()
+                         < b.getTemporal()->getUpperBound();
+                 });
+
+        pre_it head_child_it = head_it.begin();
+        Handle action_done_h = _atomSpace.getHandle(PREDICATE_NODE,
+                               ACTION_DONE_PREDICATE_NAME);
+        Handle agent_h =
+            WorldWrapperUtil::toHandle(_atomSpace, get_definite_object(*head_child_it),
+                                       _self_id, _owner_id);
+        //define template to match
+        atom_tree* no_arg_actionDone = makeVirtualAtom(EVALUATION_LINK,
+                                       makeVirtualAtom(action_done_h, NULL),
+                                       makeVirtualAtom(LIST_LINK, makeVirtualAtom(agent_h, NULL), NULL),
+                                       NULL);
+        does_fit_template dft(*no_arg_actionDone, &_atomSpace, false);
+        for (std::list<HandleTemporalPair>::const_iterator i = htp.begin();
+                i != htp.end(); ++i) {
+            Handle evalLink_h = i->getHandle();
+            //check if evalLink_h match the template
+            if (dft(evalLink_h)) {
+                unsigned long cur_tu = i->getTemporal()->getUpperBound();
+                if (cur_tu < t)
+                    continue;
+                bool val = combo::vertex_to_bool(WorldWrapperUtil::evalPerception(
+                                                 smh,
+                                                 cur_tu,
+                                                 _atomSpace,
+                                                 _self_id,
+                                                 _owner_id,
+                                                 head_it,
+                                                 true));
+                _timeline.record(c, t, cur_tu, val);
+                t = cur_tu;
+            }
+        }
+        _timeline.record(c, t, ltu, false);
+    }
+    else {
+        bool canUsePreviousValue = false;
+#ifdef ISMOVING_OPTIMIZE
+        //check if we can use the previous value rather than computing
+        //a new one
+        if (!isFirstMap && isMovOptPossible && doesInvolveMoving(head)) {
+            canUsePreviousValue = true;
+            for (sib_it opra = head_it.begin();
+                 opra != head_it.end() && canUsePreviousValue; ++opra)
+                canUsePreviousValue =
+                    !getIsMoving(get_definite_object(*opra));
+        }
+#endif
+        bool val;
+        if (canUsePreviousValue)
+            val = _timeline.getLastValue(c);
+        else
+            val = combo::vertex_to_bool(WorldWrapperUtil::evalPerception(smh,
+                                        ltl,
+                                        _atomSpace,
+                                        _self_id,
+                                        _owner_id,
+                                        head_it,
+                                        true));
+        _timeline.record(c, ltl, ltu, val);
+    }
+}
+
+void EntropyFilter::recordHasSaid(PerceptionTimeline::column_id c,
+                                  Handle smh,
+                                  unsigned long ltl,
+                                  unsigned long ltu,
+                                  pre_it head_it)
+{
+    OC_ASSERT(_hasSaidDelay > 0, "_hasSaidDelay cannot be null");
+    sib_it agent = head_it.begin();
+    sib_it msg = agent;
+    ++msg;
+    OC_ASSERT(is_message(*msg), "the 2nd argument of has_said must be a message");
+
+    if (!is_definite_object(*agent)) {
+        //random speaker, fall back on sampling the perception
+        //every _hasSaidDelay
+        for (unsigned long i = ltl; i < ltu; i += _hasSaidDelay) {
+            unsigned long j = std::min(i + _hasSaidDelay, ltu);
+            _timeline.record(c, i, j,
+                             combo::vertex_to_bool(WorldWrapperUtil::evalPerception(
+                                                   smh, j, _atomSpace,
+                                                   _self_id, _owner_id,
+                                                   head_it, true)));
+        }
+        return;
+    }
+
+    //has_said is true at time t if the message has been said within
+    //[t - _hasSaidDelay, t], so get all say actions that started within
+    //[ltl - _hasSaidDelay, ltu]
+    std::vector<unsigned long> says;
+    Handle from_h = WorldWrapperUtil::toHandle(_atomSpace,
+                                               get_definite_object(*agent),
+                                               _self_id, _owner_id);
+    if (from_h != Handle::UNDEFINED) {
+        unsigned long from = ltl > _hasSaidDelay ? ltl - _hasSaidDelay : 0;
+        AtomSpaceUtil::getHasSaidTimestamps(_atomSpace, Temporal(from, ltu),
+                                            from_h, Handle::UNDEFINED,
+                                            get_message(*msg).getContent(),
+                                            says);
+    }
+
+    //the union of the [s, s + _hasSaidDelay] intervals clipped to
+    //[ltl, ltu) gives the change points of the perception
+    unsigned long t = ltl;
+    for (unsigned long s : says) {
+        unsigned long start = std::max(s, ltl);
+        unsigned long end = std::min(s + _hasSaidDelay, ltu);
+        if (end <= t)
+            continue;
+        start = std::max(start, t);
+        _timeline.record(c, t, start, false);
+        _timeline.record(c, start, end, true);
+        t = end;
+    }
+    _timeline.record(c, t, ltu, false);
 }
 
 void EntropyFilter::rebuildPerceptToTime()
@@ -416,34 +452,26 @@ void EntropyFilter::rebuildPerceptToTime()
             psi != _elementary_perceptions.end(); ++psi) {
         build_and_insert_atomic_perceptions(*psi);
     }
+
+    //evaluate the new perceptions over the exemplars already seen
+    for (unsigned int ex = 0; ex < _timeline.getExemplarCount(); ++ex)
+        evaluateExemplar(ex);
 }
 
 //fill pred_set with all predicates with entropy above threshold
 void EntropyFilter::generateFilteredPerceptions(combo_tree_ns_set& pred_set,
                                                 double threshold)
 {
-#ifdef ISMOVING_OPTIMIZE
-    for (combo_tree_bool_time_map_it is = _perceptToBoolTime.begin();
-         is != _perceptToBoolTime.end(); ++is) {
-        std::pair<bool, unsigned long>& pa = is->second;
-        float p = (float)pa.second / (float)_total_time;
-        float entropy = opencog::binaryEntropy(p);
+    for (PerceptionTimeline::column_id c = 0;
+         c < _timeline.getColumnCount(); ++c) {
+        double entropy = _timeline.getEntropy(c);
         //print debug
-        //std::cout << "PERCEPTION TR : " << is->first << " P : " << p
+        //std::cout << "PERCEPTION TR : " << _timeline.getPercept(c)
         // << " ENTROPY : " << entropy << std::endl;
         //~print debug
         if (entropy > threshold)
-            pred_set.insert(is->first);
+            pred_set.insert(_timeline.getPercept(c));
     }
-#else
-    for (combo_tree_time_map_it is = _perceptToTime.begin();
-            is != _perceptToTime.end(); ++is) {
-        float p = (float)is->second / (float)_total_time;
-        float entropy = opencog::binaryEntropy(p);
-        if (entropy > threshold)
-            pred_set.insert(is->first);
-    }
-#endif
 }
 
 inline bool EntropyFilter::doesInvolveMoving(vertex v)
@@ -546,26 +574,12 @@ void EntropyFilter::build_and_insert_atomic_perceptions(const combo_tree& tr,
         reduct::hillclimbing_perception_reduce(tmp);
         pre_it tmp_head = tmp.begin();
         if (*tmp_head != id::logical_true && *tmp_head != id::logical_false) {
-#ifdef ISMOVING_OPTIMIZE
-            //if the perception is new then add it
-            //this conditional is used because
-            //it might not be the first time the set of atomic perception
-            //is being built (when other new BD exemplars comes for instance)
-            if (_perceptToBoolTime.find(tmp) == _perceptToBoolTime.end()) {
-                std::pair<bool, unsigned long> p(false, 0);
-                _perceptToBoolTime[tmp] = p;
-                //print debug
-                //std::cout << "ADD PERCEPT TO TIME : " << tmp << std::endl;
-                //~print debug
-            }
-#else
-            //if the perception is new then add it
-            //this conditional is used because
-            //it might not be the first time the set of atomic perception
-            //is being built (when other new BD exemplars comes for instance)
-            if (_perceptToTime.find(tmp) == _perceptToTime.end())
-                _perceptToTime[tmp] = 0;
-#endif
+            //if the perception is new then add it, addPercept does
+            //nothing if the perception is already there
+            //because it might not be the first time the set of atomic
+            //perception is being built (when other new BD exemplars
+            //comes for instance)
+            _timeline.addPercept(tmp);
         }
     }
     //--------------
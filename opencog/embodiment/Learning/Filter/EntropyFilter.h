@@ -39,13 +39,14 @@
 #include <opencog/embodiment/Learning/RewritingRules/RewritingRules.h>
 #include <opencog/embodiment/Learning/behavior/BehaviorCategory.h>
 #include "EntityRelevanceFilter.h"
+#include "PerceptionTimeline.h"
 
 // Enable optimization of the algo based on _isMoving. It computes
 // _isMoving (via setIsMoving) for all entities over the given time
 // interval and at each considered instant do not calculate the
 // predicates that are invariant over fixed entites (via checking the
 // predicate with the method doesInvolveMoving) and use their previous
-// value instead (via _perceptToBoolTime)
+// value instead (via _timeline)
 #define ISMOVING_OPTIMIZE
 
 //enable optimize using lru_cache
@@ -75,16 +76,6 @@ class EntropyFilter
     typedef combo_tree_ns_set::iterator combo_tree_ns_set_it;
     typedef combo_tree_ns_set::const_iterator combo_tree_ns_set_const_it;
 
-    typedef std::map<const opencog::combo::combo_tree, unsigned long, combo_tree_order> combo_tree_time_map;
-    typedef combo_tree_time_map::iterator combo_tree_time_map_it;
-    typedef combo_tree_time_map::const_iterator combo_tree_time_map_const_it;
-
-    typedef std::pair<bool, unsigned long> bool_time_pair;
-    typedef std::map<const opencog::combo::combo_tree, bool_time_pair, combo_tree_order>
-    combo_tree_bool_time_map;
-    typedef combo_tree_bool_time_map::iterator combo_tree_bool_time_map_it;
-    typedef combo_tree_bool_time_map::const_iterator combo_tree_bool_time_map_const_it;
-
     typedef std::set<vertex> vertex_set;
     typedef vertex_set::iterator vertex_set_it;
     typedef vertex_set::const_iterator vertex_set_const_it;
@@ -125,8 +116,8 @@ public:
                   const type_tree_seq& input_arg_types);
     ~EntropyFilter();
 
-    //update the map _perceptToTim and _total_time by evaluating all
-    //perceptions in the interval temp
+    //add the exemplar temp to _timeline and evaluate all
+    //perceptions over it
     void updatePerceptToTime(const Temporal& temp,
                              const argument_list& al);
 
@@ -136,14 +127,15 @@ public:
 
     //when the set of definite object changes the set of possible
     //perception must be rebuild accordingly
-    //that method add the new perceptions in _perceptToTime
+    //that method add the new perceptions in _timeline and evaluates
+    //them (and only them) over the exemplars already seen
     void rebuildPerceptToTime();
 
     //fill pred_set with all predicates with entropy above threshold
     void generateFilteredPerceptions(combo_tree_ns_set& pred_set,
                                      double threshold);
 
-    //update _perceptToTime and _total_time
+    //update _timeline
     //according to the intervals of the BehaviorCategory
     //then fill pred_set with perceptions with entropy > threshold
     void generateFilteredPerceptions(combo_tree_ns_set& pred_set,
@@ -153,7 +145,7 @@ public:
                                      const argument_list_list& all);
 
     //rebuild the object set and add new perceptions
-    //then update _perceptToTime and _total_time
+    //then update _timeline
     //according to the interval of cbd
     //then fill pred_set with perception with entropy > threshold
     void generateFilteredPerceptions(combo_tree_ns_set& pred_set,
@@ -181,18 +173,11 @@ private:
     //messages and arguments, in children of
     //perception
 
-#ifdef ISMOVING_OPTIMIZE
-    combo_tree_bool_time_map _perceptToBoolTime; //associate a perception to its
-    //last truth value
-    //expectation time
-#else
-    combo_tree_time_map _perceptToTime; //associate a perception to its
-    //expectation time (of being true)
-#endif
-
-    unsigned int _percept_count; //number of perceptions used by the lru_cache
+    PerceptionTimeline _timeline; //truth value of each perception
+    //over the exemplars seen so far
 
-    unsigned long _total_time; //total time of a perception (equal for all)
+    std::vector<argument_list> _exemplarArguments; //argument list of each
+    //exemplar in _timeline, to evaluate new perceptions over them
 
     Handle _spaceMapNode;
 
@@ -235,6 +220,28 @@ private:
     //eval perception
     bool evalPerception(Handle smh, const opencog::combo::combo_tree tr);
 
+    //evaluate over the exemplar ex all perceptions of _timeline that
+    //have not been evaluated over it yet
+    void evaluateExemplar(unsigned int ex);
+
+    //evaluate the perception of column c over the spaceMap smh valid
+    //during [ltl, ltu) and record it in _timeline
+    void evalPerceptionOverMap(PerceptionTimeline::column_id c,
+                               Handle smh,
+                               unsigned long ltl,
+                               unsigned long ltu,
+                               const argument_list& al,
+                               bool isFirstMap);
+
+    //record the has_said perception of column c (head_it pointing to
+    //has_said with its operands evaluated) over [ltl, ltu) from the say
+    //actions that occurred, rather than by sampling it
+    void recordHasSaid(PerceptionTimeline::column_id c,
+                       Handle smh,
+                       unsigned long ltl,
+                       unsigned long ltu,
+                       pre_it head_it);
+
     //build (or rebuild) the set of operands
     //by inserting all new definite_objects, indefinite_objects
     //messages, input arguments ($1, $2, ...)
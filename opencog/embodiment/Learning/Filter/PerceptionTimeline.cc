@@ -0,0 +1,199 @@
+/*
+ * opencog/embodiment/Learning/Filter/PerceptionTimeline.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/util/oc_assert.h>
+#include <opencog/util/numeric.h>
+
+#include "PerceptionTimeline.h"
+
+namespace Filter
+{
+
+using namespace opencog;
+using namespace opencog::combo;
+
+PerceptionTimeline::PerceptionTimeline() : _exemplarTime(1, 0) {}
+
+PerceptionTimeline::column_id
+PerceptionTimeline::addPercept(const combo_tree& tr)
+{
+    percept_index::const_iterator pi = _index.find(tr);
+    if (pi != _index.end())
+        return pi->second;
+
+    column_id c = _percepts.size();
+    _index.insert(std::make_pair(tr, c));
+    _percepts.push_back(tr);
+    _changes.push_back(change_points());
+    _trueTime.push_back(0);
+    _lastEnd.push_back(0);
+    _inExemplar.push_back(false);
+    _coverage.push_back(0);
+    return c;
+}
+
+unsigned int PerceptionTimeline::getColumnCount() const
+{
+    return _percepts.size();
+}
+
+const combo_tree& PerceptionTimeline::getPercept(column_id c) const
+{
+    OC_ASSERT(c < _percepts.size());
+    return _percepts[c];
+}
+
+unsigned int PerceptionTimeline::addExemplar(unsigned long tl,
+                                             unsigned long tu)
+{
+    OC_ASSERT(tl <= tu, "The exemplar must start before it ends");
+    _exemplars.push_back(interval(tl, tu));
+    _exemplarTime.push_back(_exemplarTime.back() + (tu - tl));
+    return _exemplars.size() - 1;
+}
+
+unsigned int PerceptionTimeline::getExemplarCount() const
+{
+    return _exemplars.size();
+}
+
+const PerceptionTimeline::interval&
+PerceptionTimeline::getExemplar(unsigned int ex) const
+{
+    OC_ASSERT(ex < _exemplars.size());
+    return _exemplars[ex];
+}
+
+unsigned int PerceptionTimeline::getCoverage(column_id c) const
+{
+    OC_ASSERT(c < _coverage.size());
+    return _coverage[c];
+}
+
+void PerceptionTimeline::record(column_id c, unsigned long from,
+                                unsigned long to, bool val)
+{
+    OC_ASSERT(c < _percepts.size());
+    OC_ASSERT(_coverage[c] < _exemplars.size(),
+              "Column %u has already been evaluated over all exemplars", c);
+    OC_ASSERT(from <= to);
+    if (from == to)
+        return;
+
+    change_points& cps = _changes[c];
+    //a new change point is needed if the value changes, if there is a
+    //gap with the previous record, or at the start of each exemplar, even
+    //one starting right where the previous one ended (see getValueAt)
+    if (cps.empty() || cps.back().value != val || _lastEnd[c] != from
+        || !_inExemplar[c]) {
+        OC_ASSERT(cps.empty() || cps.back().time <= from,
+                  "Records must come in chronological order");
+        cps.push_back(ChangePoint(from, val));
+    }
+    _lastEnd[c] = to;
+    _inExemplar[c] = true;
+    if (val)
+        _trueTime[c] += to - from;
+}
+
+void PerceptionTimeline::close(column_id c)
+{
+    OC_ASSERT(c < _coverage.size());
+    OC_ASSERT(_coverage[c] < _exemplars.size());
+    _coverage[c]++;
+    _inExemplar[c] = false;
+}
+
+bool PerceptionTimeline::getLastValue(column_id c) const
+{
+    OC_ASSERT(c < _changes.size());
+    return _changes[c].empty() ? false : _changes[c].back().value;
+}
+
+bool PerceptionTimeline::getValueAt(column_id c, unsigned long t) const
+{
+    OC_ASSERT(c < _changes.size());
+    if (t >= _lastEnd[c])
+        return false;
+    const change_points& cps = _changes[c];
+    //first change point strictly after t
+    change_points_const_it cpi =
+        std::upper_bound(cps.begin(), cps.end(), t,
+                         [](unsigned long t, const ChangePoint& cp) {
+                             return t < cp.time;
+                         });
+    if (cpi == cps.begin())
+        return false;
+    --cpi;
+    //make sure t is not in a gap between 2 exemplars
+    std::vector<interval>::const_iterator ei =
+        std::upper_bound(_exemplars.begin(), _exemplars.end(),
+                         interval(t, ~0UL));
+    if (ei == _exemplars.begin())
+        return false;
+    --ei;
+    return t < ei->second && cpi->time >= ei->first && cpi->value;
+}
+
+const PerceptionTimeline::change_points&
+PerceptionTimeline::getChangePoints(column_id c) const
+{
+    OC_ASSERT(c < _changes.size());
+    return _changes[c];
+}
+
+unsigned long PerceptionTimeline::getTrueTime(column_id c) const
+{
+    OC_ASSERT(c < _trueTime.size());
+    return _trueTime[c];
+}
+
+unsigned long PerceptionTimeline::getTotalTime() const
+{
+    return _exemplarTime.back();
+}
+
+double PerceptionTimeline::getEntropy(column_id c) const
+{
+    OC_ASSERT(c < _coverage.size());
+    unsigned long total = _exemplarTime[_coverage[c]];
+    if (total == 0)
+        return 0.0;
+    return binaryEntropy((double)_trueTime[c] / (double)total);
+}
+
+void PerceptionTimeline::clear()
+{
+    _index.clear();
+    _percepts.clear();
+    _changes.clear();
+    _trueTime.clear();
+    _lastEnd.clear();
+    _inExemplar.clear();
+    _coverage.clear();
+    _exemplars.clear();
+    _exemplarTime.assign(1, 0);
+}
+
+} //~namespace Filter
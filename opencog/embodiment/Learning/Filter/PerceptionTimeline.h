@@ -0,0 +1,157 @@
+/*
+ * opencog/embodiment/Learning/Filter/PerceptionTimeline.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PERCEPTIONTIMELINE_H_
+#define PERCEPTIONTIMELINE_H_
+
+#include <map>
+#include <vector>
+#include <utility>
+
+#include <opencog/util/tree.h>
+#include <moses/comboreduct/combo/vertex.h>
+
+namespace Filter
+{
+
+/**
+ * Truth value of a set of perceptions over the exemplars seen so far.
+ *
+ * The data is stored column-wise, one column per perception, each
+ * column being the list of the points in time where the perception
+ * changes its truth value (plus the accumulated time during which it is
+ * true). The entropy of a perception is therefore available at any time
+ * without going through the exemplars again, and feeding a new exemplar
+ * only costs one record per perception per constant-valued interval,
+ * whatever the length of that interval.
+ *
+ * Exemplars are appended with addExemplar. Each column keeps track of
+ * the number of exemplars it has been evaluated over (its coverage), so
+ * that perceptions added after some exemplars have been seen (because
+ * new objects came up) can be evaluated over the missing exemplars only,
+ * instead of re-evaluating all perceptions.
+ */
+class PerceptionTimeline
+{
+public:
+    typedef unsigned int column_id;
+    typedef std::pair<unsigned long, unsigned long> interval;
+
+    //point in time from which the perception takes the given value
+    struct ChangePoint {
+        ChangePoint(unsigned long t, bool v) : time(t), value(v) {}
+        unsigned long time;
+        bool value;
+    };
+    typedef std::vector<ChangePoint> change_points;
+    typedef change_points::const_iterator change_points_const_it;
+
+    PerceptionTimeline();
+
+    /**
+     * Add a perception column, return the existing column if the
+     * perception is already there.
+     */
+    column_id addPercept(const opencog::combo::combo_tree& tr);
+
+    unsigned int getColumnCount() const;
+
+    const opencog::combo::combo_tree& getPercept(column_id c) const;
+
+    /**
+     * Append the exemplar [tl, tu] and return its index. Its length
+     * is immediately added to the total time.
+     */
+    unsigned int addExemplar(unsigned long tl, unsigned long tu);
+
+    unsigned int getExemplarCount() const;
+
+    const interval& getExemplar(unsigned int ex) const;
+
+    /**
+     * Number of exemplars the column c has been evaluated over, that is
+     * the index of the next exemplar to evaluate it over.
+     */
+    unsigned int getCoverage(column_id c) const;
+
+    /**
+     * Record that perception c holds value val over [from, to) within
+     * the exemplar following its coverage. Records of a given column must
+     * come in chronological order.
+     */
+    void record(column_id c, unsigned long from, unsigned long to, bool val);
+
+    /**
+     * Mark the column c as evaluated over the next exemplar.
+     */
+    void close(column_id c);
+
+    /**
+     * Last value recorded for c, false if nothing has been recorded.
+     */
+    bool getLastValue(column_id c) const;
+
+    /**
+     * Value of c at time t, false outside the recorded intervals.
+     */
+    bool getValueAt(column_id c, unsigned long t) const;
+
+    const change_points& getChangePoints(column_id c) const;
+
+    unsigned long getTrueTime(column_id c) const;
+
+    unsigned long getTotalTime() const;
+
+    /**
+     * Binary entropy of the probability of c being true over all
+     * exemplars. Columns with partial coverage are only accounted for
+     * the exemplars they cover.
+     */
+    double getEntropy(column_id c) const;
+
+    void clear();
+
+private:
+    typedef opencog::size_tree_order<opencog::combo::vertex> combo_tree_order;
+    typedef std::map<opencog::combo::combo_tree, column_id,
+                     combo_tree_order> percept_index;
+
+    percept_index _index;
+
+    //columns
+    std::vector<opencog::combo::combo_tree> _percepts;
+    std::vector<change_points> _changes;
+    std::vector<unsigned long> _trueTime;
+    std::vector<unsigned long> _lastEnd;
+    //true once something has been recorded over the exemplar following
+    //the coverage
+    std::vector<bool> _inExemplar;
+    std::vector<unsigned int> _coverage;
+
+    std::vector<interval> _exemplars;
+    //_exemplarTime[i] is the total length of the first i exemplars
+    std::vector<unsigned long> _exemplarTime;
+};
+
+} //~namespace Filter
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * opencog/embodiment/Learning/Filter/perception-timeline-benchmark.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Compare the entropy computation of the EntropyFilter done by sampling
+// each perception every HAS_SAID_DELAY time units (as it used to be)
+// against ingesting change points in a PerceptionTimeline.
+//
+// The exemplars are read from a recorded trace on the standard input,
+// one line per exemplar:
+//
+//   <lower bound> <upper bound> <change point>*
+//
+// where each change point is "<percept index>:<time>:<0|1>", or
+// generated randomly if no trace is given (-r option).
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencog/util/numeric.h>
+#include <opencog/util/mt19937ar.h>
+#include <opencog/embodiment/Learning/Filter/PerceptionTimeline.h>
+
+using namespace std;
+using namespace opencog;
+using namespace Filter;
+
+struct Change {
+    unsigned int percept;
+    unsigned long time;
+    bool value;
+};
+
+struct Exemplar {
+    unsigned long tl, tu;
+    vector<Change> changes; // in chronological order
+};
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static unsigned int readTrace(istream& in, vector<Exemplar>& exemplars)
+{
+    unsigned int percepts = 0;
+    string line;
+    while (getline(in, line)) {
+        istringstream ss(line);
+        Exemplar ex;
+        if (!(ss >> ex.tl >> ex.tu))
+            continue;
+        string cp;
+        while (ss >> cp) {
+            Change c;
+            int v;
+            if (sscanf(cp.c_str(), "%u:%lu:%d", &c.percept, &c.time, &v) != 3)
+                continue;
+            c.value = v != 0;
+            percepts = max(percepts, c.percept + 1);
+            ex.changes.push_back(c);
+        }
+        exemplars.push_back(ex);
+    }
+    return percepts;
+}
+
+static void randomTrace(unsigned int percepts, unsigned int n_exemplars,
+                        unsigned long length, unsigned int changes,
+                        vector<Exemplar>& exemplars)
+{
+    MT19937RandGen rng(0);
+    unsigned long t = 0;
+    for (unsigned int e = 0; e < n_exemplars; ++e) {
+        Exemplar ex;
+        ex.tl = t;
+        ex.tu = t + length;
+        for (unsigned int p = 0; p < percepts; ++p) {
+            Change c = {p, ex.tl, rng.randbool()};
+            ex.changes.push_back(c);
+            for (unsigned int i = 0; i < changes; ++i) {
+                c.time = ex.tl + rng.randint(length);
+                c.value = rng.randbool();
+                ex.changes.push_back(c);
+            }
+        }
+        stable_sort(ex.changes.begin(), ex.changes.end(),
+                    [](const Change& a, const Change& b) {
+                        return a.time < b.time;
+                    });
+        exemplars.push_back(ex);
+        t = ex.tu + length;
+    }
+}
+
+// value of the percept p at time t in ex, what a perception
+// evaluation returns
+static bool evalAt(const Exemplar& ex, unsigned int p, unsigned long t)
+{
+    bool v = false;
+    for (const Change& c : ex.changes) {
+        if (c.time > t)
+            break;
+        if (c.percept == p)
+            v = c.value;
+    }
+    return v;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long delay = 200;
+    unsigned int percepts = 0;
+    vector<Exemplar> exemplars;
+
+    if (argc > 1 && string(argv[1]) == "-r") {
+        percepts = argc > 2 ? atoi(argv[2]) : 500;
+        unsigned int n = argc > 3 ? atoi(argv[3]) : 10;
+        unsigned long length = argc > 4 ? atol(argv[4]) : 20000;
+        randomTrace(percepts, n, length, 4, exemplars);
+    } else {
+        percepts = readTrace(cin, exemplars);
+    }
+    if (exemplars.empty() || percepts == 0) {
+        cerr << "Usage: " << argv[0] << " < trace" << endl
+             << "       " << argv[0]
+             << " -r [percepts] [exemplars] [exemplar length]" << endl;
+        return 1;
+    }
+
+    // dense sampling
+    double start = now();
+    unsigned long samples = 0;
+    unsigned long total = 0;
+    vector<unsigned long> trueTime(percepts, 0);
+    for (const Exemplar& ex : exemplars) {
+        for (unsigned int p = 0; p < percepts; ++p) {
+            for (unsigned long t = ex.tl; t < ex.tu; t += delay) {
+                samples++;
+                if (evalAt(ex, p, t))
+                    trueTime[p] += min(delay, ex.tu - t);
+            }
+        }
+        total += ex.tu - ex.tl;
+    }
+    vector<double> denseEntropy(percepts);
+    for (unsigned int p = 0; p < percepts; ++p)
+        denseEntropy[p] = binaryEntropy((double)trueTime[p] / (double)total);
+    double dense = now() - start;
+
+    // change points
+    start = now();
+    unsigned long records = 0;
+    PerceptionTimeline timeline;
+    for (unsigned int p = 0; p < percepts; ++p) {
+        stringstream ss;
+        ss << p;
+        timeline.addPercept(combo::combo_tree(combo::definite_object(ss.str())));
+    }
+    for (const Exemplar& ex : exemplars) {
+        timeline.addExemplar(ex.tl, ex.tu);
+        vector<unsigned long> last(percepts, ex.tl);
+        vector<bool> value(percepts, false);
+        for (const Change& c : ex.changes) {
+            timeline.record(c.percept, last[c.percept], c.time,
+                            value[c.percept]);
+            last[c.percept] = c.time;
+            value[c.percept] = c.value;
+            records++;
+        }
+        for (unsigned int p = 0; p < percepts; ++p) {
+            timeline.record(p, last[p], ex.tu, value[p]);
+            timeline.close(p);
+        }
+    }
+    double maxDiff = 0.0;
+    for (unsigned int p = 0; p < percepts; ++p)
+        maxDiff = max(maxDiff, fabs(timeline.getEntropy(p) - denseEntropy[p]));
+    double incremental = now() - start;
+
+    cout << "percepts: " << percepts
+         << ", exemplars: " << exemplars.size()
+         << ", total time: " << total << endl;
+    cout << "dense sampling: " << samples << " evaluations, "
+         << dense << " s" << endl;
+    cout << "change points:  " << records << " records, "
+         << incremental << " s" << endl;
+    cout << "max entropy difference (sampling error): " << maxDiff << endl;
+    return 0;
+}
@@ -73,6 +73,8 @@ NoSpaceLifeFitnessEstimator::NoSpaceLifeFitnessEstimator
     //if the random operator optimization is activated then
     //a plan is sent without evaluating indefinite objects
     _sendDefinitePlan = !_randomOperatorOptimization;
+
+    updateReplays();
 }
 
 NoSpaceLifeFitnessEstimator::~NoSpaceLifeFitnessEstimator() {}
@@ -81,6 +83,12 @@ NoSpaceLifeFitnessEstimator::~NoSpaceLifeFitnessEstimator() {}
  * operator
  */
 fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr) const
+{
+    return (*this)(tr, -std::numeric_limits<fitness_t>::max());
+}
+
+fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr,
+                                                  fitness_t cutoff) const
 {
     //debug log
     if (logger().isDebugEnabled()) {
@@ -97,6 +105,12 @@ fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr) c
     //then take the mean of their similarity
     const std::vector<CompositeBehaviorDescription>& bdce = _BDCat.getEntries();
     OC_ASSERT(!bdce.empty(), "Error : No exemplars");
+    OC_ASSERT(_replays.size() == bdce.size(),
+              "The fitness estimator must be updated when an exemplar is added");
+
+    //compute size penalty, first because it is needed to know whether
+    //tr can still reach cutoff
+    double sp = _sizePenalty.computeSizePenalty(tr);
 
     //debug log
     opencog::logger().debug("NoSpaceLifeFitnessEstimator - Loop over Behavior Category starts");
@@ -109,18 +123,43 @@ fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr) c
         trial_count = getTrialCount(tr); //in case the tree contains rands
 
 #ifdef IS_FE_LRU_CACHE
-    BDCache::map_iter mi = _bd_cache.find(tr);
-    bool cache_failure = _bd_cache.is_cache_failure(mi);
-    fitness_vec new_fv;
-    fitness_vec& ref_fv = cache_failure ? new_fv : mi->second;
+    //copy the cached scores, if any, so that the entry can be evicted
+    //by another thread while this one is running the simulations
+    fitness_vec ref_fv;
+    bool cache_failure;
+    {
+        std::lock_guard<std::mutex> lock(_bd_cache_mutex);
+        BDCache::map_iter mi = _bd_cache.find(tr);
+        cache_failure = _bd_cache.is_cache_failure(mi);
+        if (!cache_failure)
+            ref_fv = mi->second;
+    }
     fitness_vec_const_it fv_it = ref_fv.begin();
 #endif
 
+    //true if the loop is left before all exemplars are scored
+    bool terminated_early = false;
+    unsigned int remaining = bdce.size();
+
     std::vector<CompositeBehaviorDescription>::const_iterator
     cbd_it = bdce.begin();
-    std::vector<Temporal>::const_iterator eti = _exemplarTemporals.begin();
     argument_list_list_const_it allci = _all.begin();
-    for (; cbd_it != bdce.end(); ++cbd_it, ++allci, ++eti) {
+    std::vector< std::unique_ptr<ImaginaryLife::ExemplarReplay> >::const_iterator
+    ri = _replays.begin();
+    for (; cbd_it != bdce.end(); ++cbd_it, ++allci, ++ri, --remaining) {
+        //best fitness tr can get, if it imitates the remaining exemplars
+        //perfectly
+        double best_possible =
+            (score + remaining * MAX_PERTINENCE) / (float)(bdce.size()) * sp;
+        if (best_possible < cutoff) {
+            //debug log
+            logger().debug("NoSpaceLifeFitnessEstimator - Early termination, %u exemplars left, best possible fitness : %f", remaining, best_possible);
+            //~debug log
+            score = best_possible;
+            terminated_early = true;
+            break;
+        }
+
         fitness_t bd_score = 0;
 #ifdef IS_FE_LRU_CACHE
         if (fv_it == ref_fv.end()) {
@@ -128,13 +167,10 @@ fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr) c
         {
 #endif
             for (int i = 0; i < trial_count; i++) {
-                //generate behavior description with NoSpaceLife
-                world::NoSpaceLifeWorldWrapper nspww(_wp->getAtomSpace(),
-                        _petName,
-                        _ownerName,
-                        _avatarName,
-                        *cbd_it,
-                        *eti);
+                //generate behavior description with NoSpaceLife,
+                //the snapshot of the world at the exemplar checkpoints
+                //is shared with the other candidates
+                world::NoSpaceLifeWorldWrapper nspww(**ri, _petName);
                 RunningComboProcedure rp(nspww, tr, *allci, _sendDefinitePlan);
                 unsigned int cbd_size = cbd_it->size();
                 for (unsigned int i = 0;
@@ -158,9 +194,9 @@ fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr) c
                 }
                 //~debug log
 
-                bd_score = _BDMatcher.computePertinenceDegree(genBD,
-                           *cbd_it,
-                           TIMING_PERTINANCE);
+                bd_score += _BDMatcher.computePertinenceDegree(genBD,
+                            *cbd_it,
+                            TIMING_PERTINANCE);
             }
             bd_score /= trial_count;
 
@@ -184,25 +220,38 @@ fitness_t NoSpaceLifeFitnessEstimator::operator()(const combo::combo_tree& tr) c
     //~debug log
 
 #ifdef IS_FE_LRU_CACHE
-    //if cache failure then insert ref_fv in the cache
-    if (cache_failure)
-        _bd_cache.insert_new(tr, ref_fv);
-    else _cache_success++;
-    _total_fitness_call++;
-
-    //debug log
-    logger().debug("NoSpaceLifeFitnessEstimator - Total fitness call = %u, Cache success = %u", _total_fitness_call, _cache_success);
-    //~debug log
+    {
+        std::lock_guard<std::mutex> lock(_bd_cache_mutex);
+        //insert ref_fv in the cache, or update the cached entry if new
+        //exemplars have been scored since (the entry may have been
+        //inserted or evicted by another thread in the meantime)
+        BDCache::map_iter mi = _bd_cache.find(tr);
+        if (_bd_cache.is_cache_failure(mi)) {
+            if (!ref_fv.empty())
+                _bd_cache.insert_new(tr, ref_fv);
+        }
+        else if (mi->second.size() < ref_fv.size())
+            mi->second = ref_fv;
+        if (!cache_failure)
+            _cache_success++;
+        _total_fitness_call++;
+
+        //debug log
+        logger().debug("NoSpaceLifeFitnessEstimator - Total fitness call = %u, Cache success = %u", _total_fitness_call, _cache_success);
+        //~debug log
+    }
 #endif
 
+    //the bound is already normalized and penalized
+    if (terminated_early)
+        return score;
+
     //compute score
     score /= (float)(bdce.size()); //normalized score
     //debug log for SPCTools
     logger().debug("NoSpaceLifeFitnessEstimator - SPCTools - Score : %f", score);
     //~debug log for SPCTools
 
-    //compute size penalty
-    double sp = _sizePenalty.computeSizePenalty(tr);
     //compute fitness estimation
     double fit = score * sp;
 
@@ -226,6 +275,7 @@ void NoSpaceLifeFitnessEstimator::update(int indefinite_object_count,
                         condition_count, action_count);
     OC_ASSERT(_BDCat.getSize() == (int)_all.size(),
                      "There must be as many behavior category as argument lists");
+    updateReplays();
 }
 
 /**
@@ -247,5 +297,21 @@ int NoSpaceLifeFitnessEstimator::getTrialCount(const combo::combo_tree& tr) cons
     return res;
 }
 
+void NoSpaceLifeFitnessEstimator::updateReplays()
+{
+    //the entries and temporals may have been reallocated when the last
+    //exemplar was added so all replays are rebuilt
+    const std::vector<CompositeBehaviorDescription>& bdce = _BDCat.getEntries();
+    OC_ASSERT(bdce.size() == _exemplarTemporals.size(),
+              "There must be as many exemplar temporals as behavior descriptions");
+    _replays.clear();
+    for (unsigned int i = 0; i < bdce.size(); i++)
+        _replays.push_back(std::unique_ptr<ImaginaryLife::ExemplarReplay>
+                           (new ImaginaryLife::ExemplarReplay(_wp->getAtomSpace(),
+                                                              _ownerName,
+                                                              _avatarName,
+                                                              bdce[i],
+                                                              _exemplarTemporals[i])));
 }
 
+}
@@ -24,12 +24,18 @@
 #ifndef _NOSPACELIFEFITNESSESTIMATOR_H
 #define _NOSPACELIFEFITNESSESTIMATOR_H
 
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <opencog/util/lru_cache.h>
 
 #include <moses/comboreduct/combo/vertex.h>
 #include <opencog/embodiment/Learning/behavior/BehaviorCategory.h>
 #include <opencog/embodiment/Learning/behavior/BehaviorDescriptionMatcher.h>
 #include <opencog/embodiment/Learning/behavior/WorldProvider.h>
+#include <opencog/embodiment/Learning/NoSpaceLife/ExemplarReplay.h>
 #include "SizePenalty.h"
 
 //that paramter is here to determine to the maximum number of cycles the
@@ -41,6 +47,9 @@
 //where bd.size() is the sie of the current composite behavior description
 #define MAX_ADDITIONAL_CYCLE_COEF 1.0
 
+//the score of a candidate against an exemplar is at most that
+#define MAX_PERTINENCE 1.0
+
 #define IS_FE_LRU_CACHE
 #define FE_LRU_CACHE_SIZE 1000000
 
@@ -95,9 +104,23 @@ public:
 
     /**
      * operator
+     *
+     * Safe to call from several threads at once, as done by the
+     * hillclimber when HC_FITNESS_ESTIMATION_THREADS is greater than 1.
      */
     result_type operator()(const argument_type& tr) const;
 
+    /**
+     * like above but stops replaying the exemplars as soon as tr cannot
+     * reach cutoff anymore, even if it imitated the remaining exemplars
+     * perfectly. The result is the fitness of tr if it is not lower than
+     * cutoff, otherwise it is an upper bound of it (lower than cutoff).
+     *
+     * The scores against the exemplars replayed are cached all the same,
+     * a later call with a lower cutoff only replays the remaining ones.
+     */
+    result_type operator()(const argument_type& tr, fitness_t cutoff) const;
+
     /**
      * public methods
      */
@@ -105,6 +128,8 @@ public:
     /**
      * update the fitness estimator by retreiving the last examplar
      * and update predCount and actionCount
+     *
+     * Must not be called while estimating.
      */
     void update(int indefinite_object_count, int operator_count,
                 int predicate_count, int action_count);
@@ -127,6 +152,9 @@ private:
     behavior::BehaviorDescriptionMatcher _BDMatcher;
     SizePenalty _sizePenalty;
 
+    //one per exemplar, shared by all the candidates replaying it
+    std::vector< std::unique_ptr<ImaginaryLife::ExemplarReplay> > _replays;
+
 #ifdef IS_FE_LRU_CACHE
     typedef std::vector<fitness_t> fitness_vec;
     typedef fitness_vec::iterator fitness_vec_it;
@@ -135,6 +163,8 @@ private:
     mutable BDCache _bd_cache;
     mutable unsigned int _cache_success;
     mutable unsigned int _total_fitness_call;
+    //protects _bd_cache and its counters
+    mutable std::mutex _bd_cache_mutex;
 #endif
 
     //true to be activated
@@ -149,6 +179,12 @@ private:
      */
     int getTrialCount(const opencog::combo::combo_tree& tr) const;
 
+    /**
+     * rebuild the replays of the exemplars, the snapshots they hold are
+     * out of date once an exemplar is added
+     */
+    void updateReplays();
+
 };
 }
 
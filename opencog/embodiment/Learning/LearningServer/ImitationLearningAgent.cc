@@ -22,6 +22,7 @@
  */
 
 #include <iostream>
+#include <algorithm>
 
 #include <opencog/util/exceptions.h>
 #include <opencog/util/mt19937ar.h>
@@ -331,11 +332,17 @@ bool ImitationLearningAgent::initLearning(int nepc,
         if (ILALGO == opencog::control::ImitationLearningAlgo::HillClimbing) {
             bool abibb = config().get_bool("ACTION_BOOLEAN_IF_BOTH_BRANCHES_HC_EXPENSION");
             bool neic = config().get_bool("HC_NEW_EXEMPLAR_INITIALIZES_CENTER");
+            int n_threads = config().get_int("HC_FITNESS_ESTIMATION_THREADS");
+            int cache_size = config().get_int("HC_ESTIMATOR_CACHE_SIZE");
+            bool early_termination = config().get_bool("HC_EARLY_TERMINATION");
             _PIL = new petaverse_hillclimber(nepc, *_fitnessEstimator,
                                              _definite_objects, eo,
                                              _atomic_perceptions,
                                              _atomic_actions,
-                                             abibb, neic, true);
+                                             abibb, neic, true,
+                                             std::max(n_threads, 1),
+                                             std::max(cache_size, 0),
+                                             early_termination);
         } else if (ILALGO == opencog::control::ImitationLearningAlgo::MOSES) {
             _PIL = new moses::moses_learning(nepc, *_fitnessEstimator,
                                              _definite_objects,
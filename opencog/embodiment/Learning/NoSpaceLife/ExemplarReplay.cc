@@ -0,0 +1,185 @@
+/*
+ * opencog/embodiment/Learning/NoSpaceLife/ExemplarReplay.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/embodiment/AvatarComboVocabulary/AvatarComboVocabulary.h>
+#include <opencog/embodiment/AtomSpaceExtensions/AtomSpaceUtil.h>
+#include <opencog/embodiment/WorldWrapper/WorldWrapperUtil.h>
+
+#include "ExemplarReplay.h"
+
+namespace ImaginaryLife
+{
+
+using namespace opencog::world;
+using namespace AvatarCombo;
+
+ExemplarReplay::ExemplarReplay(AtomSpace& atomSpace,
+                               const std::string& owner_id,
+                               const std::string& avatar_id,
+                               const CompositeBehaviorDescription& cbd,
+                               const Temporal& et) :
+        _atomSpace(atomSpace), _owner_id(owner_id), _avatar_id(avatar_id),
+        _imitatedBD(cbd), _exemplarTemporal(et), _hits(0)
+{
+    _mapHandle = AtomSpaceUtil::getCurrentSpaceMapHandle(_atomSpace);
+
+    //extract once the arguments of the exemplar actions, converted to self
+    //or owner if their name is _avatar_id or _owner_id (the pet puts
+    //itself under the skin of the avatar)
+    const std::vector<PredicateHandleSet>& tls = _imitatedBD.getTimelineSets();
+    _arguments.resize(tls.size());
+    for (unsigned i = 0; i < tls.size(); ++i) {
+        const PredicateHandleSet& hs = tls[i];
+        unsigned s = hs.getSize();
+        OC_ASSERT(s == 0 || s == 1, "hs should have at 0 or 1 element.");
+        if (s == 0)
+            continue;
+
+        //check that it matches Behavior Description atom structure
+        Handle h = *hs.getSet().begin();
+        OC_ASSERT(h != Handle::UNDEFINED);
+        OC_ASSERT(_atomSpace.getType(h) == EVALUATION_LINK);
+        OC_ASSERT(_atomSpace.getArity(h) == 2, "An EvaluationLink must have only 2 arguments");
+
+        Handle list_h = _atomSpace.getOutgoing(h, 1);
+        OC_ASSERT(_atomSpace.getType(list_h) == LIST_LINK);
+        //the first two elements are the subject and the action
+        for (int j = 2; j < _atomSpace.getArity(list_h); ++j) {
+            Handle arg_h = _atomSpace.getOutgoing(list_h, j);
+            OC_ASSERT(arg_h != Handle::UNDEFINED);
+            _arguments[i].push_back(WorldWrapperUtil::atom_name_to_definite_object(_atomSpace.getName(arg_h), _avatar_id, _owner_id));
+        }
+    }
+}
+
+AtomSpace& ExemplarReplay::getAtomSpace() const
+{
+    return _atomSpace;
+}
+
+const std::string& ExemplarReplay::getOwnerId() const
+{
+    return _owner_id;
+}
+
+const std::string& ExemplarReplay::getAvatarId() const
+{
+    return _avatar_id;
+}
+
+const CompositeBehaviorDescription& ExemplarReplay::getImitatedBD() const
+{
+    return _imitatedBD;
+}
+
+const Temporal& ExemplarReplay::getExemplarTemporal() const
+{
+    return _exemplarTemporal;
+}
+
+Handle ExemplarReplay::getMapHandle() const
+{
+    return _mapHandle;
+}
+
+bool ExemplarReplay::getExemplarArgument(unsigned index, unsigned arg_index,
+                                         std::string& do_id) const
+{
+    if (index >= _arguments.size() || arg_index >= _arguments[index].size())
+        return false;
+    do_id = _arguments[index][arg_index];
+    return true;
+}
+
+vertex ExemplarReplay::evalPerception(combo_tree::iterator per,
+                                      unsigned long time, bool isInThePast)
+{
+    SnapshotKey key(std::make_pair(time, isInThePast), combo_tree(per));
+    bool keep = !WorldWrapperUtil::has_random(key.second);
+    vertex v;
+    if (keep && lookup(key, v))
+        return v;
+    //evaluated outside the lock, two threads may evaluate the same
+    //perception at the same time, which is harmless
+    v = WorldWrapperUtil::evalPerception(_mapHandle, time, _atomSpace,
+                                         _avatar_id, _owner_id,
+                                         key.second.begin(), isInThePast);
+    if (keep)
+        insert(key, v);
+    return v;
+}
+
+vertex ExemplarReplay::evalIndefiniteObject(indefinite_object io,
+                                            unsigned long time,
+                                            bool isInThePast)
+{
+    if (is_random(io))
+        return WorldWrapperUtil::evalIndefiniteObject(_mapHandle, time,
+                                                      _atomSpace, _avatar_id,
+                                                      _owner_id, io,
+                                                      isInThePast);
+    SnapshotKey key(std::make_pair(time, isInThePast), combo_tree(vertex(io)));
+    vertex v;
+    if (lookup(key, v))
+        return v;
+    v = WorldWrapperUtil::evalIndefiniteObject(_mapHandle, time, _atomSpace,
+                                               _avatar_id, _owner_id, io,
+                                               isInThePast);
+    insert(key, v);
+    return v;
+}
+
+bool ExemplarReplay::isRandomCandidate(indefinite_object io,
+                                       const std::string& do_id,
+                                       unsigned long time)
+{
+    if (io == get_instance(id::random_object))
+        return true;
+    combo_tree per(vertex(WorldWrapperUtil::nearest_random_X_to_is_X(io)));
+    per.append_child(per.begin(), vertex(definite_object(do_id)));
+    return vertex_to_bool(evalPerception(per.begin(), time, true));
+}
+
+unsigned ExemplarReplay::getNumberOfHits() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+bool ExemplarReplay::lookup(const SnapshotKey& key, vertex& v)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Snapshot::const_iterator it = _snapshot.find(key);
+    if (it == _snapshot.end())
+        return false;
+    ++_hits;
+    v = it->second;
+    return true;
+}
+
+void ExemplarReplay::insert(const SnapshotKey& key, const vertex& v)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _snapshot.insert(std::make_pair(key, v));
+}
+
+}//~namespace ImaginaryLife
@@ -0,0 +1,141 @@
+/*
+ * opencog/embodiment/Learning/NoSpaceLife/ExemplarReplay.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _EXEMPLARREPLAY_H
+#define _EXEMPLARREPLAY_H
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <moses/comboreduct/combo/vertex.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/embodiment/Learning/behavior/CompositeBehaviorDescription.h>
+
+namespace ImaginaryLife
+{
+
+using namespace behavior;
+using namespace combo;
+
+/**
+ * What every replay of an exemplar shares, whatever the candidate program
+ * being replayed: the exemplar itself, the space map it happened in, the
+ * arguments of its actions, and a snapshot of the world at each checkpoint
+ * of its timeline (the times at which a replay evaluates perceptions and
+ * indefinite objects).
+ *
+ * The snapshot is filled as the replays go: the first replay that needs
+ * a perception at a given time evaluates it, the others reuse the value.
+ * Perceptions and indefinite objects involving a random operator are never
+ * kept, since each evaluation must draw again.
+ *
+ * All methods are safe to call from several threads at once, so a single
+ * ExemplarReplay can be used by every candidate evaluated in parallel: the
+ * snapshot is protected by a mutex, and the evaluations go through
+ * WorldWrapperUtil, whose cache and random generator are per thread.
+ */
+class ExemplarReplay
+{
+public:
+    ExemplarReplay(AtomSpace& atomSpace, const std::string& owner_id,
+                   const std::string& avatar_id,
+                   const CompositeBehaviorDescription& cbd,
+                   const Temporal& exemplarTemporal);
+
+    AtomSpace& getAtomSpace() const;
+    const std::string& getOwnerId() const;
+    const std::string& getAvatarId() const;
+    const CompositeBehaviorDescription& getImitatedBD() const;
+    const Temporal& getExemplarTemporal() const;
+
+    /**
+     * the SpaceMap the exemplar is replayed in
+     */
+    Handle getMapHandle() const;
+
+    /**
+     * get the definite object given as argument arg_index to the action of
+     * the exemplar at the given timeline index, from the avatar point of
+     * view. Return false if there is no action or no such argument there.
+     */
+    bool getExemplarArgument(unsigned index, unsigned arg_index,
+                             std::string& do_id) const;
+
+    /**
+     * evaluate a perception, from the avatar point of view, at the given
+     * time
+     */
+    vertex evalPerception(combo_tree::iterator per, unsigned long time,
+                          bool isInThePast);
+
+    /**
+     * evaluate an indefinite object, from the avatar point of view, at
+     * the given time
+     */
+    vertex evalIndefiniteObject(indefinite_object io, unsigned long time,
+                                bool isInThePast);
+
+    /**
+     * return true iff the definite object do_id satisfies the perception
+     * associated to the random operator io (is_X for random_X) at the given
+     * time
+     */
+    bool isRandomCandidate(indefinite_object io, const std::string& do_id,
+                           unsigned long time);
+
+    /**
+     * number of evaluations answered from the snapshot
+     */
+    unsigned getNumberOfHits() const;
+
+private:
+    AtomSpace& _atomSpace;
+    const std::string& _owner_id;
+    const std::string& _avatar_id;
+    const CompositeBehaviorDescription& _imitatedBD;
+    const Temporal& _exemplarTemporal;
+
+    Handle _mapHandle;
+
+    //arguments of the action at each timeline index (empty if pause)
+    std::vector< std::vector<std::string> > _arguments;
+
+    //(time, isInThePast, perception or indefinite object) -> value
+    typedef std::pair<std::pair<unsigned long, bool>, combo_tree> SnapshotKey;
+    typedef boost::unordered_map<SnapshotKey, vertex,
+                                 boost::hash<SnapshotKey> > Snapshot;
+    Snapshot _snapshot;
+    unsigned _hits;
+    mutable std::mutex _mutex;
+
+    bool lookup(const SnapshotKey& key, vertex& v);
+    void insert(const SnapshotKey& key, const vertex& v);
+};
+
+}//~namespace ImaginaryLife
+
+#endif
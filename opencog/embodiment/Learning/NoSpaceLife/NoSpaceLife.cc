@@ -47,14 +47,29 @@ NoSpaceLife::NoSpaceLife(AtomSpace& atomSpace, const std::string& pet_id,
                          const std::string& avatar_id,
                          const CompositeBehaviorDescription& cbd,
                          const Temporal& et) :
+        _ownReplay(new ExemplarReplay(atomSpace, owner_id, avatar_id, cbd, et)),
+        _replay(*_ownReplay),
         _atomSpace(atomSpace), _pet_id(pet_id), _owner_id(owner_id),
         _avatar_id(avatar_id),
-        _currentTime(0), _currentIndex(0), _currentMapHandle(Handle::UNDEFINED),
-        _hasTimeChanged(true), _imitatedBD(cbd), _exemplarTemporal(et),
+        _currentTime(0), _currentIndex(0),
+        _imitatedBD(cbd), _exemplarTemporal(et),
         _generatedBD(&atomSpace)
 {
     _currentTime = _imitatedBD.getStartTime();
 }
+
+NoSpaceLife::NoSpaceLife(ExemplarReplay& replay, const std::string& pet_id) :
+        _replay(replay),
+        _atomSpace(replay.getAtomSpace()), _pet_id(pet_id),
+        _owner_id(replay.getOwnerId()), _avatar_id(replay.getAvatarId()),
+        _currentTime(0), _currentIndex(0),
+        _imitatedBD(replay.getImitatedBD()),
+        _exemplarTemporal(replay.getExemplarTemporal()),
+        _generatedBD(&replay.getAtomSpace())
+{
+    _currentTime = _imitatedBD.getStartTime();
+}
+
 NoSpaceLife::~NoSpaceLife() {}
 
 bool NoSpaceLife::processSequential_and(sib_it from, sib_it to)
@@ -102,12 +117,7 @@ CompositeBehaviorDescription& NoSpaceLife::getGeneratedBD()
 
 Handle NoSpaceLife::getCurrentMapHandle()
 {
-    if (_hasTimeChanged) {
-        _currentMapHandle
-        = AtomSpaceUtil::getCurrentSpaceMapHandle(_atomSpace);
-        _hasTimeChanged = false;
-    }
-    return _currentMapHandle;
+    return _replay.getMapHandle();
 }
 
 unsigned long NoSpaceLife::getCurrentTime() const
@@ -120,6 +130,11 @@ AtomSpace& NoSpaceLife::getAtomSpace() const
     return _atomSpace;
 }
 
+ExemplarReplay& NoSpaceLife::getExemplarReplay() const
+{
+    return _replay;
+}
+
 /**
  * private methods
  */
@@ -196,7 +211,7 @@ void NoSpaceLife::generateElementaryBD(ElementaryBehaviorDescription& ebd,
 
 builtin_action NoSpaceLife::choose_random_step() const
 {
-    int c = randGen().randint(4);
+    int c = AtomSpaceUtil::getThreadRandGen().randint(4);
     switch (c) {
     case 0:
         return get_instance(id::step_backward);
@@ -215,68 +230,15 @@ builtin_action NoSpaceLife::choose_random_step() const
 
 definite_object NoSpaceLife::choose_definite_object_that_fits(indefinite_object io, int arg_index)
 {
-    //get the elementary BD at current time
-    const std::vector<PredicateHandleSet>& tls = _imitatedBD.getTimelineSets();
-
-    bool corresponding_arg_exists = false;
-    std::string do_id; //id (or name) of the definite_object to return;
-
-    if (_currentIndex < tls.size()) {
-        const PredicateHandleSet& hs = tls[_currentIndex];
-        unsigned s = hs.getSize();
-        OC_ASSERT(s == 0 || s == 1, "hs should have at 0 or 1 element.");
-        if (s > 0) { //if there is an element then check if it could fit
-
-            //get the Handle of the arg_index argument if there is
-            Handle h = *hs.getSet().begin();
-            //check that it matches Behavior Description atom structure
-            OC_ASSERT(h != Handle::UNDEFINED);
-            OC_ASSERT(_atomSpace.getType(h) == EVALUATION_LINK);
-            OC_ASSERT(_atomSpace.getArity(h) == 2, "An EvaluationLink must have only 2 arguments");
-
-            Handle list_h = _atomSpace.getOutgoing(h, 1);
-            OC_ASSERT(_atomSpace.getType(list_h) == LIST_LINK);
-            //check if the equivalent argument exists
-            //and can correspond to a random operator
-            if (arg_index < _atomSpace.getArity(list_h) - 2) {
-                Handle arg_h = _atomSpace.getOutgoing(list_h, arg_index + 2);
-                OC_ASSERT(arg_h != Handle::UNDEFINED);
-                OC_ASSERT(_atomSpace.getType(arg_h),
-                                 "arg_h must be a Node");
-                //convert to self or owner if name is _avatar_id or _owner_id
-                //(avatarName corresponds to self because the puts itself under its
-                //skin
-                do_id = WorldWrapperUtil::atom_name_to_definite_object(_atomSpace.getName(arg_h), _avatar_id, _owner_id);
-                //depending on the random operator check if the object belongs to
-                //the set
-                if (io == get_instance(id::random_object))
-                    corresponding_arg_exists = true;
-                else {
-                    perception p = WorldWrapperUtil::nearest_random_X_to_is_X(io);
-                    pre_it it = WorldWrapperUtil::maketree_percept(p, do_id);
-                    corresponding_arg_exists =
-                        combo::vertex_to_bool(
-                            WorldWrapperUtil::evalPerception(getCurrentMapHandle(),
-                                                             _currentTime, _atomSpace,
-                                                             _avatar_id, _owner_id,
-                                                             it, true));
-                }
-            }
-        }
-    }
-    //if a corresponding argument exist then take it
+    //if the action of the exemplar at current time has a corresponding
+    //argument that fits the random operator io then take it
     //otherwise choose one randomly according to the random operator io
-    if (corresponding_arg_exists) {
+    std::string do_id;
+    if (_replay.getExemplarArgument(_currentIndex, arg_index, do_id)
+            && _replay.isRandomCandidate(io, do_id, _currentTime)) {
         return definite_object(do_id);
     } else {
-        vertex v = WorldWrapperUtil::evalIndefiniteObject(
-                   getCurrentMapHandle(),
-                   _currentTime,
-                   _atomSpace,
-                   _avatar_id,
-                   _owner_id,
-                   io,
-                   true);
+        vertex v = _replay.evalIndefiniteObject(io, _currentTime, true);
         OC_ASSERT(is_definite_object(v));
         return get_definite_object(v);
     }
@@ -24,12 +24,16 @@
 #ifndef _NOSPACELIFE_H
 #define _NOSPACELIFE_H
 
+#include <memory>
+
 #include <moses/comboreduct/combo/vertex.h>
 
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/embodiment/Learning/behavior/CompositeBehaviorDescription.h>
 #include <opencog/embodiment/AvatarComboVocabulary/AvatarComboVocabulary.h>
 
+#include "ExemplarReplay.h"
+
 #define ACTION_DONE_TIME 200 //each action takes 2 seconds
 #define PAUSE_TIME 200
 #define BEHAVED_STR "behaved"
@@ -57,6 +61,12 @@ public:
                 const CompositeBehaviorDescription& cbd,
                 const Temporal& exemplarTemporal);
 
+    /**
+     * replay the exemplar of replay, sharing with the other replays of it
+     * the snapshot of the world at its checkpoints
+     */
+    NoSpaceLife(ExemplarReplay& replay, const std::string& pet_id);
+
     ~NoSpaceLife();
 
     /**
@@ -80,7 +90,13 @@ public:
 
     AtomSpace& getAtomSpace() const;
 
+    ExemplarReplay& getExemplarReplay() const;
+
 private:
+    //owned replay when not shared, see the first constructor
+    std::unique_ptr<ExemplarReplay> _ownReplay;
+    ExemplarReplay& _replay;
+
     AtomSpace& _atomSpace; //a reference to the AtomSpace that lives within LS
     //not a const because it can be changed by the algo
 
@@ -95,10 +111,6 @@ private:
 
     unsigned _currentIndex;
 
-    Handle _currentMapHandle;
-
-    bool _hasTimeChanged;
-
     const CompositeBehaviorDescription& _imitatedBD;
 
     const Temporal& _exemplarTemporal;
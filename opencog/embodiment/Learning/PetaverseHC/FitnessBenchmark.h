@@ -0,0 +1,124 @@
+/*
+ * opencog/embodiment/Learning/PetaverseHC/FitnessBenchmark.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef _HILLCLIMBING_FITNESS_BENCHMARK_H
+#define _HILLCLIMBING_FITNESS_BENCHMARK_H
+
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FitnessCache.h"
+
+namespace opencog { namespace hillclimbing {
+
+struct fitness_benchmark_result
+{
+    unsigned candidates;
+    unsigned threads;
+    double seconds;
+    // number of results lower than the cutoff, that is the candidates
+    // that were estimated exactly below it or terminated early
+    unsigned below_cutoff;
+    double best;
+
+    double candidates_per_second() const
+    {
+        return seconds > 0 ? candidates / seconds : 0;
+    }
+
+    std::string to_string() const
+    {
+        std::stringstream ss;
+        ss << candidates << " candidates, " << threads << " threads: "
+           << seconds << "s (" << candidates_per_second()
+           << " candidates/s), " << below_cutoff
+           << " below cutoff, best " << best;
+        return ss.str();
+    }
+};
+
+/**
+ * Time the estimation of the candidates in [from, to) the way hillclimber
+ * estimates a neighborhood, that is through parallel_estimate over
+ * n_threads threads.
+ *
+ * Any fitness estimator can be benchmarked: a function object from
+ * combo_tree to its result_type (NoSpaceLifeFitnessEstimator, a
+ * fitness_cache in front of it, ...) that is safe to call concurrently
+ * if n_threads is greater than 1. The fitnesses are written in res.
+ *
+ * fitness-benchmark runs it on NoSpaceLifeFitnessEstimator.
+ */
+template<typename F, typename TreeIt, typename Result>
+fitness_benchmark_result benchmark_estimation(const F& f,
+                                              TreeIt from, TreeIt to,
+                                              unsigned n_threads,
+                                              std::vector<Result>& res,
+                                              Result cutoff = -std::numeric_limits<Result>::max())
+{
+    typedef std::chrono::steady_clock clock;
+
+    fitness_benchmark_result br;
+    br.candidates = std::distance(from, to);
+    br.threads = n_threads;
+    res.resize(br.candidates);
+
+    clock::time_point start = clock::now();
+    parallel_estimate(f, from, to, res.begin(), n_threads);
+    br.seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    br.below_cutoff = 0;
+    br.best = -std::numeric_limits<double>::max();
+    for (const Result& r : res) {
+        if (r < cutoff)
+            ++br.below_cutoff;
+        if (r > br.best)
+            br.best = r;
+    }
+    return br;
+}
+
+/**
+ * Same as above with early termination: FE must provide
+ * operator()(tree, cutoff), see fitness_cache.
+ */
+template<typename FE, typename TreeIt>
+fitness_benchmark_result benchmark_estimation_with_cutoff(const FE& fe,
+        TreeIt from, TreeIt to, unsigned n_threads,
+        typename FE::result_type cutoff,
+        std::vector<typename FE::result_type>& res)
+{
+    typedef typename FE::result_type result_type;
+    typedef typename std::iterator_traits<TreeIt>::value_type tree_type;
+    return benchmark_estimation([&fe, cutoff](const tree_type& tr) {
+                                    return fe(tr, cutoff);
+                                },
+                                from, to, n_threads, res,
+                                result_type(cutoff));
+}
+
+}} // ~namespace opencog::hillclimbing
+
+#endif // _HILLCLIMBING_FITNESS_BENCHMARK_H
@@ -0,0 +1,254 @@
+/*
+ * opencog/embodiment/Learning/PetaverseHC/FitnessCache.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef _HILLCLIMBING_FITNESS_CACHE_H
+#define _HILLCLIMBING_FITNESS_CACHE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <moses/comboreduct/combo/vertex.h>
+
+namespace opencog { namespace hillclimbing {
+
+/**
+ * Thread-safe LRU cache in front of a fitness estimator.
+ *
+ * The key is the combo tree as handed over by the caller. The
+ * NeighborhoodGenerator already reduces every candidate to its normal
+ * form, so two syntactically different but equivalent programs end up
+ * on the same entry and are only scored once.
+ *
+ * The estimator itself is called outside the lock, so several threads
+ * may estimate different candidates at the same time. A thread that
+ * misses on a candidate being estimated by another thread waits for
+ * that estimation instead of starting its own, so each candidate is
+ * estimated once.
+ *
+ * A capacity of 0 disables caching altogether (every call goes to the
+ * estimator).
+ */
+template<typename FE>
+class fitness_cache
+{
+public:
+    typedef typename FE::result_type result_type;
+    typedef combo::combo_tree argument_type;
+
+    fitness_cache(unsigned capacity, const FE& fe)
+        : _capacity(capacity), _fe(fe), _hits(0), _misses(0) {}
+
+    result_type operator()(const argument_type& tr) const
+    {
+        if (_capacity == 0) {
+            ++_misses;
+            return _fe(tr);
+        }
+        result_type res;
+        if (lookup_or_reserve(tr, res))
+            return res;
+        try {
+            res = _fe(tr);
+        } catch (...) {
+            release(tr);
+            throw;
+        }
+        release(tr, &res);
+        return res;
+    }
+
+    /**
+     * Same as above, but the estimator may stop as soon as tr cannot
+     * reach cutoff. FE must then provide operator()(tr, cutoff), returning
+     * the fitness of tr if it is not lower than cutoff, and an upper bound
+     * of it lower than cutoff otherwise. Such bounds are not cached, since
+     * they depend on the cutoff, only exact estimations are.
+     */
+    result_type operator()(const argument_type& tr, result_type cutoff) const
+    {
+        if (_capacity == 0) {
+            ++_misses;
+            return _fe(tr, cutoff);
+        }
+        result_type res;
+        if (lookup_or_reserve(tr, res))
+            return res;
+        try {
+            res = _fe(tr, cutoff);
+        } catch (...) {
+            release(tr);
+            throw;
+        }
+        release(tr, res < cutoff ? NULL : &res);
+        return res;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _map.clear();
+        _lru.clear();
+    }
+
+    unsigned size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _map.size();
+    }
+
+    // Number of calls answered from the cache
+    unsigned get_number_of_hits() const { return _hits; }
+    // Number of calls that went to the estimator
+    unsigned get_number_of_evaluations() const { return _misses; }
+
+private:
+    typedef std::list<argument_type> lru_list;
+    typedef typename lru_list::iterator lru_it;
+    typedef boost::unordered_map<argument_type,
+                                 std::pair<result_type, lru_it>,
+                                 boost::hash<argument_type> > cache_map;
+    typedef typename cache_map::iterator map_it;
+
+    const unsigned _capacity;
+    const FE& _fe;
+
+    mutable std::mutex _mutex;
+    mutable lru_list _lru;
+    mutable cache_map _map;
+    // candidates being estimated, and where to wait for them
+    mutable boost::unordered_set<argument_type,
+                                 boost::hash<argument_type> > _pending;
+    mutable std::condition_variable _estimated;
+
+    mutable std::atomic<unsigned> _hits;
+    mutable std::atomic<unsigned> _misses;
+
+    /**
+     * Return true and the cached fitness of tr in res if there is one,
+     * waiting for the estimation of tr if another thread is running it.
+     * Otherwise return false, and the caller must estimate tr and then
+     * call release(tr).
+     */
+    bool lookup_or_reserve(const argument_type& tr, result_type& res) const
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;) {
+            map_it mi = _map.find(tr);
+            if (mi != _map.end()) {
+                // move the entry to the front of the LRU list
+                _lru.splice(_lru.begin(), _lru, mi->second.second);
+                ++_hits;
+                res = mi->second.first;
+                return true;
+            }
+            // the other estimation may end without a cacheable result
+            // (an error, a bound), then this thread estimates it
+            if (_pending.find(tr) == _pending.end())
+                break;
+            _estimated.wait(lock);
+        }
+        _pending.insert(tr);
+        ++_misses;
+        return false;
+    }
+
+    /**
+     * End the estimation of tr, caching res if not NULL, and wake up the
+     * threads waiting for it.
+     */
+    void release(const argument_type& tr, const result_type* res = NULL) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending.erase(tr);
+            if (res)
+                insert(tr, *res);
+        }
+        _estimated.notify_all();
+    }
+
+    // _mutex must be held
+    void insert(const argument_type& tr, result_type res) const
+    {
+        if (_map.find(tr) == _map.end()) {
+            if (_map.size() >= _capacity) {
+                _map.erase(_lru.back());
+                _lru.pop_back();
+            }
+            _lru.push_front(tr);
+            _map.insert(std::make_pair(tr,
+                        std::make_pair(res, _lru.begin())));
+        }
+    }
+};
+
+/**
+ * Estimate the fitness of every tree in [from, to) and write the results
+ * into [out, out + (to - from)), using n_threads worker threads.
+ *
+ * Candidates are handed out one at a time through a shared counter so
+ * that expensive candidates don't leave the other workers idle. The
+ * result at a given position does not depend on the number of threads,
+ * hence the order of the neighborhood (and therefore the hillclimber
+ * itself) stays deterministic.
+ *
+ * F must be safe to call concurrently from several threads.
+ */
+template<typename F, typename TreeIt, typename OutIt>
+void parallel_estimate(const F& f, TreeIt from, TreeIt to, OutIt out,
+                       unsigned n_threads)
+{
+    const size_t n = std::distance(from, to);
+    if (n_threads <= 1 || n <= 1) {
+        for (; from != to; ++from, ++out)
+            *out = f(*from);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++)
+            *(out + i) = f(*(from + i));
+    };
+
+    n_threads = std::min<size_t>(n_threads, n);
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads - 1);
+    for (unsigned t = 1; t < n_threads; ++t)
+        workers.push_back(std::thread(worker));
+    // the calling thread takes its share of the work as well
+    worker();
+    for (std::thread& t : workers)
+        t.join();
+}
+
+}} // ~namespace opencog::hillclimbing
+
+#endif // _HILLCLIMBING_FITNESS_CACHE_H
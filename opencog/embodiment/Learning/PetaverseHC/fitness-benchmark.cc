@@ -0,0 +1,217 @@
+/*
+ * opencog/embodiment/Learning/PetaverseHC/fitness-benchmark.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Times NoSpaceLifeFitnessEstimator on a neighborhood of candidates, the
+// way hillclimber estimates it, over 1, 2, 4, ... threads, with and
+// without early termination.
+//
+// The exemplars are sequences of actions of an avatar on a few objects,
+// the candidates sequences of the same actions, some of them with
+// random_step so that the Monte Carlo trials are timed too.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <opencog/util/Config.h>
+#include <opencog/util/mt19937ar.h>
+
+#include <opencog/spacetime/SpaceTime.h>
+
+#include <opencog/embodiment/AtomSpaceExtensions/atom_types.h>
+#include <opencog/embodiment/AvatarComboVocabulary/AvatarComboVocabulary.h>
+#include <opencog/embodiment/Control/EmbodimentConfig.h>
+#include <opencog/embodiment/Learning/FitnessEstimator/NoSpaceLifeFitnessEstimator.h>
+#include <opencog/embodiment/Learning/NoSpaceLife/NoSpaceLife.h>
+#include <opencog/embodiment/Learning/behavior/BehaviorCategory.h>
+#include <opencog/embodiment/Learning/behavior/WorldProvider.h>
+
+#include "FitnessBenchmark.h"
+
+using namespace opencog;
+using namespace opencog::hillclimbing;
+using namespace behavior;
+using namespace FitnessEstimator;
+using boost::lexical_cast;
+
+#define PET_NAME "Fido"
+#define OWNER_NAME "Wynx"
+#define AVATAR_NAME "Wynx"
+#define TRICK_NAME "benchmark"
+
+// the actions of the exemplars and of the candidates, and their objects
+static const char* actions[] = { "sit", "jump_up", "drop", "step_forward",
+                                 "rotate_left", "grab", "kick", "eat" };
+static const bool takes_object[] = { false, false, false, false,
+                                     false, true, true, true };
+static const unsigned n_actions = sizeof(actions) / sizeof(actions[0]);
+static const char* objects[] = { "stick", "ball", "bone" };
+static const unsigned n_objects = sizeof(objects) / sizeof(objects[0]);
+
+class BenchmarkWorldProvider : public WorldProvider
+{
+    AtomSpace& _as;
+public:
+    BenchmarkWorldProvider(AtomSpace& as) : _as(as) {}
+    unsigned long getLatestSimWorldTimestamp() const { return 0; }
+    AtomSpace& getAtomSpace() const { return _as; }
+};
+
+static std::string random_action(RandGen& rng)
+{
+    unsigned a = rng.randint(n_actions);
+    std::string action = actions[a];
+    if (takes_object[a])
+        action += std::string("(") + objects[rng.randint(n_objects)] + ")";
+    return action;
+}
+
+// EvaluationLink(behaved, ListLink(avatar, action, object)) for each
+// action, one after the other
+static CompositeBehaviorDescription random_exemplar(AtomSpace& as,
+                                                    RandGen& rng,
+                                                    Temporal& temporal)
+{
+    CompositeBehaviorDescription cbd(&as);
+    Handle behaved_h = as.addNode(PREDICATE_NODE, BEHAVED_STR);
+    Handle avatar_h = as.addNode(AVATAR_NODE, AVATAR_NAME);
+    unsigned length = 3 + rng.randint(3);
+    unsigned long time = 0;
+    for (unsigned i = 0; i < length; ++i, time += ACTION_DONE_TIME + PAUSE_TIME) {
+        unsigned a = rng.randint(n_actions);
+        HandleSeq list;
+        list.push_back(avatar_h);
+        list.push_back(as.addNode(NODE, actions[a]));
+        if (takes_object[a])
+            list.push_back(as.addNode(OBJECT_NODE, objects[rng.randint(n_objects)]));
+        HandleSeq eval;
+        eval.push_back(behaved_h);
+        eval.push_back(as.addLink(LIST_LINK, list));
+        cbd.addPredicate(as.addLink(EVALUATION_LINK, eval),
+                         time, time + ACTION_DONE_TIME);
+    }
+    temporal = Temporal(0, time);
+    return cbd;
+}
+
+// and_seq of 1 to 5 actions, random_step in one candidate out of 5
+static combo::combo_tree random_candidate(RandGen& rng)
+{
+    std::stringstream ss;
+    ss << "and_seq(";
+    unsigned length = 1 + rng.randint(5);
+    for (unsigned i = 0; i < length; ++i)
+        ss << (i ? " " : "") << random_action(rng);
+    if (rng.randint(5) == 0)
+        ss << " random_step";
+    ss << ")";
+    combo::combo_tree tr;
+    AvatarCombo::operator>>(ss, tr);
+    return tr;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 5) {
+        std::cout << "Usage: " << argv[0]
+                  << " [candidates = 200] [exemplars = 4]"
+                  << " [max_threads = number of cores] [seed = 0]"
+                  << std::endl;
+        return 1;
+    }
+    unsigned n_candidates = argc > 1 ? lexical_cast<unsigned>(argv[1]) : 200;
+    unsigned n_exemplars = argc > 2 ? lexical_cast<unsigned>(argv[2]) : 4;
+    unsigned max_threads = argc > 3 ? lexical_cast<unsigned>(argv[3])
+                           : std::max(1u, std::thread::hardware_concurrency());
+    unsigned long seed = argc > 4 ? lexical_cast<unsigned long>(argv[4]) : 0;
+
+    config(control::EmbodimentConfig::embodimentCreateInstance, true);
+    server(SpaceTimeCogServer::createInstance);
+    AtomSpace& as = server().getAtomSpace();
+    MT19937RandGen rng(seed);
+
+    as.addNode(PET_NODE, PET_NAME);
+    as.addNode(AVATAR_NODE, OWNER_NAME);
+    definite_object_set dos;
+    for (unsigned i = 0; i < n_objects; ++i) {
+        as.addNode(OBJECT_NODE, objects[i]);
+        dos.insert(definite_object(objects[i]));
+    }
+
+    BehaviorCategory BDCat(&as);
+    std::vector<Temporal> temporals;
+    argument_list_list all;
+    for (unsigned i = 0; i < n_exemplars; ++i) {
+        Temporal t(0);
+        BDCat.addCompositeBehaviorDescription(random_exemplar(as, rng, t));
+        temporals.push_back(t);
+        all.push_back(argument_list());
+    }
+
+    std::vector<combo::combo_tree> candidates;
+    for (unsigned i = 0; i < n_candidates; ++i)
+        candidates.push_back(random_candidate(rng));
+
+    BenchmarkWorldProvider wp(as);
+    std::vector<fitness_t> res, ref;
+    std::cout << n_exemplars << " exemplars" << std::endl;
+    for (unsigned n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+        // a new estimator each time, its cache would answer the
+        // candidates estimated by the previous runs
+        NoSpaceLifeFitnessEstimator fe(&wp, PET_NAME, OWNER_NAME, AVATAR_NAME,
+                                       TRICK_NAME, dos, BDCat, temporals, all,
+                                       0, 1, 0, n_actions);
+        fitness_benchmark_result br =
+            benchmark_estimation(fe, candidates.begin(), candidates.end(),
+                                 n_threads, res);
+        std::cout << "exact:  " << br.to_string() << std::endl;
+
+        // the candidates without random operators must not depend on
+        // the number of threads
+        if (ref.empty())
+            ref = res;
+        for (unsigned i = 0; i < candidates.size(); ++i) {
+            std::stringstream ss;
+            ss << candidates[i];
+            if (ss.str().find("random") == std::string::npos && res[i] != ref[i]) {
+                std::cerr << "Fitness of " << ss.str() << " is " << res[i]
+                          << " over " << n_threads << " threads, "
+                          << ref[i] << " over 1 thread" << std::endl;
+                return 1;
+            }
+        }
+
+        NoSpaceLifeFitnessEstimator fe_cutoff(&wp, PET_NAME, OWNER_NAME,
+                                              AVATAR_NAME, TRICK_NAME, dos,
+                                              BDCat, temporals, all,
+                                              0, 1, 0, n_actions);
+        br = benchmark_estimation_with_cutoff(fe_cutoff, candidates.begin(),
+                                              candidates.end(), n_threads,
+                                              br.best * 0.9, res);
+        std::cout << "cutoff: " << br.to_string() << std::endl;
+    }
+    return 0;
+}
@@ -27,23 +27,23 @@
 #include <opencog/util/selection.h>
 #include <opencog/util/exceptions.h>
 #include <opencog/util/oc_assert.h>
-#include <opencog/util/lru_cache.h>
 #include <opencog/util/numeric.h>
 #include <opencog/util/RandGen.h>
 
 #include <moses/comboreduct/combo/vertex.h>
 #include "NeighborhoodGenerator.h"
+#include "FitnessCache.h"
 #include <ctime>
+#include <limits>
 #include <vector>
 #include <iostream>
 #include <map>
 #include <set>
 #include <boost/unordered_set.hpp>
 
-//uncomment those 2 lines if want cache
-//don't forget to comment COUNT_NUMBER_OF_FITNESS as well
-//#define IS_HC_CACHE
-//#define ESTIMATOR_CACHE_SIZE 500000
+//default number of entries kept in the estimator cache
+//(0 disables the cache)
+#define ESTIMATOR_CACHE_SIZE 500000
 
 //info for debug
 //#define COUNT_NUMBER_OF_FITNESS
@@ -100,6 +100,12 @@ struct hillclimber {
     //- neic stands for new_exemplar_initializes_center
     //  and if is true then everytime a new exemplar comes
     //  the center is initialized with the empty program instead of the best one
+    //- n_threads is the number of threads used to estimate the fitness
+    //  of the neighborhood, if greater than 1 then FE must be thread safe
+    //- cache_size is the max number of estimations kept in the cache
+    //- early_termination is true to let FE stop estimating the candidates
+    //  that cannot beat the best estimation so far, FE must then provide
+    //  operator()(tree, cutoff), see fitness_cache
     hillclimber(const FE& fe, int fepc,
                 const operator_set& os,
                 const combo_tree_ns_set& conditions,
@@ -109,12 +115,15 @@ struct hillclimber {
                 const rule& full_reduction,
                 bool abibb,
                 bool neic,
-                bool reduct_enabled = true)
+                bool reduct_enabled = true,
+                unsigned n_threads = 1,
+                unsigned cache_size = ESTIMATOR_CACHE_SIZE,
+                bool early_termination = false)
             : _fitnessEstimator(fe),
             _fitnessEstimationPerCycle(fepc),
-#ifdef IS_HC_CACHE
-            _estimator_cache(ESTIMATOR_CACHE_SIZE, _fitnessEstimator),
-#endif
+            _n_threads(n_threads),
+            _early_termination(early_termination),
+            _estimator_cache(cache_size, _fitnessEstimator),
             _current_fitness(INIT_FITNESS),
             _current_fitness_estimated(MIN_FITNESS),
             _best_fitness(MIN_FITNESS),
@@ -194,6 +203,7 @@ struct hillclimber {
             //estimate the fitness of the neighborhood
             //and fill _ordered_neighborhood using fitness as order
             estimate_fitness_at_most(_fitnessEstimationPerCycle);
+            settle_best_estimates();
             //update _best_fitness_estimated
             ordered_neighborhood_const_it oni = _ordered_best_estimates.begin();
             OC_ASSERT(!_ordered_best_estimates.empty(),
@@ -276,10 +286,10 @@ struct hillclimber {
     }
 
     void reset_estimator() {
-#ifdef IS_HC_CACHE
+        //the fitness landscape changes with every new exemplar
         _estimator_cache.clear();
-#endif
         _ordered_best_estimates.clear(); //because its content is out of date
+        _bounded_estimates.clear();
         _used_as_center.clear();
 
         //depending on the option
@@ -309,9 +319,11 @@ private:
 
     int _fitnessEstimationPerCycle;
 
-#ifdef IS_HC_CACHE
-    lru_cache<FE> _estimator_cache;
-#endif
+    unsigned _n_threads;
+
+    bool _early_termination;
+
+    fitness_cache<FE> _estimator_cache;
 
     //Attributes
     //current program represent the current best program estimated during
@@ -330,6 +342,9 @@ private:
     neighborhood _neighborhood;
 
     ordered_neighborhood _ordered_best_estimates; //_ordered_neighborhood;
+    //candidates whose estimation was terminated early, ordered by the
+    //upper bound of their fitness
+    ordered_neighborhood _bounded_estimates;
 
     HCState _hcState;
 
@@ -348,33 +363,83 @@ private:
     // fitness estimation of n candidates at most
     //---------------------------------------------------------------------
 
+    //the candidates are taken out of the neighborhood in order
+    //then estimated concurrently over _n_threads threads
+    //
+    //with early termination, the candidates that cannot beat the best
+    //estimation before that call are given an upper bound of their
+    //fitness (lower than the best) instead, and are kept aside in
+    //_bounded_estimates until settle_best_bound re-estimates them
     void estimate_fitness_at_most(int n) {
         OC_ASSERT(n > 0);
-        for (int i = 0; i < n && !_neighborhood.empty(); ++i) {
+        std::vector<combo_tree> candidates;
+        candidates.reserve(std::min<size_t>(n, _neighborhood.size()));
+        neighborhood_it ni = _neighborhood.begin();
+        for (int i = 0; i < n && ni != _neighborhood.end(); ++i, ++ni)
+            candidates.push_back(*ni);
+        _neighborhood.erase(_neighborhood.begin(), ni);
+
+        std::vector<fitness_t> fitnesses(candidates.size());
+        bool bounded = _early_termination && !_ordered_best_estimates.empty();
+        fitness_t cutoff = bounded ? _ordered_best_estimates.begin()->first
+                                   : MIN_FITNESS;
+        if (bounded)
+            parallel_estimate([this, cutoff](const combo_tree& tr) {
+                                  return _estimator_cache(tr, cutoff);
+                              },
+                              candidates.begin(), candidates.end(),
+                              fitnesses.begin(), _n_threads);
+        else
+            parallel_estimate(_estimator_cache,
+                              candidates.begin(), candidates.end(),
+                              fitnesses.begin(), _n_threads);
+
+        for (unsigned i = 0; i < candidates.size(); ++i) {
+            ordered_neighborhood& on = bounded && fitnesses[i] < cutoff ?
+                                       _bounded_estimates : _ordered_best_estimates;
+            on.insert(std::make_pair(fitnesses[i], candidates[i]));
+        }
 #ifdef COUNT_NUMBER_OF_FITNESS
-            _number_of_fitness++;
+        _number_of_fitness += candidates.size();
 #endif
-            neighborhood_it tmp_it = _neighborhood.begin();
-#ifdef IS_HC_CACHE
-            std::pair<fitness_t, combo_tree> p(_estimator_cache(*tmp_it), *tmp_it);
-#else
-            std::pair<fitness_t, combo_tree> p(_fitnessEstimator(*tmp_it), *tmp_it);
-#endif
-
-            _ordered_best_estimates.insert(p);
-            _neighborhood.erase(tmp_it);
-        }
         if (_neighborhood.empty()) {
             _used_as_center.insert(_center);
         }
 #ifdef COUNT_NUMBER_OF_FITNESS
         //debug log
         logger().debug("hillclimber - Total number of fitness estimations : %d", _number_of_fitness);
-        logger().debug("hillclimber - Total number of non-cached estimations : %d", _estimator_cache.get_number_of_evaluations());
+        logger().debug("hillclimber - Total number of non-cached estimations : %u", _estimator_cache.get_number_of_evaluations());
         //~debug log
 #endif
     }
 
+    //if the best bounded candidate could be as good as fitness f, that is
+    //its upper bound is not lower than f, then estimate it exactly and
+    //move it to _ordered_best_estimates. Return true iff it did so
+    bool settle_best_bound(fitness_t f) {
+        if (_bounded_estimates.empty())
+            return false;
+        ordered_neighborhood_it bi = _bounded_estimates.begin();
+        if (bi->first < f)
+            return false;
+        combo_tree tr = bi->second;
+        _bounded_estimates.erase(bi);
+        _ordered_best_estimates.insert(std::make_pair(_estimator_cache(tr),
+                                                      tr));
+#ifdef COUNT_NUMBER_OF_FITNESS
+        ++_number_of_fitness;
+#endif
+        return true;
+    }
+
+    //estimate exactly the bounded candidates until none of them can beat
+    //the best of _ordered_best_estimates
+    void settle_best_estimates() {
+        while (settle_best_bound(_ordered_best_estimates.empty() ?
+                                 -std::numeric_limits<fitness_t>::max() :
+                                 _ordered_best_estimates.begin()->first));
+    }
+
     //---------------------------------------------------------------------
     // Populate methods
     //---------------------------------------------------------------------
@@ -414,17 +479,15 @@ private:
     //If there is no such candidate (all has been sent or no candidates
     //have been produced), then it returns the end interator
     ordered_neighborhood_it random_not_sent_best_program() {
-        ordered_neighborhood_it oni = _ordered_best_estimates.end();
-        if (!_ordered_best_estimates.empty()) {
-            oni = random_best_candidate();
-            while (!_ordered_best_estimates.empty()
-                    && has_been_sent_to_user(oni->second)) {
-                _ordered_best_estimates.erase(oni);
-                if (!_ordered_best_estimates.empty())
-                    oni = random_best_candidate();
-            }
+        for (;;) {
+            settle_best_estimates();
+            if (_ordered_best_estimates.empty())
+                return _ordered_best_estimates.end();
+            ordered_neighborhood_it oni = random_best_candidate();
+            if (!has_been_sent_to_user(oni->second))
+                return oni;
+            _ordered_best_estimates.erase(oni);
         }
-        return oni;
     }
 
     //return randomly one of the best (fitness, cadidate)
@@ -454,13 +517,20 @@ private:
     //therefore the candidate space is finite
     bool choose_center(combo_tree& tr) {
 #ifdef DETERMINISTIC_REEXPANSION
-        ordered_neighborhood_const_it oni = _ordered_best_estimates.begin();
-        while (has_been_used_as_center(oni->second)) {
-            ++oni;
-            if (oni == _ordered_best_estimates.end()) //that is all candidates
-                //have been tried as center
-                return false;
-        }
+        ordered_neighborhood_const_it oni;
+        //a bounded candidate must be estimated exactly before it is
+        //passed over by a worse center
+        do {
+            oni = _ordered_best_estimates.begin();
+            while (oni != _ordered_best_estimates.end()
+                    && has_been_used_as_center(oni->second))
+                ++oni;
+        } while (settle_best_bound(oni == _ordered_best_estimates.end() ?
+                                   -std::numeric_limits<fitness_t>::max() :
+                                   oni->first));
+        if (oni == _ordered_best_estimates.end()) //that is all candidates
+            //have been tried as center
+            return false;
         tr = oni->second;
         return true;
 #else
@@ -53,7 +53,8 @@ struct interactive_hillclimber {
         _hillclimber = new hillclimber<FitnessEstimator>
         (fe, fepc, _elementary_operators, _perceptions, _actions, _comp,
          action_reduction(), action_reduction(),
-         false, false);
+         false, false, true,
+         1, 0); //the user is the estimator, don't cache nor parallelize
 
     }
 
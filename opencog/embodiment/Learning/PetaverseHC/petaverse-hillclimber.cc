@@ -35,7 +35,10 @@ petaverse_hillclimber::petaverse_hillclimber(int nepc,
         const combo_tree_ns_set& actions,
         bool abibb,
         bool neic,
-        bool reduct_enabled)
+        bool reduct_enabled,
+        unsigned n_threads,
+        unsigned cache_size,
+        bool early_termination)
         : _comp(dos),
         _elementary_operators(eo), _conditions(conditions),
         _actions(actions),
@@ -43,7 +46,8 @@ petaverse_hillclimber::petaverse_hillclimber(int nepc,
                      _conditions, _actions, _comp,
                      hillclimbing_action_reduction(),
                      hillclimbing_full_reduction(),
-                     abibb, neic, reduct_enabled)
+                     abibb, neic, reduct_enabled,
+                     n_threads, cache_size, early_termination)
 {
 
     //right after run the operator once to have already a learned candidate
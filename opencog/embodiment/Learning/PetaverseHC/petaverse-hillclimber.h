@@ -43,6 +43,10 @@ public:
     //- neic stands for new_exemplar_initializes_center
     //  and if is true then everytime a new exemplar comes
     //  the center is initialized with the empty program instead of the best one
+    //- n_threads is the number of threads estimating the neighborhood
+    //- cache_size is the size of the fitness estimation cache
+    //- early_termination is true to stop estimating the candidates that
+    //  cannot beat the best estimation so far
     petaverse_hillclimber(int nepc,
                           const FE& fitness_estimator,
                           const definite_object_set& dos,
@@ -51,7 +55,10 @@ public:
                           const combo_tree_ns_set& actions,
                           bool abibb,
                           bool neic,
-                          bool reduct_enabled);
+                          bool reduct_enabled,
+                          unsigned n_threads = 1,
+                          unsigned cache_size = ESTIMATOR_CACHE_SIZE,
+                          bool early_termination = false);
 
     ~petaverse_hillclimber();
 
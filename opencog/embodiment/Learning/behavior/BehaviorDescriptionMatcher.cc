@@ -25,6 +25,7 @@
 #include <opencog/util/oc_assert.h>
 #include "BehaviorDescriptionMatcher.h"
 #include "EvaluationLinkSimilarityEvaluator.h"
+#include <algorithm>
 #include <math.h>
 
 //WARNING : temporary just for debug
@@ -46,60 +47,65 @@ BehaviorDescriptionMatcher::~BehaviorDescriptionMatcher()
 BehaviorDescriptionMatcher::BehaviorDescriptionMatcher(AtomSpace *atomSpace)
 {
     this->atomSpace = atomSpace;
-    matricesBuilt = false;
+    matrixSize = 0;
+    setsDistributionRelevance = 0;
+    sucessorRelevance = 0;
+    intervalRelevance = 0;
 }
 
-void BehaviorDescriptionMatcher::destroyMatrices(BehaviorCategory &category)
+float BehaviorDescriptionMatcher::computePertinenceDegree(BehaviorCategory &category, CompositeBehaviorDescription &behaviorDescription, bool timingRelevanceFlag)
 {
 
-    std::vector<CompositeBehaviorDescription> bds = category.getEntries();
+    prepareCategory(category, timingRelevanceFlag);
+    return scoreBehaviorDescription(behaviorDescription, timingRelevanceFlag);
+}
 
-    if (matricesBuilt) {
-        for (unsigned int i = 0; i < bds.size(); i++) {
-            for (unsigned int j = 0; j < allSets.size(); j++) {
-                delete [] categoryMatrices[i][j];
-            }
-            delete [] categoryMatrices[i];
-        }
-        delete [] categoryMatrices;
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            delete [] averageMatrix[j];
-        }
-        delete [] averageMatrix;
-        matricesBuilt = false;
+void BehaviorDescriptionMatcher::computePertinenceDegrees(BehaviorCategory &category, std::vector<CompositeBehaviorDescription> &behaviorDescriptions, std::vector<float> &degrees, bool timingRelevanceFlag)
+{
+
+    prepareCategory(category, timingRelevanceFlag);
+    degrees.resize(behaviorDescriptions.size());
+    for (unsigned int i = 0; i < behaviorDescriptions.size(); i++) {
+        degrees[i] = scoreBehaviorDescription(behaviorDescriptions[i], timingRelevanceFlag);
     }
 }
 
-float BehaviorDescriptionMatcher::computePertinenceDegree(BehaviorCategory &category, CompositeBehaviorDescription &behaviorDescription, bool timingRelevanceFlag)
+void BehaviorDescriptionMatcher::prepareCategory(BehaviorCategory &category, bool timingRelevanceFlag)
 {
 
-    buildMapping(category, behaviorDescription);
+    buildUnionOfPredicateSets(category);
 
     // Sets (or chunks/pred-chunks in Ben's terminology) which apperar in BD and category
 
     computeSetDistribution(category);
-    float f1 = computeSetsDistributionFitness(behaviorDescription);
-    float w1 = computeSetsDistributionRelevance(category);
+    setsDistributionRelevance = computeSetsDistributionRelevance(category);
 
     // Relative order among sets in each BD
 
     computeSucessorMatrix(category);
-    float f2 = computeSucessorFitness(behaviorDescription);
-    float w2 = computeSucessorRelevance(category);
-    destroyMatrices(category);
+    sucessorRelevance = computeSucessorRelevance(category);
 
     // Time length of intervals
 
-    float f3;
-    float w3;
     if (timingRelevanceFlag) {
         computeTimeLengthBoundaries(category);
-        f3 = computeIntervalFitness(behaviorDescription);
-        w3 = computeIntervalRelevance(category);
+        intervalRelevance = computeIntervalRelevance(category);
     } else {
-        f3 = 1;
-        w3 = 0;
+        intervalRelevance = 0;
     }
+}
+
+float BehaviorDescriptionMatcher::scoreBehaviorDescription(CompositeBehaviorDescription &behaviorDescription, bool timingRelevanceFlag)
+{
+
+    mapBehaviorDescription(behaviorDescription);
+
+    float w1 = setsDistributionRelevance;
+    float w2 = sucessorRelevance;
+    float w3 = intervalRelevance;
+    float f1 = computeSetsDistributionFitness(behaviorDescription);
+    float f2 = computeSucessorFitness(behaviorDescription);
+    float f3 = timingRelevanceFlag ? computeIntervalFitness(behaviorDescription) : 1;
 
     float answer = ((w1 * f1) + (w2 * f2) + (w3 * f3)) / (w1 + w2 + w3);
 
@@ -120,8 +126,8 @@ float BehaviorDescriptionMatcher::computePertinenceDegree(BehaviorCategory &cate
 float BehaviorDescriptionMatcher::computePertinenceDegree(const CompositeBehaviorDescription &bd1, const CompositeBehaviorDescription &bd2, bool timingRelevanceFlag) const
 {
     //WARNING : this a temporary replacement of the real computePertinenceDegree until the bug is fixed
-    std::vector<PredicateHandleSet> tls1 = bd1.getTimelineSets();
-    std::vector<PredicateHandleSet> tls2 = bd2.getTimelineSets();
+    const std::vector<PredicateHandleSet>& tls1 = bd1.getTimelineSets();
+    const std::vector<PredicateHandleSet>& tls2 = bd2.getTimelineSets();
     unsigned s1 = tls1.size();
     unsigned s2 = tls2.size();
     float acc = 0; //the accumlated similarity score before being normalized to correspond to f
@@ -129,8 +135,8 @@ float BehaviorDescriptionMatcher::computePertinenceDegree(const CompositeBehavio
     unsigned pause_count = 0;
     OC_ASSERT(s1 > 0 || s2 > 0, "tls1 or tls2 should have at least one 'PredicateHandleSet'.");
     if (s1 > s2) {
-        std::vector<PredicateHandleSet>::iterator i1 = tls1.begin();
-        std::vector<PredicateHandleSet>::iterator i2 = tls2.begin();
+        std::vector<PredicateHandleSet>::const_iterator i1 = tls1.begin();
+        std::vector<PredicateHandleSet>::const_iterator i2 = tls2.begin();
         for (; i2 != tls2.end(); ++i1, ++i2) {
             if (i1->empty() && i2->empty())
                 pause_count++;
@@ -154,8 +160,8 @@ float BehaviorDescriptionMatcher::computePertinenceDegree(const CompositeBehavio
         f = (acc + pause_count * PAUSE_COEF)
             / (s1 + pause_count * (PAUSE_COEF - 1.0));
     } else {
-        std::vector<PredicateHandleSet>::iterator i2 = tls2.begin();
-        for (std::vector<PredicateHandleSet>::iterator i1 = tls1.begin(); i1 != tls1.end(); ++i1, ++i2) {
+        std::vector<PredicateHandleSet>::const_iterator i2 = tls2.begin();
+        for (std::vector<PredicateHandleSet>::const_iterator i1 = tls1.begin(); i1 != tls1.end(); ++i1, ++i2) {
             if (i1->empty() && i2->empty())
                 pause_count++;
             else acc += computeHandleSetSimilarity(*i1, *i2);
@@ -204,6 +210,10 @@ float BehaviorDescriptionMatcher::computeHandleSetSimilarity(const PredicateHand
         Handle h1 = *ps1.getSet().begin();
         Handle h2 = *ps2.getSet().begin();
 
+        // the candidate often does just what the exemplar did
+        if (h1 == h2)
+            return 1.0;
+
         OC_ASSERT(atomSpace->getType(h1) == EVALUATION_LINK && atomSpace->getArity(h1) == 2,
                          "Handle h1 should be an 'EVALUATION_LINK' and have arity 2.");
         OC_ASSERT(atomSpace->getType(h2) == EVALUATION_LINK && atomSpace->getArity(h2) == 2,
@@ -228,7 +238,7 @@ float BehaviorDescriptionMatcher::computeHandleSetSimilarity(const PredicateHand
         OC_ASSERT( atomSpace->isNode(hact1), "hact1 is not a 'Node'");
         OC_ASSERT( atomSpace->isNode(hact2), "hact2 is not a 'Node'");
 
-        if (atomSpace->getName(hact1) == atomSpace->getName(hact2)) {
+        if (hact1 == hact2 || atomSpace->getName(hact1) == atomSpace->getName(hact2)) {
             int a1 = atomSpace->getArity(hargs1);
             int a2 = atomSpace->getArity(hargs2);
             if (a1 == a2) {
@@ -236,6 +246,8 @@ float BehaviorDescriptionMatcher::computeHandleSetSimilarity(const PredicateHand
                     //compare action parameters
                     Handle arg_p_1 = atomSpace->getOutgoing(hargs1, i);
                     Handle arg_p_2 = atomSpace->getOutgoing(hargs2, i);
+                    if (arg_p_1 == arg_p_2)
+                        continue;
                     //we only compare if there type is not NUMBER_NODE
                     if (atomSpace->getType(arg_p_1) != NUMBER_NODE
                             && atomSpace->getType(arg_p_2) != NUMBER_NODE
@@ -256,20 +268,15 @@ float BehaviorDescriptionMatcher::computeHandleSetSimilarity(const PredicateHand
 std::string BehaviorDescriptionMatcher::toStringTestCase(BehaviorCategory &category, CompositeBehaviorDescription &behaviorDescription)
 {
 
-    buildMapping(category, behaviorDescription);
+    prepareCategory(category, true);
+    mapBehaviorDescription(behaviorDescription);
 
-    computeSetDistribution(category);
+    float w1 = setsDistributionRelevance;
+    float w2 = sucessorRelevance;
+    float w3 = intervalRelevance;
     float f1 = computeSetsDistributionFitness(behaviorDescription);
-    float w1 = computeSetsDistributionRelevance(category);
-
-    computeSucessorMatrix(category);
     float f2 = computeSucessorFitness(behaviorDescription);
-    float w2 = computeSucessorRelevance(category);
-    destroyMatrices(category);
-
-    computeTimeLengthBoundaries(category);
     float f3 = computeIntervalFitness(behaviorDescription);
-    float w3 = computeIntervalRelevance(category);
 
     float fitness = ((w1 * f1) + (w2 * f2) + (w3 * f3)) / (w1 + w2 + w3);
 
@@ -443,7 +450,7 @@ std::string BehaviorDescriptionMatcher::toStringMatrices(BehaviorCategory &categ
         for (unsigned int j = 0; j < allSets.size(); j++) {
             for (unsigned int k = 0; k < allSets.size(); k++) {
                 char tmp[128];
-                sprintf(tmp, "%d", categoryMatrices[i][j][k]);
+                sprintf(tmp, "%d", matrixAt(i)[j * matrixSize + k]);
                 answer.append(tmp);
                 if (k != (allSets.size() - 1)) {
                     answer.append(" ");
@@ -587,61 +594,23 @@ float BehaviorDescriptionMatcher::computeSucessorFitness(CompositeBehaviorDescri
 
     //printf("DMAX = %d\n", DMAX);
 
-    //printf("allSets.size() = %u\n", allSets.size());
-    int **bdMatrix = NULL;
-    //printf("index = %d\n", index);
-    if (index == -1) {
-        bdMatrix = new int *[allSets.size()];
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            bdMatrix[j] = new int[allSets.size()];
-        }
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            for (unsigned int k = 0; k < allSets.size(); k++) {
-                bdMatrix[j][k] = 0;
-            }
-        }
-        buildSucessorMatrix(bd, bdMatrix, false);
-    }
-
-    /*
+    const int *matrix;
     if (index == -1) {
-        std::string answer;
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            for (unsigned int k = 0; k < allSets.size(); k++) {
-                char tmp[128];
-                sprintf(tmp, "%d", bdMatrix[j][k]);
-                answer.append(tmp);
-                if (k != (allSets.size() - 1)) {
-                    answer.append(" ");
-                } else {
-                    answer.append("\n");
-                }
-            }
-        }
-        printf("bdMatrix =\n%s\n\n", answer.c_str());
+        bdMatrix.assign(matrixSize * matrixSize, 0);
+        buildSucessorMatrix(bd, bdMatrix.data(), false);
+        matrix = bdMatrix.data();
+    } else {
+        matrix = matrixAt(index);
     }
-    */
 
     float sumDifferences = 0;
-    for (unsigned int j = 0; j < allSets.size(); j++) {
-        for (unsigned int k = 0; k < allSets.size(); k++) {
-            if (index == -1) {
-                sumDifferences +=  fabs(bdMatrix[j][k] - averageMatrix[j][k]);
-            } else {
-                sumDifferences +=  fabs(categoryMatrices[index][j][k] - averageMatrix[j][k]);
-            }
-        }
+    const float *average = averageMatrix.data();
+    for (unsigned int j = 0; j < matrixSize * matrixSize; j++) {
+        sumDifferences += fabs(matrix[j] - average[j]);
     }
 
     //printf("sumDifferences = %f\n", sumDifferences);
 
-    if (index == -1) {
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            delete [] bdMatrix[j];
-        }
-        delete [] bdMatrix;
-    }
-
     float f;
     if (sumDifferences >= DMAX) {
         f = 0;
@@ -666,27 +635,31 @@ float BehaviorDescriptionMatcher::computeSucessorRelevance(BehaviorCategory &cat
     return answer;
 }
 
-void BehaviorDescriptionMatcher::buildSucessorMatrix(CompositeBehaviorDescription &bd, int **matrix, bool categoryFlag)
+int *BehaviorDescriptionMatcher::matrixAt(unsigned int index)
+{
+    return &categoryMatrices[index * matrixSize * matrixSize];
+}
+
+void BehaviorDescriptionMatcher::buildSucessorMatrix(CompositeBehaviorDescription &bd, int *matrix, bool categoryFlag)
 {
 
     //printf("Buinding sucessor matrix for %s\n", bd.toStringTimeline().c_str());
     std::vector<PredicateHandleSet> sets = bd.getTimelineSets();
 
-    for (unsigned int i = 1; i < sets.size(); i++) {
+    // look the matrix index of each set up once rather than for each pair
+    std::vector<unsigned int> indexes(sets.size());
+    for (unsigned int i = 0; i < sets.size(); i++) {
+        if (categoryFlag) {
+            indexes[i] = matrixIndex[sets[i]];
+        } else {
+            indexes[i] = matrixIndex[mapping[sets[i]]];
+        }
+    }
+
+    for (unsigned int i = 1; i < indexes.size(); i++) {
+        int *row = matrix + indexes[i] * matrixSize;
         for (unsigned int j =  0; j < i; j++) {
-            if (categoryFlag) {
-                //printf("matrixIndex[sets[i]] = %u\n", matrixIndex[sets[i]]);
-                //printf("matrixIndex[sets[j]] = %u\n", matrixIndex[sets[j]]);
-                matrix[matrixIndex[sets[i]]][matrixIndex[sets[j]]]++;
-            } else {
-                //printf("sets[i] = %s\n", sets[i].toString().c_str());
-                //printf("mapping[sets[i]] = %s\n", mapping[sets[i]].toString().c_str());
-                //printf("matrixIndex[mapping[sets[i]]] = %u\n", matrixIndex[mapping[sets[i]]]);
-                //printf("sets[j] = %s\n", sets[j].toString().c_str());
-                //printf("mapping[sets[j]] = %s\n", mapping[sets[j]].toString().c_str());
-                //printf("matrixIndex[mapping[sets[j]]] = %u\n", matrixIndex[mapping[sets[j]]]);
-                matrix[matrixIndex[mapping[sets[i]]]][matrixIndex[mapping[sets[j]]]]++;
-            }
+            row[indexes[j]]++;
         }
     }
     //printf("Done\n");
@@ -697,62 +670,38 @@ void BehaviorDescriptionMatcher::computeSucessorMatrix(BehaviorCategory &categor
 
     std::vector<CompositeBehaviorDescription> bds = category.getEntries();
 
-    if (! matricesBuilt) {
-        //printf("Allocating\n");
-        categoryMatrices = new int **[bds.size()];
-        for (unsigned int i = 0; i < bds.size(); i++) {
-            categoryMatrices[i] = new int *[allSets.size()];
-            for (unsigned int j = 0; j < allSets.size(); j++) {
-                categoryMatrices[i][j] = new int[allSets.size()];
-            }
-        }
-
-        averageMatrix = new float *[allSets.size()];
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            averageMatrix[j] = new float[allSets.size()];
-        }
+    // the matrices are only reallocated when they grow
+    matrixSize = allSets.size();
+    unsigned int n = matrixSize * matrixSize;
+    categoryMatrices.assign(bds.size() * n, 0);
+    averageMatrix.assign(n, 0);
 
-        {
-            std::set<PredicateHandleSet>::iterator it = allSets.begin();
-            unsigned int j = 0;
-            while (it != allSets.end()) {
-                matrixIndex[*it] = j;
-                ++j;
-                ++it;
-            }
-        }
-
-        matricesBuilt = true;
-    }
-
-    //printf("Zeroing\n");
-    for (unsigned int i = 0; i < bds.size(); i++) {
-        for (unsigned int j = 0; j < allSets.size(); j++) {
-            for (unsigned int k = 0; k < allSets.size(); k++) {
-                categoryMatrices[i][j][k] = 0;
-            }
+    matrixIndex.clear();
+    {
+        std::set<PredicateHandleSet>::iterator it = allSets.begin();
+        unsigned int j = 0;
+        while (it != allSets.end()) {
+            matrixIndex[*it] = j;
+            ++j;
+            ++it;
         }
     }
 
     //printf("Building matrices\n");
     for (unsigned int i = 0; i < bds.size(); i++) {
-        buildSucessorMatrix(bds[i], categoryMatrices[i], true);
+        buildSucessorMatrix(bds[i], matrixAt(i), true);
     }
 
     //printf("Averaging\n");
-    for (unsigned int j = 0; j < allSets.size(); j++) {
-        for (unsigned int k = 0; k < allSets.size(); k++) {
-            averageMatrix[j][k] = 0;
-            for (unsigned int i = 0; i < bds.size(); i++) {
-                averageMatrix[j][k] += categoryMatrices[i][j][k];
-            }
+    for (unsigned int i = 0; i < bds.size(); i++) {
+        const int *matrix = matrixAt(i);
+        for (unsigned int j = 0; j < n; j++) {
+            averageMatrix[j] += matrix[j];
         }
     }
 
-    for (unsigned int j = 0; j < allSets.size(); j++) {
-        for (unsigned int k = 0; k < allSets.size(); k++) {
-            averageMatrix[j][k] /= bds.size();
-        }
+    for (unsigned int j = 0; j < n; j++) {
+        averageMatrix[j] /= bds.size();
     }
     //printf("Done\n");
 }
@@ -841,6 +790,7 @@ void BehaviorDescriptionMatcher::buildUnionOfPredicateSets(BehaviorCategory &cat
     allSets.clear();
     allSetsCount.clear();
     sumAllSetsCount = 0;
+    clearPredicateIds();
 
     std::vector<CompositeBehaviorDescription> bds = category.getEntries();
     for (unsigned int i = 0; i < bds.size(); i++) {
@@ -855,14 +805,66 @@ void BehaviorDescriptionMatcher::buildUnionOfPredicateSets(BehaviorCategory &cat
             }
         }
     }
+
+    encodedAllSets.resize(allSets.size());
+    unsigned int i = 0;
+    for (std::set<PredicateHandleSet>::iterator it = allSets.begin(); it != allSets.end(); ++it, ++i) {
+        encode(*it, encodedAllSets[i]);
+    }
 }
 
 
-float BehaviorDescriptionMatcher::computeSetSimilarity(const PredicateHandleSet &set1, const PredicateHandleSet &set2) const
+void BehaviorDescriptionMatcher::clearPredicateIds()
 {
+    predicateIds.clear();
+    idPredicates.clear();
+    similarityCache.clear();
+}
 
-    if (set1.getSize() == 0) {
-        if (set2.getSize() == 0) {
+unsigned int BehaviorDescriptionMatcher::getPredicateId(Handle h)
+{
+    std::map<Handle, unsigned int>::const_iterator it = predicateIds.find(h);
+    if (it != predicateIds.end()) {
+        return it->second;
+    }
+    unsigned int id = idPredicates.size();
+    predicateIds[h] = id;
+    idPredicates.push_back(h);
+    return id;
+}
+
+float BehaviorDescriptionMatcher::getPredicateSimilarity(unsigned int id1, unsigned int id2)
+{
+    std::pair<unsigned int, unsigned int> key(id1, id2);
+    std::map<std::pair<unsigned int, unsigned int>, float>::const_iterator it = similarityCache.find(key);
+    if (it != similarityCache.end()) {
+        return it->second;
+    }
+    float similarity = EvaluationLinkSimilarityEvaluator::similarity(*atomSpace, idPredicates[id1], idPredicates[id2]);
+    similarityCache[key] = similarity;
+    return similarity;
+}
+
+void BehaviorDescriptionMatcher::encode(const PredicateHandleSet &set, EncodedSet &encoded)
+{
+    encoded.ids.clear();
+    for (std::set<Handle>::const_iterator it = set.getSet().begin(); it != set.getSet().end(); ++it) {
+        encoded.ids.push_back(getPredicateId(*it));
+    }
+    // ids are kept in the order of the handle set so that weighted sums
+    // are accumulated in the same order as before
+    unsigned int maxId = encoded.ids.empty() ? 0 : *std::max_element(encoded.ids.begin(), encoded.ids.end());
+    encoded.bits.assign(encoded.ids.empty() ? 0 : maxId / 64 + 1, 0);
+    for (unsigned int i = 0; i < encoded.ids.size(); i++) {
+        encoded.bits[encoded.ids[i] / 64] |= ((uint64_t) 1) << (encoded.ids[i] % 64);
+    }
+}
+
+float BehaviorDescriptionMatcher::computeSetSimilarity(const EncodedSet &set1, const EncodedSet &set2)
+{
+
+    if (set1.ids.size() == 0) {
+        if (set2.ids.size() == 0) {
             printf("both sets are 0 size\n");
             return 1.0;
         } else {
@@ -870,7 +872,7 @@ float BehaviorDescriptionMatcher::computeSetSimilarity(const PredicateHandleSet
             return 0.0;
         }
     } else {
-        if (set2.getSize() == 0) {
+        if (set2.ids.size() == 0) {
             printf("only set2 is 0 size\n");
             return 0.0;
         }
@@ -891,27 +893,30 @@ float BehaviorDescriptionMatcher::computeSetSimilarity(const PredicateHandleSet
 
 }
 
-float BehaviorDescriptionMatcher::intersectionOverUnion(const PredicateHandleSet &set1, const PredicateHandleSet &set2) const
+float BehaviorDescriptionMatcher::intersectionOverUnion(const EncodedSet &set1, const EncodedSet &set2) const
 {
 
+    // popcount over the common words of the bitsets, the loop is simple
+    // enough to be vectorized by the compiler
+    unsigned int words = std::min(set1.bits.size(), set2.bits.size());
+    const uint64_t *b1 = set1.bits.data();
+    const uint64_t *b2 = set2.bits.data();
     int intersectionSize = 0;
-    for (std::set<Handle>::iterator it = set1.getSet().begin(); it != set1.getSet().end(); ++it) {
-        if (set2.getSet().find(*it) != set2.getSet().end()) {
-            intersectionSize++;
-        }
+    for (unsigned int i = 0; i < words; i++) {
+        intersectionSize += __builtin_popcountll(b1[i] & b2[i]);
     }
 
-    return ((float) intersectionSize / (float) (set1.getSize() + set2.getSize() - intersectionSize));
+    return ((float) intersectionSize / (float) (set1.ids.size() + set2.ids.size() - intersectionSize));
 }
 
-float BehaviorDescriptionMatcher::weightedIntersectionOverUnion(const PredicateHandleSet &set1, const PredicateHandleSet &set2) const
+float BehaviorDescriptionMatcher::weightedIntersectionOverUnion(const EncodedSet &set1, const EncodedSet &set2)
 {
 
     float intersectionSize = 0;
-    for (std::set<Handle>::iterator it1 = set1.getSet().begin(); it1 != set1.getSet().end(); ++it1) {
+    for (unsigned int i = 0; i < set1.ids.size(); i++) {
         float bestSimilarity = 0;
-        for (std::set<Handle>::iterator it2 = set2.getSet().begin(); it2 != set2.getSet().end(); ++it2) {
-            float similarity = EvaluationLinkSimilarityEvaluator::similarity(*atomSpace, *it1, *it2);
+        for (unsigned int j = 0; j < set2.ids.size(); j++) {
+            float similarity = getPredicateSimilarity(set1.ids[i], set2.ids[j]);
             if (similarity > bestSimilarity) {
                 bestSimilarity = similarity;
             }
@@ -919,13 +924,18 @@ float BehaviorDescriptionMatcher::weightedIntersectionOverUnion(const PredicateH
         intersectionSize += bestSimilarity;
     }
 
-    return (intersectionSize / (float) (set1.getSize() + set2.getSize() - intersectionSize));
+    return (intersectionSize / (float) (set1.ids.size() + set2.ids.size() - intersectionSize));
 }
 
 void BehaviorDescriptionMatcher::buildMapping(BehaviorCategory &category, CompositeBehaviorDescription &behaviorDescription)
 {
 
     buildUnionOfPredicateSets(category);
+    mapBehaviorDescription(behaviorDescription);
+}
+
+void BehaviorDescriptionMatcher::mapBehaviorDescription(CompositeBehaviorDescription &behaviorDescription)
+{
 
     std::vector<PredicateHandleSet> bdSets = behaviorDescription.getTimelineSets();
 
@@ -936,21 +946,25 @@ void BehaviorDescriptionMatcher::buildMapping(BehaviorCategory &category, Compos
     mapping.clear();
     mappingSimilarity.clear();
 
+    EncodedSet encoded;
     for (unsigned int i = 0; i < bdSets.size(); i++) {
         //printf("mapping %s\n", bdSets[i].toString(*atomSpace).c_str());
+        // a set repeated in the timeline maps the same way
+        if (mapping.find(bdSets[i]) != mapping.end()) {
+            continue;
+        }
+        encode(bdSets[i], encoded);
         float betterSimilarity = -1;
-        for (std::set<PredicateHandleSet>::iterator it = allSets.begin(); it != allSets.end(); ++it) {
+        std::set<PredicateHandleSet>::iterator it = allSets.begin();
+        for (unsigned int j = 0; it != allSets.end(); ++it, ++j) {
             //printf("comparing against %s\n", (*it).toString(*atomSpace).c_str());
-            float similarity = computeSetSimilarity(bdSets[i], *it);
+            float similarity = computeSetSimilarity(encoded, encodedAllSets[j]);
             //printf("similarity = %f\n", similarity);
             if (similarity > betterSimilarity) {
                 betterSimilarity = similarity;
-                //printf("updating\n");
                 mapping[bdSets[i]] = *it;
                 mappingSimilarity[bdSets[i]] = similarity;
-                //printf("done\n");
                 if (similarity == 1.0) {
-                    //printf("breaking\n");
                     break;
                 }
             }
@@ -984,5 +998,6 @@ void BehaviorDescriptionMatcher::computeSetDistribution(BehaviorCategory &catego
 void BehaviorDescriptionMatcher::setAtomSpace(AtomSpace *atomSpace)
 {
     this->atomSpace = atomSpace;
+    clearPredicateIds();
 }
 
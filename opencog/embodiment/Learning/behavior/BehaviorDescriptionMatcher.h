@@ -28,6 +28,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <stdint.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include "CompositeBehaviorDescription.h"
 #include "BehaviorCategory.h"
@@ -41,31 +42,71 @@ class BehaviorDescriptionMatcher
 
 private:
 
+    /**
+     * A PredicateHandleSet encoded with the dense predicate ids given by
+     * predicateIds, both as an id array in the order of the handle set
+     * (to iterate over) and as a bitset (to compute intersections with
+     * popcounts).
+     */
+    struct EncodedSet {
+        std::vector<unsigned int> ids;
+        std::vector<uint64_t> bits;
+    };
+
     int sumAllSetsCount;
     std::set<PredicateHandleSet> allSets;
+    std::vector<EncodedSet> encodedAllSets; // same order as allSets
     std::map<PredicateHandleSet, int> allSetsCount;
     std::map<PredicateHandleSet, PredicateHandleSet> mapping;
     std::map<PredicateHandleSet, float> mappingSimilarity;
     std::map<PredicateHandleSet, std::vector<int> > setDistribution;
     std::map<PredicateHandleSet, long> upperBound;
     std::map<PredicateHandleSet, long> lowerBound;
-    bool matricesBuilt;
-    int*** categoryMatrices;
     std::map<PredicateHandleSet, unsigned int> matrixIndex;
-    float** averageMatrix;
+
+    // Successor matrices, stored contiguously and reused across calls.
+    // categoryMatrices holds one allSets.size()^2 matrix per entry of
+    // the category, see matrixAt.
+    unsigned int matrixSize;
+    std::vector<int> categoryMatrices;
+    std::vector<float> averageMatrix;
+    std::vector<int> bdMatrix;
+
+    // Dense ids of the predicates of the category and of the behavior
+    // descriptions being matched against it, and the
+    // EvaluationLinkSimilarityEvaluator::similarity of the pairs of them
+    // compared so far. The similarities come from SimilarityLinks that
+    // may change between two calls, so all of it only lasts for one
+    // call of computePertinenceDegree(s).
+    std::map<Handle, unsigned int> predicateIds;
+    std::vector<Handle> idPredicates;
+    std::map<std::pair<unsigned int, unsigned int>, float> similarityCache;
+
+    // relevances of the category prepared by prepareCategory
+    float setsDistributionRelevance;
+    float sucessorRelevance;
+    float intervalRelevance;
+
     AtomSpace *atomSpace; // used to retrieve similarity links (in buildMapping()
 
     void computeSetDistribution(BehaviorCategory &category);
     void buildMapping(BehaviorCategory &category, CompositeBehaviorDescription &behaviorDescription);
+    void mapBehaviorDescription(CompositeBehaviorDescription &behaviorDescription);
     void buildUnionOfPredicateSets(BehaviorCategory &category);
-    float computeSetSimilarity(const PredicateHandleSet &set1, const PredicateHandleSet &set2) const;
-    float intersectionOverUnion(const PredicateHandleSet &set1, const PredicateHandleSet &set2) const;
-    float weightedIntersectionOverUnion(const PredicateHandleSet &set1, const PredicateHandleSet &set2) const;
+    void prepareCategory(BehaviorCategory &category, bool timingRelevanceFlag);
+    float scoreBehaviorDescription(CompositeBehaviorDescription &behaviorDescription, bool timingRelevanceFlag);
+    void clearPredicateIds();
+    unsigned int getPredicateId(Handle h);
+    float getPredicateSimilarity(unsigned int id1, unsigned int id2);
+    void encode(const PredicateHandleSet &set, EncodedSet &encoded);
+    float computeSetSimilarity(const EncodedSet &set1, const EncodedSet &set2);
+    float intersectionOverUnion(const EncodedSet &set1, const EncodedSet &set2) const;
+    float weightedIntersectionOverUnion(const EncodedSet &set1, const EncodedSet &set2);
     float computeSetsDistributionFitness(CompositeBehaviorDescription &behaviorDescription, bool relevanceFlag = false);
     float computeSetsDistributionRelevance(BehaviorCategory &category);
     void computeSucessorMatrix(BehaviorCategory &category);
-    void buildSucessorMatrix(CompositeBehaviorDescription &bd, int **matrix, bool categoryFlag = false);
-    void destroyMatrices(BehaviorCategory &category);
+    void buildSucessorMatrix(CompositeBehaviorDescription &bd, int *matrix, bool categoryFlag = false);
+    int *matrixAt(unsigned int index);
     float computeSucessorFitness(CompositeBehaviorDescription &bd, int index = -1);
     float computeSucessorRelevance(BehaviorCategory &category);
     void computeTimeLengthBoundaries(BehaviorCategory &category);
@@ -101,6 +142,17 @@ public:
      */
     float computePertinenceDegree(BehaviorCategory &category, CompositeBehaviorDescription &behaviorDescription, bool timingRelevanceFlag = true);
 
+    /**
+     * Same as above for a batch of behavior descriptions, degrees[i]
+     * being the pertinence degree of behaviorDescriptions[i]. Everything
+     * that only depends on the category (union of the sets, successor
+     * matrices, relevances) is computed once for the whole batch.
+     */
+    void computePertinenceDegrees(BehaviorCategory &category,
+                                  std::vector<CompositeBehaviorDescription> &behaviorDescriptions,
+                                  std::vector<float> &degrees,
+                                  bool timingRelevanceFlag = true);
+
     /**
     * like above but the category is replaced by a single
     * CompositeBehaviorDescription
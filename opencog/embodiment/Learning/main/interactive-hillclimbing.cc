@@ -50,6 +50,10 @@ struct InteractiveFitnessEstimator : unary_function<combo_tree, fitness_t> {
         cin >> score;
         return score;
     }
+    //the user gives the exact score whatever the cutoff
+    result_type operator()(argument_type tr, result_type cutoff) const {
+        return (*this)(tr);
+    }
 };
 
 int main(int argc, char** argv)
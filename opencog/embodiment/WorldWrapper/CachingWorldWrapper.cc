@@ -0,0 +1,116 @@
+/*
+ * opencog/embodiment/WorldWrapper/CachingWorldWrapper.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "CachingWorldWrapper.h"
+#include <opencog/embodiment/AvatarComboVocabulary/AvatarComboVocabulary.h>
+
+#include "WorldWrapperUtil.h"
+
+namespace opencog { namespace world {
+
+using namespace combo;
+
+CachingWorldWrapper::CachingWorldWrapper(WorldWrapperBase* ww)
+    : _ww(ww), _hits(0), _misses(0) {}
+
+CachingWorldWrapper::~CachingWorldWrapper()
+{
+    delete _ww;
+}
+
+bool CachingWorldWrapper::isPlanFinished() const
+{
+    return _ww->isPlanFinished();
+}
+
+bool CachingWorldWrapper::isPlanFailed() const
+{
+    return _ww->isPlanFailed();
+}
+
+bool CachingWorldWrapper::sendSequential_and(sib_it from, sib_it to)
+{
+    return _ww->sendSequential_and(from, to);
+}
+
+combo::vertex CachingWorldWrapper::evalPerception(pre_it per,
+                                                  combo::variable_unifier& vu)
+{
+    combo_tree key(per);
+    if (&vu != &combo::variable_unifier::DEFAULT_VU()
+        || WorldWrapperUtil::has_random(key)) {
+        ++_misses;
+        return _ww->evalPerception(per, vu);
+    }
+
+    perception_cache::const_iterator it = _perceptions.find(key);
+    if (it != _perceptions.end()) {
+        ++_hits;
+        return it->second;
+    }
+    ++_misses;
+    combo::vertex v = _ww->evalPerception(per, vu);
+    _perceptions.insert(std::make_pair(key, v));
+    return v;
+}
+
+combo::vertex CachingWorldWrapper::evalIndefiniteObject(combo::indefinite_object io,
+                                                        combo::variable_unifier& vu)
+{
+    if (&vu != &combo::variable_unifier::DEFAULT_VU() || AvatarCombo::is_random(io)) {
+        ++_misses;
+        return _ww->evalIndefiniteObject(io, vu);
+    }
+
+    indefinite_object_cache::const_iterator it = _indefiniteObjects.find(io);
+    if (it != _indefiniteObjects.end()) {
+        ++_hits;
+        return it->second;
+    }
+    ++_misses;
+    combo::vertex v = _ww->evalIndefiniteObject(io, vu);
+    _indefiniteObjects.insert(std::make_pair(io, v));
+    return v;
+}
+
+void CachingWorldWrapper::clear()
+{
+    _perceptions.clear();
+    _indefiniteObjects.clear();
+}
+
+WorldWrapperBase& CachingWorldWrapper::getWorldWrapper()
+{
+    return *_ww;
+}
+
+unsigned int CachingWorldWrapper::getHits() const
+{
+    return _hits;
+}
+
+unsigned int CachingWorldWrapper::getMisses() const
+{
+    return _misses;
+}
+
+} } // namespace opencog::world
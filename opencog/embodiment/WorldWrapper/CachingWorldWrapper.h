@@ -0,0 +1,101 @@
+/*
+ * opencog/embodiment/WorldWrapper/CachingWorldWrapper.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CACHINGWORLDWRAPPER_H
+#define _CACHINGWORLDWRAPPER_H
+
+#include <map>
+#include <boost/unordered_map.hpp>
+
+#include <moses/comboreduct/combo/vertex.h>
+
+#include "WorldWrapper.h"
+
+namespace opencog { namespace world {
+
+/**
+ * World wrapper memoizing the perceptions and the indefinite objects
+ * evaluated by another world wrapper, unless they involve a random
+ * indefinite object (random_X).
+ *
+ * The world does not change while the procedures of an interpreter
+ * cycle are being run, so the same perception asked by several
+ * procedures (or several times by the same looping procedure) only
+ * needs to be evaluated once per cycle (WorldWrapperUtil makes the
+ * same assumption, caching predicates per simulation timestamp). The
+ * owner is expected to call clear() at the beginning of each cycle.
+ *
+ * Evaluations going through a non default variable_unifier are never
+ * cached since their result depends on the state of the unifier.
+ */
+class CachingWorldWrapper : public WorldWrapperBase
+{
+
+public:
+
+    /**
+     * ww is the wrapped world wrapper, it is deleted with this one
+     */
+    explicit CachingWorldWrapper(WorldWrapperBase* ww);
+    ~CachingWorldWrapper();
+
+    bool isPlanFinished() const;
+
+    bool isPlanFailed() const;
+
+    bool sendSequential_and(sib_it from, sib_it to);
+
+    combo::vertex evalPerception(pre_it per,
+                                 combo::variable_unifier& vu = combo::variable_unifier::DEFAULT_VU());
+
+    combo::vertex evalIndefiniteObject(combo::indefinite_object io,
+                                       combo::variable_unifier& vu = combo::variable_unifier::DEFAULT_VU());
+
+    /**
+     * forget all the memoized evaluations
+     */
+    void clear();
+
+    WorldWrapperBase& getWorldWrapper();
+
+    // number of evaluations answered from the cache
+    unsigned int getHits() const;
+    // number of evaluations forwarded to the wrapped world wrapper
+    unsigned int getMisses() const;
+
+private:
+    typedef boost::unordered_map<combo::combo_tree, combo::vertex,
+                                 boost::hash<combo::combo_tree> > perception_cache;
+    typedef std::map<combo::indefinite_object, combo::vertex> indefinite_object_cache;
+
+    WorldWrapperBase* _ww;
+
+    perception_cache _perceptions;
+    indefinite_object_cache _indefiniteObjects;
+
+    unsigned int _hits;
+    unsigned int _misses;
+};
+
+} } // namespace opencog::world
+
+#endif
@@ -46,6 +46,13 @@ NoSpaceLifeWorldWrapper::NoSpaceLifeWorldWrapper(AtomSpace& atomSpace,
         _atomSpace(atomSpace), _petName(petName), _ownerName(ownerName),
         _avatarName(avatarName) {}
 
+NoSpaceLifeWorldWrapper::NoSpaceLifeWorldWrapper(ExemplarReplay& replay,
+        const string& petName)
+        : _isFailed(false), _isFinished(true),
+        _noSpaceLife(replay, petName),
+        _atomSpace(replay.getAtomSpace()), _petName(petName),
+        _ownerName(replay.getOwnerId()), _avatarName(replay.getAvatarId()) {}
+
 NoSpaceLifeWorldWrapper::~NoSpaceLifeWorldWrapper() {}
 
 /**
@@ -84,17 +91,12 @@ bool NoSpaceLifeWorldWrapper::sendSequential_and(sib_it from, sib_it to)
                 //check that it's not a random indefinite object and evaluate it
                 if (!is_random(io)) {
                     OC_ASSERT(arg.is_childless());
-                    Handle h = _noSpaceLife.getCurrentMapHandle();
-                    OC_ASSERT(h != Handle::UNDEFINED,
+                    OC_ASSERT(_noSpaceLife.getCurrentMapHandle() != Handle::UNDEFINED,
                                      "A SpaceMap must exists");
-                    //eval indefinite object, put _avatarName as selfName to get
-                    //avatar_to_imitate's view point
-                    *arg = WorldWrapperUtil::evalIndefiniteObject(h,
-                            simulated_time,
-                            _atomSpace,
-                            _avatarName,
-                            _ownerName,
-                            io);
+                    //eval indefinite object from avatar_to_imitate's
+                    //view point
+                    *arg = _noSpaceLife.getExemplarReplay().evalIndefiniteObject(io,
+                            simulated_time, false);
                 }
             }
         }
@@ -104,28 +106,24 @@ bool NoSpaceLifeWorldWrapper::sendSequential_and(sib_it from, sib_it to)
 
 combo::vertex NoSpaceLifeWorldWrapper::evalPerception(pre_it it, combo::variable_unifier& vu)
 {
-    Handle h = _noSpaceLife.getCurrentMapHandle();
     unsigned int simulated_time = _noSpaceLife.getCurrentTime();
-    OC_ASSERT(h != Handle::UNDEFINED, "A SpaceMap must exists");
-    //eval perception, put _avatarName as selfName to get
-    //avatar_to_imitate's view point
-    return WorldWrapperUtil::evalPerception(h, simulated_time,
-                                            _atomSpace, _avatarName,
-                                            _ownerName, it, LOOK_IN_THE_PAST);
+    OC_ASSERT(_noSpaceLife.getCurrentMapHandle() != Handle::UNDEFINED,
+              "A SpaceMap must exists");
+    //eval perception from avatar_to_imitate's view point, perceptions
+    //already evaluated at that time by another candidate are not
+    //evaluated again
+    return _noSpaceLife.getExemplarReplay().evalPerception(it, simulated_time,
+            LOOK_IN_THE_PAST);
 }
 
 combo::vertex NoSpaceLifeWorldWrapper::evalIndefiniteObject(combo::indefinite_object io, combo::variable_unifier& vu)
 {
-    Handle h = _noSpaceLife.getCurrentMapHandle();
     unsigned int simulated_time = _noSpaceLife.getCurrentTime();
-    OC_ASSERT(h != Handle::UNDEFINED, "A SpaceMap must exists");
-    //eval indefinite object, put _avatarName as selfName to get
-    //avatar_to_imitate's view point
-    return WorldWrapperUtil::evalIndefiniteObject(h,
-            simulated_time,
-            _atomSpace,
-            _avatarName, _ownerName, io,
-            LOOK_IN_THE_PAST);
+    OC_ASSERT(_noSpaceLife.getCurrentMapHandle() != Handle::UNDEFINED,
+              "A SpaceMap must exists");
+    //eval indefinite object from avatar_to_imitate's view point
+    return _noSpaceLife.getExemplarReplay().evalIndefiniteObject(io,
+            simulated_time, LOOK_IN_THE_PAST);
 }
 
 NoSpaceLife& NoSpaceLifeWorldWrapper::getNoSpaceLife()
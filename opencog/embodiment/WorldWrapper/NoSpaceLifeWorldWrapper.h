@@ -54,6 +54,12 @@ public:
                             const string& avatarName,
                             const CompositeBehaviorDescription& cbd,
                             const Temporal& exemplarTemporal);
+
+    /**
+     * the exemplar to imitate is the one of replay, perceptions are
+     * evaluated from its snapshot of the world
+     */
+    NoSpaceLifeWorldWrapper(ExemplarReplay& replay, const string& petName);
     ~NoSpaceLifeWorldWrapper();
 
     /**
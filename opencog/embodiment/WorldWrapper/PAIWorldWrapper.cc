@@ -559,7 +559,13 @@ void PAIWorldWrapper::getWaypoints( const spatial::Point& startPoint,
 
             SpaceServer::SpaceMap *map = const_cast<SpaceServer::SpaceMap*>(&sm);
             unsigned int maximumClusters = config().get_int("HPA_MAXIMUM_CLUSTERS");
-            spatial::HPASearch search( map, 1, maximumClusters );
+            // the search of the previous plans is kept while the map is the
+            // same one, the objects added, removed or updated since then
+            // only invalidate the clusters they touch
+            if ( !hpaSearch || hpaSearch->map != map ) {
+                hpaSearch.reset( new spatial::HPASearch( map, 1, maximumClusters ) );
+            }
+            spatial::HPASearch& search = *hpaSearch;
 
             _hasPlanFailed = !search.processPath( spatial::math::Vector2( begin.first, begin.second ), spatial::math::Vector2( end.first, end.second ) );
             std::vector<spatial::math::Vector2> pathPoints = search.getProcessedPath( 1 );
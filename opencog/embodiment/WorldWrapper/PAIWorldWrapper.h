@@ -122,6 +122,10 @@ private:
      */
     //void getWaypoints( const spatial::Point& startPoint, const spatial::Point& endPoint, std::vector<spatial::Point>& actions );
 
+    // HPA* search of the map getWaypoints plans on, kept from one plan to
+    // the next
+    //boost::scoped_ptr<spatial::HPASearch> hpaSearch;
+
 //    /**
 //     * Given a start and an end point, return the 3D waypoints necessary to
 //     * travel between them.
@@ -58,7 +58,7 @@ namespace opencog { namespace world {
 typedef combo_tree::iterator pre_it;
 typedef combo_tree::sibling_iterator sib_it;
 
-WorldWrapperUtilCache WorldWrapperUtil::cache;
+thread_local WorldWrapperUtilCache WorldWrapperUtil::cache;
 
 const float WorldWrapperUtil::meanTruthThreshold = 0.5;
 
@@ -141,7 +141,7 @@ std::string WorldWrapperUtil::lookupInheritanceLink(
         return id::null_obj;
 
     // return the first element of the outgoing set of the inheritance link
-    return as.getName(as.getOutgoing(res[randGen().randint(res.size())],0));
+    return as.getName(as.getOutgoing(res[AtomSpaceUtil::getThreadRandGen().randint(res.size())],0));
 }
 
 std::string WorldWrapperUtil::lookupExecLink(
@@ -158,7 +158,7 @@ std::string WorldWrapperUtil::lookupExecLink(
                     NULL, 3, true);
     if (res.empty())
         return id::null_obj;
-    return (as.getName(res[randGen().randint(res.size())]));
+    return (as.getName(res[AtomSpaceUtil::getThreadRandGen().randint(res.size())]));
 }
 
 pre_it WorldWrapperUtil::maketree(string str, std::string h)
@@ -178,7 +178,8 @@ pre_it WorldWrapperUtil::maketree_percept(perception p, std::string h)
 
 pre_it WorldWrapperUtil::maketree_vertex(const vertex& v, std::string h)
 {
-    static combo_tree tmp;
+    //one per thread, fitness estimations may run concurrently
+    static thread_local combo_tree tmp;
     tmp = combo_tree(v);
     tmp.append_child(tmp.begin(), h);
     return tmp.begin();
@@ -2740,6 +2741,14 @@ perception WorldWrapperUtil::nearest_random_X_to_is_X(avatar_indefinite_object_e
     }
 }
 
+bool WorldWrapperUtil::has_random(const combo_tree& tr)
+{
+    for (combo_tree::iterator it = tr.begin(); it != tr.end(); ++it)
+        if (is_indefinite_object(*it) && is_random(get_indefinite_object(*it)))
+            return true;
+    return false;
+}
+
 bool WorldWrapperUtil::is_builtin_compound_action(const vertex& v)
 {
     if (const builtin_action* ba = boost::get<builtin_action>(&v)) {
@@ -2874,7 +2883,7 @@ float WorldWrapperUtil::getDemandGoalTruthValue(AtomSpace & atomSpace,
             Handle hDemandGoal =
                 AtomSpaceUtil::getDemandGoalEvaluationLink(atomSpace, demand);
             if ( hDemandGoal == opencog::Handle::UNDEFINED ) 
-                value = randGen().randfloat();
+                value = AtomSpaceUtil::getThreadRandGen().randfloat();
             else
                 value = atomSpace.getMean(hDemandGoal); 
             return value; },
@@ -54,8 +54,9 @@ class WorldWrapperUtil
 
 private:
 
-    // cache predicates information between timestamps.
-    static WorldWrapperUtilCache cache;
+    // cache predicates information between timestamps, one per thread
+    // as it is cleared whenever the timestamp changes.
+    static thread_local WorldWrapperUtilCache cache;
 
     /**
      * @return a list of definite objects for the given vertex. In general,
@@ -369,6 +370,10 @@ public:
     //like above but uses indefinite_object instead
     static combo::perception nearest_random_X_to_is_X(combo::indefinite_object io);
 
+    //true iff a random indefinite object (random_X) appears in tr, in
+    //which case its evaluation cannot be memoized
+    static bool has_random(const combo::combo_tree& tr);
+
     static bool is_builtin_compound_action(const combo::vertex& v);
     static bool is_builtin_atomic_action(const combo::vertex& v);
 };
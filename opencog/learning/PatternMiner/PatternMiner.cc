@@ -41,6 +41,7 @@
 #include <opencog/query/BindLink.h>
 #include <opencog/util/Config.h>
 #include <opencog/util/StringManipulator.h>
+#include <opencog/learning/statistics/NGramStatistics.h>
 
 #include "PatternMiner.h"
 
@@ -1216,87 +1217,57 @@ void PatternMiner::calculateInteractionInformation(HTreeNode* HNode)
 
 //    std::cout << "II = ";
 
-    // Start from the last gram:
+    // The subsets of the links of the pattern are enumerated by NGramStatistics, the same as for n-grams of ids.
     int maxgram = HNode->pattern.size();
-    int sign;
-    if (maxgram%2)
-        sign = 1;
-    else
-        sign = -1;
-
-    double II = sign * log2(HNode->count);
-//    std::cout << "H(curpattern) = log" << HNode->count << "="  << II << " sign=" << sign << std::endl;
+    uint32_t wholePattern = (1u << maxgram) - 1;
 
-
-    for (int gram = maxgram-1; gram > 0; gram --)
+    double II = statistics::NGramStatistics::interactionInformationOfSubsets(maxgram, [&](uint32_t subset) -> double
     {
-         sign *= -1;
-//         std::cout << "start subpatterns of gram = " << gram << std::endl;
-
-         bool* indexes = new bool[maxgram];
-
-         // generate the first combination
-         for (int i = 0; i < gram; ++ i)
-             indexes[i] = true;
-
-         for (int i = gram; i < maxgram; ++ i)
-             indexes[i] = false;
-
-         while(true)
-         {
-             HandleSeq subPattern;
-             for (int index = 0; index < maxgram; index ++)
-             {
-                 if (indexes[index])
-                     subPattern.push_back(HNode->pattern[index]);
-             }
-
-             unsigned int unifiedLastLinkIndex;
-             HandleSeq unifiedSubPattern = UnifyPatternOrder(subPattern, unifiedLastLinkIndex);
-             string subPatternKey = unifiedPatternToKeyString(unifiedSubPattern);
-
-//             std::cout<< "Subpattern: " << subPatternKey;
-
-             // First check if this subpattern is disconnected. If it is disconnected, it won't exist in the H-Tree anyway.
-             HandleSeqSeq splittedSubPattern;
-             if (splitDisconnectedLinksIntoConnectedGroups(unifiedSubPattern, splittedSubPattern))
-             {
-//                 std::cout<< " is disconnected! splitted it into connected parts: \n" ;
-                 // The splitted parts are disconnected, so they are independent. So the entroy = the sum of each part.
-                 // e.g. if ABC is disconneted, and it's splitted into connected subgroups by splitDisconnectedLinksIntoConnectedGroups,
-                 // for example: AC, B  then H(ABC) = H(AC) + H(B)
-                 for (HandleSeq aConnectedSubPart : splittedSubPattern)
-                 {
-                     // Unify it again
-                     unsigned int _unifiedLastLinkIndex;
-                     HandleSeq unifiedConnectedSubPattern = UnifyPatternOrder(aConnectedSubPart, _unifiedLastLinkIndex);
-                     string connectedSubPatternKey = unifiedPatternToKeyString(unifiedConnectedSubPattern);
-//                     cout << "a splitted part: " << connectedSubPatternKey;
-                     double h = calculateEntropyOfASubConnectedPattern(connectedSubPatternKey, unifiedConnectedSubPattern);
-                     II += sign*h;
-//                     cout << "sign="<<sign << " h =" << h << std::endl << std::endl;
-
-                 }
-
-             }
-             else
-             {
-//                 std::cout<< " is connected! \n" ;
-                 double h =calculateEntropyOfASubConnectedPattern(subPatternKey, unifiedSubPattern);
-                 II += sign*h;
-//                 cout << "sign="<<sign << " h =" << h << std::endl << std::endl;
-             }
-
+        if (subset == wholePattern)
+        {
+//            std::cout << "H(curpattern) = log" << HNode->count << std::endl;
+            return log2(HNode->count);
+        }
 
-             if (isLastNElementsAllTrue(indexes, maxgram, gram))
-                 break;
+        HandleSeq subPattern;
+        for (int index = 0; index < maxgram; index ++)
+        {
+            if (subset & (1u << index))
+                subPattern.push_back(HNode->pattern[index]);
+        }
 
-             // generate the next combination
-             generateNextCombinationGroup(indexes, maxgram);
-         }
+        unsigned int unifiedLastLinkIndex;
+        HandleSeq unifiedSubPattern = UnifyPatternOrder(subPattern, unifiedLastLinkIndex);
+        string subPatternKey = unifiedPatternToKeyString(unifiedSubPattern);
 
+//        std::cout<< "Subpattern: " << subPatternKey;
 
-    }
+        // First check if this subpattern is disconnected. If it is disconnected, it won't exist in the H-Tree anyway.
+        HandleSeqSeq splittedSubPattern;
+        if (splitDisconnectedLinksIntoConnectedGroups(unifiedSubPattern, splittedSubPattern))
+        {
+//            std::cout<< " is disconnected! splitted it into connected parts: \n" ;
+            // The splitted parts are disconnected, so they are independent. So the entroy = the sum of each part.
+            // e.g. if ABC is disconneted, and it's splitted into connected subgroups by splitDisconnectedLinksIntoConnectedGroups,
+            // for example: AC, B  then H(ABC) = H(AC) + H(B)
+            double h = 0.0;
+            for (HandleSeq aConnectedSubPart : splittedSubPattern)
+            {
+                // Unify it again
+                unsigned int _unifiedLastLinkIndex;
+                HandleSeq unifiedConnectedSubPattern = UnifyPatternOrder(aConnectedSubPart, _unifiedLastLinkIndex);
+                string connectedSubPatternKey = unifiedPatternToKeyString(unifiedConnectedSubPattern);
+//                cout << "a splitted part: " << connectedSubPatternKey;
+                h += calculateEntropyOfASubConnectedPattern(connectedSubPatternKey, unifiedConnectedSubPattern);
+            }
+            return h;
+        }
+        else
+        {
+//            std::cout<< " is connected! \n" ;
+            return calculateEntropyOfASubConnectedPattern(subPatternKey, unifiedSubPattern);
+        }
+    });
 
     HNode->interactionInformation = II;
 //    std::cout<< "\n total II = " << II << "\n" ;
@@ -2612,5 +2583,8 @@ bool PatternMiner::containIgnoredContent(Handle link )
     return false;
 }
 
-
-
+void opencog_pattern_miner_run(AtomSpace* atomSpace, unsigned int max_gram, unsigned int thresholdFrequency)
+{
+    PatternMiner miner(atomSpace, max_gram);
+    miner.runPatternMiner(thresholdFrequency);
+}
@@ -317,4 +317,10 @@ namespace PatternMining
 }
 }
 
+// Run the PatternMiner once over an AtomSpace. This is for the code that
+// loads this library at run time instead of linking it, like the
+// pattern-miner scenario of the BenchmarkModule.
+extern "C" void opencog_pattern_miner_run(opencog::AtomSpace* atomSpace, unsigned int max_gram,
+                                          unsigned int thresholdFrequency);
+
 #endif //_OPENCOG_PATTERNMINER_PATTERNMINER_H
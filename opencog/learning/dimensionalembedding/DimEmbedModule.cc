@@ -26,6 +26,8 @@
 #include <limits>
 #include <numeric>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
 #include <opencog/atomspaceutils/AtomSpaceUtils.h>
@@ -96,9 +98,9 @@ void DimEmbedModule::init()
 #endif
 }
 
-const std::vector<double>& DimEmbedModule::getEmbedVector(Handle h,
-                                                          Type l,
-                                                          bool fanin) const
+std::vector<double> DimEmbedModule::getEmbedVector(Handle h,
+                                                  Type l,
+                                                  bool fanin) const
 {
     if (!classserver().isLink(l))
         throw InvalidParamException(TRACE_INFO,
@@ -113,22 +115,12 @@ const std::vector<double>& DimEmbedModule::getEmbedVector(Handle h,
 
     bool symmetric = classserver().isA(l,UNORDERED_LINK);
     if (symmetric) {
-        const AtomEmbedding& aE = (atomMaps.find(l))->second;
-        //AtomEmbedding::const_iterator aEit = aE.find(h);
-        //return aEit->second;
-        return aE.find(h)->second;
+        return atomMaps.find(l)->second.get(h);
     } else {
         const std::pair<AtomEmbedding, AtomEmbedding>& aEPair =
             (asymAtomMaps.find(l))->second;
-        if (fanin) {
-            //AtomEmbedding::const_iterator aEit = aEPair.second.find(h);
-            //return aEit->second;
-            return aEPair.second.find(h)->second;
-        } else {
-            //AtomEmbedding::const_iterator aEit = aE.find(h);
-            //return aEit->second;
-            return aEPair.first.find(h)->second;
-        }
+        if (fanin) return aEPair.second.get(h);
+        else return aEPair.first.get(h);
     }
 }
 
@@ -153,12 +145,18 @@ HandleSeq& DimEmbedModule::getPivots(Type l, bool fanin)
 }
 
 HandleSeq DimEmbedModule::kNearestNeighbors(Handle h, Type l, int k, bool fanin)
+{
+    return batchNearestNeighbors(HandleSeq(1, h), l, k, fanin)[0];
+}
+
+std::vector<HandleSeq> DimEmbedModule::batchNearestNeighbors(const HandleSeq& hs,
+                                                             Type l, int k,
+                                                             bool fanin)
 {
     if (!classserver().isLink(l))
         throw InvalidParamException(TRACE_INFO,
             "DimensionalEmbedding requires link type, not %s",
             classserver().getTypeName(l).c_str());
-    //logger().info("%d nearest neighbours start", k);
     if (!isEmbedded(l)) {
         const char* tName = classserver().getTypeName(l).c_str();
         logger().error("No embedding exists for type %s", tName);
@@ -166,156 +164,201 @@ HandleSeq DimEmbedModule::kNearestNeighbors(Handle h, Type l, int k, bool fanin)
     }
     bool symmetric = classserver().isA(l,UNORDERED_LINK);
 
-    std::vector<CoverTreePoint> points;
-    if (symmetric) {
-        EmbedTreeMap::const_iterator it = embedTreeMap.find(l);
-        points =
-            it->second.kNearestNeighbors(CoverTreePoint(h,atomMaps[l][h]),k);
-    } else {
-        AsymEmbedTreeMap::const_iterator it = asymEmbedTreeMap.find(l);
-        if (fanin) {
-            points =
-                it->second.second.
-                kNearestNeighbors(CoverTreePoint(h,asymAtomMaps[l].second[h]),k);
+    const AtomEmbedding& aE = symmetric ? atomMaps[l] :
+        (fanin ? asymAtomMaps[l].second : asymAtomMaps[l].first);
+    std::vector<std::vector<double> > queries;
+    for (HandleSeq::const_iterator it=hs.begin(); it!=hs.end(); ++it) {
+        queries.push_back(aE.get(*it));
+    }
+    if (k < 0) k = 0;
+    return aE.nearest(queries, k);
+}
+
+namespace {
+
+/**
+ * Binary max-heap of node ids, keyed by their path weight to the pivot.
+ * The position of each node in the heap is kept, so that its weight can
+ * be increased in place instead of searching for it.
+ */
+class PathHeap
+{
+public:
+    PathHeap(const std::vector<double>& weights)
+        : _weights(weights), _pos(weights.size(), npos) {}
+
+    bool empty() const { return _heap.empty(); }
+
+    //call after the weight of id has been increased
+    void update(size_t id) {
+        if (_pos[id] == npos) {
+            _pos[id] = _heap.size();
+            _heap.push_back(id);
         }
-        else {
-            points =
-                it->second.first.
-                kNearestNeighbors(CoverTreePoint(h,asymAtomMaps[l].first[h]),k);
+        up(_pos[id]);
+    }
+
+    size_t pop() {
+        size_t top = _heap.front();
+        _pos[top] = npos;
+        _heap.front() = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty()) {
+            _pos[_heap.front()] = 0;
+            down(0);
         }
+        return top;
     }
-    HandleSeq results;
-    std::vector<CoverTreePoint>::const_iterator it;
-    for (it=points.begin(); it!=points.end(); ++it) {
-        results.push_back(it->getHandle());
+
+private:
+    static const size_t npos = (size_t) -1;
+
+    void swap(size_t i, size_t j) {
+        std::swap(_heap[i], _heap[j]);
+        _pos[_heap[i]] = i;
+        _pos[_heap[j]] = j;
     }
-    return results;
+    void up(size_t i) {
+        while (i > 0 && _weights[_heap[(i-1)/2]] < _weights[_heap[i]]) {
+            swap(i, (i-1)/2);
+            i = (i-1)/2;
+        }
+    }
+    void down(size_t i) {
+        for (;;) {
+            size_t best = i;
+            size_t l = 2*i+1, r = 2*i+2;
+            if (l < _heap.size() && _weights[_heap[best]] < _weights[_heap[l]])
+                best = l;
+            if (r < _heap.size() && _weights[_heap[best]] < _weights[_heap[r]])
+                best = r;
+            if (best == i) return;
+            swap(i, best);
+            i = best;
+        }
+    }
+
+    const std::vector<double>& _weights;
+    std::vector<size_t> _pos;
+    std::vector<size_t> _heap;
+};
+
+const size_t PathHeap::npos;
+
 }
 
-void DimEmbedModule::addPivot(Handle h, Type linkType, bool fanin)
+void DimEmbedModule::embedDirection(Type linkType, int numDimensions,
+                                    bool fanin, HandleSeq& pivots,
+                                    AtomEmbedding& aE) const
 {
-    if (!classserver().isLink(linkType))
-        throw InvalidParamException(TRACE_INFO,
-            "DimensionalEmbedding requires link type, not %s",
-            classserver().getTypeName(linkType).c_str());
     bool symmetric = classserver().isA(linkType,UNORDERED_LINK);
-    if (!fanin) as->incVLTI(h);//We don't want pivot atoms to be forgotten...
+
     HandleSeq nodes;
     as->getHandlesByType(std::back_inserter(nodes), NODE, true);
+    const size_t n = nodes.size();
+    std::unordered_map<Handle, size_t, handle_hash> ids;
+    for (size_t i=0; i<n; ++i) ids[nodes[i]] = i;
 
-    std::map<Handle,double> distMap;
-
-    typedef std::multimap<double,Handle> pQueue_t;
-    pQueue_t pQueue;
-    for (HandleSeq::iterator it=nodes.begin(); it!=nodes.end(); ++it){
-        if (*it==h) {
-            pQueue.insert(std::pair<double, Handle>(1,*it));
-            distMap[*it]=1;
-        } else {
-            pQueue.insert(std::pair<double, Handle>(0,*it));
-            distMap[*it]=0;
+    //Snapshot of the links as adjacency lists: the neighbours of node u
+    //are col[row[u]] .. col[row[u+1]-1], weight[k] being the strength
+    //times the confidence of the link joining u to col[k]
+    std::vector<std::pair<size_t, std::pair<size_t, double> > > edges;
+    HandleSeq links;
+    as->getHandlesByType(std::back_inserter(links), linkType, true);
+    for (HandleSeq::iterator it=links.begin(); it!=links.end(); ++it) {
+        TruthValuePtr linkTV = as->getTV(*it);
+        double w = linkTV->getMean() * linkTV->getConfidence();
+        HandleSeq out = as->getOutgoing(*it);
+        std::vector<size_t> outIds;
+        for (HandleSeq::iterator it2=out.begin(); it2!=out.end(); ++it2) {
+            std::unordered_map<Handle, size_t, handle_hash>::const_iterator
+                idIt = ids.find(*it2);
+            outIds.push_back(idIt == ids.end() ? (size_t) -1 : idIt->second);
         }
-    }
-    if (symmetric) {
-        pivotsMap[linkType].push_back(h);
-    } else {
-        if (fanin) asymPivotsMap[linkType].second.push_back(h);
-        else asymPivotsMap[linkType].first.push_back(h);
-    }
-    while(!pQueue.empty()) {
-        pQueue_t::reverse_iterator p_it = pQueue.rbegin();
-        Handle u = p_it->second;//extract max (highest weight)
-
-        /*std::cout << "U=" << u << " distmap={";
-        for (std::map<Handle, double>::iterator it = distMap.begin();
-                it != distMap.end(); ++it) {
-            std::cout << it->second << ":h=" << it->first << ",";
-        }
-        std::cout << "}" << std::endl;*/
-
-        //we can't simply erase p_it->first because there could be multiple
-        //nodes that are the same distance from our pivot, and we can't
-        //pass erase p_it because it's a reverseiterator, thus this awkwardness
-        pQueue_t::iterator erase_it = pQueue.end();
-        pQueue.erase(--erase_it);
-
-        if (distMap[u]==0) { break;}
-        HandleSeq newLinks = as->getIncoming(u);
-        for (HandleSeq::iterator it=newLinks.begin(); it!=newLinks.end(); ++it){
-            //ignore links that aren't a subtype of linkType
-            if (!classserver().isA(as->getType(*it),linkType)) continue;
-            TruthValuePtr linkTV = as->getTV(*it);
-            HandleSeq newNodes = as->getOutgoing(*it);
-            HandleSeq::iterator it2=newNodes.begin();
+        if (outIds.empty()) continue;
+        for (size_t i=0; i<outIds.size(); ++i) {
+            size_t u = outIds[i];
+            if (u == (size_t) -1) continue;
             //if !fanin, we're following the "outward" links, so it's only a
-            //valid link if u is the source
-            if (!symmetric && !fanin && !as->isSource(u,*it)) continue;
+            //valid link if u is the source. If fanin, only the source can
+            //be reached.
+            if (!symmetric && !fanin && i != 0) continue;
             if (!symmetric && fanin) {
-                if (as->isSource(u,*it)) {
-                    continue;
-                }
-                else {
-                    newNodes.clear();
-                    newNodes.push_back(*it2);
-                    it2=newNodes.begin();
-                }
+                if (u == outIds[0] || outIds[0] == (size_t) -1) continue;
+                edges.push_back(std::make_pair(u, std::make_pair(outIds[0], w)));
+                continue;
             }
-            for (;it2!=newNodes.end(); ++it2) {
-                if (!as->isNode(*it2)) continue;
-                double alt =
-                    distMap[u] * linkTV->getMean() * linkTV->getConfidence();
-                double oldDist=distMap[*it2];
-                //If we've found a better (higher weight) path, update distMap
-                if (alt>oldDist) {
-                    pQueue_t::iterator it3;
-                    std::pair<pQueue_t::iterator, pQueue_t::iterator>
-                        itPair = pQueue.equal_range(oldDist);
-                    for (it3=itPair.first;it3!=itPair.second;++it3) {
-                        if (it3->second==*it2) {pQueue.erase(it3); break;}
-                    }
-                    pQueue.insert(std::pair<double, Handle>(alt,*it2));
-                    distMap[*it2]=alt;
-                }
+            for (size_t j=0; j<outIds.size(); ++j) {
+                size_t v = outIds[j];
+                if (v == (size_t) -1 || v == u) continue;
+                edges.push_back(std::make_pair(u, std::make_pair(v, w)));
             }
         }
     }
-    for (std::map<Handle, double>::iterator it = distMap.begin();
-            it != distMap.end(); ++it) {
-        if (symmetric) {
-            atomMaps[linkType][it->first].push_back(it->second);
-        } else {
-            if (fanin) asymAtomMaps[linkType].second[it->first].push_back(it->second);
-            else asymAtomMaps[linkType].first[it->first].push_back(it->second);
-        }
+    std::vector<size_t> row(n+1, 0);
+    for (size_t e=0; e<edges.size(); ++e) row[edges[e].first+1]++;
+    for (size_t u=0; u<n; ++u) row[u+1] += row[u];
+    std::vector<size_t> col(edges.size());
+    std::vector<double> weight(edges.size());
+    std::vector<size_t> fill(row.begin(), row.end()-1);
+    for (size_t e=0; e<edges.size(); ++e) {
+        size_t k = fill[edges[e].first]++;
+        col[k] = edges[e].second.first;
+        weight[k] = edges[e].second.second;
     }
-}
+    edges.clear();
 
-Handle DimEmbedModule::pickPivot(Type linkType, HandleSeq& nodes, bool fanin)
-{
-    bool symmetric = classserver().isA(linkType,UNORDERED_LINK);
+    //candidates for new pivots, and the highest weight path from each
+    //node to any pivot picked so far
+    std::vector<size_t> candidates;
+    for (size_t i=0; i<n; ++i) candidates.push_back(i);
+    std::vector<double> closest(n, 0.0);
 
-    HandleSeq& pivots = getPivots(linkType,fanin);
-    Handle bestChoice = nodes.back();
-    if (pivots.empty()) return bestChoice;
-    logger().info("Pivot %d picked", pivots.size());
-    double bestChoiceWeight = 1;
-    //pick the next pivot to maximize its distance from its closest pivot
-    //(maximizing distance = minimizing path weight)
-    for (HandleSeq::iterator it=nodes.begin(); it!=nodes.end(); ++it) {
-        std::vector<double> eV;
-        if (symmetric) {
-            eV = atomMaps[linkType][*it];
-        } else {
-            if (fanin) eV = asymAtomMaps[linkType].second[*it];
-            else eV = asymAtomMaps[linkType].first[*it];
+    std::vector<std::vector<double> > columns;
+    std::vector<double> dist(n);
+    for (int d=0; d<numDimensions && !candidates.empty(); ++d) {
+        //pick the next pivot to maximize its distance from its closest
+        //pivot (maximizing distance = minimizing path weight)
+        size_t bestIndex = candidates.size()-1;
+        if (d != 0) {
+            double bestChoiceWeight = 1;
+            for (size_t c=0; c<candidates.size(); ++c) {
+                if (closest[candidates[c]] < bestChoiceWeight) {
+                    bestIndex = c;
+                    bestChoiceWeight = closest[candidates[c]];
+                }
+            }
         }
-        double testChoiceWeight = *std::max_element(eV.begin(), eV.end());
-        if (testChoiceWeight < bestChoiceWeight) {
-            bestChoice = *it;
-            bestChoiceWeight = testChoiceWeight;
+        size_t pivot = candidates[bestIndex];
+        candidates.erase(candidates.begin()+bestIndex);
+        pivots.push_back(nodes[pivot]);
+
+        //max-product Dijkstra from the pivot
+        std::fill(dist.begin(), dist.end(), 0.0);
+        dist[pivot] = 1;
+        PathHeap pQueue(dist);
+        pQueue.update(pivot);
+        while (!pQueue.empty()) {
+            size_t u = pQueue.pop();//extract max (highest weight)
+            for (size_t k=row[u]; k<row[u+1]; ++k) {
+                double alt = dist[u] * weight[k];
+                //If we've found a better (higher weight) path, update dist
+                if (alt > dist[col[k]]) {
+                    dist[col[k]] = alt;
+                    pQueue.update(col[k]);
+                }
+            }
         }
+        for (size_t i=0; i<n; ++i)
+            closest[i] = std::max(closest[i], dist[i]);
+        columns.push_back(dist);
+    }
+
+    std::vector<double> embedVec(columns.size());
+    for (size_t i=0; i<n; ++i) {
+        for (size_t d=0; d<columns.size(); ++d) embedVec[d] = columns[d][i];
+        aE.set(nodes[i], embedVec);
     }
-    return bestChoice;
 }
 
 void DimEmbedModule::embedAtomSpace(Type linkType,
@@ -333,55 +376,38 @@ void DimEmbedModule::embedAtomSpace(Type linkType,
     int numDimensions = 5;
     if (_numDimensions > 0) numDimensions = _numDimensions;
 
-    bool fanin=false;
-    dimensionMap[linkType]=numDimensions;
-    //const HandleSeq& pivots = getPivots(linkType);
-    HandleSeq nodes;//candidates for new pivots
+    HandleSeq nodes;
     as->getHandlesByType(std::back_inserter(nodes), NODE, true);
     if (nodes.empty()) return;
     if (nodes.size() < (size_t) numDimensions) numDimensions = nodes.size();
+    dimensionMap[linkType]=numDimensions;
 
-    for (int i=0; i<numDimensions; ++i) {
-        Handle newPivot;
-        if (i!=0) newPivot = pickPivot(linkType,nodes,fanin);
-        else newPivot = nodes.back();
-        nodes.erase(std::find(nodes.begin(), nodes.end(), newPivot));
-        addPivot(newPivot, linkType, fanin);
-        if (!symmetric && !fanin && (nodes.empty() || i==numDimensions-1)) {
-            fanin=true;
-            nodes.clear();
-            as->getHandlesByType(std::back_inserter(nodes), NODE, true);
-            i=-1;
-        }
-
-    }
-    //Now that all the points are calculated, we construct a
-    //cover tree for them.
-    //since every element of each embedding vector ranges from 0 to 1, no
-    //two elements will have distance greater than numDimensions.
+    HandleSeq* pivots;
     if (symmetric) {
-        CoverTree<CoverTreePoint>& cTree =
-            embedTreeMap.insert(std::make_pair(linkType,CoverTree<CoverTreePoint>(numDimensions+.1))).first->second;
-        AtomEmbedding& aE = atomMaps[linkType];
-        AtomEmbedding::const_iterator it = aE.begin();
-        for (;it!=aE.end();++it) {
-            cTree.insert(CoverTreePoint(it->first,it->second));
-        }
+        pivots = &pivotsMap[linkType];
+        AtomEmbedding& aE = atomMaps[linkType] = AtomEmbedding(numDimensions);
+        embedDirection(linkType, numDimensions, false, *pivots, aE);
+        aE.buildIndex();
     } else {
-        std::pair<CoverTree<CoverTreePoint>, CoverTree<CoverTreePoint> >& cTrees
-            = asymEmbedTreeMap.insert(std::make_pair(linkType,
-                                            std::make_pair(CoverTree<CoverTreePoint>(numDimensions+.1), CoverTree<CoverTreePoint>(numDimensions+.1)))).first->second;
+        std::pair<HandleSeq, HandleSeq>& asymPivots = asymPivotsMap[linkType];
         std::pair<AtomEmbedding, AtomEmbedding>& aE = asymAtomMaps[linkType];
-        const AtomEmbedding& aE1 = aE.first;
-        AtomEmbedding::const_iterator it = aE1.begin();
-        for (;it!=aE1.end();++it) {
-            cTrees.first.insert(CoverTreePoint(it->first,it->second));
-        }
-        const AtomEmbedding& aE2 = aE.second;
-        it = aE2.begin();
-        for (;it!=aE2.end();++it) {
-            cTrees.second.insert(CoverTreePoint(it->first,it->second));
-        }
+        aE.first = AtomEmbedding(numDimensions);
+        aE.second = AtomEmbedding(numDimensions);
+        pivots = &asymPivots.first;
+        //the two directions are independent
+        std::thread faninThread([&]() {
+            embedDirection(linkType, numDimensions, true,
+                           asymPivots.second, aE.second);
+            aE.second.buildIndex();
+        });
+        embedDirection(linkType, numDimensions, false,
+                       asymPivots.first, aE.first);
+        aE.first.buildIndex();
+        faninThread.join();
+    }
+    //We don't want pivot atoms to be forgotten...
+    for (HandleSeq::iterator it=pivots->begin(); it!=pivots->end(); ++it) {
+        as->incVLTI(*it);
     }
     //logger().info("done embedding");
 }
@@ -430,20 +456,10 @@ std::vector<double> DimEmbedModule::addNode(Handle h,
     }
     */
     if (symmetric) {
-        atomMaps[linkType][h] = newEmbedding;
-        EmbedTreeMap::iterator treeMapIt = embedTreeMap.find(linkType);
-        OC_ASSERT(treeMapIt!=embedTreeMap.end());
-        CoverTree<CoverTreePoint>& cTree = treeMapIt->second;
-        cTree.insert(CoverTreePoint(h,newEmbedding));
+        atomMaps[linkType].set(h, newEmbedding);
     } else {
-        asymAtomMaps[linkType].first[h] = newEmbedding;
-        asymAtomMaps[linkType].second[h] = newEmbedding;
-        AsymEmbedTreeMap::iterator treeMapIt = asymEmbedTreeMap.find(linkType);
-        OC_ASSERT(treeMapIt!=asymEmbedTreeMap.end());
-        CoverTree<CoverTreePoint>& cTree1 = treeMapIt->second.first;
-        cTree1.insert(CoverTreePoint(h,newEmbedding));
-        CoverTree<CoverTreePoint>& cTree2 = treeMapIt->second.second;
-        cTree2.insert(CoverTreePoint(h,newEmbedding));
+        asymAtomMaps[linkType].first.set(h, newEmbedding);
+        asymAtomMaps[linkType].second.set(h, newEmbedding);
     }
     return newEmbedding;
 }
@@ -462,23 +478,10 @@ void DimEmbedModule::removeNode(Handle h,
     }
     bool symmetric = classserver().isA(linkType,UNORDERED_LINK);
     if (symmetric) {
-        EmbedTreeMap::iterator treeMapIt = embedTreeMap.find(linkType);
-        OC_ASSERT(treeMapIt!=embedTreeMap.end());
-        CoverTree<CoverTreePoint>& cTree = treeMapIt->second;
-        AtomEmbedding::iterator aEit = atomMaps[linkType].find(h);
-        cTree.remove(CoverTreePoint(h,aEit->second));
-        atomMaps[linkType].erase(aEit);
+        atomMaps[linkType].remove(h);
     } else {
-        AsymEmbedTreeMap::iterator treeMapIt = asymEmbedTreeMap.find(linkType);
-        OC_ASSERT(treeMapIt!=asymEmbedTreeMap.end());
-        CoverTree<CoverTreePoint>& cTree1 = treeMapIt->second.first;
-        CoverTree<CoverTreePoint>& cTree2 = treeMapIt->second.second;
-        AtomEmbedding::iterator aEit = asymAtomMaps[linkType].first.find(h);
-        cTree1.remove(CoverTreePoint(h,aEit->second));
-        asymAtomMaps[linkType].first.erase(aEit);
-        aEit = asymAtomMaps[linkType].second.find(h);
-        cTree2.remove(CoverTreePoint(h,aEit->second));
-        asymAtomMaps[linkType].second.erase(aEit);
+        asymAtomMaps[linkType].first.remove(h);
+        asymAtomMaps[linkType].second.remove(h);
     }
 }
 
@@ -501,9 +504,6 @@ void DimEmbedModule::addLink(Handle h,
 
 void DimEmbedModule::symAddLink(Handle h, Type linkType)
 {
-    EmbedTreeMap::iterator treeMapIt = embedTreeMap.find(linkType);
-    OC_ASSERT(treeMapIt!=embedTreeMap.end());
-    CoverTree<CoverTreePoint>& cTree = treeMapIt->second;
     int dim = dimensionMap[linkType];
     AtomEmbedding& aE = atomMaps[linkType];
     TruthValuePtr linkTV = h->getTruthValue();
@@ -511,30 +511,25 @@ void DimEmbedModule::symAddLink(Handle h, Type linkType)
     HandleSeq nodes;
     if (LinkCast(h)) nodes = LinkCast(h)->getOutgoingSet();
     for (HandleSeq::iterator it=nodes.begin();it!=nodes.end();++it) {
-        AtomEmbedding::iterator aEit = aE.find(*it);
+        if (!aE.contains(*it)) continue;
+        std::vector<double> embedding = aE.get(*it);
         bool changed=false;
         for (HandleSeq::iterator it2=nodes.begin();it2!=nodes.end();++it2) {
-            std::vector<double> vec = aE[*it2];
+            if (!aE.contains(*it2)) continue;
+            std::vector<double> vec = aE.get(*it2);
             for (int i=0; i<dim; ++i) {
-                if ((aEit->second)[i]<weight*vec[i]) {
-                    if (!changed) {
-                        changed=true;
-                        cTree.remove(CoverTreePoint(aEit->first,aEit->second));
-                    }
-                    (aEit->second)[i]=weight*vec[i];
+                if (embedding[i]<weight*vec[i]) {
+                    changed=true;
+                    embedding[i]=weight*vec[i];
                 }
             }
         }
-        if (changed) cTree.insert(CoverTreePoint(aEit->first,aEit->second));
+        if (changed) aE.set(*it, embedding);
     }
 }
 
 void DimEmbedModule::asymAddLink(Handle h, Type linkType)
 {
-    AsymEmbedTreeMap::iterator treeMapIt = asymEmbedTreeMap.find(linkType);
-    OC_ASSERT(treeMapIt!=asymEmbedTreeMap.end());
-    CoverTree<CoverTreePoint>& cTreeForw = treeMapIt->second.first;
-    CoverTree<CoverTreePoint>& cTreeBackw = treeMapIt->second.second;
     int dim = dimensionMap[linkType];
     AtomEmbedding& aEForw = asymAtomMaps[linkType].first;
     AtomEmbedding& aEBackw = asymAtomMaps[linkType].second;
@@ -542,37 +537,34 @@ void DimEmbedModule::asymAddLink(Handle h, Type linkType)
     double weight = linkTV->getConfidence() * linkTV->getMean();
     HandleSeq nodes;
     if (LinkCast(h)) nodes = LinkCast(h)->getOutgoingSet();
+    if (nodes.empty()) return;
     Handle source = nodes.front();
+    if (!aEForw.contains(source)) return;
     HandleSeq::iterator it = nodes.begin();
     ++it;
-    std::vector<double>& sourceVecForw = aEForw[source];
-    const std::vector<double>& sourceVecBackw = aEBackw[source];
+    std::vector<double> sourceVecForw = aEForw.get(source);
+    const std::vector<double> sourceVecBackw = aEBackw.get(source);
     bool sourceChanged=false;
     for (;it!=nodes.end();++it) {
+        if (!aEForw.contains(*it)) continue;
         bool changed=false;
-        std::vector<double>& vecBackw = aEBackw[*it];
+        std::vector<double> vecBackw = aEBackw.get(*it);
         for (int i=0; i<dim; ++i) {
             if (vecBackw[i]<weight*sourceVecBackw[i]) {
-                if (!changed) {
-                    changed=true;
-                    cTreeBackw.remove(CoverTreePoint(*it,vecBackw));
-                }
+                changed=true;
                 vecBackw[i]=weight*sourceVecBackw[i];
             }
         }
-        if (changed) cTreeBackw.insert(CoverTreePoint(*it,vecBackw));
-        const std::vector<double>& vecForw = aEForw[*it];
+        if (changed) aEBackw.set(*it, vecBackw);
+        const std::vector<double> vecForw = aEForw.get(*it);
         for (int i=0; i<dim; ++i) {
             if (sourceVecForw[i]<weight*vecForw[i]) {
-                if (!sourceChanged) {
-                    sourceChanged=true;
-                    cTreeForw.remove(CoverTreePoint(source,sourceVecForw));
-                }
+                sourceChanged=true;
                 sourceVecForw[i]=weight*vecForw[i];
             }
         }
     }
-    if (sourceChanged) cTreeForw.insert(CoverTreePoint(source, sourceVecForw));
+    if (sourceChanged) aEForw.set(source, sourceVecForw);
 }
 
 void DimEmbedModule::clearEmbedding(Type linkType)
@@ -583,27 +575,27 @@ void DimEmbedModule::clearEmbedding(Type linkType)
             classserver().getTypeName(linkType).c_str());
     bool symmetric = classserver().isA(linkType,UNORDERED_LINK);
 
-    HandleSeq pivots  = pivotsMap[linkType];
+    HandleSeq pivots;
+    if (symmetric) pivots = pivotsMap[linkType];
+    else pivots = asymPivotsMap[linkType].first;
     for (HandleSeq::iterator it = pivots.begin(); it!=pivots.end(); ++it) {
         if (as->isValidHandle(*it)) as->decVLTI(*it);
     }
     if (symmetric) {
         atomMaps.erase(linkType);
-        embedTreeMap.erase(linkType);
+        pivotsMap.erase(linkType);
     } else {
         asymAtomMaps.erase(linkType);
-        asymEmbedTreeMap.erase(linkType);
+        asymPivotsMap.erase(linkType);
     }
-    pivotsMap.erase(linkType);
     dimensionMap.erase(linkType);
 }
 
 void DimEmbedModule::logAtomEmbedding(Type linkType)
 {
     bool symmetric = classserver().isA(linkType,UNORDERED_LINK);
-    AtomEmbedding atomEmbedding;
-    if (symmetric) atomEmbedding=atomMaps[linkType];
-    else atomEmbedding=asymAtomMaps[linkType].first;
+    const AtomEmbedding& atomEmbedding = symmetric ? atomMaps[linkType] :
+        asymAtomMaps[linkType].first;
     const HandleSeq& pivots = getPivots(linkType);
 
     std::ostringstream oss;
@@ -617,14 +609,14 @@ void DimEmbedModule::logAtomEmbedding(Type linkType)
         }
     }
     oss << "Node Embeddings:" << std::endl;
-    AtomEmbedding::const_iterator it;
-    for (it=atomEmbedding.begin(); it!=atomEmbedding.end(); ++it){
-        if (as->isValidHandle(it->first)) {
-            oss << as->atomAsString(it->first,true) << " : (";
+    HandleSeq handles = atomEmbedding.handles();
+    for (HandleSeq::const_iterator it=handles.begin(); it!=handles.end(); ++it){
+        if (as->isValidHandle(*it)) {
+            oss << as->atomAsString(*it,true) << " : (";
         } else {
-            oss << "[NODE'S BEEN DELETED H=" << it->first << "] : (";
+            oss << "[NODE'S BEEN DELETED H=" << *it << "] : (";
         }
-        const std::vector<double>& embedvector = it->second;
+        const std::vector<double> embedvector = atomEmbedding.get(*it);
         for (std::vector<double>::const_iterator it2=embedvector.begin();
             it2!=embedvector.end();
             ++it2){
@@ -643,16 +635,16 @@ void DimEmbedModule::printEmbedding()
     oss << "Node Embeddings" << std::endl;
     for (; mit != atomMaps.end(); ++mit) {
         oss << "=== for type" << classserver().getTypeName(mit->first).c_str() << std::endl;
-        AtomEmbedding atomEmbedding=mit->second;
-        AtomEmbedding::const_iterator it;
-        for (it=atomEmbedding.begin(); it!=atomEmbedding.end(); ++it){
-            if (as->isValidHandle(it->first)) {
-                oss << as->atomAsString(it->first,true) << " : (";
+        const AtomEmbedding& atomEmbedding=mit->second;
+        HandleSeq handles = atomEmbedding.handles();
+        for (HandleSeq::const_iterator it=handles.begin(); it!=handles.end(); ++it){
+            if (as->isValidHandle(*it)) {
+                oss << as->atomAsString(*it,true) << " : (";
             } else {
                 oss << "[NODE'S BEEN DELETED. handle=";
-                oss << it->first << "] : (";
+                oss << *it << "] : (";
             }
-            const std::vector<double>& embedVector = it->second;
+            const std::vector<double> embedVector = atomEmbedding.get(*it);
             for (std::vector<double>::const_iterator it2=embedVector.begin();
                 it2!=embedVector.end();
                 ++it2){
@@ -703,13 +695,13 @@ ClusterSeq DimEmbedModule::kMeansCluster(Type l, int numClusters, int npass, boo
         mask[i] = maskArray + numDimensions*i;
     }
     Handle* handleArray = new Handle[numVectors];
-    AtomEmbedding::const_iterator aEit=aE.begin();
+    HandleSeq handles = aE.handles();
     int i=0;
     int j;
     //add the values to the embeddingmatrix...
-    for (;aEit!=aE.end();++aEit) {
-        handleArray[i]=aEit->first;
-        const std::vector<double>& embedding = aEit->second;
+    for (HandleSeq::const_iterator aEit=handles.begin();aEit!=handles.end();++aEit) {
+        handleArray[i]=*aEit;
+        const std::vector<double> embedding = aE.get(*aEit);
         std::vector<double>::const_iterator vit=embedding.begin();
         j=0;
         for (;vit!=embedding.end();++vit) {
@@ -908,18 +900,20 @@ double DimEmbedModule::separation(const HandleSeq& cluster,
 
     const AtomEmbedding& aE = (atomMaps.find(linkType))->second;
     double minDist=DBL_MAX;
-    for (AtomEmbedding::const_iterator it=aE.begin();it!=aE.end();++it) {
+    HandleSeq handles = aE.handles();
+    for (HandleSeq::const_iterator it=handles.begin();it!=handles.end();++it) {
+        const std::vector<double> embedding = aE.get(*it);
         bool inCluster=false; //whether *it is in cluster
         bool better=false; //whether *it is closer to some element of cluster
                            //than minDist
         double dist;
         for (HandleSeq::const_iterator it2=cluster.begin();
                                       it2!=cluster.end();++it2) {
-            if (it->first==*it2) {
+            if (*it==*it2) {
                 inCluster=true;
                 break;
             }
-            dist = euclidDist(it->second,getEmbedVector(*it2,linkType));
+            dist = euclidDist(embedding,getEmbedVector(*it2,linkType));
             if (dist<minDist) better=true;
         }
         //If the node is closer and it is not in the cluster, update minDist
@@ -949,24 +943,22 @@ Handle DimEmbedModule::blendNodes(Handle n1,
     }
     const HandleSeq& pivots = getPivots(l);
     const unsigned int numDims = (unsigned int) dimensionMap[l];
-    const std::vector<double>& embedVec1 = getEmbedVector(n1,l);
-    const std::vector<double>& embedVec2 = getEmbedVector(n2,l);
+    const std::vector<double> embedVec1 = getEmbedVector(n1,l);
+    const std::vector<double> embedVec2 = getEmbedVector(n2,l);
     OC_ASSERT(numDims==embedVec1.size() &&
               numDims==embedVec2.size() && numDims==pivots.size());
     std::vector<double> newVec(embedVec1.begin(), embedVec1.end());
 
-    EmbedTreeMap::iterator treeMapIt = embedTreeMap.find(l);
-    OC_ASSERT(treeMapIt!=embedTreeMap.end());
-    CoverTree<CoverTreePoint>& cTree = treeMapIt->second;
+    const AtomEmbedding& aE = atomMaps[l];
     //For each pivot, see whether replacing embedVec1's embedding with
     //embedVec2's will make newVec farther from any existing point. Replace
     //it if so.
     for (unsigned int i=0; i<numDims; i++) {
-        CoverTreePoint p1(Handle::UNDEFINED,newVec);
+        std::vector<double> p1(newVec);
         newVec[i]=embedVec2[i];
-        CoverTreePoint p2(Handle::UNDEFINED,newVec);
-        double dist1 = p1.distance(cTree.kNearestNeighbors(p1,1)[0]);
-        double dist2 = p2.distance(cTree.kNearestNeighbors(p2,1)[0]);
+        const std::vector<double>& p2 = newVec;
+        double dist1 = euclidDist(p1, aE.get(aE.nearest(p1,1)[0]));
+        double dist2 = euclidDist(p2, aE.get(aE.nearest(p2,1)[0]));
         if (dist1>dist2) newVec[i]=embedVec2[i];
     }
     std::string prefix("blend_"+as->getName(n1)+"_"+as->getName(n2)+"_");
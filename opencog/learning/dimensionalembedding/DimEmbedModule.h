@@ -32,8 +32,7 @@
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/server/Module.h>
 #include <opencog/server/CogServer.h>
-#include <opencog/util/Cover_Tree.h>
-#include "CoverTreePoint.h"
+#include "EmbeddingTable.h"
 
 namespace opencog
 {
@@ -47,7 +46,7 @@ namespace opencog
     class DimEmbedModule : public Module
     {
     private:
-        typedef std::map<Handle, std::vector<double> > AtomEmbedding;
+        typedef EmbeddingTable AtomEmbedding;
         typedef std::map<Type, HandleSeq> PivotMap;
         typedef std::map<Type, std::pair<HandleSeq, HandleSeq> > AsymPivotMap;
         typedef std::map<Type, AtomEmbedding> AtomEmbedMap;
@@ -57,10 +56,6 @@ namespace opencog
         //the second is for (inheritance atom pivot) (ie pivot is target)
         //the "fanin" argument in several functions represents whether the links
         //go "inward", with pivots as targets (ie the second embedding)
-        typedef std::map<Type, CoverTree<CoverTreePoint> > EmbedTreeMap;
-        typedef std::map<Type, std::pair<CoverTree<CoverTreePoint>,
-                                         CoverTree<CoverTreePoint> > >
-            AsymEmbedTreeMap;
         typedef std::vector<std::pair<HandleSeq,std::vector<double> > >
             ClusterSeq; //the vector of doubles is the centroid of the cluster
         
@@ -73,26 +68,31 @@ namespace opencog
         AsymAtomEmbedMap asymAtomMaps;
         PivotMap pivotsMap;//Pivot atoms which act as the basis
         AsymPivotMap asymPivotsMap;
-        EmbedTreeMap embedTreeMap;
-        AsymEmbedTreeMap asymEmbedTreeMap;
         std::map<Type,int> dimensionMap;//Stores the number of dimensions that
                                         //each link type is embedded under
 
         /**
-         * Adds h as a pivot and adds the distances from each node to
-         * the pivot to the appropriate atomEmbedding. Also increase
-         * the VLTI of the new pivot (we don't want pivot atoms to be
-         * forgotten).
+         * Picks the pivots one at a time, each one as far as possible from
+         * the previous ones, and computes the distances from each node to
+         * each pivot, which are the embedding vectors.
          *
-         * @param h Handle to be added as a pivot
-         * @param linkType Type of link for which h should be added as a pivot
+         * The links of linkType are first copied out of the atomspace
+         * into adjacency lists, then the distances to each pivot are
+         * found by a max-product Dijkstra over them. This only reads the
+         * atomspace, so both directions of an asymmetric link type are
+         * embedded at the same time.
+         *
+         * @param linkType Type of link to embed
+         * @param numDimensions Number of pivots to pick
          * @param fanin For asymmetric link types, we need to embed twice,
          * once with fanin=true and once with fanin=false. The fanin=true
          * embedding of a given node represents the weight of the path
          * starting from the node and going to the pivot.
+         * @param pivots The pivots picked, in order
+         * @param aE The embedding, with numDimensions dimensions
          */
-        void addPivot(Handle h, Type linkType, bool fanin=false);
-        Handle pickPivot(Type linkType, HandleSeq& nodes, bool fanin=false);
+        void embedDirection(Type linkType, int numDimensions, bool fanin,
+                            HandleSeq& pivots, AtomEmbedding& aE) const;
         /**
          * Adds node to the appropriate AtomEmbedding in the AtomEmbedMap.
          *
@@ -112,7 +112,7 @@ namespace opencog
                                     Type linkType);
 
         /**
-         * Removes the node from the AtomEmbedding and Cover Tree for linkType.
+         * Removes the node from the AtomEmbedding for linkType.
          *
          * @param h Handle of node to be removed.
          * @param linkType Type for which h is removed from the embedding.
@@ -163,7 +163,7 @@ namespace opencog
          * @return A vector of doubles corresponding to handle h's distance
          * from each of the pivots.
          */
-        const std::vector<double>& getEmbedVector(Handle h, Type l, bool fanin=false) const;
+        std::vector<double> getEmbedVector(Handle h, Type l, bool fanin=false) const;
 
         /**
          * Returns the list of pivots for the embedding of type l.
@@ -232,12 +232,21 @@ namespace opencog
          * @param l The Type of link for which the neighbors are found
          * @param k The number of neighbors to find
          * @param fanin If l is asymmetric, indicates the embedding direction
-         * @return A vector of at least k handles, sorted from nearest to
-         * farthest (the 0ths element of the vector is closest to h). If there
-         * is a tie for the kth closest, this may return more than k handles.
+         * @return A vector of k handles (fewer if fewer nodes are
+         * embedded), sorted from nearest to farthest (the 0ths element of
+         * the vector is closest to h). Approximate for embeddings large
+         * enough to be indexed, see EmbeddingTable.
          */
         HandleSeq kNearestNeighbors(Handle h, Type l, int k, bool fanin=false);
 
+        /**
+         * Returns the k nearest nodes of each of the handles hs, the
+         * queries being answered in parallel. See kNearestNeighbors.
+         */
+        std::vector<HandleSeq> batchNearestNeighbors(const HandleSeq& hs,
+                                                     Type l, int k,
+                                                     bool fanin=false);
+
         /**
          * Use k-means clustering to find clusters using the
          * dimensional embedding. This function won't actually add
@@ -313,7 +322,7 @@ namespace opencog
         void handleAddSignal(Handle h);
 
         /**
-         * Removes the node from embedding & cover tree. Does not alter
+         * Removes the node from the embedding. Does not alter
          * the embedding vector of any nodes. Does nothing if removed
          * atom is a link.
          */
@@ -0,0 +1,317 @@
+/*
+ * opencog/learning/dimensionalembedding/EmbeddingTable.cc
+ *
+ * Copyright (C) 2015 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include <opencog/util/oc_assert.h>
+
+#include "EmbeddingTable.h"
+
+using namespace opencog;
+
+static unsigned numThreads(unsigned nThreads)
+{
+    if (nThreads > 0) return nThreads;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+EmbeddingTable::EmbeddingTable(size_t dimensions)
+    : _dim(dimensions), _nprobe(8)
+{
+}
+
+bool EmbeddingTable::contains(const Handle& h) const
+{
+    return _ids.find(h) != _ids.end();
+}
+
+std::vector<double> EmbeddingTable::get(const Handle& h) const
+{
+    std::vector<double> v(_dim, 0.0);
+    std::unordered_map<Handle, size_t, handle_hash>::const_iterator it =
+        _ids.find(h);
+    if (it != _ids.end()) {
+        const float* r = row(it->second);
+        std::copy(r, r + _dim, v.begin());
+    }
+    return v;
+}
+
+void EmbeddingTable::set(const Handle& h, const std::vector<double>& v)
+{
+    OC_ASSERT(v.size() == _dim);
+    size_t id;
+    std::unordered_map<Handle, size_t, handle_hash>::const_iterator it =
+        _ids.find(h);
+    if (it != _ids.end()) {
+        id = it->second;
+        if (isIndexed()) removeFromList(id);
+    } else if (!_free.empty()) {
+        id = _free.back();
+        _free.pop_back();
+        _handles[id] = h;
+        _ids[h] = id;
+    } else {
+        id = _handles.size();
+        _handles.push_back(h);
+        _data.resize(_data.size() + _dim);
+        _listOf.push_back(0);
+        _posInList.push_back(0);
+        _ids[h] = id;
+    }
+    std::copy(v.begin(), v.end(), _data.begin() + id * _dim);
+    if (isIndexed()) addToList(id);
+}
+
+void EmbeddingTable::remove(const Handle& h)
+{
+    std::unordered_map<Handle, size_t, handle_hash>::iterator it =
+        _ids.find(h);
+    if (it == _ids.end()) return;
+    size_t id = it->second;
+    if (isIndexed()) removeFromList(id);
+    _handles[id] = Handle::UNDEFINED;
+    _free.push_back(id);
+    _ids.erase(it);
+}
+
+void EmbeddingTable::clear()
+{
+    _data.clear();
+    _handles.clear();
+    _free.clear();
+    _ids.clear();
+    _centroids.clear();
+    _lists.clear();
+    _listOf.clear();
+    _posInList.clear();
+}
+
+HandleSeq EmbeddingTable::handles() const
+{
+    HandleSeq result;
+    result.reserve(size());
+    for (const Handle& h : _handles)
+        if (h != Handle::UNDEFINED) result.push_back(h);
+    return result;
+}
+
+double EmbeddingTable::distance(const float* r,
+                                const std::vector<double>& v) const
+{
+    double d = 0;
+    for (size_t i = 0; i < _dim; ++i) {
+        double diff = r[i] - v[i];
+        d += diff * diff;
+    }
+    return std::sqrt(d);
+}
+
+void EmbeddingTable::scan(const std::vector<size_t>& ids,
+                          const std::vector<double>& v, size_t k,
+                          std::vector<Neighbor>& heap) const
+{
+    //heap is a max-heap of the k nearest rows found so far
+    for (size_t id : ids) {
+        Neighbor n(distance(row(id), v), id);
+        if (heap.size() < k) {
+            heap.push_back(n);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (n < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = n;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+}
+
+HandleSeq EmbeddingTable::nearest(const std::vector<double>& v, size_t k) const
+{
+    OC_ASSERT(v.size() == _dim);
+    std::vector<Neighbor> heap;
+    if (k == 0) return HandleSeq();
+    heap.reserve(k + 1);
+
+    if (!isIndexed()) {
+        std::vector<size_t> ids;
+        ids.reserve(size());
+        for (size_t id = 0; id < _handles.size(); ++id)
+            if (_handles[id] != Handle::UNDEFINED) ids.push_back(id);
+        scan(ids, v, k, heap);
+    } else {
+        //scan the buckets of the nprobe centroids nearest to v
+        std::vector<std::pair<double, size_t> > lists;
+        lists.reserve(_lists.size());
+        for (size_t l = 0; l < _lists.size(); ++l) {
+            double d = 0;
+            for (size_t i = 0; i < _dim; ++i) {
+                double diff = _centroids[l * _dim + i] - v[i];
+                d += diff * diff;
+            }
+            lists.push_back(std::make_pair(d, l));
+        }
+        size_t nprobe = std::min<size_t>(std::max(1u, _nprobe), lists.size());
+        std::partial_sort(lists.begin(), lists.begin() + nprobe, lists.end());
+        for (size_t p = 0; p < nprobe; ++p)
+            scan(_lists[lists[p].second], v, k, heap);
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    HandleSeq result;
+    for (const Neighbor& n : heap)
+        result.push_back(_handles[n.second]);
+    return result;
+}
+
+std::vector<HandleSeq>
+EmbeddingTable::nearest(const std::vector<std::vector<double> >& vs,
+                        size_t k, unsigned nThreads) const
+{
+    std::vector<HandleSeq> results(vs.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < vs.size(); i = next++)
+            results[i] = nearest(vs[i], k);
+    };
+
+    nThreads = std::min<size_t>(numThreads(nThreads), vs.size());
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < nThreads; ++t)
+        workers.push_back(std::thread(worker));
+    //the calling thread takes its share of the work as well
+    worker();
+    for (std::thread& t : workers)
+        t.join();
+    return results;
+}
+
+size_t EmbeddingTable::nearestList(const float* r) const
+{
+    size_t nlist = _centroids.size() / _dim;
+    size_t best = 0;
+    double bestDist = std::numeric_limits<double>::max();
+    for (size_t l = 0; l < nlist; ++l) {
+        double d = 0;
+        for (size_t i = 0; i < _dim; ++i) {
+            double diff = _centroids[l * _dim + i] - r[i];
+            d += diff * diff;
+        }
+        if (d < bestDist) {
+            bestDist = d;
+            best = l;
+        }
+    }
+    return best;
+}
+
+void EmbeddingTable::addToList(size_t id)
+{
+    size_t l = nearestList(row(id));
+    _listOf[id] = l;
+    _posInList[id] = _lists[l].size();
+    _lists[l].push_back(id);
+}
+
+void EmbeddingTable::removeFromList(size_t id)
+{
+    std::vector<size_t>& list = _lists[_listOf[id]];
+    size_t last = list.back();
+    list[_posInList[id]] = last;
+    _posInList[last] = _posInList[id];
+    list.pop_back();
+}
+
+void EmbeddingTable::buildIndex(unsigned nThreads)
+{
+    _centroids.clear();
+    _lists.clear();
+    if (size() < minIndexedSize || _dim == 0) return;
+
+    std::vector<size_t> ids;
+    ids.reserve(size());
+    for (size_t id = 0; id < _handles.size(); ++id)
+        if (_handles[id] != Handle::UNDEFINED) ids.push_back(id);
+
+    const size_t nlist = (size_t) std::sqrt((double) ids.size());
+
+    //train the centroids on a sample of about 32 rows per centroid,
+    //starting from evenly spaced rows
+    const size_t step = std::max<size_t>(1, ids.size() / (32 * nlist));
+    std::vector<size_t> sample;
+    for (size_t i = 0; i < ids.size(); i += step)
+        sample.push_back(ids[i]);
+
+    _centroids.resize(nlist * _dim);
+    for (size_t l = 0; l < nlist; ++l) {
+        const float* r = row(sample[l * sample.size() / nlist]);
+        std::copy(r, r + _dim, _centroids.begin() + l * _dim);
+    }
+
+    std::vector<double> sums(nlist * _dim);
+    std::vector<size_t> counts(nlist);
+    for (int iter = 0; iter < 10; ++iter) {
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t id : sample) {
+            const float* r = row(id);
+            size_t l = nearestList(r);
+            for (size_t i = 0; i < _dim; ++i)
+                sums[l * _dim + i] += r[i];
+            counts[l]++;
+        }
+        //empty centroids are left where they are
+        for (size_t l = 0; l < nlist; ++l)
+            if (counts[l] > 0)
+                for (size_t i = 0; i < _dim; ++i)
+                    _centroids[l * _dim + i] = sums[l * _dim + i] / counts[l];
+    }
+
+    //bucket every row; finding the nearest centroids is done in parallel
+    std::vector<size_t> assignment(ids.size());
+    std::atomic<size_t> next(0);
+    const size_t chunk = 1024;
+    auto worker = [&]() {
+        for (size_t c = next++; c * chunk < ids.size(); c = next++) {
+            size_t end = std::min(ids.size(), (c + 1) * chunk);
+            for (size_t i = c * chunk; i < end; ++i)
+                assignment[i] = nearestList(row(ids[i]));
+        }
+    };
+    nThreads = numThreads(nThreads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < nThreads; ++t)
+        workers.push_back(std::thread(worker));
+    worker();
+    for (std::thread& t : workers)
+        t.join();
+
+    _lists.resize(nlist);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        size_t l = assignment[i];
+        _listOf[ids[i]] = l;
+        _posInList[ids[i]] = _lists[l].size();
+        _lists[l].push_back(ids[i]);
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * opencog/learning/dimensionalembedding/EmbeddingTable.h
+ *
+ * Copyright (C) 2015 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_EMBEDDING_TABLE_H
+#define _OPENCOG_EMBEDDING_TABLE_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atomspace/Handle.h>
+
+namespace opencog
+{
+    /**
+     * The embedding vectors of the nodes for one link type (and one
+     * direction, for asymmetric link types).
+     *
+     * The vectors are the rows of a single contiguous matrix of floats,
+     * addressed by dense ids. The ids of removed nodes are reused by the
+     * next nodes added.
+     *
+     * Nearest neighbour queries scan the whole matrix until buildIndex()
+     * has been called on a large enough table. From then on they go
+     * through an inverted file index: the rows are bucketed by their
+     * nearest centroid (out of about sqrt(n) centroids found by k-means)
+     * and a query only scans the buckets of its nprobe nearest centroids,
+     * so the results are approximate. Rows added, changed or removed
+     * afterwards are moved between the buckets as they change; the
+     * centroids themselves stay until the index is rebuilt.
+     *
+     * The table is not thread-safe, except that any number of queries may
+     * run concurrently with each other.
+     */
+    class EmbeddingTable
+    {
+    public:
+        EmbeddingTable(size_t dimensions = 0);
+
+        size_t dimensions() const { return _dim; }
+
+        /**
+         * Number of nodes in the table.
+         */
+        size_t size() const { return _ids.size(); }
+
+        bool contains(const Handle& h) const;
+
+        /**
+         * Returns the embedding vector of h, all zeros if h is not in
+         * the table.
+         */
+        std::vector<double> get(const Handle& h) const;
+
+        /**
+         * Adds h with the given vector, or replaces its vector if h is
+         * already in the table.
+         */
+        void set(const Handle& h, const std::vector<double>& v);
+
+        void remove(const Handle& h);
+
+        void clear();
+
+        /**
+         * Returns the nodes in the table, in id order.
+         */
+        HandleSeq handles() const;
+
+        /**
+         * Builds the inverted file index, or drops it if the table has
+         * fewer than minIndexedSize nodes (exact search is fast enough
+         * then).
+         */
+        void buildIndex(unsigned nThreads = 0);
+        bool isIndexed() const { return !_lists.empty(); }
+
+        /**
+         * Sets the number of buckets scanned per query by the index.
+         * More buckets give better results for slower queries.
+         */
+        void setProbes(unsigned nprobe) { _nprobe = nprobe; }
+
+        /**
+         * Returns the (at most) k nodes nearest to v, from nearest to
+         * farthest.
+         */
+        HandleSeq nearest(const std::vector<double>& v, size_t k) const;
+
+        /**
+         * Answers several nearest neighbour queries using nThreads worker
+         * threads (0 for one per hardware thread).
+         */
+        std::vector<HandleSeq> nearest(const std::vector<std::vector<double> >& vs,
+                                       size_t k, unsigned nThreads = 0) const;
+
+        static const size_t minIndexedSize = 4096;
+
+    private:
+        typedef std::pair<double, size_t> Neighbor;
+
+        const float* row(size_t id) const { return &_data[id * _dim]; }
+        double distance(const float* r, const std::vector<double>& v) const;
+        void scan(const std::vector<size_t>& ids, const std::vector<double>& v,
+                  size_t k, std::vector<Neighbor>& heap) const;
+        size_t nearestList(const float* r) const;
+        void addToList(size_t id);
+        void removeFromList(size_t id);
+
+        size_t _dim;
+        std::vector<float> _data;
+        std::vector<Handle> _handles; //Handle::UNDEFINED for free rows
+        std::vector<size_t> _free;
+        std::unordered_map<Handle, size_t, handle_hash> _ids;
+
+        //inverted file index
+        std::vector<double> _centroids;
+        std::vector<std::vector<size_t> > _lists;
+        std::vector<size_t> _listOf; //bucket of each row
+        std::vector<size_t> _posInList; //position of each row in its bucket
+        unsigned _nprobe;
+    };
+} //namespace
+
+#endif // _OPENCOG_EMBEDDING_TABLE_H
@@ -0,0 +1,69 @@
+/*
+ * opencog/learning/statistics/CountMinSketch.cc
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "CountMinSketch.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace opencog::statistics;
+
+CountMinSketch::CountMinSketch(unsigned int width, unsigned int depth)
+    : mWidth(std::max(width, 1u)), mDepth(std::max(depth, 1u)),
+      mCells((size_t)mWidth * mDepth, 0), mTotal(0)
+{
+}
+
+unsigned int CountMinSketch::cellIndex(uint64_t keyHash, unsigned int row) const
+{
+    // Derive the hash of each row from the two halves of the key hash
+    // (Kirsch-Mitzenmacher), then scramble it once more.
+    uint64_t h = (keyHash & 0xffffffffULL) + (uint64_t)(row + 1) * (keyHash >> 32);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (unsigned int)(h % mWidth);
+}
+
+void CountMinSketch::add(uint64_t keyHash, uint64_t countNum)
+{
+    for (unsigned int row = 0; row < mDepth; ++row)
+        mCells[(size_t)row * mWidth + cellIndex(keyHash, row)] += countNum;
+
+    mTotal += countNum;
+}
+
+uint64_t CountMinSketch::estimate(uint64_t keyHash) const
+{
+    uint64_t result = std::numeric_limits<uint64_t>::max();
+    for (unsigned int row = 0; row < mDepth; ++row)
+        result = std::min(result,
+                          mCells[(size_t)row * mWidth + cellIndex(keyHash, row)]);
+
+    return result;
+}
+
+void CountMinSketch::clear()
+{
+    std::fill(mCells.begin(), mCells.end(), 0);
+    mTotal = 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * opencog/learning/statistics/CountMinSketch.h
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STATISTICS_COUNT_MIN_SKETCH_H
+#define _OPENCOG_STATISTICS_COUNT_MIN_SKETCH_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace opencog {
+ namespace statistics {
+
+ // Approximate counter for keys given as 64-bit hashes.
+ // A key is counted in one cell of each of the depth rows, and its count
+ // is estimated as the smallest of these cells, so the estimate is never
+ // below the real count. With width w, the excess is at most about
+ // e/w times the total count with probability 1 - exp(-depth).
+ class CountMinSketch
+ {
+ public:
+     CountMinSketch(unsigned int width = 1 << 16, unsigned int depth = 4);
+
+     void add(uint64_t keyHash, uint64_t countNum = 1);
+
+     uint64_t estimate(uint64_t keyHash) const;
+
+     // sum of all the counts added so far
+     uint64_t total() const { return mTotal; }
+
+     void clear();
+
+ protected:
+     unsigned int mWidth;
+     unsigned int mDepth;
+     // mDepth rows of mWidth cells each, row after row
+     std::vector<uint64_t> mCells;
+     uint64_t mTotal;
+
+     unsigned int cellIndex(uint64_t keyHash, unsigned int row) const;
+ };
+
+ } //  namespace statistics
+
+} // namespace opencog
+
+#endif //_OPENCOG_STATISTICS_COUNT_MIN_SKETCH_H
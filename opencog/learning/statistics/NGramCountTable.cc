@@ -0,0 +1,148 @@
+/*
+ * opencog/learning/statistics/NGramCountTable.cc
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "NGramCountTable.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace opencog::statistics;
+
+NGramCountTable::NGramCountTable(int _n_gram, size_t exactLimit)
+    : n_gram(_n_gram), mExactLimit(exactLimit), mSlots(16, 0), mTotal(0)
+{
+}
+
+uint64_t NGramCountTable::hashKey(const unsigned int* ids, int n)
+{
+    // FNV-1a over the ids, followed by a final mix so that the low bits
+    // (used to pick the slot) depend on all of them
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < n; ++i)
+    {
+        h ^= ids[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+size_t NGramCountTable::findSlot(const unsigned int* ids, uint64_t hash) const
+{
+    size_t mask = mSlots.size() - 1;
+    size_t slot = hash & mask;
+
+    // linear probing: stop on the first empty slot or on the n-gram itself
+    while (mSlots[slot] != 0)
+    {
+        size_t entry = mSlots[slot] - 1;
+        if (mHashes[entry] == hash &&
+            memcmp(&mKeys[entry * n_gram], ids, n_gram * sizeof(unsigned int)) == 0)
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void NGramCountTable::grow()
+{
+    std::vector<uint32_t> slots(mSlots.size() * 2, 0);
+    size_t mask = slots.size() - 1;
+
+    for (size_t entry = 0; entry < mCounts.size(); ++ entry)
+    {
+        size_t slot = mHashes[entry] & mask;
+        while (slots[slot] != 0)
+            slot = (slot + 1) & mask;
+
+        slots[slot] = entry + 1;
+    }
+
+    mSlots.swap(slots);
+}
+
+void NGramCountTable::add(const unsigned int* ids, uint64_t countNum)
+{
+    uint64_t hash = hashKey(ids, n_gram);
+    size_t slot = findSlot(ids, hash);
+
+    mTotal += countNum;
+
+    if (mSlots[slot] != 0)
+    {
+        // this n-gram already exists in the table, just add the countNum
+        mCounts[mSlots[slot] - 1] += countNum;
+        return;
+    }
+
+    if (mExactLimit != 0 && mCounts.size() >= mExactLimit)
+    {
+        if (! mSketch)
+            mSketch.reset(new CountMinSketch());
+
+        mSketch->add(hash, countNum);
+        return;
+    }
+
+    // add a new entry, keeping the load factor under 1/2
+    mKeys.insert(mKeys.end(), ids, ids + n_gram);
+    mCounts.push_back(countNum);
+    mHashes.push_back(hash);
+    mSlots[slot] = mCounts.size();
+
+    if (mCounts.size() * 2 > mSlots.size())
+        grow();
+}
+
+long NGramCountTable::find(const unsigned int* ids) const
+{
+    size_t slot = findSlot(ids, hashKey(ids, n_gram));
+    return ((long) mSlots[slot]) - 1;
+}
+
+uint64_t NGramCountTable::getCount(const unsigned int* ids) const
+{
+    uint64_t hash = hashKey(ids, n_gram);
+    size_t slot = findSlot(ids, hash);
+
+    if (mSlots[slot] != 0)
+        return mCounts[mSlots[slot] - 1];
+
+    if (mSketch)
+        return mSketch->estimate(hash);
+
+    return 0;
+}
+
+void NGramCountTable::clear()
+{
+    mKeys.clear();
+    mCounts.clear();
+    mHashes.clear();
+    mSlots.assign(16, 0);
+    mSketch.reset();
+    mTotal = 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * opencog/learning/statistics/NGramCountTable.h
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STATISTICS_NGRAM_COUNT_TABLE_H
+#define _OPENCOG_STATISTICS_NGRAM_COUNT_TABLE_H
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "CountMinSketch.h"
+
+namespace opencog {
+ namespace statistics {
+
+ // Counts of the n-grams of one given length, the n-grams being arrays of
+ // integer ids.
+ //
+ // The entries are stored densely, in insertion order: the keys of all the
+ // entries in one array, the counts in another one, and an open addressing
+ // hash index of entry numbers on top of them. An entry number stays valid
+ // as long as the table is not cleared, so that results computed per entry
+ // can be kept in plain arrays next to the table.
+ //
+ // If exactLimit is not 0, at most exactLimit n-grams are counted exactly.
+ // The counts of the n-grams seen after the table is full (the long tail)
+ // go to a count-min sketch and are only available as estimates.
+ class NGramCountTable
+ {
+ public:
+     NGramCountTable(int _n_gram, size_t exactLimit = 0);
+
+     int gram() const { return n_gram; }
+
+     // add countNum to the count of the n-gram ids[0] ... ids[n_gram - 1]
+     void add(const unsigned int* ids, uint64_t countNum = 1);
+
+     // the entry number of this n-gram, or -1 if it is not counted exactly
+     long find(const unsigned int* ids) const;
+
+     // the exact count of the n-gram, or its estimate if it's in the sketch,
+     // 0 if it has never been seen
+     uint64_t getCount(const unsigned int* ids) const;
+
+     // number of n-grams counted exactly
+     size_t size() const { return mCounts.size(); }
+
+     const unsigned int* getEntryKey(size_t entry) const
+     { return &mKeys[entry * n_gram]; }
+
+     uint64_t getEntryCount(size_t entry) const { return mCounts[entry]; }
+
+     // sum of the counts of all the n-grams, including the ones in the sketch
+     uint64_t total() const { return mTotal; }
+
+     bool hasSketch() const { return (bool) mSketch; }
+
+     void clear();
+
+     static uint64_t hashKey(const unsigned int* ids, int n);
+
+ protected:
+     int n_gram;
+     size_t mExactLimit;
+
+     std::vector<unsigned int> mKeys;
+     std::vector<uint64_t> mCounts;
+     std::vector<uint64_t> mHashes;
+
+     // entry number + 1 for each used slot, 0 for the empty ones.
+     // The number of slots is a power of 2.
+     std::vector<uint32_t> mSlots;
+
+     std::unique_ptr<CountMinSketch> mSketch;
+
+     uint64_t mTotal;
+
+     size_t findSlot(const unsigned int* ids, uint64_t hash) const;
+
+     void grow();
+ };
+
+ } //  namespace statistics
+
+} // namespace opencog
+
+#endif //_OPENCOG_STATISTICS_NGRAM_COUNT_TABLE_H
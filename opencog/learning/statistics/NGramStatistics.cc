@@ -0,0 +1,211 @@
+/*
+ * opencog/learning/statistics/NGramStatistics.cc
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "NGramStatistics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <math.h>
+
+#include <opencog/util/oc_assert.h>
+
+using namespace opencog::statistics;
+using namespace std;
+
+namespace {
+
+// Run f(i) for every i in [0, n) on n_threads threads, the calling thread
+// being one of them. The items are handed out one at a time through a
+// shared counter.
+template<typename F>
+void parallelFor(size_t n, unsigned int n_threads, const F& f)
+{
+    if (n_threads == 0)
+        n_threads = max(1u, thread::hardware_concurrency());
+
+    if (n_threads <= 1 || n <= 1)
+    {
+        for (size_t i = 0; i < n; ++ i)
+            f(i);
+        return;
+    }
+
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++)
+            f(i);
+    };
+
+    n_threads = min<size_t>(n_threads, n);
+    vector<thread> workers;
+    for (unsigned int t = 1; t < n_threads; ++ t)
+        workers.push_back(thread(worker));
+    worker();
+    for (thread& t : workers)
+        t.join();
+}
+
+}
+
+NGramStatistics::NGramStatistics(int _n_gram, bool _isOrderDependent, size_t exactLimit)
+    : n_gram(_n_gram), isOrderDependent(_isOrderDependent),
+      mEntropies(_n_gram + 1), mInteractionInformations(_n_gram + 1)
+{
+    // the subsets of an n-gram are enumerated as bit masks
+    OC_ASSERT(_n_gram > 0 && _n_gram < 32);
+
+    for (int n = 0; n <= n_gram; ++ n)
+        mTables.push_back(NGramCountTable(max(n, 1), exactLimit));
+}
+
+void NGramStatistics::makeKey(int _n_gram, const unsigned int* oneRawData,
+                              unsigned int* key) const
+{
+    copy(oneRawData, oneRawData + _n_gram, key);
+
+    // if it is not order dependent, the ids are sorted ascending
+    if (! isOrderDependent)
+        sort(key, key + _n_gram);
+}
+
+void NGramStatistics::addOneRawDataCount(int _n_gram, const unsigned int* oneRawData,
+                                         uint64_t countNum)
+{
+    OC_ASSERT(_n_gram > 0 && _n_gram <= n_gram);
+
+    unsigned int key[32];
+    makeKey(_n_gram, oneRawData, key);
+    mTables[_n_gram].add(key, countNum);
+}
+
+void NGramStatistics::addSequence(const unsigned int* ids, size_t length)
+{
+    for (size_t start = 0; start < length; ++ start)
+        for (int n = 1; n <= n_gram && start + n <= length; ++ n)
+            addOneRawDataCount(n, ids + start);
+}
+
+uint64_t NGramStatistics::getCount(int _n_gram, const unsigned int* oneRawData) const
+{
+    OC_ASSERT(_n_gram > 0 && _n_gram <= n_gram);
+
+    unsigned int key[32];
+    makeKey(_n_gram, oneRawData, key);
+    return mTables[_n_gram].getCount(key);
+}
+
+float NGramStatistics::getProbability(int _n_gram, const unsigned int* oneRawData) const
+{
+    uint64_t total = mTables[_n_gram].total();
+    if (total == 0)
+        return 0.0f;
+
+    return ((float) getCount(_n_gram, oneRawData)) / ((float) total);
+}
+
+float NGramStatistics::entropyOfCount(int _n_gram, uint64_t count) const
+{
+    if (count == 0)
+        return 0.0f;
+
+    float probability = ((float) count) / ((float) mTables[_n_gram].total());
+    return (-1.0f) * probability * log2(probability);
+}
+
+float NGramStatistics::getEntropy(int _n_gram, const unsigned int* oneRawData) const
+{
+    return entropyOfCount(_n_gram, getCount(_n_gram, oneRawData));
+}
+
+float NGramStatistics::interactionInformationOfKey(int _n_gram, const unsigned int* key,
+                                                   bool useEntries) const
+{
+    // the order of the ids is kept in the subsets
+    return (float) interactionInformationOfSubsets(_n_gram, [&](uint32_t subset) -> float {
+        unsigned int subKey[32];
+        int size = 0;
+        for (int i = 0; i < _n_gram; ++ i)
+            if (subset & (1u << i))
+                subKey[size ++] = key[i];
+
+        const NGramCountTable& table = mTables[size];
+        long entry = table.find(subKey);
+        if (entry >= 0)
+        {
+            if (useEntries)
+                return mEntropies[size][entry];
+            else
+                return entropyOfCount(size, table.getEntryCount(entry));
+        }
+        else
+            return entropyOfCount(size, table.getCount(subKey));
+    });
+}
+
+float NGramStatistics::calculateInteractionInformation(int _n_gram,
+                                                       const unsigned int* oneRawData) const
+{
+    OC_ASSERT(_n_gram > 0 && _n_gram <= n_gram);
+
+    unsigned int key[32];
+    makeKey(_n_gram, oneRawData, key);
+    return interactionInformationOfKey(_n_gram, key, false);
+}
+
+void NGramStatistics::calculateInteractionInformations(unsigned int n_threads)
+{
+    // first the entropies of all the entries, which the interaction
+    // informations of the longer n-grams are then made of
+    for (int n = 1; n <= n_gram; ++ n)
+    {
+        const NGramCountTable& table = mTables[n];
+        vector<float>& entropies = mEntropies[n];
+        entropies.resize(table.size());
+
+        parallelFor(table.size(), n_threads, [&](size_t entry) {
+            entropies[entry] = entropyOfCount(n, table.getEntryCount(entry));
+        });
+    }
+
+    for (int n = 1; n <= n_gram; ++ n)
+    {
+        const NGramCountTable& table = mTables[n];
+        vector<float>& interactionInformations = mInteractionInformations[n];
+        interactionInformations.resize(table.size());
+
+        parallelFor(table.size(), n_threads, [&](size_t entry) {
+            interactionInformations[entry] =
+                interactionInformationOfKey(n, table.getEntryKey(entry), true);
+        });
+    }
+}
+
+void NGramStatistics::clear()
+{
+    for (int n = 0; n <= n_gram; ++ n)
+    {
+        mTables[n].clear();
+        mEntropies[n].clear();
+        mInteractionInformations[n].clear();
+    }
+}
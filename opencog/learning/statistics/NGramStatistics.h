@@ -0,0 +1,148 @@
+/*
+ * opencog/learning/statistics/NGramStatistics.h
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STATISTICS_NGRAM_STATISTICS_H
+#define _OPENCOG_STATISTICS_NGRAM_STATISTICS_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "NGramCountTable.h"
+
+namespace opencog {
+ namespace statistics {
+
+ // Probability, entropy and interaction information of n-grams of integer
+ // ids, for all the gram lengths from 1 to n_gram.
+ //
+ // This does the same computations as DataProvider + Probability + Entropy
+ // + InteractionInformation, but the ids are used directly as keys instead
+ // of strings made from them, and the counts are kept in one
+ // NGramCountTable per gram length. The callers give each of their
+ // metadata an id (e.g. its index in their own table).
+ //
+ // Counts can be added at any time (streaming); the totals are kept up to
+ // date, so every query reflects all the counts added so far and nothing
+ // needs to be recomputed from scratch. Adding counts is not thread safe,
+ // the queries are and can run concurrently with each other.
+ class NGramStatistics
+ {
+ public:
+     // exactLimit is the maximum number of n-grams counted exactly for each
+     // gram length, 0 for no limit. See NGramCountTable.
+     NGramStatistics(int _n_gram, bool _isOrderDependent, size_t exactLimit = 0);
+
+     int gram() const { return n_gram; }
+
+     // Does the permutation order of the ids in one n-gram matter?
+     // like whether "a-b-c" is considered to be the same with "b-c-a"
+     bool orderDependent() const { return isOrderDependent; }
+
+     // add the count number of one piece of raw data of length _n_gram
+     void addOneRawDataCount(int _n_gram, const unsigned int* oneRawData,
+                             uint64_t countNum = 1);
+
+     // Count all the n-grams of length 1 to n_gram in a window of n_gram
+     // ids sliding over the sequence, as if each of them had been added with
+     // addOneRawDataCount.
+     void addSequence(const unsigned int* ids, size_t length);
+
+     uint64_t getCount(int _n_gram, const unsigned int* oneRawData) const;
+
+     float getProbability(int _n_gram, const unsigned int* oneRawData) const;
+
+     // -p * log2(p)
+     float getEntropy(int _n_gram, const unsigned int* oneRawData) const;
+
+     // The sum of the entropies of all the non empty subsets of the n-gram,
+     // the ones of odd size being added and the ones of even size
+     // subtracted, as in InteractionInformation.
+     float calculateInteractionInformation(int _n_gram,
+                                           const unsigned int* oneRawData) const;
+
+     // The interaction information of _n_gram items from the entropies of
+     // their subsets: entropyOfSubset(subset) gives the entropy of the
+     // items whose bits are set in subset, for every non empty subset.
+     // This is how calculateInteractionInformation is computed, and can be
+     // used for items that are not ids counted here (e.g. the links of a
+     // pattern in PatternMiner).
+     template<typename F>
+     static double interactionInformationOfSubsets(int _n_gram, const F& entropyOfSubset)
+     {
+         double interactionInfo = 0.0;
+         for (uint32_t subset = 1; subset < (1u << _n_gram); ++ subset)
+         {
+             int size = 0;
+             for (uint32_t bits = subset; bits != 0; bits >>= 1)
+                 size += bits & 1;
+
+             if (size % 2 == 1)
+                 interactionInfo += entropyOfSubset(subset);
+             else
+                 interactionInfo -= entropyOfSubset(subset);
+         }
+         return interactionInfo;
+     }
+
+     // Compute the entropy and the interaction information of every n-gram
+     // counted exactly, using n_threads threads (0 for one per core). The
+     // results can then be read with getEntryEntropies and
+     // getEntryInteractionInformations, until counts are added again.
+     void calculateInteractionInformations(unsigned int n_threads = 0);
+
+     const NGramCountTable& getTable(int _n_gram) const { return mTables[_n_gram]; }
+
+     // indexed by the entry numbers of getTable(_n_gram)
+     const std::vector<float>& getEntryEntropies(int _n_gram) const
+     { return mEntropies[_n_gram]; }
+     const std::vector<float>& getEntryInteractionInformations(int _n_gram) const
+     { return mInteractionInformations[_n_gram]; }
+
+     void clear();
+
+ protected:
+     int n_gram;
+     bool isOrderDependent;
+
+     // the tables for 1-gram to n-gram, mTables[0] is not used
+     std::vector<NGramCountTable> mTables;
+
+     std::vector<std::vector<float> > mEntropies;
+     std::vector<std::vector<float> > mInteractionInformations;
+
+     // the key of oneRawData: a copy, sorted unless isOrderDependent
+     void makeKey(int _n_gram, const unsigned int* oneRawData,
+                  unsigned int* key) const;
+
+     float entropyOfCount(int _n_gram, uint64_t count) const;
+
+     // Interaction information of a key. If useEntries, the entropies of
+     // the subsets counted exactly are taken from mEntropies.
+     float interactionInformationOfKey(int _n_gram, const unsigned int* key,
+                                       bool useEntries) const;
+ };
+
+ } //  namespace statistics
+
+} // namespace opencog
+
+#endif //_OPENCOG_STATISTICS_NGRAM_STATISTICS_H
@@ -0,0 +1,217 @@
+/*
+ * opencog/learning/statistics/statistics-benchmark.cc
+ *
+ * Copyright (C) 2014 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Compare NGramStatistics with the string keyed computation of
+// DataProvider / Entropy / InteractionInformation on a random sequence
+// of ids with a Zipf-like distribution.
+//
+// The string keyed version is reproduced here, since the templates of
+// DataProvider and InteractionInformation are only defined in their .cc
+// files and can't be instantiated from outside.
+//
+// usage: statistics-benchmark [sequence length] [n_gram] [number of ids] [threads]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DataProvider.h"
+#include "NGramStatistics.h"
+
+using namespace opencog::statistics;
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point start)
+{
+    return chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+static string makeKeyString(const unsigned int* ids, int n)
+{
+    string key = "";
+    for (int i = 0; i < n; ++ i)
+    {
+        if (i != 0)
+            key += "-";
+
+        char buf[16];
+        sprintf(buf, "%u", ids[i]);
+        key += string(buf);
+    }
+    return key;
+}
+
+// the string keyed maps of DataProvider, with the computations of
+// Probability, Entropy and InteractionInformation
+struct StringStatistics
+{
+    int n_gram;
+    vector<map<string, StatisticData> > dataMaps;
+    vector<int> rawDataNumbers;
+
+    StringStatistics(int _n_gram)
+        : n_gram(_n_gram), dataMaps(_n_gram + 1), rawDataNumbers(_n_gram + 1, 0) {}
+
+    void addOneRawDataCount(int n, const unsigned int* oneRawData)
+    {
+        vector<unsigned int> key(oneRawData, oneRawData + n);
+        sort(key.begin(), key.end());
+        string keyString = makeKeyString(&key[0], n);
+        map<string, StatisticData>::iterator it = dataMaps[n].find(keyString);
+        if (it == dataMaps[n].end())
+            dataMaps[n].insert(make_pair(keyString, StatisticData(1)));
+        else
+            it->second.count += 1;
+        rawDataNumbers[n] += 1;
+    }
+
+    void calculateProbabilityAndEntropies()
+    {
+        for (int n = 1; n <= n_gram; ++ n)
+            for (map<string, StatisticData>::iterator it = dataMaps[n].begin();
+                 it != dataMaps[n].end(); ++ it)
+            {
+                StatisticData& pieceData = it->second;
+                pieceData.probability = ((float) pieceData.count) / ((float) rawDataNumbers[n]);
+                pieceData.entropy = (-1.0f) * pieceData.probability * log2(pieceData.probability);
+            }
+    }
+
+    float calculateInteractionInformation(const string& keyString)
+    {
+        vector<unsigned int> ids;
+        for (size_t pos = 0; pos < keyString.size(); )
+        {
+            size_t end = keyString.find('-', pos);
+            if (end == string::npos)
+                end = keyString.size();
+            ids.push_back(atoi(keyString.substr(pos, end - pos).c_str()));
+            pos = end + 1;
+        }
+
+        int n_max = ids.size();
+        float interactionInfo = 0.0f;
+        for (uint32_t subset = 1; subset < (1u << n_max); ++ subset)
+        {
+            vector<unsigned int> sub;
+            for (int i = 0; i < n_max; ++ i)
+                if (subset & (1u << i))
+                    sub.push_back(ids[i]);
+
+            map<string, StatisticData>::iterator it =
+                dataMaps[sub.size()].find(makeKeyString(&sub[0], sub.size()));
+            if (it == dataMaps[sub.size()].end())
+                continue;
+
+            if (sub.size() % 2 == 1)
+                interactionInfo += it->second.entropy;
+            else
+                interactionInfo -= it->second.entropy;
+        }
+        return interactionInfo;
+    }
+
+    void calculateInteractionInformations()
+    {
+        for (int n = 1; n <= n_gram; ++ n)
+            for (map<string, StatisticData>::iterator it = dataMaps[n].begin();
+                 it != dataMaps[n].end(); ++ it)
+                it->second.interactionInformation = calculateInteractionInformation(it->first);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    size_t length = argc > 1 ? atol(argv[1]) : 200000;
+    int n_gram = argc > 2 ? atoi(argv[2]) : 4;
+    unsigned int n_ids = argc > 3 ? atoi(argv[3]) : 2000;
+    unsigned int n_threads = argc > 4 ? atoi(argv[4]) : 0;
+
+    // Zipf-like distribution of the ids
+    vector<double> weights;
+    for (unsigned int i = 1; i <= n_ids; ++ i)
+        weights.push_back(1.0 / i);
+    mt19937 rng(42);
+    discrete_distribution<unsigned int> zipf(weights.begin(), weights.end());
+    vector<unsigned int> sequence;
+    for (size_t i = 0; i < length; ++ i)
+        sequence.push_back(zipf(rng));
+
+    printf("%lu ids, %d-grams, %u distinct ids\n",
+           (unsigned long) length, n_gram, n_ids);
+
+    bench_clock::time_point start = bench_clock::now();
+    StringStatistics strings(n_gram);
+    for (size_t i = 0; i < length; ++ i)
+        for (int n = 1; n <= n_gram && i + n <= length; ++ n)
+            strings.addOneRawDataCount(n, &sequence[i]);
+    double stringCountTime = seconds_since(start);
+    start = bench_clock::now();
+    strings.calculateProbabilityAndEntropies();
+    strings.calculateInteractionInformations();
+    double stringEvalTime = seconds_since(start);
+
+    start = bench_clock::now();
+    NGramStatistics stats(n_gram, false);
+    stats.addSequence(&sequence[0], length);
+    double countTime = seconds_since(start);
+    start = bench_clock::now();
+    stats.calculateInteractionInformations(n_threads);
+    double evalTime = seconds_since(start);
+
+    // both must give the same results
+    double maxDiff = 0.0;
+    size_t entries = 0;
+    for (int n = 1; n <= n_gram; ++ n)
+    {
+        const NGramCountTable& table = stats.getTable(n);
+        const vector<float>& ii = stats.getEntryInteractionInformations(n);
+        for (size_t entry = 0; entry < table.size(); ++ entry)
+        {
+            string key = makeKeyString(table.getEntryKey(entry), n);
+            const StatisticData& pieceData = strings.dataMaps[n].find(key)->second;
+            maxDiff = max(maxDiff, (double) fabs(pieceData.interactionInformation - ii[entry]));
+        }
+        entries += table.size();
+    }
+    size_t stringEntries = 0;
+    for (int n = 1; n <= n_gram; ++ n)
+        stringEntries += strings.dataMaps[n].size();
+
+    printf("string keyed maps:  count %.3fs, evaluate %.3fs\n",
+           stringCountTime, stringEvalTime);
+    printf("NGramStatistics:    count %.3fs, evaluate %.3fs\n",
+           countTime, evalTime);
+    printf("%lu n-grams (%lu), max difference of the interaction informations %g\n",
+           (unsigned long) entries, (unsigned long) stringEntries, maxDiff);
+
+    return (entries == stringEntries && maxDiff < 1e-4) ? 0 : 1;
+}
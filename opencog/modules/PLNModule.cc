@@ -21,9 +21,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <tbb/task.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
 
-#include <opencog/util/tbb.h>
 #include <opencog/util/Config.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/rule-engine/forwardchainer/DefaultForwardChainerCB.h>
@@ -37,10 +39,24 @@ using namespace opencog;
 DECLARE_MODULE(PLNModule);
 
 PLNModule::PLNModule(CogServer& cs) :
-        Module(cs)
+        Module(cs),
+        queue_(config().has("PLN_TRIGGER_QUEUE_SIZE") ?
+               std::max(1, config().get_int("PLN_TRIGGER_QUEUE_SIZE")) : 1000,
+               [this](const Handle& h) { return source_sti(h); }),
+        window_ms_(100), stopping_(false), chained_(0), failed_(0)
 {
     as_ = &cs.getAtomSpace();
 
+    if (config().has("PLN_TRIGGER_WINDOW"))
+        window_ms_ = config().get_int("PLN_TRIGGER_WINDOW");
+    unsigned int n_workers = 1;
+    if (config().has("PLN_TRIGGER_WORKERS"))
+        n_workers = std::max(1, config().get_int("PLN_TRIGGER_WORKERS"));
+
+    dispatcher_ = std::thread(&PLNModule::dispatch_loop, this);
+    for (unsigned int i = 0; i < n_workers; i++)
+        workers_.push_back(std::thread(&PLNModule::worker_loop, this));
+
     enum StartingCondition {
         ATOM_ADDED = 1, ADDED_TO_AF, BOTH
     };
@@ -75,6 +91,18 @@ PLNModule::~PLNModule()
     logger().info("Destroying PLNModule instance.");
     add_atom_connection_.disconnect();
     add_af_connection_.disconnect();
+    do_pln_stats_unregister();
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mtx_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    dispatcher_.join();
+
+    queue_.close();
+    for (std::thread& worker : workers_)
+        worker.join();
 }
 
 void PLNModule::run()
@@ -85,50 +113,89 @@ void PLNModule::run()
 void PLNModule::init()
 {
     logger().info("Initializing PLNModule.");
+    do_pln_stats_register();
 }
-/*
- * Create a task to handle the add_af_signal_handler event to avoid blocking.
+
+/**
+ * Signal handlers only record the source; they run in the thread that
+ * changed the atomspace, so they must not wait for the chainer.
  */
 void PLNModule::add_af_signal(const Handle& source,
                               const AttentionValuePtr& av_old,
                               const AttentionValuePtr& av_new)
 {
-    tbb_enqueue_lambda([=] {
-        add_af_signal_handler(source, av_old, av_new);
-    });
+    queue_.trigger(source);
+}
+
+void PLNModule::add_atom_signal(const Handle& new_atom)
+{
+    queue_.trigger(new_atom);
 }
 
 /**
- * Whenever an atom enters in to the attentional focus,  start PLN reasoning.
- * This can be seen as a reactive(event-condition-action) type of rule engine
- * scenario.
+ * At the end of each window, queue the sources triggered during it,
+ * by STI.
  */
-void PLNModule::add_af_signal_handler(const Handle& h,
-                                      const AttentionValuePtr& av_old,
-                                      const AttentionValuePtr& av_new)
+void PLNModule::dispatch_loop()
 {
-    //!start the chainer xxx more code here
-    DefaultForwardChainerCB dfcb(as_);
-    ForwardChainer fc(as_, "I am broken now");
-    fc.do_chain(dfcb, h);
+    std::unique_lock<std::mutex> lock(stop_mtx_);
+    while (not stopping_) {
+        stop_cv_.wait_for(lock, std::chrono::milliseconds(window_ms_));
+        if (stopping_) break;
+
+        lock.unlock();
+        queue_.flush();
+        lock.lock();
+    }
 }
-/*
- * Create a task to handle the add_atom_signal_handler event to avoid blocking.
+
+/**
+ * The sources removed from the atomspace come last, and are skipped by
+ * the workers.
  */
-void PLNModule::add_atom_signal(const Handle& new_atom)
+PLNTriggerQueue::sti_t PLNModule::source_sti(const Handle& h) const
 {
-    tbb_enqueue_lambda([=] {
-        add_atom_signal_handler(new_atom);
-    });
+    if (not as_->isValidHandle(h))
+        return std::numeric_limits<PLNTriggerQueue::sti_t>::min();
+    return as_->getSTI(h);
 }
 
 /**
- * Whenever a new atom is added, start PLN reasoning.
+ * Whenever a new atom is added, or an atom enters in to the attentional
+ * focus, start PLN reasoning. This can be seen as a reactive
+ * (event-condition-action) type of rule engine scenario. The chainer is
+ * built once per worker and reused for every source.
  */
-void PLNModule::add_atom_signal_handler(const Handle& h)
+void PLNModule::worker_loop()
 {
-    //!Start the chainer xxx more code here/
+    //!start the chainer xxx more code here
     DefaultForwardChainerCB dfcb(as_);
     ForwardChainer fc(as_, "I am still very broken");
-    fc.do_chain(dfcb, h);
+
+    Handle h;
+    while (queue_.pop(h)) {
+        // The atom may have been removed while it was waiting.
+        if (not as_->isValidHandle(h)) continue;
+        try {
+            fc.do_chain(dfcb, h);
+            chained_++;
+        } catch (const std::exception& e) {
+            failed_++;
+            logger().error("PLNModule: chaining failed: %s", e.what());
+        }
+    }
+}
+
+std::string PLNModule::do_pln_stats(Request *dummy, std::list<std::string> args)
+{
+    PLNTriggerQueue::Stats stats = queue_.stats();
+    std::ostringstream oss;
+    oss << "received:  " << stats.received << std::endl
+        << "coalesced: " << stats.coalesced << std::endl
+        << "queued:    " << stats.queued << std::endl
+        << "dropped:   " << stats.dropped << std::endl
+        << "full:      " << stats.full << std::endl
+        << "chained:   " << chained_ << std::endl
+        << "failed:    " << failed_ << std::endl;
+    return oss.str();
 }
@@ -24,10 +24,19 @@
 #ifndef PLNAGENT_H_
 #define PLNAGENT_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <boost/signals2.hpp>
 
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/server/Module.h>
+#include <opencog/server/Request.h>
+
+#include "PLNTriggerQueue.h"
 
 namespace opencog
 {
@@ -38,6 +47,13 @@ namespace opencog
  * (Reactive rule engine ). Having this functionality will also help
  * us experiment with the dynamics of ECAN together with PLN
  * reasoning.
+ *
+ * The events are not chained one by one: they are coalesced into a
+ * PLNTriggerQueue during PLN_TRIGGER_WINDOW milliseconds, and then
+ * chained by PLN_TRIGGER_WORKERS threads, highest STI first, each one
+ * reusing the same chainer. When more than PLN_TRIGGER_QUEUE_SIZE
+ * sources are waiting, the ones with the lowest STI are dropped. The
+ * counters are reported by the pln-stats command.
  */
 class CogServer;
 class AtomSpace;
@@ -46,6 +62,30 @@ private:
     AtomSpace * as_;
     boost::signals2::connection add_af_connection_; //!atom entering to AF
     boost::signals2::connection add_atom_connection_; //!atom creation
+
+    PLNTriggerQueue queue_;
+    unsigned int window_ms_;
+
+    std::thread dispatcher_;
+    std::vector<std::thread> workers_;
+    bool stopping_;
+    std::mutex stop_mtx_;
+    std::condition_variable stop_cv_;
+
+    std::atomic<size_t> chained_;
+    std::atomic<size_t> failed_;
+
+    void dispatch_loop();
+    void worker_loop();
+    PLNTriggerQueue::sti_t source_sti(const Handle&) const;
+
+    DECLARE_CMD_REQUEST(PLNModule, "pln-stats", do_pln_stats,
+       "Show the counters of the reactive rule engine",
+       "Usage: pln-stats\n\n"
+       "Show how many trigger events were received, coalesced and\n"
+       "dropped, how many sources are waiting, and how many were chained.",
+       false, false)
+
 public:
     PLNModule(CogServer&);
     virtual ~PLNModule();
@@ -56,11 +96,8 @@ public:
     //! Attentional focus events
     void add_af_signal(const Handle&, const AttentionValuePtr&,
                        const AttentionValuePtr&);
-    void add_af_signal_handler(const Handle&, const AttentionValuePtr&,
-                               const AttentionValuePtr&);
     //! Atom added events
     void add_atom_signal(const Handle&);
-    void add_atom_signal_handler(const Handle&);
 
 };
 } /* namespace opencog*/
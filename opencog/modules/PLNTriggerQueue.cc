@@ -0,0 +1,141 @@
+/*
+ * PLNTriggerQueue.cc
+ *
+ * Copyright (C) 2015 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <iterator>
+#include <vector>
+
+#include "PLNTriggerQueue.h"
+
+using namespace opencog;
+
+PLNTriggerQueue::PLNTriggerQueue(size_t capacity, const Priority& priority) :
+        capacity_(capacity), priority_(priority), closed_(false)
+{
+    stats_ = Stats();
+}
+
+void PLNTriggerQueue::trigger(const Handle& h)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    stats_.received++;
+    if (queued_.count(h) or not pending_.insert(h).second)
+        stats_.coalesced++;
+}
+
+size_t PLNTriggerQueue::flush()
+{
+    std::set<Handle> window;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        window.swap(pending_);
+    }
+    if (window.empty()) return 0;
+
+    // Don't hold the lock while looking up the STIs in the atomspace.
+    std::vector<std::pair<sti_t, Handle>> sources;
+    sources.reserve(window.size());
+    for (const Handle& h : window)
+        sources.push_back(std::make_pair(priority_(h), h));
+
+    std::set<Handle> added;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        bool full = false;
+        for (const auto& source : sources) {
+            if (not queued_.insert(source.second).second) {
+                stats_.coalesced++;
+                continue;
+            }
+            queue_.insert(source);
+            added.insert(source.second);
+            Handle evicted;
+            if (evict_lowest(evicted)) {
+                full = true;
+                added.erase(evicted);
+            }
+        }
+        if (full) stats_.full++;
+    }
+    if (not added.empty()) cv_.notify_all();
+    return added.size();
+}
+
+bool PLNTriggerQueue::evict_lowest(Handle& evicted)
+{
+    if (queue_.size() <= capacity_) return false;
+
+    // Evict the lowest priority; ties evict the oldest.
+    auto lowest = queue_.begin();
+    evicted = lowest->second;
+    queued_.erase(evicted);
+    queue_.erase(lowest);
+    stats_.dropped++;
+    return true;
+}
+
+bool PLNTriggerQueue::pop(Handle& h)
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        while (not closed_ and queue_.empty())
+            cv_.wait(lock);
+        if (closed_) return false;
+
+        // Take the source out while its priority is looked up again; it
+        // stays in queued_, so that it is not queued twice meanwhile.
+        auto highest = std::prev(queue_.end());
+        h = highest->second;
+        queue_.erase(highest);
+        lock.unlock();
+        sti_t sti = priority_(h);
+        lock.lock();
+
+        if (closed_ or queue_.empty() or
+            std::prev(queue_.end())->first <= sti) {
+            queued_.erase(h);
+            return not closed_;
+        }
+
+        // Its STI fell below the one of the next source: put it back in
+        // its place. Another flush may have filled the queue meanwhile.
+        queue_.insert(std::make_pair(sti, h));
+        Handle evicted;
+        evict_lowest(evicted);
+    }
+}
+
+void PLNTriggerQueue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+PLNTriggerQueue::Stats PLNTriggerQueue::stats() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    Stats s = stats_;
+    s.queued = queue_.size();
+    return s;
+}
@@ -0,0 +1,113 @@
+/*
+ * PLNTriggerQueue.h
+ *
+ * Copyright (C) 2015 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PLNTRIGGERQUEUE_H_
+#define PLNTRIGGERQUEUE_H_
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include <opencog/atomspace/AttentionValue.h>
+#include <opencog/atomspace/Handle.h>
+
+namespace opencog
+{
+/**
+ * The sources waiting to be chained by the PLNModule.
+ *
+ * Trigger events are first coalesced: the sources triggered during a
+ * time window are gathered in a set, so that an atom added and then
+ * entering the attentional focus, or triggered several times, is only
+ * chained once. At the end of the window, flush() moves them to a
+ * bounded work queue, ordered by the STI of the source. A source that
+ * is already queued is not queued again. When the queue is full, the
+ * source with the lowest STI is dropped, which may be the incoming one.
+ *
+ * The STI of a source may change while it waits: pop() looks it up
+ * again, and puts the source back in its place if it is no longer the
+ * highest.
+ *
+ * All the methods are thread-safe.
+ */
+class PLNTriggerQueue
+{
+public:
+    typedef AttentionValue::sti_t sti_t;
+    typedef std::function<sti_t(const Handle&)> Priority;
+
+    struct Stats
+    {
+        size_t received;   //! trigger events
+        size_t coalesced;  //! events whose source was already pending or queued
+        size_t dropped;    //! sources dropped because the queue was full
+        size_t full;       //! windows flushed into a full queue
+        size_t queued;     //! sources in the queue now
+    };
+
+    /**
+     * The priority of a source is looked up without holding the lock,
+     * since trigger() may be called with the atomspace locked.
+     */
+    PLNTriggerQueue(size_t capacity, const Priority&);
+
+    /** Record a trigger event. Only takes a lock; never blocks on chaining. */
+    void trigger(const Handle&);
+
+    /**
+     * Move the sources triggered since the last flush to the work queue.
+     * Return the number of sources queued.
+     */
+    size_t flush();
+
+    /**
+     * Wait for the source with the highest priority, and remove it from
+     * the queue. Return false once the queue is closed.
+     */
+    bool pop(Handle&);
+
+    /** Wake up and stop the threads waiting in pop(). */
+    void close();
+
+    Stats stats() const;
+
+private:
+    size_t capacity_;
+    Priority priority_;
+    bool closed_;
+    Stats stats_;
+
+    std::set<Handle> pending_;
+    std::multimap<sti_t, Handle> queue_;
+    std::set<Handle> queued_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+
+    // Drop the source with the lowest priority if the queue is over
+    // capacity, and return true. Called with the lock held.
+    bool evict_lowest(Handle& evicted);
+};
+} /* namespace opencog*/
+#endif /* PLNTRIGGERQUEUE_H_ */
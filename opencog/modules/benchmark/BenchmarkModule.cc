@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iomanip>
@@ -39,18 +40,28 @@
 #include <opencog/util/oc_omp.h>
 
 #include "BenchmarkModule.h"
+#include "BenchmarkScenarios.h"
 
 using namespace std;
 using namespace opencog;
 
 DECLARE_MODULE(BenchmarkModule)
 
-BenchmarkModule::BenchmarkModule(CogServer& cs) : Module(cs)
+BenchmarkModule::BenchmarkModule(CogServer& cs) : Module(cs),
+    backgroundRunning(false)
 {
     logger().info("[BenchmarkModule] constructor");
     this->as = &cs.getAtomSpace();
 
+    registerScenario(BenchmarkScenarioPtr(new AgentCycleScenario()));
+    registerScenario(BenchmarkScenarioPtr(new AttentionScenario()));
+    registerScenario(BenchmarkScenarioPtr(new CommandScenario()));
+    registerScenario(BenchmarkScenarioPtr(new PersistScenario()));
+    registerScenario(BenchmarkScenarioPtr(new PatternMinerScenario()));
+    registerScenario(BenchmarkScenarioPtr(new RequestLatencyScenario()));
+
     do_fullyConnectedTest_register();
+    do_benchmark_register();
 }
 
 void BenchmarkModule::init(void)
@@ -67,6 +78,19 @@ BenchmarkModule::~BenchmarkModule()
     logger().info("Terminating BenchmarkModule.");
 
     do_fullyConnectedTest_unregister();
+    do_benchmark_unregister();
+
+    // The server loop is busy unloading this module, so a background
+    // scenario waiting for it has to be cancelled
+    for (auto& scenario : scenarios)
+        scenario.second->cancel();
+    if (backgroundThread.joinable())
+        backgroundThread.join();
+}
+
+void BenchmarkModule::registerScenario(BenchmarkScenarioPtr scenario)
+{
+    scenarios[scenario->name()] = scenario;
 }
 
 int BenchmarkModule::fullyConnectedTestConcurrent(int numAtoms)
@@ -206,3 +230,124 @@ BenchmarkModule::do_fullyConnectedTest(Request *dummy,
             std::to_string(numThreads) + "\n";
     return message;
 }
+
+std::string BenchmarkModule::listScenarios(void)
+{
+    std::string message = "Benchmark scenarios:\n";
+    std::map<std::string, BenchmarkScenarioPtr>::const_iterator it;
+    for (it = scenarios.begin(); it != scenarios.end(); ++it) {
+        const BenchmarkScenario& scenario = *it->second;
+        message += "  " + it->first;
+        if (*scenario.usage() != '\0')
+            message += std::string(" ") + scenario.usage();
+        message += "\n      " + std::string(scenario.description()) + "\n";
+    }
+    return message;
+}
+
+std::string BenchmarkModule::reportResult(const BenchmarkResult& result,
+                                          const std::string& format,
+                                          const std::string& output)
+{
+    if (output.empty())
+        return result.format(format);
+
+    // The CSV header is only written at the start of the file, so that a
+    // file can collect the results of many runs
+    bool withHeader;
+    {
+        std::ifstream existing(output.c_str());
+        withHeader = !existing.good() || existing.peek() == EOF;
+    }
+
+    std::ofstream out(output.c_str(), std::ios::app);
+    if (!out.good())
+        return result.toText() + "Error: can't write to " + output + "\n";
+    out << result.format(format, withHeader);
+    return result.toText() + "Results appended to " + output + "\n";
+}
+
+std::string
+BenchmarkModule::do_benchmark(Request *dummy, std::list<std::string> args)
+{
+    std::vector<std::string> argv{ std::begin(args), std::end(args) };
+
+    if (argv.empty() || argv[0] == "list")
+        return listScenarios();
+
+    if (argv[0] != "run" || argv.size() < 2)
+        return "Error, unrecognized argument. Usage:\n"
+               "  benchmark list\n"
+               "  benchmark run SCENARIO [--iterations N] [--warmup N] "
+               "[--format text|csv|json] [--output FILE] [ARGS...]\n";
+
+    std::map<std::string, BenchmarkScenarioPtr>::iterator it =
+        scenarios.find(argv[1]);
+    if (it == scenarios.end())
+        return "Error: unknown scenario " + argv[1] + ".\n" + listScenarios();
+    BenchmarkScenarioPtr scenario = it->second;
+
+    int iterations = 10;
+    int warmup = 1;
+    std::string format = "text";
+    std::string output;
+    std::vector<std::string> scenarioArgs;
+    for (size_t i = 2; i < argv.size(); i++) {
+        const std::string& arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            scenarioArgs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argv.size())
+            return "Error: missing value for " + arg + ".\n";
+        const std::string& value = argv[++i];
+        try
+        {
+            if (arg == "--iterations")
+                iterations = std::stoi(value);
+            else if (arg == "--warmup")
+                warmup = std::stoi(value);
+            else if (arg == "--format")
+                format = value;
+            else if (arg == "--output")
+                output = value;
+            else
+                return "Error: unknown option " + arg + ".\n";
+        }
+        catch(std::invalid_argument& e)
+        {
+            return "Error: " + arg + " must be an integer.\n";
+        }
+    }
+    if (iterations < 1 || warmup < 0)
+        return "Error: --iterations must be positive and --warmup must not "
+               "be negative.\n";
+    if (format != "text" && format != "csv" && format != "json")
+        return "Error: --format must be text, csv or json.\n";
+
+    if (!scenario->needsServerLoop())
+        return reportResult(runBenchmark(*scenario, scenarioArgs,
+                                         iterations, warmup),
+                            format, output);
+
+    // This command runs in the server loop, which must go on to process
+    // the requests of the scenario
+    if (backgroundRunning)
+        return "Error: a background benchmark is already running.\n";
+    if (backgroundThread.joinable())
+        backgroundThread.join();
+
+    backgroundRunning = true;
+    backgroundThread = std::thread([this, scenario, scenarioArgs,
+                                    iterations, warmup, format, output]()
+    {
+        BenchmarkResult result =
+            runBenchmark(*scenario, scenarioArgs, iterations, warmup);
+        std::string report = reportResult(result, format, output);
+        logger().info("[BenchmarkModule] %s", report.c_str());
+        backgroundRunning = false;
+    });
+
+    return "Running " + argv[1] + " in the background, the results will "
+           "be written to " + (output.empty() ? "the log" : output) + ".\n";
+}
@@ -25,11 +25,16 @@
 #ifndef _OPENCOG_BENCHMARK_MODULE_H
 #define _OPENCOG_BENCHMARK_MODULE_H
 
+#include <atomic>
+#include <map>
 #include <string>
+#include <thread>
 
 #include <opencog/server/Module.h>
 #include <opencog/server/CogServer.h>
 
+#include "BenchmarkScenario.h"
+
 namespace opencog
 {
 
@@ -75,6 +80,44 @@ class BenchmarkModule : public Module
          */
         int updateSTITestConcurrent(void);
 
+        /*
+         * Runs one of the registered benchmark scenarios and reports its
+         * timings, percentiles and memory usage.
+         *
+         * Invoked from the CogServer shell. Syntax:
+         *   benchmark list
+         *   benchmark run SCENARIO [--iterations N] [--warmup N]
+         *                          [--format text|csv|json] [--output FILE]
+         *                          [ARGS...]
+         *
+         * The results are appended to FILE if given. Scenarios that need
+         * the server loop to keep running are run in a background thread,
+         * and their results go to FILE or to the log.
+         */
+        DECLARE_CMD_REQUEST(BenchmarkModule, "benchmark",
+           do_benchmark,
+           "Run a CogServer benchmark scenario",
+           "Usage: benchmark list\n"
+           "       benchmark run SCENARIO [--iterations N] [--warmup N] "
+           "[--format text|csv|json] [--output FILE] [ARGS...]\n"
+           "Run 'benchmark list' for the scenarios and their arguments.",
+           false, false)
+
+        std::map<std::string, BenchmarkScenarioPtr> scenarios;
+
+        std::thread backgroundThread;
+        std::atomic<bool> backgroundRunning;
+
+        std::string listScenarios(void);
+
+        /*
+         * Formats the result, and appends it to the output file if there
+         * is one. Returns the text for the shell.
+         */
+        std::string reportResult(const BenchmarkResult& result,
+                                 const std::string& format,
+                                 const std::string& output);
+
     public:
         BenchmarkModule(CogServer&);
         virtual ~BenchmarkModule();
@@ -82,6 +125,13 @@ class BenchmarkModule : public Module
 
         static const char *id(void);
         virtual void init(void);
+
+        /*
+         * Makes a scenario available to the 'benchmark' command. Other
+         * modules can add their own through
+         * cogserver().getModule("opencog::BenchmarkModule").
+         */
+        void registerScenario(BenchmarkScenarioPtr scenario);
 };
 
 }
@@ -0,0 +1,300 @@
+/*
+ * opencog/modules/benchmark/BenchmarkScenario.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <sstream>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/server/CogServer.h>
+#include <opencog/util/exceptions.h>
+
+#include "BenchmarkScenario.h"
+
+using namespace opencog;
+
+typedef std::chrono::steady_clock bench_clock;
+
+namespace
+{
+
+double cpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// high-water mark of the resident set size, in kilobytes
+long peakRSS()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// current resident set size, in kilobytes, or 0 where /proc is missing
+long currentRSS()
+{
+    long pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL) return 0;
+    if (fscanf(statm, "%*s %ld", &pages) != 1) pages = 0;
+    fclose(statm);
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if ((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string csvString(const std::string& s)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '"') out += '"';
+        out += s[i];
+    }
+    return out + "\"";
+}
+
+std::string number(double value)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", value);
+    return buf;
+}
+
+}
+
+double opencog::percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t) ceil(p / 100.0 * sorted.size());
+    if (rank > 0) rank--;
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+BenchmarkResult::BenchmarkResult()
+    : timestamp(0), warmup(0), iterations(0), operations(0),
+      atomsBefore(0), atomsAfter(0), wallTime(0.0), cpuTime(0.0),
+      minTime(0.0), meanTime(0.0), p50Time(0.0), p90Time(0.0),
+      p99Time(0.0), maxTime(0.0), rssBefore(0), rssAfter(0), rssPeak(0)
+{
+}
+
+double BenchmarkResult::operationsPerSecond() const
+{
+    return wallTime > 0.0 ? operations / wallTime : 0.0;
+}
+
+std::string BenchmarkResult::toText() const
+{
+    std::ostringstream out;
+    out << "Benchmark " << scenario;
+    if (!args.empty()) out << " " << args;
+    out << "\n";
+    if (!error.empty()) {
+        out << "Error: " << error << "\n";
+        return out.str();
+    }
+    out << iterations << " iterations (" << warmup << " warmup), "
+        << operations << " operations in " << number(wallTime) << " s, "
+        << number(operationsPerSecond()) << " operations/s\n"
+        << "Iteration time (us): min " << number(minTime)
+        << ", mean " << number(meanTime)
+        << ", p50 " << number(p50Time)
+        << ", p90 " << number(p90Time)
+        << ", p99 " << number(p99Time)
+        << ", max " << number(maxTime) << "\n"
+        << "CPU time: " << number(cpuTime) << " s\n"
+        << "RSS: " << rssBefore << " kB before, " << rssAfter
+        << " kB after, " << rssPeak << " kB peak\n"
+        << "Atoms: " << atomsBefore << " before, " << atomsAfter << " after\n";
+    return out.str();
+}
+
+std::string BenchmarkResult::toJSON() const
+{
+    std::ostringstream out;
+    out << "{\"scenario\":" << jsonString(scenario)
+        << ",\"args\":" << jsonString(args)
+        << ",\"timestamp\":" << timestamp
+        << ",\"warmup\":" << warmup
+        << ",\"iterations\":" << iterations
+        << ",\"operations\":" << operations
+        << ",\"wall_s\":" << number(wallTime)
+        << ",\"cpu_s\":" << number(cpuTime)
+        << ",\"ops_per_s\":" << number(operationsPerSecond())
+        << ",\"min_us\":" << number(minTime)
+        << ",\"mean_us\":" << number(meanTime)
+        << ",\"p50_us\":" << number(p50Time)
+        << ",\"p90_us\":" << number(p90Time)
+        << ",\"p99_us\":" << number(p99Time)
+        << ",\"max_us\":" << number(maxTime)
+        << ",\"rss_before_kb\":" << rssBefore
+        << ",\"rss_after_kb\":" << rssAfter
+        << ",\"rss_peak_kb\":" << rssPeak
+        << ",\"atoms_before\":" << atomsBefore
+        << ",\"atoms_after\":" << atomsAfter
+        << ",\"error\":" << jsonString(error)
+        << "}\n";
+    return out.str();
+}
+
+std::string BenchmarkResult::csvHeader()
+{
+    return "scenario,args,timestamp,warmup,iterations,operations,wall_s,"
+           "cpu_s,ops_per_s,min_us,mean_us,p50_us,p90_us,p99_us,max_us,"
+           "rss_before_kb,rss_after_kb,rss_peak_kb,atoms_before,atoms_after,"
+           "error\n";
+}
+
+std::string BenchmarkResult::toCSV() const
+{
+    std::ostringstream out;
+    out << csvString(scenario) << ","
+        << csvString(args) << ","
+        << timestamp << ","
+        << warmup << ","
+        << iterations << ","
+        << operations << ","
+        << number(wallTime) << ","
+        << number(cpuTime) << ","
+        << number(operationsPerSecond()) << ","
+        << number(minTime) << ","
+        << number(meanTime) << ","
+        << number(p50Time) << ","
+        << number(p90Time) << ","
+        << number(p99Time) << ","
+        << number(maxTime) << ","
+        << rssBefore << ","
+        << rssAfter << ","
+        << rssPeak << ","
+        << atomsBefore << ","
+        << atomsAfter << ","
+        << csvString(error) << "\n";
+    return out.str();
+}
+
+std::string BenchmarkResult::format(const std::string& fmt,
+                                    bool withHeader) const
+{
+    if (fmt == "json") return toJSON();
+    if (fmt == "csv") return withHeader ? csvHeader() + toCSV() : toCSV();
+    return toText();
+}
+
+BenchmarkResult opencog::runBenchmark(BenchmarkScenario& scenario,
+                                      const std::vector<std::string>& args,
+                                      unsigned int iterations,
+                                      unsigned int warmup)
+{
+    AtomSpace& as = cogserver().getAtomSpace();
+
+    BenchmarkResult result;
+    result.scenario = scenario.name();
+    for (size_t i = 0; i < args.size(); i++)
+        result.args += (i == 0 ? "" : " ") + args[i];
+    result.timestamp = time(NULL);
+    result.warmup = warmup;
+    result.iterations = iterations;
+
+    result.error = scenario.setUp(args);
+    if (!result.error.empty()) {
+        scenario.tearDown();
+        return result;
+    }
+
+    std::vector<double> times;
+    times.reserve(iterations);
+    try {
+        for (unsigned int i = 0; i < warmup; i++)
+            scenario.runIteration();
+
+        result.atomsBefore = as.getSize();
+        result.rssBefore = currentRSS();
+        double cpuStart = cpuSeconds();
+        bench_clock::time_point start = bench_clock::now();
+
+        for (unsigned int i = 0; i < iterations; i++) {
+            bench_clock::time_point iterationStart = bench_clock::now();
+            result.operations += scenario.runIteration();
+            times.push_back(std::chrono::duration<double, std::micro>(
+                bench_clock::now() - iterationStart).count());
+        }
+
+        result.wallTime = std::chrono::duration<double>(
+            bench_clock::now() - start).count();
+        result.cpuTime = cpuSeconds() - cpuStart;
+        result.rssAfter = currentRSS();
+        result.rssPeak = peakRSS();
+        result.atomsAfter = as.getSize();
+    }
+    catch (const StandardException& ex) {
+        result.error = ex.getMessage();
+    }
+    catch (const std::exception& ex) {
+        result.error = ex.what();
+    }
+    scenario.tearDown();
+
+    if (!times.empty()) {
+        std::sort(times.begin(), times.end());
+        double total = 0.0;
+        for (size_t i = 0; i < times.size(); i++)
+            total += times[i];
+        result.minTime = times.front();
+        result.maxTime = times.back();
+        result.meanTime = total / times.size();
+        result.p50Time = percentile(times, 50);
+        result.p90Time = percentile(times, 90);
+        result.p99Time = percentile(times, 99);
+    }
+    return result;
+}
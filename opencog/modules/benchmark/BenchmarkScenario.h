@@ -0,0 +1,153 @@
+/*
+ * opencog/modules/benchmark/BenchmarkScenario.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BENCHMARK_SCENARIO_H
+#define _OPENCOG_BENCHMARK_SCENARIO_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace opencog
+{
+
+/**
+ * A benchmark run by the 'benchmark' command of the BenchmarkModule.
+ *
+ * The runner calls setUp() once with the arguments given on the command
+ * line, then runIteration() for the warmup and the measured iterations,
+ * then tearDown(). Each iteration is timed on its own, so that latency
+ * percentiles can be computed.
+ *
+ * Scenarios are registered with BenchmarkModule::registerScenario(), so
+ * that other modules can add their own.
+ */
+class BenchmarkScenario
+{
+    public:
+        virtual ~BenchmarkScenario() {}
+
+        virtual const char* name() const = 0;
+        virtual const char* description() const = 0;
+        virtual const char* usage() const { return ""; }
+
+        /**
+         * Prepare the scenario. Return an error message if it can't be run
+         * with these arguments, or an empty string. tearDown() is called
+         * in both cases.
+         */
+        virtual std::string setUp(const std::vector<std::string>& args)
+        {
+            return "";
+        }
+
+        /**
+         * Run one iteration and return the number of operations it made
+         * (agents run, requests processed, ...), used for the throughput.
+         * Throw a RuntimeException on failure.
+         */
+        virtual size_t runIteration() = 0;
+
+        virtual void tearDown() {}
+
+        /**
+         * Whether the scenario needs the CogServer main loop to keep running
+         * while it is measured (e.g. to process the requests it sends over
+         * the network). Such scenarios are run in a background thread.
+         */
+        virtual bool needsServerLoop() const { return false; }
+
+        /**
+         * Ask a scenario running in the background to stop as soon as it
+         * can, e.g. because the module is being unloaded. Called from
+         * another thread; the iteration running may then throw.
+         */
+        virtual void cancel() {}
+};
+
+typedef std::shared_ptr<BenchmarkScenario> BenchmarkScenarioPtr;
+
+/**
+ * Measurements of one benchmark run.
+ */
+struct BenchmarkResult
+{
+    BenchmarkResult();
+
+    std::string scenario;
+    std::string args;
+    // seconds since epoch at the start of the run
+    long timestamp;
+    unsigned int warmup;
+    unsigned int iterations;
+    size_t operations;
+    size_t atomsBefore;
+    size_t atomsAfter;
+
+    // wall clock time of the measured iterations, in seconds
+    double wallTime;
+    // user + system CPU time of the process, in seconds
+    double cpuTime;
+    // per iteration wall clock times, in microseconds
+    double minTime;
+    double meanTime;
+    double p50Time;
+    double p90Time;
+    double p99Time;
+    double maxTime;
+
+    // resident set size before and after the run, and high-water mark of
+    // the process, in kilobytes
+    long rssBefore;
+    long rssAfter;
+    long rssPeak;
+
+    // empty if the run succeeded
+    std::string error;
+
+    double operationsPerSecond() const;
+
+    std::string toText() const;
+    std::string toJSON() const;
+    static std::string csvHeader();
+    std::string toCSV() const;
+
+    /** Format as "text", "csv" or "json". */
+    std::string format(const std::string& fmt, bool withHeader = true) const;
+};
+
+/**
+ * Run a scenario: setUp(args), warmup iterations, measured iterations,
+ * tearDown(). Errors are reported in BenchmarkResult::error.
+ */
+BenchmarkResult runBenchmark(BenchmarkScenario& scenario,
+                             const std::vector<std::string>& args,
+                             unsigned int iterations, unsigned int warmup);
+
+/**
+ * Nearest-rank percentile of sorted values, p in [0, 100].
+ */
+double percentile(const std::vector<double>& sorted, double p);
+
+} // namespace opencog
+
+#endif // _OPENCOG_BENCHMARK_SCENARIO_H
@@ -0,0 +1,357 @@
+/*
+ * opencog/modules/benchmark/BenchmarkScenarios.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <opencog/server/CogServer.h>
+#include <opencog/server/Request.h>
+#include <opencog/server/RequestResult.h>
+#include <opencog/server/SystemActivityTable.h>
+#include <opencog/util/Config.h>
+#include <opencog/util/exceptions.h>
+
+#include "BenchmarkScenarios.h"
+
+using namespace opencog;
+
+namespace
+{
+
+// Collects the output of a request executed by the benchmark
+class CapturedResult : public RequestResult
+{
+    public:
+        CapturedResult() : RequestResult("text/plain") {}
+
+        virtual void SendResult(const std::string& res) { output += res; }
+        virtual void OnRequestComplete() {}
+
+        std::string output;
+};
+
+bool parseUnsigned(const std::string& s, unsigned int& value)
+{
+    try {
+        size_t end;
+        unsigned long v = std::stoul(s, &end);
+        if (end != s.size()) return false;
+        value = v;
+        return true;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+}
+
+// ---------------------------------------------------------------------
+// agent-cycle
+
+std::string AgentCycleScenario::createAgents(const std::vector<std::string>& ids)
+{
+    _ownAgents = true;
+    for (size_t i = 0; i < ids.size(); i++) {
+        AgentPtr agent = cogserver().createAgent(ids[i], false);
+        if (!agent) {
+            _agents.clear();
+            return "Unknown agent " + ids[i] + ". Is its module loaded?";
+        }
+        _agents.push_back(agent);
+    }
+    return "";
+}
+
+std::string AgentCycleScenario::setUp(const std::vector<std::string>& args)
+{
+    _agents.clear();
+    _ownAgents = false;
+    if (!args.empty())
+        return createAgents(args);
+
+    _agents = cogserver().runningAgents();
+    if (_agents.empty())
+        return "No running agents. Start some, or give their ids.";
+    return "";
+}
+
+size_t AgentCycleScenario::runIteration()
+{
+    for (size_t i = 0; i < _agents.size(); i++)
+        cogserver().runAgent(_agents[i]);
+    return _agents.size();
+}
+
+void AgentCycleScenario::tearDown()
+{
+    // the activities of the running agents are kept, they are real ones
+    if (_ownAgents) {
+        for (size_t i = 0; i < _agents.size(); i++)
+            cogserver().systemActivityTable().clearActivity(_agents[i]);
+    }
+    _agents.clear();
+}
+
+// ---------------------------------------------------------------------
+// attention
+
+std::string AttentionScenario::setUp(const std::vector<std::string>& args)
+{
+    _agents.clear();
+    if (!args.empty())
+        return createAgents(args);
+
+    std::vector<std::string> ids;
+    ids.push_back("opencog::ImportanceUpdatingAgent");
+    ids.push_back("opencog::HebbianUpdatingAgent");
+    ids.push_back("opencog::ImportanceDiffusionAgent");
+    std::string error = createAgents(ids);
+    if (!error.empty())
+        return error + " The attention scenario needs libattention.so.";
+    return "";
+}
+
+// ---------------------------------------------------------------------
+// command
+
+std::string CommandScenario::setUp(const std::vector<std::string>& args)
+{
+    if (args.empty())
+        return "Missing COMMAND.";
+    _command = args[0];
+    _params.assign(args.begin() + 1, args.end());
+    _output.clear();
+
+    Request* request = cogserver().createRequest(_command);
+    if (request == NULL)
+        return "Unknown command " + _command + ".";
+    bool shell = request->isShell();
+    delete request;
+    if (shell)
+        return "Shell commands can't be benchmarked, give the expression "
+               "to evaluate to the shell on the command line instead.";
+    return "";
+}
+
+size_t CommandScenario::runIteration()
+{
+    Request* request = cogserver().createRequest(_command);
+    if (request == NULL)
+        throw RuntimeException(TRACE_INFO, "Command %s was unregistered",
+                               _command.c_str());
+
+    // declared before the request, which uses it until it is deleted
+    CapturedResult result;
+    request->setRequestResult(&result);
+    request->setParameters(_params);
+    request->execute();
+    delete request;
+
+    _output = result.output;
+    return 1;
+}
+
+// ---------------------------------------------------------------------
+// persist
+
+std::string PersistScenario::setUp(const std::vector<std::string>& args)
+{
+    std::string mode = args.empty() ? "store" : args[0];
+    if (args.size() > 1 || (mode != "store" && mode != "load"))
+        return "Usage: persist [store|load]";
+
+    std::vector<std::string> command(1, "sql-" + mode);
+    std::string error = CommandScenario::setUp(command);
+    if (!error.empty())
+        return error + " The persist scenario needs libPersistModule.so.";
+    return "";
+}
+
+size_t PersistScenario::runIteration()
+{
+    CommandScenario::runIteration();
+
+    // the PersistModule reports failures in its output only
+    if (_output.find("completed") == std::string::npos)
+        throw RuntimeException(TRACE_INFO, "%s failed: %s",
+                               _command.c_str(), _output.c_str());
+    return 1;
+}
+
+// ---------------------------------------------------------------------
+// pattern-miner
+
+PatternMinerScenario::~PatternMinerScenario()
+{
+    if (_library)
+        dlclose(_library);
+}
+
+std::string PatternMinerScenario::setUp(const std::vector<std::string>& args)
+{
+    _maxGram = 3;
+    _threshold = 2;
+    if ((args.size() > 0 && !parseUnsigned(args[0], _maxGram)) ||
+        (args.size() > 1 && !parseUnsigned(args[1], _threshold)) ||
+        args.size() > 2)
+        return "Usage: pattern-miner [MAX_GRAM] [THRESHOLD_FREQUENCY]";
+
+    if (!config().has("Pattern_mining_mode"))
+        return "The PatternMiner isn't configured. Load the settings of "
+               "lib/opencog_patternminer.conf in the CogServer config.";
+
+    if (!_run) {
+        std::string filename = config().has("PATTERN_MINER_LIBRARY") ?
+            config()["PATTERN_MINER_LIBRARY"] : "libPatternMiner.so";
+        // the same flags as CogServer::loadModule()
+        dlerror();
+        if (!_library)
+            _library = dlopen(filename.c_str(), RTLD_LAZY | RTLD_GLOBAL);
+        if (!_library)
+            return "Can't load " + filename + ": " + dlerror() +
+                   ". Set PATTERN_MINER_LIBRARY to the path of the "
+                   "PatternMiner library.";
+        _run = (RunFunction*) dlsym(_library, "opencog_pattern_miner_run");
+        if (!_run)
+            return "No opencog_pattern_miner_run in " + filename + ".";
+    }
+    return "";
+}
+
+size_t PatternMinerScenario::runIteration()
+{
+    _run(&cogserver().getAtomSpace(), _maxGram, _threshold);
+    return 1;
+}
+
+// ---------------------------------------------------------------------
+// request-latency
+
+// The sockets time out after a short while, so that a cancel() is seen
+// quickly, but a reply is only given up on after REPLY_TIMEOUT seconds.
+#define RECEIVE_TIMEOUT_MS 100
+#define REPLY_TIMEOUT 60
+
+std::string RequestLatencyScenario::setUp(const std::vector<std::string>& args)
+{
+    _cancelled = false;
+    size_t first = 0;
+    _connections = 1;
+    if (!args.empty() && parseUnsigned(args[0], _connections))
+        first = 1;
+    if (_connections == 0)
+        return "CONNECTIONS must be positive.";
+
+    _line.clear();
+    for (size_t i = first; i < args.size(); i++)
+        _line += (i == first ? "" : " ") + args[i];
+    if (_line.empty())
+        _line = "help";
+    _line += "\n";
+
+    // the prompt follows every reply of the console
+    _prompt = config().get_bool("ANSI_ENABLED") ?
+              config()["ANSI_PROMPT"] : config()["PROMPT"];
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config().get_int("SERVER_PORT"));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    try {
+        for (unsigned int i = 0; i < _connections; i++) {
+            int s = socket(AF_INET, SOCK_STREAM, 0);
+            if (s < 0)
+                return std::string("Can't create a socket: ") + strerror(errno);
+            _sockets.push_back(s);
+
+            struct timeval timeout;
+            timeout.tv_sec = 0;
+            timeout.tv_usec = RECEIVE_TIMEOUT_MS * 1000;
+            setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+            if (connect(s, (struct sockaddr*) &address, sizeof(address)) < 0)
+                return "Can't connect to port " + config()["SERVER_PORT"] +
+                       ": " + strerror(errno);
+            readReply(s);
+        }
+    }
+    catch (const StandardException& ex) {
+        return ex.getMessage();
+    }
+    return "";
+}
+
+void RequestLatencyScenario::readReply(int s)
+{
+    std::string received;
+    char buf[4096];
+    time_t deadline = time(NULL) + REPLY_TIMEOUT;
+    while (received.size() < _prompt.size() ||
+           received.compare(received.size() - _prompt.size(),
+                            _prompt.size(), _prompt) != 0)
+    {
+        if (_cancelled)
+            throw RuntimeException(TRACE_INFO, "Cancelled");
+
+        ssize_t n = recv(s, buf, sizeof(buf), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (time(NULL) >= deadline)
+                throw RuntimeException(TRACE_INFO,
+                    "No reply from the console in %d seconds", REPLY_TIMEOUT);
+            continue;
+        }
+        if (n <= 0)
+            throw RuntimeException(TRACE_INFO,
+                "No reply from the console: %s",
+                n == 0 ? "connection closed" : strerror(errno));
+        received.append(buf, n);
+    }
+}
+
+size_t RequestLatencyScenario::runIteration()
+{
+    for (size_t i = 0; i < _sockets.size(); i++) {
+        if (send(_sockets[i], _line.c_str(), _line.size(), 0) < 0)
+            throw RuntimeException(TRACE_INFO, "Can't send the request: %s",
+                                   strerror(errno));
+    }
+    for (size_t i = 0; i < _sockets.size(); i++)
+        readReply(_sockets[i]);
+    return _sockets.size();
+}
+
+void RequestLatencyScenario::tearDown()
+{
+    for (size_t i = 0; i < _sockets.size(); i++)
+        close(_sockets[i]);
+    _sockets.clear();
+}
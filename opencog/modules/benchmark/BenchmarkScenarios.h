@@ -0,0 +1,219 @@
+/*
+ * opencog/modules/benchmark/BenchmarkScenarios.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BENCHMARK_SCENARIOS_H
+#define _OPENCOG_BENCHMARK_SCENARIOS_H
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <opencog/server/CogServer.h>
+
+#include "BenchmarkScenario.h"
+
+namespace opencog
+{
+
+/**
+ * Run a set of MindAgents once per iteration, as the CogServer does in
+ * one cycle, through CogServer::runAgent() so that the
+ * SystemActivityTable records them too.
+ *
+ * Arguments: AGENT_ID... The running agents are used if none is given,
+ * otherwise new instances of the given agents are created for the run.
+ */
+class AgentCycleScenario : public BenchmarkScenario
+{
+    public:
+        AgentCycleScenario() : _ownAgents(false) {}
+
+        virtual const char* name() const { return "agent-cycle"; }
+        virtual const char* description() const
+        {
+            return "Throughput of MindAgent cycles";
+        }
+        virtual const char* usage() const { return "[AGENT_ID...]"; }
+
+        virtual std::string setUp(const std::vector<std::string>& args);
+        virtual size_t runIteration();
+        virtual void tearDown();
+
+    protected:
+        std::string createAgents(const std::vector<std::string>& ids);
+
+        AgentSeq _agents;
+        // whether the agents were created for the run
+        bool _ownAgents;
+};
+
+/**
+ * The agent cycle of the ECAN attention allocation agents of the
+ * AttentionModule, which must be loaded.
+ *
+ * Arguments: [AGENT_ID...] to replace the default agents.
+ */
+class AttentionScenario : public AgentCycleScenario
+{
+    public:
+        virtual const char* name() const { return "attention"; }
+        virtual const char* description() const
+        {
+            return "Attention allocation (ECAN) agent cycles";
+        }
+
+        virtual std::string setUp(const std::vector<std::string>& args);
+};
+
+/**
+ * Execute a CogServer command in-process once per iteration, as the
+ * server loop does, without the network.
+ *
+ * Arguments: COMMAND [ARGS...]
+ */
+class CommandScenario : public BenchmarkScenario
+{
+    public:
+        virtual const char* name() const { return "command"; }
+        virtual const char* description() const
+        {
+            return "Execution time of any CogServer command";
+        }
+        virtual const char* usage() const { return "COMMAND [ARGS...]"; }
+
+        virtual std::string setUp(const std::vector<std::string>& args);
+        virtual size_t runIteration();
+
+        // output of the last iteration
+        const std::string& lastOutput() const { return _output; }
+
+    protected:
+        std::string _command;
+        std::list<std::string> _params;
+        std::string _output;
+};
+
+/**
+ * Store the AtomSpace to, or load it from, the SQL database of the
+ * PersistModule, which must be loaded and connected with sql-open.
+ *
+ * Arguments: [store|load], store by default.
+ */
+class PersistScenario : public CommandScenario
+{
+    public:
+        virtual const char* name() const { return "persist"; }
+        virtual const char* description() const
+        {
+            return "SQL persistence with sql-store or sql-load";
+        }
+        virtual const char* usage() const { return "[store|load]"; }
+
+        virtual std::string setUp(const std::vector<std::string>& args);
+        virtual size_t runIteration();
+};
+
+/**
+ * Mine the patterns of the AtomSpace of the CogServer with the
+ * PatternMiner, configured as in lib/opencog_patternminer.conf.
+ *
+ * The PatternMiner library is loaded when the scenario is first set up,
+ * from PATTERN_MINER_LIBRARY (libPatternMiner.so by default), so that
+ * this module doesn't depend on it.
+ *
+ * Arguments: [MAX_GRAM] [THRESHOLD_FREQUENCY], 3 and 2 by default.
+ */
+class PatternMinerScenario : public BenchmarkScenario
+{
+    public:
+        PatternMinerScenario() : _maxGram(3), _threshold(2),
+                                 _library(NULL), _run(NULL) {}
+        virtual ~PatternMinerScenario();
+
+        virtual const char* name() const { return "pattern-miner"; }
+        virtual const char* description() const
+        {
+            return "One PatternMiner run over the AtomSpace";
+        }
+        virtual const char* usage() const
+        {
+            return "[MAX_GRAM] [THRESHOLD_FREQUENCY]";
+        }
+
+        virtual std::string setUp(const std::vector<std::string>& args);
+        virtual size_t runIteration();
+
+    private:
+        // opencog_pattern_miner_run() of the PatternMiner library
+        typedef void RunFunction(AtomSpace*, unsigned int, unsigned int);
+
+        unsigned int _maxGram;
+        unsigned int _threshold;
+        void* _library;
+        RunFunction* _run;
+};
+
+/**
+ * Round-trip latency of requests sent to the console port of this
+ * CogServer (SERVER_PORT), the way telnet and the shells do. Each
+ * iteration sends the command on all the connections at once, and
+ * completes when all of them have received the reply and the prompt.
+ *
+ * The requests are processed by the server loop, so this scenario runs
+ * in a background thread.
+ *
+ * Arguments: [CONNECTIONS] [COMMAND...], 1 and "help" by default.
+ */
+class RequestLatencyScenario : public BenchmarkScenario
+{
+    public:
+        RequestLatencyScenario() : _connections(1), _cancelled(false) {}
+
+        virtual const char* name() const { return "request-latency"; }
+        virtual const char* description() const
+        {
+            return "Latency of requests over the console socket";
+        }
+        virtual const char* usage() const { return "[CONNECTIONS] [COMMAND...]"; }
+
+        virtual std::string setUp(const std::vector<std::string>& args);
+        virtual size_t runIteration();
+        virtual void tearDown();
+
+        virtual bool needsServerLoop() const { return true; }
+        virtual void cancel() { _cancelled = true; }
+
+    private:
+        // read from the socket until the data ends with the prompt
+        void readReply(int socket);
+
+        unsigned int _connections;
+        std::string _line;
+        std::string _prompt;
+        std::vector<int> _sockets;
+        std::atomic<bool> _cancelled;
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_BENCHMARK_SCENARIOS_H
@@ -34,6 +34,8 @@
 #include <tbb/task.h>
 #include <tbb/concurrent_queue.h>
 #include <opencog/util/tbb.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <thread>
 #include <iomanip>
@@ -50,6 +52,17 @@ AtomSpacePublisherModule::AtomSpacePublisherModule(CogServer& cs) : Module(cs)
     logger().info("[AtomSpacePublisherModule] constructor");
     this->as = &cs.getAtomSpace();
 
+    binaryEncoding = config().has("ZMQ_EVENT_ENCODING") &&
+        config().get("ZMQ_EVENT_ENCODING") == "binary";
+    batchWindow = 50;
+    if (config().has("ZMQ_EVENT_BATCH_WINDOW"))
+        batchWindow = config().get_int("ZMQ_EVENT_BATCH_WINDOW");
+    terminating = false;
+    context = NULL;
+    // Nothing is published until a subscriber shows up
+    typeCount = classserver().getNumberOfClasses();
+    subscribed.assign(NUMBER_OF_PUBLISHER_EVENTS * typeCount, false);
+
     enableSignals();
 
     do_publisherEnableSignals_register();
@@ -72,12 +85,16 @@ AtomSpacePublisherModule::~AtomSpacePublisherModule()
     
     disableSignals();
     
-    // Shut down the ZeroMQ proxy loop
+    // Shut down the ZeroMQ proxy loop, and wait for it to close its
+    // socket before the context goes
+    terminating = true;
     message_t message;
     message.type = "CONTROL";
     message.payload = "TERMINATE";
     queue.push(message); 
-    context->close();
+    if (proxyThread.joinable())
+        proxyThread.join();
+    delete context;
     
     do_publisherEnableSignals_unregister();
     do_publisherDisableSignals_unregister();
@@ -148,14 +165,18 @@ void AtomSpacePublisherModule::disableSignals()
 void AtomSpacePublisherModule::InitZeroMQ()
 {
     context = new zmq::context_t(1);
-    std::thread proxyThread(&AtomSpacePublisherModule::proxy, this);
-    proxyThread.detach();
+    proxyThread = std::thread(binaryEncoding ?
+                              &AtomSpacePublisherModule::binaryProxy :
+                              &AtomSpacePublisherModule::proxy, this);
 }
 
 void AtomSpacePublisherModule::proxy()
 {
     zmq::socket_t pub(*context, ZMQ_PUB);
     pub.setsockopt(ZMQ_SNDHWM, &HWM, sizeof(HWM));
+    // Don't hold up the shutdown with unsent messages
+    int linger = 0;
+    pub.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
     
     std::string zmq_event_port = config().get("ZMQ_EVENT_PORT");
     bool zmq_use_public_ip = config().get_bool("ZMQ_EVENT_USE_PUBLIC_IP");
@@ -183,24 +204,166 @@ void AtomSpacePublisherModule::proxy()
     // received from multithreaded TBB worker tasks and forward them to the
     // ZeroMQ publisher socket
     bool active = true;
-    while (active)
+    try
     {
-        message_t message;
-        queue.pop(message);
-        
-        if (message.type == "CONTROL")
+        while (active)
         {
-            if (message.payload == "TERMINATE")
+            message_t message;
+            queue.pop(message);
+
+            if (message.type == "CONTROL")
             {
-                active = false; 
+                if (message.payload == "TERMINATE")
+                {
+                    active = false; 
+                }
+            }
+            else
+            {
+                s_sendmore(pub, message.type);
+                s_send(pub, message.payload);
             }
         }
-        else
+    }
+    catch (const zmq::error_t& error)
+    {
+        // ETERM: the context is shutting down
+        if (error.num() != ETERM)
+            logger().error("[AtomSpacePublisherModule] ZeroMQ error: %s",
+                           error.what());
+    }
+}
+
+void AtomSpacePublisherModule::binaryProxy()
+{
+    zmq::socket_t pub(*context, ZMQ_XPUB);
+    pub.setsockopt(ZMQ_SNDHWM, &HWM, sizeof(HWM));
+    int linger = 0;
+    pub.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+
+    std::string zmq_event_port = config().get("ZMQ_EVENT_PORT");
+    bool zmq_use_public_ip = config().get_bool("ZMQ_EVENT_USE_PUBLIC_IP");
+    std::string zmq_ip = zmq_use_public_ip ? "0.0.0.0" : "*";
+
+    try
+    {
+        pub.bind(("tcp://" + zmq_ip + ":" + zmq_event_port).c_str());
+    }
+    catch (zmq::error_t error)
+    {
+        std::cout << "ZeroMQ error: " << error.what() << std::endl;
+        return;
+    }
+
+    // Wait for subscription changes until the end of the current window,
+    // then publish what has been batched during the window
+    typedef std::chrono::steady_clock clock;
+    clock::time_point windowEnd = clock::now() +
+        std::chrono::milliseconds(batchWindow);
+    try
+    {
+        while (!terminating)
+        {
+            long timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                windowEnd - clock::now()).count();
+            zmq::pollitem_t items[] = { { (void*) pub, 0, ZMQ_POLLIN, 0 } };
+            zmq::poll(items, 1, std::max(timeout, 0L));
+
+            if (items[0].revents & ZMQ_POLLIN)
+            {
+                // Subscription messages: 1 (subscribe) or 0 (unsubscribe)
+                // followed by the topic
+                zmq::message_t subscription;
+                bool changed = false;
+                while (pub.recv(&subscription, ZMQ_DONTWAIT))
+                {
+                    if (subscription.size() == 0) continue;
+                    const char* data = (const char*) subscription.data();
+                    std::string topic(data + 1, subscription.size() - 1);
+                    if (data[0] == 1)
+                        subscriptions.insert(topic);
+                    else
+                        subscriptions.erase(topic);
+                    changed = true;
+                }
+                if (changed) updateSubscriptions();
+            }
+
+            if (clock::now() >= windowEnd)
+            {
+                uint64_t timestamp =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                publishBatch(pub, timestamp);
+                windowEnd = clock::now() + std::chrono::milliseconds(batchWindow);
+            }
+        }
+    }
+    catch (const zmq::error_t& error)
+    {
+        // ETERM: the context is shutting down
+        if (error.num() != ETERM)
+            logger().error("[AtomSpacePublisherModule] ZeroMQ error: %s",
+                           error.what());
+    }
+}
+
+void AtomSpacePublisherModule::updateSubscriptions()
+{
+    Type count = classserver().getNumberOfClasses();
+    std::vector<bool> wanted(NUMBER_OF_PUBLISHER_EVENTS * count, false);
+    for (int event = 0; event < NUMBER_OF_PUBLISHER_EVENTS; event++)
+    {
+        for (Type type = 0; type < count; type++)
         {
-            s_sendmore(pub, message.type);
-            s_send(pub, message.payload);
+            std::string topic =
+                BinaryEventBatch::topic((PublisherEvent) event, type);
+            std::set<std::string>::const_iterator it;
+            for (it = subscriptions.begin(); it != subscriptions.end(); ++it)
+            {
+                if (topic.compare(0, it->size(), *it) == 0)
+                {
+                    wanted[event * count + type] = true;
+                    break;
+                }
+            }
         }
     }
+
+    std::lock_guard<std::mutex> lock(batchMutex);
+    subscribed.swap(wanted);
+    typeCount = count;
+}
+
+void AtomSpacePublisherModule::queueBinaryEvent(const PublishedEvent& e)
+{
+    std::lock_guard<std::mutex> lock(batchMutex);
+    // Types created after the last subscription change are let through,
+    // ZeroMQ will filter them anyway
+    if (e.type < typeCount && !subscribed[e.event * typeCount + e.type])
+        return;
+    batch.add(e);
+}
+
+void AtomSpacePublisherModule::publishBatch(zmq::socket_t& pub,
+                                            uint64_t timestamp)
+{
+    // Take the batch out of the lock so that the slots are not held up
+    // by the encoding
+    BinaryEventBatch window;
+    {
+        std::lock_guard<std::mutex> lock(batchMutex);
+        if (batch.empty()) return;
+        std::swap(window, batch);
+    }
+
+    std::vector<std::pair<std::string, std::string> > frames;
+    window.encode(*as, timestamp, frames);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        s_sendmore(pub, frames[i].first);
+        s_send(pub, frames[i].second);
+    }
 }
 
 void AtomSpacePublisherModule::sendMessage(std::string messageType, 
@@ -214,6 +377,14 @@ void AtomSpacePublisherModule::sendMessage(std::string messageType,
     
 void AtomSpacePublisherModule::atomAddSignal(Handle h)
 {   
+    if (binaryEncoding) {
+        PublishedEvent e;
+        e.event = EVENT_ADD;
+        e.h = h;
+        e.type = h->getType();
+        queueBinaryEvent(e);
+        return;
+    }
     tbb_enqueue_lambda([=] {
        sendMessage("add", atomMessage(atomToJSON(h)));
     });
@@ -221,6 +392,14 @@ void AtomSpacePublisherModule::atomAddSignal(Handle h)
 
 void AtomSpacePublisherModule::atomRemoveSignal(AtomPtr atom)
 {
+    if (binaryEncoding) {
+        PublishedEvent e;
+        e.event = EVENT_REMOVE;
+        e.h = atom->getHandle();
+        e.type = atom->getType();
+        queueBinaryEvent(e);
+        return;
+    }
     tbb_enqueue_lambda([=] {
         sendMessage("remove", atomMessage(atomToJSON(atom->getHandle())));
     });
@@ -230,6 +409,16 @@ void AtomSpacePublisherModule::AVChangedSignal(const Handle& h,
                                                const AttentionValuePtr& av_old,
                                                const AttentionValuePtr& av_new)
 {
+    if (binaryEncoding) {
+        PublishedEvent e;
+        e.event = EVENT_AV_CHANGED;
+        e.h = h;
+        e.type = h->getType();
+        e.avOld = av_old;
+        e.avNew = av_new;
+        queueBinaryEvent(e);
+        return;
+    }
     tbb_enqueue_lambda([=] {
         sendMessage("avChanged", avMessage(atomToJSON(h), 
                                            avToJSON(av_old), 
@@ -241,6 +430,16 @@ void AtomSpacePublisherModule::TVChangedSignal(const Handle& h,
                                                const TruthValuePtr& tv_old,
                                                const TruthValuePtr& tv_new)
 {
+    if (binaryEncoding) {
+        PublishedEvent e;
+        e.event = EVENT_TV_CHANGED;
+        e.h = h;
+        e.type = h->getType();
+        e.tvOld = tv_old;
+        e.tvNew = tv_new;
+        queueBinaryEvent(e);
+        return;
+    }
     tbb_enqueue_lambda([=] {
         sendMessage("tvChanged", tvMessage(atomToJSON(h), 
                                            tvToJSON(tv_old),
@@ -252,6 +451,16 @@ void AtomSpacePublisherModule::addAFSignal(const Handle& h,
                                            const AttentionValuePtr& av_old,
                                            const AttentionValuePtr& av_new)
 {
+    if (binaryEncoding) {
+        PublishedEvent e;
+        e.event = EVENT_ADD_AF;
+        e.h = h;
+        e.type = h->getType();
+        e.avOld = av_old;
+        e.avNew = av_new;
+        queueBinaryEvent(e);
+        return;
+    }
     tbb_enqueue_lambda([=] {
         sendMessage("addAF", avMessage(atomToJSON(h), 
                                        avToJSON(av_old),
@@ -263,6 +472,16 @@ void AtomSpacePublisherModule::removeAFSignal(const Handle& h,
                                               const AttentionValuePtr& av_old,
                                               const AttentionValuePtr& av_new)
 {  
+    if (binaryEncoding) {
+        PublishedEvent e;
+        e.event = EVENT_REMOVE_AF;
+        e.h = h;
+        e.type = h->getType();
+        e.avOld = av_old;
+        e.avNew = av_new;
+        queueBinaryEvent(e);
+        return;
+    }
     tbb_enqueue_lambda([=] {
         sendMessage("removeAF", avMessage(atomToJSON(h), 
                                           avToJSON(av_old),
@@ -25,7 +25,11 @@
 #ifndef _OPENCOG_ATOMSPACE_PUBLISHER_MODULE_H
 #define _OPENCOG_ATOMSPACE_PUBLISHER_MODULE_H
 
+#include <atomic>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <opencog/server/Agent.h>
 #include <opencog/server/Module.h>
 #include <opencog/server/CogServer.h>
@@ -34,6 +38,7 @@
 #include <tbb/concurrent_queue.h>
 #include <opencog/util/tbb.h>
 #include <lib/zmq/zhelpers.hpp>
+#include "BinaryEventBatch.h"
 
 using namespace json_spirit;
 
@@ -71,6 +76,15 @@ class CogServer;
  *   - Serialized output is forwarded to a TBB concurrent queue
  *   - Proxy accesses the concurrent queue using a blocking pop operation to 
  *     demultiplex messages and forward them to the ZeroMQ publisher socket
+ *
+ * With ZMQ_EVENT_ENCODING = binary, the events are not serialized one by
+ * one. The slots add them to a BinaryEventBatch instead, and every
+ * ZMQ_EVENT_BATCH_WINDOW milliseconds the proxy encodes the batch into
+ * one compact binary frame per (event type, atom type) and publishes the
+ * frames. Repeated avChanged events of an atom within a window are
+ * coalesced. The proxy uses an XPUB socket to keep track of the topics
+ * the subscribers asked for, and the events nobody subscribed to are
+ * dropped right in the slots.
  **/
 class AtomSpacePublisherModule;
 typedef std::shared_ptr<AtomSpacePublisherModule> AtomSpacePublisherModulePtr;
@@ -101,9 +115,29 @@ class AtomSpacePublisherModule : public Module
         
         // ZeroMQ
         zmq::context_t * context;
+        // runs proxy() or binaryProxy(), joined before the context goes
+        std::thread proxyThread;
         void InitZeroMQ();
         void proxy();
 
+        // Binary encoding
+        bool binaryEncoding;
+        unsigned int batchWindow; // milliseconds
+        std::atomic<bool> terminating;
+        std::mutex batchMutex;
+        // guarded by batchMutex
+        BinaryEventBatch batch;
+        // subscribed[event * typeCount + type] is true if some subscriber
+        // wants the frames of that event type and atom type
+        std::vector<bool> subscribed;
+        Type typeCount;
+        // topics subscribed to, only used by the proxy thread
+        std::set<std::string> subscriptions;
+        void binaryProxy();
+        void updateSubscriptions();
+        void queueBinaryEvent(const PublishedEvent& e);
+        void publishBatch(zmq::socket_t& pub, uint64_t timestamp);
+
         void sendMessage(std::string messageType, std::string payload);
         std::string atomMessage(Object jsonAtom);
         std::string avMessage(Object jsonAtom, Object jsonAVOld, Object jsonAVNew);
@@ -0,0 +1,284 @@
+/*
+ * opencog/modules/events/BinaryEventBatch.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "BinaryEventBatch.h"
+
+#include <string.h>
+
+#include <opencog/atomspace/ClassServer.h>
+
+using namespace opencog;
+
+// Version of the payload format, first byte of each payload
+static const uint8_t BINARY_FRAME_VERSION = 2;
+
+const char* opencog::publisherEventName(int event)
+{
+    static const char* names[NUMBER_OF_PUBLISHER_EVENTS] = {
+        "add", "remove", "tvChanged", "avChanged", "addAF", "removeAF"
+    };
+    return names[event];
+}
+
+namespace
+{
+
+// All the numbers are written little-endian whatever the host is.
+
+void putUint(std::string& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+void putFloat(std::string& out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putUint(out, bits, 4);
+}
+
+void putTV(std::string& out, const TruthValuePtr& tv)
+{
+    putFloat(out, tv ? tv->getMean() : 0.0f);
+    putFloat(out, tv ? tv->getConfidence() : 0.0f);
+    putFloat(out, tv ? tv->getCount() : 0.0f);
+}
+
+void putAV(std::string& out, const AttentionValuePtr& av)
+{
+    putUint(out, (uint32_t) (int32_t) (av ? av->getSTI() : 0), 4);
+    putUint(out, (uint32_t) (int32_t) (av ? av->getLTI() : 0), 4);
+    putUint(out, (av && av->getVLTI() != 0) ? 1 : 0, 1);
+}
+
+class Reader
+{
+    public:
+        Reader(const std::string& in) : _in(in), _pos(0), _ok(true) {}
+
+        bool ok() const { return _ok; }
+        bool atEnd() const { return _pos == _in.size(); }
+
+        uint64_t getUint(int bytes)
+        {
+            if (_pos + bytes > _in.size()) {
+                _ok = false;
+                return 0;
+            }
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; i++)
+                value |= ((uint64_t) (unsigned char) _in[_pos + i]) << (8 * i);
+            _pos += bytes;
+            return value;
+        }
+
+        float getFloat()
+        {
+            uint32_t bits = getUint(4);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        std::string getString(size_t length)
+        {
+            if (_pos + length > _in.size()) {
+                _ok = false;
+                return "";
+            }
+            std::string s = _in.substr(_pos, length);
+            _pos += length;
+            return s;
+        }
+
+        void getTV(float tv[3])
+        {
+            for (int i = 0; i < 3; i++)
+                tv[i] = getFloat();
+        }
+
+        void getAV(int32_t av[3])
+        {
+            av[0] = (int32_t) (uint32_t) getUint(4);
+            av[1] = (int32_t) (uint32_t) getUint(4);
+            av[2] = getUint(1);
+        }
+
+    private:
+        const std::string& _in;
+        size_t _pos;
+        bool _ok;
+};
+
+}
+
+BinaryEventBatch::BinaryEventBatch() : _size(0), _coalesced(0), _seq(0)
+{
+}
+
+void BinaryEventBatch::add(const PublishedEvent& e)
+{
+    uint32_t key = ((uint32_t) e.event << 16) | e.type;
+    std::vector<PublishedEvent>& group = _groups[key];
+    if (group.empty())
+        _order.push_back(key);
+
+    if (e.event == EVENT_AV_CHANGED) {
+        std::unordered_map<Handle, size_t, handle_hash>::iterator it =
+            _avChanged.find(e.h);
+        if (it != _avChanged.end()) {
+            // keep the oldest value and move on to the newest one, the
+            // event keeps the sequence number of the first change
+            group[it->second].avNew = e.avNew;
+            _coalesced++;
+            return;
+        }
+        _avChanged[e.h] = group.size();
+    }
+
+    group.push_back(e);
+    group.back().seq = _seq++;
+    _size++;
+}
+
+void BinaryEventBatch::clear()
+{
+    _groups.clear();
+    _order.clear();
+    _avChanged.clear();
+    _size = 0;
+    _coalesced = 0;
+    _seq = 0;
+}
+
+std::string BinaryEventBatch::topic(PublisherEvent event, Type type)
+{
+    return std::string("bin:") + publisherEventName(event) + ":" +
+        classserver().getTypeName(type);
+}
+
+void BinaryEventBatch::encode(AtomSpace& as, uint64_t timestamp,
+        std::vector<std::pair<std::string, std::string> >& frames) const
+{
+    for (size_t g = 0; g < _order.size(); g++) {
+        const std::vector<PublishedEvent>& group = _groups.at(_order[g]);
+        if (group.empty()) continue;
+        PublisherEvent event = group.front().event;
+        Type type = group.front().type;
+
+        std::string payload;
+        putUint(payload, BINARY_FRAME_VERSION, 1);
+        putUint(payload, event, 1);
+        putUint(payload, type, 2);
+        putUint(payload, timestamp, 8);
+        putUint(payload, group.size(), 4);
+
+        for (size_t i = 0; i < group.size(); i++) {
+            const PublishedEvent& e = group[i];
+            putUint(payload, e.seq, 4);
+            putUint(payload, e.h.value(), 8);
+
+            switch (event) {
+                case EVENT_ADD: {
+                    std::string name = as.getName(e.h);
+                    putUint(payload, name.size(), 4);
+                    payload += name;
+                    HandleSeq outgoing = as.getOutgoing(e.h);
+                    putUint(payload, outgoing.size(), 4);
+                    for (size_t j = 0; j < outgoing.size(); j++)
+                        putUint(payload, outgoing[j].value(), 8);
+                    putTV(payload, as.getTV(e.h));
+                    putAV(payload, as.getAV(e.h));
+                    break;
+                }
+                case EVENT_TV_CHANGED:
+                    putTV(payload, e.tvOld);
+                    putTV(payload, e.tvNew);
+                    break;
+                case EVENT_AV_CHANGED:
+                case EVENT_ADD_AF:
+                case EVENT_REMOVE_AF:
+                    putAV(payload, e.avOld);
+                    putAV(payload, e.avNew);
+                    break;
+                case EVENT_REMOVE:
+                case NUMBER_OF_PUBLISHER_EVENTS:
+                    break;
+            }
+        }
+
+        frames.push_back(std::make_pair(topic(event, type), payload));
+    }
+}
+
+bool opencog::decodeBinaryFrame(const std::string& payload, DecodedFrame& frame)
+{
+    Reader in(payload);
+    if (in.getUint(1) != BINARY_FRAME_VERSION) return false;
+    uint64_t event = in.getUint(1);
+    if (event >= NUMBER_OF_PUBLISHER_EVENTS) return false;
+    frame.event = (PublisherEvent) event;
+    frame.type = in.getUint(2);
+    frame.timestamp = in.getUint(8);
+    size_t count = in.getUint(4);
+    if (!in.ok()) return false;
+
+    frame.events.clear();
+    for (size_t i = 0; i < count && in.ok(); i++) {
+        DecodedEvent e;
+        memset(e.tvOld, 0, sizeof(e.tvOld));
+        memset(e.tvNew, 0, sizeof(e.tvNew));
+        memset(e.avOld, 0, sizeof(e.avOld));
+        memset(e.avNew, 0, sizeof(e.avNew));
+        e.seq = in.getUint(4);
+        e.handle = in.getUint(8);
+
+        switch (frame.event) {
+            case EVENT_ADD: {
+                e.name = in.getString(in.getUint(4));
+                size_t arity = in.getUint(4);
+                for (size_t j = 0; j < arity && in.ok(); j++)
+                    e.outgoing.push_back(in.getUint(8));
+                in.getTV(e.tvNew);
+                in.getAV(e.avNew);
+                break;
+            }
+            case EVENT_TV_CHANGED:
+                in.getTV(e.tvOld);
+                in.getTV(e.tvNew);
+                break;
+            case EVENT_AV_CHANGED:
+            case EVENT_ADD_AF:
+            case EVENT_REMOVE_AF:
+                in.getAV(e.avOld);
+                in.getAV(e.avNew);
+                break;
+            case EVENT_REMOVE:
+            case NUMBER_OF_PUBLISHER_EVENTS:
+                break;
+        }
+        frame.events.push_back(e);
+    }
+
+    return in.ok() && in.atEnd();
+}
@@ -0,0 +1,173 @@
+/*
+ * opencog/modules/events/BinaryEventBatch.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BINARY_EVENT_BATCH_H
+#define _OPENCOG_BINARY_EVENT_BATCH_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+
+/**
+ * Event types of the AtomSpacePublisherModule. The names are the ZeroMQ
+ * topics of the JSON encoding.
+ */
+enum PublisherEvent
+{
+    EVENT_ADD = 0,
+    EVENT_REMOVE,
+    EVENT_TV_CHANGED,
+    EVENT_AV_CHANGED,
+    EVENT_ADD_AF,
+    EVENT_REMOVE_AF,
+    NUMBER_OF_PUBLISHER_EVENTS
+};
+
+const char* publisherEventName(int event);
+
+/**
+ * One AtomSpace event, as received from the AtomSpace signals. The values
+ * that are not relevant for the event type are left empty.
+ */
+struct PublishedEvent
+{
+    PublishedEvent() : event(EVENT_ADD), type(NOTYPE), seq(0) {}
+
+    PublisherEvent event;
+    Handle h;
+    Type type;
+    TruthValuePtr tvOld;
+    TruthValuePtr tvNew;
+    AttentionValuePtr avOld;
+    AttentionValuePtr avNew;
+    // position of the event in its window, set by BinaryEventBatch::add()
+    uint32_t seq;
+};
+
+/**
+ * An event decoded from a binary frame. See decodeBinaryFrame().
+ */
+struct DecodedEvent
+{
+    // position of the event in its window, across all the frames
+    uint32_t seq;
+    UUID handle;
+    // add only
+    std::string name;
+    std::vector<UUID> outgoing;
+    // TruthValues as (strength, confidence, count). For add events, the
+    // TruthValue of the atom is in tvNew.
+    float tvOld[3];
+    float tvNew[3];
+    // AttentionValues as (sti, lti, vlti). For add events, the
+    // AttentionValue of the atom is in avNew.
+    int32_t avOld[3];
+    int32_t avNew[3];
+};
+
+struct DecodedFrame
+{
+    PublisherEvent event;
+    Type type;
+    // milliseconds since epoch at the end of the batching window
+    uint64_t timestamp;
+    std::vector<DecodedEvent> events;
+};
+
+/**
+ * The events received during one batching window of the binary encoding
+ * of the AtomSpacePublisherModule.
+ *
+ * The events are grouped by (event type, atom type). Each group becomes
+ * one ZeroMQ message, sent under the topic "bin:EVENT:ATOMTYPE" (e.g.
+ * "bin:avChanged:ConceptNode"), so that subscribers can filter by event
+ * type, or by event type and atom type, with the usual ZeroMQ prefix
+ * matching.
+ *
+ * All the avChanged events of an atom within a window are coalesced into
+ * a single one, going from the AttentionValue before the first change to
+ * the one after the last change. The other events are all kept, in the
+ * order they were added.
+ *
+ * Every event carries its sequence number in the window, so that a
+ * subscriber to several topics can restore the order of the events of
+ * an atom (e.g. its add before its remove). The groups are encoded in
+ * the order of their first event.
+ *
+ * The payload format is described in README.md. This class is not thread
+ * safe.
+ */
+class BinaryEventBatch
+{
+    public:
+        BinaryEventBatch();
+
+        void add(const PublishedEvent& e);
+
+        // number of events in the batch, after coalescing
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        // number of avChanged events merged into a previous one
+        size_t coalesced() const { return _coalesced; }
+
+        void clear();
+
+        /**
+         * Append one (topic, payload) pair per group of events to frames.
+         * The atomspace is used to get the names, outgoing sets and values
+         * of the added atoms.
+         */
+        void encode(AtomSpace& as, uint64_t timestamp,
+                    std::vector<std::pair<std::string, std::string> >& frames) const;
+
+        static std::string topic(PublisherEvent event, Type type);
+
+    private:
+        // (event << 16 | atom type) -> events of the group
+        std::unordered_map<uint32_t, std::vector<PublishedEvent> > _groups;
+        // keys of _groups in the order of their first event
+        std::vector<uint32_t> _order;
+        // position of the avChanged event of each atom in its group
+        std::unordered_map<Handle, size_t, handle_hash> _avChanged;
+        size_t _size;
+        size_t _coalesced;
+        // sequence number of the next event
+        uint32_t _seq;
+};
+
+/**
+ * Decode the payload of a binary frame. Return false if it is not a valid
+ * frame.
+ */
+bool decodeBinaryFrame(const std::string& payload, DecodedFrame& frame);
+
+} // namespace opencog
+
+#endif // _OPENCOG_BINARY_EVENT_BATCH_H
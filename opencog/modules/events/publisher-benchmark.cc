@@ -0,0 +1,140 @@
+/*
+ * opencog/modules/events/publisher-benchmark.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Measure the throughput of the AtomSpacePublisherModule under a flood of
+// AttentionValue changes, as seen by a subscriber on the same host.
+//
+// usage: publisher-benchmark [json|binary] [atoms] [AV changes] [window ms]
+//
+// Run from the build directory, so that the module can be loaded.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/server/CogServer.h>
+#include <opencog/util/Config.h>
+#include <opencog/util/Logger.h>
+#include <lib/zmq/zhelpers.hpp>
+
+#include "BinaryEventBatch.h"
+
+using namespace opencog;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point start)
+{
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::string encoding = argc > 1 ? argv[1] : "binary";
+    int n_atoms = argc > 2 ? atoi(argv[2]) : 1000;
+    int n_changes = argc > 3 ? atoi(argv[3]) : 1000000;
+    std::string window = argc > 4 ? argv[4] : "50";
+    bool binary = (encoding == "binary");
+
+    if (!config().has("ZMQ_EVENT_PORT"))
+        config().set("ZMQ_EVENT_PORT", "5563");
+    if (!config().has("ZMQ_EVENT_USE_PUBLIC_IP"))
+        config().set("ZMQ_EVENT_USE_PUBLIC_IP", "FALSE");
+    config().set("ZMQ_EVENT_ENCODING", encoding);
+    config().set("ZMQ_EVENT_BATCH_WINDOW", window);
+    config().set("MODULES",
+                 "opencog/modules/events/libatomspacepublishermodule.so");
+    logger().setLevel(Logger::WARN);
+
+    cogserver().loadModules();
+    AtomSpace* as = &cogserver().getAtomSpace();
+
+    std::vector<Handle> atoms;
+    for (int i = 0; i < n_atoms; i++)
+        atoms.push_back(as->addNode(CONCEPT_NODE, "bench_" + std::to_string(i)));
+
+    // The subscriber counts the events until it has been idle for a second
+    std::atomic<bool> producing(true);
+    std::atomic<long> received(0);
+    std::atomic<long> bytes(0);
+    double drainTime = 0.0;
+    bench_clock::time_point start;
+    std::thread subscriberThread([&]() {
+        zmq::context_t context(1);
+        zmq::socket_t subscriber(context, ZMQ_SUB);
+        std::string url = "tcp://localhost:" + config()["ZMQ_EVENT_PORT"];
+        subscriber.connect(url.c_str());
+        std::string topic = binary ? "bin:avChanged" : "avChanged";
+        subscriber.setsockopt(ZMQ_SUBSCRIBE, topic.c_str(), topic.size());
+        int timeout = 1000;
+        subscriber.setsockopt(ZMQ_RCVTIMEO, &timeout, sizeof(timeout));
+
+        DecodedFrame frame;
+        while (true)
+        {
+            zmq::message_t address;
+            if (!subscriber.recv(&address)) {
+                if (!producing) break;
+                continue;
+            }
+            zmq::message_t contents;
+            subscriber.recv(&contents);
+            bytes += address.size() + contents.size();
+            if (binary) {
+                std::string payload((const char*) contents.data(),
+                                    contents.size());
+                if (decodeBinaryFrame(payload, frame))
+                    received += frame.events.size();
+            } else {
+                received++;
+            }
+            drainTime = seconds_since(start);
+        }
+    });
+
+    // Wait for the subscriber to initialize to avoid the 'slow joiner'
+    // syndrome
+    sleep(2);
+
+    start = bench_clock::now();
+    for (int i = 0; i < n_changes; i++)
+        as->setAV(atoms[i % n_atoms], createAV(i % 1000, 0, 0));
+    double produceTime = seconds_since(start);
+    producing = false;
+    subscriberThread.join();
+
+    printf("%s encoding, %d atoms, %d AV changes\n",
+           encoding.c_str(), n_atoms, n_changes);
+    printf("changes made in %.3fs (%.0f/s)\n",
+           produceTime, n_changes / produceTime);
+    printf("%ld events received in %.3fs, %.1f MB\n",
+           (long) received, drainTime, bytes / 1e6);
+
+    cogserver().stop();
+    return 0;
+}
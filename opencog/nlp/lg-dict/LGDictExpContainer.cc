@@ -206,7 +206,7 @@ void LGDictExpContainer::basic_normal_order()
  * @param as   pointer to the AtomSpace
  * @return     handle to the atom
  */
-Handle LGDictExpContainer::to_handle(AtomSpace *as)
+Handle LGDictExpContainer::to_handle(AtomSpace *as) const
 {
     if (m_type == CONNECTOR_type)
     {
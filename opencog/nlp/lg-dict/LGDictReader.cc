@@ -23,6 +23,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
 #include <opencog/nlp/types/atom_types.h>
 
 #include "LGDictReader.h"
@@ -32,11 +37,14 @@ using namespace opencog::nlp;
 using namespace opencog;
 
 
+std::mutex LGDictReader::_lookup_mutex;
+
+
 /**
  * Constructor of the LGDictReader class.
  *
  * @param pDict   the Dictionary to read from
- * @param pAS     the AtomSpace where atoms will be created
+ * @param pAS     the AtomSpace where atoms will be created by default
  */
 LGDictReader::LGDictReader(Dictionary pDict, AtomSpace* pAS)
     : _dictionary(pDict), _as(pAS)
@@ -71,31 +79,133 @@ LGDictReader::~LGDictReader()
  * not necessarily in any sort of normal form; the null connector can
  * appear anywhere.
  *
+ * If the entry of the word is already in the AtomSpace, it is returned
+ * as is, without building the disjuncts again.
+ *
  * @param word   the input word string
  * @return       the handle to the newly created atom
  */
 Handle LGDictReader::getAtom(const std::string& word)
 {
-    // See if we know about this word, or not.
-    Dict_node* dn_head = dictionary_lookup_list(_dictionary, word.c_str());
+    return getAtom(word, _as);
+}
+
+/**
+ * Same as above, creating the atoms in the given AtomSpace instead of
+ * the one of the reader.
+ *
+ * @param word   the input word string
+ * @param as     the AtomSpace where atoms will be created
+ * @return       the handle to the newly created atom
+ */
+Handle LGDictReader::getAtom(const std::string& word, AtomSpace* as)
+{
+    EntryPtr entry = get_entry(word);
 
-    if (!dn_head)
+    // We don't know about this word
+    if (entry->empty())
         return Handle::UNDEFINED;
 
+    Handle hWord = as->addNode(WORD_NODE, word);
+
+    // check if the dictionary entry is already in the atomspace
     HandleSeq outgoing;
-    Handle hWord = _as->addNode(WORD_NODE, word);
+    hWord->getIncomingSetByType(std::back_inserter(outgoing), LG_WORD_CSET, false);
+
+    if (not outgoing.empty())
+        return as->addLink(SET_LINK, outgoing);
+
+    for (const LGDictExpContainer& exp : *entry)
+        outgoing.push_back(as->addLink(LG_WORD_CSET, hWord, exp.to_handle(as)));
+
+    return as->addLink(SET_LINK, outgoing);
+}
 
-    for (Dict_node* dn = dn_head; dn; dn = dn->right)
+/**
+ * Method to import the LG dictionary entries of many words at once.
+ *
+ * The words are handed out to n_threads workers, each of them doing the
+ * DNF conversion and the atom creation of its words.  Only the lookups
+ * into the LG dictionary itself are serialized.  Meant for pre-loading a
+ * whole vocabulary before running SuReal or the Viterbi parser on it.
+ *
+ * @param words       the input word strings
+ * @param as          the AtomSpace where atoms will be created
+ * @param n_threads   number of workers, 0 for one per hardware thread
+ * @return            the handles of the entries, in the order of the
+ *                    words (Handle::UNDEFINED for unknown words)
+ */
+HandleSeq LGDictReader::getAtoms(const std::vector<std::string>& words,
+                                 AtomSpace* as, unsigned int n_threads)
+{
+    HandleSeq results(words.size());
+
+    if (n_threads == 0)
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    n_threads = std::min<size_t>(n_threads, words.size());
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < words.size(); i = next++)
+            results[i] = getAtom(words[i], as);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < n_threads; t++)
+        workers.push_back(std::thread(worker));
+
+    // the calling thread takes its share of the work as well
+    worker();
+
+    for (std::thread& t : workers)
+        t.join();
+
+    return results;
+}
+
+/**
+ * Helper method for getting the DNF expressions of a word.
+ *
+ * Look the word up in the cache of the reader first, and only go to the
+ * LG dictionary on a miss.  Unknown words are cached as well, as an
+ * empty entry.
+ *
+ * @param word   the input word string
+ * @return       one flattened expression per dictionary entry of the word
+ */
+LGDictReader::EntryPtr LGDictReader::get_entry(const std::string& word)
+{
     {
-        Exp* exp = dn->exp;
-        Handle hLG = lg_exp_to_container(exp).to_handle(_as);
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        EntryCache::const_iterator it = _cache.find(word);
+
+        if (it != _cache.end())
+            return it->second;
+    }
 
-        outgoing.push_back(_as->addLink(LG_WORD_CSET, hWord, hLG));
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    Dict_node* dn_head;
+
+    // LG makes no promise about concurrent lookups
+    {
+        std::lock_guard<std::mutex> lock(_lookup_mutex);
+        dn_head = dictionary_lookup_list(_dictionary, word.c_str());
     }
 
-    free_lookup_list(_dictionary, dn_head);
+    if (dn_head)
+    {
+        // The conversion only reads the expressions, and can be done
+        // by several threads at once.
+        for (Dict_node* dn = dn_head; dn; dn = dn->right)
+            entry->push_back(lg_exp_to_container(dn->exp));
+
+        std::lock_guard<std::mutex> lock(_lookup_mutex);
+        free_lookup_list(_dictionary, dn_head);
+    }
 
-    return _as->addLink(SET_LINK, outgoing);
+    // If another thread raced us on the same word, keep its entry
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    return _cache.insert(std::make_pair(word, entry)).first->second;
 }
 
 /**
@@ -24,6 +24,12 @@
 #ifndef _OPENCOG_LG_DICT_READER_H
 #define _OPENCOG_LG_DICT_READER_H
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <link-grammar/dict-api.h>
 
 #include <opencog/atomspace/AtomSpace.h>
@@ -41,6 +47,12 @@ namespace nlp
  *
  * A helper class for reading the LG dictionary's entry for a specific
  * word, and for creating the corresponding atom.
+ *
+ * The flattened DNF expressions of the words looked up are kept by the
+ * reader, so that each word goes through the LG dictionary and the DNF
+ * conversion only once for as long as the reader lives.  A reader must
+ * therefore be deleted before its dictionary, and is best kept around
+ * rather than created for each word.
  */
 class LGDictReader
 {
@@ -49,10 +61,25 @@ public:
     ~LGDictReader();
 
     Handle getAtom(const std::string& word);
+    Handle getAtom(const std::string& word, AtomSpace* as);
+    HandleSeq getAtoms(const std::vector<std::string>& words,
+                       AtomSpace* as, unsigned int n_threads = 0);
+
+protected:
+    typedef std::vector<LGDictExpContainer> Entry;
+    typedef std::shared_ptr<const Entry> EntryPtr;
+    typedef std::unordered_map<std::string, EntryPtr> EntryCache;
+
+    EntryPtr get_entry(const std::string& word);
+
+    std::mutex _cache_mutex;
+    EntryCache _cache;
 
 private:
     LGDictExpContainer lg_exp_to_container(Exp*);
 
+    static std::mutex _lookup_mutex;
+
     Dictionary _dictionary;
     AtomSpace* _as;
 };
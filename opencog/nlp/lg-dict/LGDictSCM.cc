@@ -37,7 +37,7 @@ using namespace opencog;
 /**
  * The constructor for LGDictSCM.
  */
-LGDictSCM::LGDictSCM()
+LGDictSCM::LGDictSCM() : m_pReader(NULL)
 {
     static bool is_init = false;
     if (is_init) return;
@@ -50,6 +50,8 @@ LGDictSCM::LGDictSCM()
  */
 LGDictSCM::~LGDictSCM()
 {
+    // the reader refers to the dictionary, so it goes first
+    delete m_pReader;
     dictionary_delete(m_pDictionary);
 }
 
@@ -85,6 +87,9 @@ void LGDictSCM::init_in_module(void* data)
 void LGDictSCM::init()
 {
     m_pDictionary = dictionary_create_default_lang();
+    // shared by all the calls, so that each word is only looked up once;
+    // the atomspace is the one of the caller
+    m_pReader = new LGDictReader(m_pDictionary, NULL);
 
 #ifdef HAVE_GUILE
     define_scheme_primitive("lg-get-dict-entry", &LGDictSCM::do_lg_get_dict_entry, this, "nlp lg-dict");
@@ -109,17 +114,8 @@ Handle LGDictSCM::do_lg_get_dict_entry(Handle h)
 
     if (pAS->isNode(h) and h->getType() == WORD_NODE)
     {
-		// check if the dictionary entry is already in the atomspace
-		HandleSeq qExisting;
-		h->getIncomingSetByType(std::back_inserter(qExisting), LG_WORD_CSET, false);
-
-		// avoid the disjuncts building if entries exist
-		if (not qExisting.empty())
-			return pAS->addLink(SET_LINK, qExisting);
-
-        LGDictReader reader(m_pDictionary, pAS);
-
-        return reader.getAtom(pAS->getName(h));
+        // the reader returns the existing entry if there is one
+        return m_pReader->getAtom(pAS->getName(h), pAS);
     }
 
     return Handle::UNDEFINED;
@@ -28,6 +28,8 @@
 #include <link-grammar/dict-api.h>
 #include <opencog/atomspace/Handle.h>
 
+#include "LGDictReader.h"
+
 
 namespace opencog
 {
@@ -47,6 +49,7 @@ private:
     bool do_lg_conn_linkable(Handle, Handle);
 
     Dictionary m_pDictionary;
+    LGDictReader* m_pReader;
 
 public:
     LGDictSCM();
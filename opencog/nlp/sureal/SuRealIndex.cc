@@ -0,0 +1,165 @@
+/*
+ * SuRealIndex.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <opencog/atomspace/ClassServer.h>
+#include <opencog/atomutils/AtomUtils.h>
+#include <opencog/nlp/types/atom_types.h>
+#include <opencog/util/Logger.h>
+
+#include "SuRealIndex.h"
+
+
+using namespace opencog::nlp;
+using namespace opencog;
+
+
+/**
+ * The constructor for SuRealIndex.
+ *
+ * @param as   the AtomSpace holding the sentences
+ */
+SuRealIndex::SuRealIndex(AtomSpace* as) :
+    m_as(as),
+    m_dirty(true)
+{
+    m_add_conn = as->addAtomSignal(boost::bind(&SuRealIndex::atomAdded, this, _1));
+    m_remove_conn = as->removeAtomSignal(boost::bind(&SuRealIndex::atomRemoved, this, _1));
+}
+
+SuRealIndex::~SuRealIndex()
+{
+    m_add_conn.disconnect();
+    m_remove_conn.disconnect();
+}
+
+/**
+ * Get the links that could ground a clause.
+ *
+ * @param hClause   the clause, from the query's SetLink
+ * @return          the links of the same shape within a sentence
+ */
+HandleSeq SuRealIndex::get_candidates(const Handle& hClause)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_dirty.exchange(false))
+        build();
+
+    auto it = m_index.find(get_shape(hClause));
+
+    if (it == m_index.end())
+        return HandleSeq();
+
+    return it->second;
+}
+
+/**
+ * Get the shape of an atom.
+ *
+ * The shape of a node is its type, the shape of a link is its type
+ * followed by the shapes of its outgoing set, sorted for unordered links.
+ * For example, (EvaluationLink (PredicateNode "runs") (ListLink
+ * (ConceptNode "he"))) has the shape
+ * "EvaluationLink(PredicateNode ListLink(ConceptNode))".
+ *
+ * @param h   the atom
+ * @return    its shape
+ */
+std::string SuRealIndex::get_shape(const Handle& h)
+{
+    Type t = h->getType();
+    std::string shape = classserver().getTypeName(t);
+
+    LinkPtr lp(LinkCast(h));
+
+    if (not lp)
+        return shape;
+
+    std::vector<std::string> qShapes;
+
+    for (const Handle& ho : lp->getOutgoingSet())
+        qShapes.push_back(get_shape(ho));
+
+    if (classserver().isA(t, UNORDERED_LINK))
+        std::sort(qShapes.begin(), qShapes.end());
+
+    shape += "(";
+
+    for (size_t i = 0; i < qShapes.size(); i++)
+    {
+        if (i > 0)
+            shape += " ";
+        shape += qShapes[i];
+    }
+
+    return shape + ")";
+}
+
+/**
+ * Rebuild the index from the SetLinks referenced by InterpretationNodes.
+ */
+void SuRealIndex::build()
+{
+    m_index.clear();
+
+    HandleSeq qItpr;
+    m_as->getHandlesByType(std::back_inserter(qItpr), INTERPRETATION_NODE);
+
+    UnorderedHandleSet sSeen;
+
+    for (const Handle& hItpr : qItpr)
+    {
+        HandleSeq qSets = getNeighbors(hItpr, false, true, REFERENCE_LINK, false);
+
+        for (const Handle& hSet : qSets)
+        {
+            if (hSet->getType() != SET_LINK)
+                continue;
+
+            for (const Handle& h : m_as->getOutgoing(hSet))
+            {
+                // the same clause could be in several sentences
+                if (not sSeen.insert(h).second)
+                    continue;
+
+                m_index[get_shape(h)].push_back(h);
+            }
+        }
+    }
+
+    logger().debug("[SuReal] Indexed %d clauses into %d shapes", sSeen.size(), m_index.size());
+}
+
+void SuRealIndex::atomAdded(Handle h)
+{
+    if (h->getType() == REFERENCE_LINK)
+        m_dirty = true;
+}
+
+void SuRealIndex::atomRemoved(AtomPtr atom)
+{
+    if (atom->getType() == REFERENCE_LINK)
+        m_dirty = true;
+}
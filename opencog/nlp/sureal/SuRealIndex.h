@@ -0,0 +1,82 @@
+/*
+ * SuRealIndex.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SUREAL_INDEX_H
+#define _OPENCOG_SUREAL_INDEX_H
+
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/signals2.hpp>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+
+namespace opencog
+{
+namespace nlp
+{
+
+/**
+ * An index of the clauses of the sentences known to SuReal.
+ *
+ * Maps the shape of a clause (its link and node types, with the nodes
+ * themselves left out) to all the links of that shape that are inside a
+ * SetLink referenced by an InterpretationNode.  Since a variable can only
+ * be matched to a node of the same type, a clause can only be grounded by
+ * a link of the same shape, so the index gives the pattern matcher the
+ * starting points without scanning every link of the clause's type.
+ *
+ * The index is built on first use, and rebuilt when a ReferenceLink is
+ * added to or removed from the AtomSpace, ie. when sentences come and go.
+ */
+class SuRealIndex
+{
+public:
+    SuRealIndex(AtomSpace* as);
+    ~SuRealIndex();
+
+    HandleSeq get_candidates(const Handle& hClause);
+
+    static std::string get_shape(const Handle& h);
+
+private:
+    void build();
+    void atomAdded(Handle h);
+    void atomRemoved(AtomPtr atom);
+
+    AtomSpace* m_as;
+
+    std::mutex m_mutex;
+    std::atomic<bool> m_dirty;
+    std::unordered_map<std::string, HandleSeq> m_index;
+
+    boost::signals2::connection m_add_conn;
+    boost::signals2::connection m_remove_conn;
+};
+
+}
+}
+
+#endif // _OPENCOG_SUREAL_INDEX_H
@@ -36,14 +36,17 @@ using namespace opencog;
 /**
  * The constructor for the PatternMatcherCallback.
  *
- * @param pAS    the corresponding AtomSpace
- * @param vars   the set of nodes that should be treated as variables
+ * @param pAS     the corresponding AtomSpace
+ * @param vars    the set of nodes that should be treated as variables
+ * @param index   the clause index used to start the search, NULL to scan
+ *                all the links of the starting clause's type
  */
-SuRealPMCB::SuRealPMCB(AtomSpace* pAS, const std::set<Handle>& vars) :
+SuRealPMCB::SuRealPMCB(AtomSpace* pAS, const std::set<Handle>& vars, SuRealIndex* index) :
     InitiateSearchCB(pAS),
     DefaultPatternMatchCB(pAS),
     m_as(pAS),
     m_vars(vars),
+    m_index(index),
     m_eval(SchemeEval::get_evaluator(pAS))
 {
 
@@ -82,6 +85,27 @@ bool SuRealPMCB::variable_match(const Handle &hPat, const Handle &hSoln)
     if (hPat->getType() == VARIABLE_NODE || hPat->getType() == INTERPRETATION_NODE)
         return true;
 
+    std::pair<Handle, Handle> key(hPat, hSoln);
+    auto it = m_var_matches.find(key);
+
+    if (it != m_var_matches.end())
+        return it->second;
+
+    bool bResult = word_match(hPat, hSoln);
+    m_var_matches[key] = bResult;
+
+    return bResult;
+}
+
+/**
+ * Check if the word of a variable can replace the word of a solution.
+ *
+ * @param hPat    the variable, a node extracted from the original query
+ * @param hSoln   the potential mapping, of the same type
+ * @return        false if solution is rejected, true if accepted
+ */
+bool SuRealPMCB::word_match(const Handle &hPat, const Handle &hSoln)
+{
     std::string sPat = m_as->getName(hPat);
     std::string sPatWord = sPat.substr(0, sPat.find_first_of('@'));
     std::string sSoln = m_as->getName(hSoln);
@@ -97,19 +121,9 @@ bool SuRealPMCB::variable_match(const Handle &hPat, const Handle &hSoln)
         return false;
 
     // get the source connectors for the solution
-    std::string scmCode = "(ListLink (word-inst-get-source-conn " + SchemeSmob::to_string(hSolnWordInst) + "))";
-    HandleSeq qTargetConns = m_as->getOutgoing(m_eval->eval_h(scmCode));
+    const HandleSeq& qTargetConns = get_target_conns(hSolnWordInst);
 
-    HandleSeq qOr = getNeighbors(hPatWordNode, false, true, LG_WORD_CSET, false);
-    HandleSeq qDisjuncts;
-
-    auto insertHelper = [&](const Handle& h)
-    {
-        HandleSeq q = m_as->getOutgoing(h);
-        qDisjuncts.insert(qDisjuncts.end(), q.begin(), q.end());
-    };
-
-    std::for_each(qOr.begin(), qOr.end(), insertHelper);
+    const HandleSeq& qDisjuncts = get_disjuncts(hPatWordNode);
 
     logger().debug("[SuReal] Looking at %d disjuncts of %s", qDisjuncts.size(), hPat->toShortString().c_str());
 
@@ -182,6 +196,51 @@ bool SuRealPMCB::variable_match(const Handle &hPat, const Handle &hSoln)
     return std::any_of(qDisjuncts.begin(), qDisjuncts.end(), matchHelper);
 }
 
+/**
+ * Get the LG connectors used by a word instance in its sentence.
+ *
+ * @param hSolnWordInst   the WordInstanceNode
+ * @return                its source connectors
+ */
+const HandleSeq& SuRealPMCB::get_target_conns(const Handle& hSolnWordInst)
+{
+    auto it = m_target_conns.find(hSolnWordInst);
+
+    if (it != m_target_conns.end())
+        return it->second;
+
+    std::string scmCode = "(ListLink (word-inst-get-source-conn " + SchemeSmob::to_string(hSolnWordInst) + "))";
+
+    return m_target_conns[hSolnWordInst] = m_as->getOutgoing(m_eval->eval_h(scmCode));
+}
+
+/**
+ * Get all the disjuncts of a word from its LG dictionary entry.
+ *
+ * @param hPatWordNode   the WordNode
+ * @return               the disjuncts of all its LgWordCset
+ */
+const HandleSeq& SuRealPMCB::get_disjuncts(const Handle& hPatWordNode)
+{
+    auto it = m_disjuncts.find(hPatWordNode);
+
+    if (it != m_disjuncts.end())
+        return it->second;
+
+    HandleSeq qOr = getNeighbors(hPatWordNode, false, true, LG_WORD_CSET, false);
+    HandleSeq& qDisjuncts = m_disjuncts[hPatWordNode];
+
+    auto insertHelper = [&](const Handle& h)
+    {
+        HandleSeq q = m_as->getOutgoing(h);
+        qDisjuncts.insert(qDisjuncts.end(), q.begin(), q.end());
+    };
+
+    std::for_each(qOr.begin(), qOr.end(), insertHelper);
+
+    return qDisjuncts;
+}
+
 /**
  * Override the clause_match callback.
  *
@@ -312,7 +371,8 @@ bool SuRealPMCB::grounding(const std::map<Handle, Handle> &var_soln, const std::
  * for SuReal will have 0 constants, most searches will require looking at all
  * the links.  This implementation improves that by looking at links within a
  * SetLink within a ReferenceLink with a InterpretationNode neightbor, thus
- * limiting the search space.
+ * limiting the search space.  With an index, only the links of the same
+ * shape as the starting clause are looked at.
  *
  * @param pPME       pointer to the PatternMatchEngine
  * @param vars       a set of nodes that are variables
@@ -358,8 +418,16 @@ bool SuRealPMCB::initiate_search(PatternMatchEngine* pPME)
 
     // keep only links of the same type as bestClause and have linkage to InterpretationNode
     HandleSeq qCandidate;
-    m_as->getHandlesByType(std::back_inserter(qCandidate), bestClause->getType());
-    qCandidate.erase(std::remove_if(qCandidate.begin(), qCandidate.end(), hasNoInterpretation), qCandidate.end());
+
+    if (m_index)
+    {
+        qCandidate = m_index->get_candidates(bestClause);
+    }
+    else
+    {
+        m_as->getHandlesByType(std::back_inserter(qCandidate), bestClause->getType());
+        qCandidate.erase(std::remove_if(qCandidate.begin(), qCandidate.end(), hasNoInterpretation), qCandidate.end());
+    }
 
     for (auto& c : qCandidate)
     {
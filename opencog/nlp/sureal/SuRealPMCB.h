@@ -29,6 +29,8 @@
 #include <opencog/query/InitiateSearchCB.h>
 #include <opencog/guile/SchemeEval.h>
 
+#include "SuRealIndex.h"
+
 
 namespace opencog
 {
@@ -40,13 +42,17 @@ namespace nlp
  *
  * Override the neccessary callbacks to do special handling of variables
  * and LG dictionary checks.
+ *
+ * The outcome of each variable check is remembered for the duration of the
+ * search, along with the connectors and disjuncts it needed, since the
+ * pattern matcher tries the same variable against the same node many times.
  */
 class SuRealPMCB :
     public InitiateSearchCB,
     public DefaultPatternMatchCB
 {
 public:
-    SuRealPMCB(AtomSpace* as, const std::set<Handle>& vars);
+    SuRealPMCB(AtomSpace* as, const std::set<Handle>& vars, SuRealIndex* index = NULL);
     ~SuRealPMCB();
 
     virtual bool variable_match(const Handle& hPat, const Handle& hSoln);
@@ -66,8 +72,17 @@ public:
 private:
     virtual Handle find_starter(const Handle&, size_t&, Handle&, size_t&);
 
+    bool word_match(const Handle& hPat, const Handle& hSoln);
+    const HandleSeq& get_target_conns(const Handle& hSolnWordInst);
+    const HandleSeq& get_disjuncts(const Handle& hPatWordNode);
+
     AtomSpace* m_as;
     std::set<Handle> m_vars;   // store nodes that are variables
+    SuRealIndex* m_index;      // candidates for starting the search, if any
+
+    std::map<std::pair<Handle, Handle>, bool> m_var_matches;
+    std::map<Handle, HandleSeq> m_target_conns;
+    std::map<Handle, HandleSeq> m_disjuncts;
 
     SchemeEval* m_eval;
 };
@@ -21,6 +21,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <atomic>
+#include <thread>
+
 #include <opencog/util/Logger.h>
 #include <opencog/atomutils/AtomUtils.h>
 #include <opencog/atomutils/FindUtils.h>
@@ -40,7 +43,9 @@ using namespace opencog;
 /**
  * The constructor for SuRealSCM.
  */
-SuRealSCM::SuRealSCM()
+SuRealSCM::SuRealSCM() :
+    m_index(NULL),
+    m_index_as(NULL)
 {
     static bool is_init = false;
     if (is_init) return;
@@ -48,6 +53,14 @@ SuRealSCM::SuRealSCM()
     scm_with_guile(init_in_guile, this);
 }
 
+/**
+ * The destructor for SuRealSCM.
+ */
+SuRealSCM::~SuRealSCM()
+{
+    delete m_index;
+}
+
 /**
  * Init function for using with scm_with_guile.
  *
@@ -93,6 +106,9 @@ void SuRealSCM::init()
  * WordNode and their LG dictionary entry.  Then construct a compact
  * structure indicating the mappings for each InterpretationNode.
  *
+ * Disconnected components of the input are matched concurrently, and
+ * their results merged afterward in the order of the components.
+ *
  * @param h   a SetLink contains the atoms which will become the clauses
  * @return    a list of the form returned by sureal_get_mapping, but spanning
  *            multiple InterpretationNode
@@ -156,29 +172,78 @@ HandleSeqSeq SuRealSCM::do_sureal_match(Handle h)
 
     logger().debug("[SuReal] Found %d disconnected components", connectedClauses.size());
 
-    std::map<Handle, std::vector<std::map<Handle, Handle> > > collector;
+    // the index of the sentences' clauses, for starting the searches
+    if (m_index_as != pAS)
+    {
+        delete m_index;
+        m_index = new SuRealIndex(pAS);
+        m_index_as = pAS;
+    }
+
+    typedef std::map<Handle, std::vector<std::map<Handle, Handle> > > ResultMap;
 
-    // call the pattern matcher on each set of disconnected commponents
-    for (size_t i=0; i<connectedClauses.size(); i++)
+    const size_t nComponents = connectedClauses.size();
+    std::vector<ResultMap> componentResults(nComponents);
+    std::atomic<bool> bFailed(false);
+    std::atomic<size_t> next(0);
+
+    // call the pattern matcher on each set of disconnected commponents,
+    // stopping as soon as one of them has no result
+    auto worker = [&]()
     {
-        logger().debug("[SuReal] starting pattern matcher");
-        const HandleSeq& qClause(connectedClauses[i]);
-        const std::set<Handle>& qVars(connectedVars[i]);
-
-        // I replaced sVars by qVars in the below. sVars had extra
-        // variables that don't appear anywhere in the clauses -- linas.
-        SuRealPMCB pmcb(pAS, qVars);
-        SatisfactionLinkPtr slp(createSatisfactionLink(qVars, qClause));
-        slp->satisfy(pmcb);
-
-        // no pattern matcher result
-        if (pmcb.m_results.empty())
-            return HandleSeqSeq();
+        for (size_t i = next++; i < nComponents and not bFailed; i = next++)
+        {
+            logger().debug("[SuReal] starting pattern matcher");
+            const HandleSeq& qClause(connectedClauses[i]);
+            const std::set<Handle>& qVars(connectedVars[i]);
+
+            // I replaced sVars by qVars in the below. sVars had extra
+            // variables that don't appear anywhere in the clauses -- linas.
+            SuRealPMCB pmcb(pAS, qVars, m_index);
+            SatisfactionLinkPtr slp(createSatisfactionLink(qVars, qClause));
+            slp->satisfy(pmcb);
+
+            // no pattern matcher result
+            if (pmcb.m_results.empty())
+                bFailed = true;
+
+            componentResults[i].swap(pmcb.m_results);
+        }
+    };
+
+    size_t nThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), nComponents);
+    std::vector<std::thread> workers;
+
+    for (size_t t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(worker));
+
+    // the calling thread takes its share of the work as well
+    worker();
+
+    // leave guile mode while waiting, so that the workers can still
+    // garbage collect when evaluating scheme code
+    auto joinHelper = [](void* p) -> void*
+    {
+        for (std::thread& t : *static_cast<std::vector<std::thread>*>(p))
+            t.join();
+        return NULL;
+    };
+
+    scm_without_guile(joinHelper, &workers);
+
+    if (bFailed)
+        return HandleSeqSeq();
+
+    ResultMap collector;
+
+    for (size_t i = 0; i < nComponents; i++)
+    {
+        ResultMap& results = componentResults[i];
 
         // first disconnected component & result? add it all
         if (collector.empty())
         {
-            collector = pmcb.m_results;
+            collector.swap(results);
             continue;
         }
 
@@ -190,7 +255,7 @@ HandleSeqSeq SuRealSCM::do_sureal_match(Handle h)
         {
             // no common Interpretation, erase the old results as it can no
             // longer be satisfied
-            if (pmcb.m_results.count(it->first) == 0)
+            if (results.count(it->first) == 0)
             {
                 logger().debug("[SuReal] Discarding a result for %s", it->first->toShortString().c_str());
 
@@ -199,7 +264,7 @@ HandleSeqSeq SuRealSCM::do_sureal_match(Handle h)
             }
 
             auto& existingMaps = it->second;                // a vector of previous mappings
-            auto& appendMaps = pmcb.m_results[it->first];   // a vector of unmerged mappings
+            auto& appendMaps = results[it->first];          // a vector of unmerged mappings
             std::vector<std::map<Handle, Handle> > newMaps;
 
             // check all combinations of all the old mappings to the new
@@ -28,6 +28,8 @@
 #include <map>
 #include <opencog/atomspace/Handle.h>
 
+#include "SuRealIndex.h"
+
 
 namespace opencog
 {
@@ -51,8 +53,12 @@ private:
 
     HandleSeqSeq sureal_get_mapping(Handle&, std::vector<std::map<Handle, Handle> >&);
 
+    SuRealIndex* m_index;
+    AtomSpace* m_index_as;
+
 public:
     SuRealSCM();
+    ~SuRealSCM();
 };
 
 }
@@ -27,6 +27,8 @@
 #include <opencog/nlp/wsd/SenseCache.h>
 #include <opencog/nlp/wsd/SenseSimilarityLCH.h>
 #include <opencog/nlp/wsd/SenseSimilaritySQL.h>
+#include <opencog/nlp/wsd/SenseSimilarityStore.h>
+#include <opencog/util/Config.h>
 #include <opencog/util/platform.h>
 
 #define DEBUG
@@ -48,20 +50,36 @@ MihalceaEdge::~MihalceaEdge()
 	atom_space = NULL;
 }
 
+// Number of sense pairs kept in memory once fetched from the slow
+// similarity measures, unless set in the config file.
+#define DEFAULT_SENSE_CACHE_SIZE 1000000
+
 void MihalceaEdge::set_atom_space(AtomSpace *as)
 {
 	atom_space = as;
 	if (sen_sim) delete sen_sim;
 
+	// The similarities are looked up in the store first: the
+	// precomputed file (if any) and the pairs already fetched. The SQL
+	// tables, or the LCH measure, are only used to fill it.
+	size_t cache_size = DEFAULT_SENSE_CACHE_SIZE;
+	if (config().has("SENSE_SIMILARITY_CACHE_SIZE"))
+		cache_size = config().get_int("SENSE_SIMILARITY_CACHE_SIZE");
+	SenseSimilarityStore *store = new SenseSimilarityStore(atom_space, cache_size);
+	if (config().has("SENSE_SIMILARITY_PRELOAD_FILE"))
+		store->preload(config().get("SENSE_SIMILARITY_PRELOAD_FILE"));
+
 #ifdef HAVE_SQL_STORAGE
-	sen_sim = new SenseSimilaritySQL(atom_space);
+	store->add_provider(new SenseSimilaritySQL(atom_space));
 #else
-	fprintf (stderr, 
-		"Warning/Error: MihalceaEdge: proper operation of word-sense \n"
-		"disambiguation requires precomputed sense similarities to be\n"
-		"pulled from SQL stoarage.\n");
-	sen_sim = new SenseSimilarityLCH();
+	if (0 == store->get_preload_size())
+		fprintf (stderr, 
+			"Warning/Error: MihalceaEdge: proper operation of word-sense \n"
+			"disambiguation requires precomputed sense similarities to be\n"
+			"pulled from SQL stoarage or from a preload file.\n");
+	store->add_provider(new SenseSimilarityLCH());
 #endif /* HAVE_SQL_STORAGE */
+	sen_sim = store;
 
 	sense_cache.set_atom_space(as);
 }
@@ -160,6 +178,8 @@ void MihalceaEdge::annotate_parse_pair(const Handle& ha, const Handle& hb)
 	double rate = edge_count / secs;
 	printf("; annotate_parse_pair added %d edges for %d word pairs (rate=%f)\n",
 		edge_count, word_pair_count, rate);
+	printf("; sense similarities: %lu preloaded, %lu cached, %lu fetched\n",
+		sen_sim->get_preload_hits(), sen_sim->get_cache_hits(), sen_sim->get_misses());
 #endif
 }
 
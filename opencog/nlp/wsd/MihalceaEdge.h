@@ -18,7 +18,7 @@
 
 #include "EdgeUtils.h"
 #include "SenseCache.h"
-#include "SenseSimilarity.h"
+#include "SenseSimilarityStore.h"
 
 namespace opencog {
 
@@ -26,7 +26,7 @@ class MihalceaEdge : private EdgeUtils
 {
 	private:
 		AtomSpace *atom_space;
-		SenseSimilarity *sen_sim;
+		SenseSimilarityStore *sen_sim;
 		SenseCache sense_cache;
 		bool annotate_parse_f(const Handle&);
 
@@ -44,6 +44,7 @@ class MihalceaEdge : private EdgeUtils
 		MihalceaEdge();
 		~MihalceaEdge();
 		void set_atom_space(AtomSpace *);
+		SenseSimilarityStore *get_sense_similarity(void) { return sen_sim; }
 		void annotate_sentence(const Handle&);
 		void annotate_parse(const Handle&);
 		void annotate_parse_pair(const Handle&, const Handle&);
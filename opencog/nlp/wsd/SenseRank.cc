@@ -12,6 +12,11 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <opencog/util/platform.h>
 #include <opencog/atomspace/Node.h>
 #include <opencog/atomspace/CountTruthValue.h>
@@ -43,6 +48,15 @@ SenseRank::SenseRank(void)
 	// smaller than the damper, since even large swings in page rank
 	// are damped by the damper. 
 	convergence_limit = 0.3 * convergence_damper;
+
+	// rank_document() iterates until no rank changes by more than
+	// this. The ranks are of order 1, so this is much tighter than
+	// what the random walk achieves.
+	tolerance = 1.0e-6;
+	max_iterations = 500;
+
+	n_threads = std::thread::hardware_concurrency();
+	if (0 == n_threads) n_threads = 1;
 }
 
 SenseRank::~SenseRank()
@@ -62,7 +76,246 @@ void SenseRank::rank_sentence(const Handle& h)
 	foreach_parse(h, &SenseRank::rank_parse_f, this);
 }
 
+/**
+ * Rank the senses of a whole document.
+ *
+ * The sense graph is copied out of the atomspace into a sparse matrix
+ * once, the page-rank equations (see rank_sense() below) are solved on
+ * it by power iteration, and the ranks are written back to the sense
+ * links at the end. This gives the stationary ranks the random walk of
+ * walk_document() approximates, without going through the atomspace at
+ * each step.
+ */
 void SenseRank::rank_document(const std::deque<Handle> &parse_list)
+{
+	std::deque<Handle>::const_iterator i;
+	for (i = parse_list.begin(); i != parse_list.end(); ++i)
+	{
+		init_parse(*i);
+	}
+
+	build_graph(parse_list);
+	unsigned int iterations = solve();
+
+#ifdef DEBUG
+	printf ("; SenseRank: %zu senses, %zu edges, converged in %u iterations\n",
+	        nodes.size(), col.size() / 2, iterations);
+#endif
+	if (max_iterations <= iterations)
+		logger().warn("SenseRank: no convergence after %u iterations", iterations);
+
+	// Write the ranks back. Disconnected senses are left alone, as the
+	// random walk would never have visited them.
+	for (size_t n = 0; n < nodes.size(); n++)
+	{
+		if (row[n] == row[n+1]) continue;
+		TruthValuePtr ctv(CountTruthValue::createTV(1.0, 0.0, (float) rank[n]));
+		nodes[n]->setTruthValue(ctv);
+	}
+}
+
+size_t SenseRank::add_node(const Handle& h)
+{
+	std::unordered_map<Handle, size_t, handle_hash>::const_iterator it =
+		node_index.find(h);
+	if (it != node_index.end()) return it->second;
+	size_t n = nodes.size();
+	node_index[h] = n;
+	nodes.push_back(h);
+	return n;
+}
+
+bool SenseRank::collect_word(const Handle& h)
+{
+	foreach_word_sense_of_inst(h, &SenseRank::collect_sense, this);
+	return false;
+}
+
+bool SenseRank::collect_sense(const Handle& word_sense_h,
+                              const Handle& sense_link_h)
+{
+	if (Handle::UNDEFINED != sense_link_h) add_node(sense_link_h);
+	return false;
+}
+
+bool SenseRank::collect_edge(const Handle& sense_b_h, const Handle& hedge)
+{
+	col.push_back(add_node(sense_b_h));
+	edge_weight.push_back(hedge->getTruthValue()->getMean());
+	return false;
+}
+
+/**
+ * Snapshot the sense graph reachable from the senses of the parses.
+ * The random walk may wander to senses of parses outside of the list
+ * (sense edges join adjacent sentences), so those are included too.
+ */
+void SenseRank::build_graph(const std::deque<Handle> &parse_list)
+{
+	nodes.clear();
+	node_index.clear();
+	row.clear();
+	col.clear();
+	edge_weight.clear();
+
+	std::deque<Handle>::const_iterator i;
+	for (i = parse_list.begin(); i != parse_list.end(); ++i)
+	{
+		foreach_word_instance(*i, &SenseRank::collect_word, this);
+	}
+
+	// Nodes get appended while their neighbours are collected, so this
+	// is a breadth-first traversal.
+	row.push_back(0);
+	for (size_t n = 0; n < nodes.size(); n++)
+	{
+		foreach_sense_edge(nodes[n], &SenseRank::collect_edge, this);
+		row.push_back(col.size());
+	}
+
+	// Normalize: t_ab = w_ab / (sum_c w_cb)
+	std::vector<double> edge_sum(nodes.size(), 0.0);
+	for (size_t n = 0; n < nodes.size(); n++)
+		for (size_t k = row[n]; k < row[n+1]; k++)
+			edge_sum[n] += edge_weight[k];
+
+	trans.resize(col.size());
+	for (size_t k = 0; k < col.size(); k++)
+	{
+		double sum = edge_sum[col[k]];
+		trans[k] = (0.0 < sum) ? edge_weight[k] / sum : 0.0;
+	}
+
+	rank.resize(nodes.size());
+	for (size_t n = 0; n < nodes.size(); n++)
+		rank[n] = nodes[n]->getTruthValue()->getCount();
+}
+
+/**
+ * One Jacobi step of the page-rank equations for the nodes [from, to),
+ * reading the current ranks and writing into next. Returns the largest
+ * change.
+ */
+double SenseRank::iterate(std::vector<double> &next, size_t from, size_t to) const
+{
+	double delta = 0.0;
+	for (size_t n = from; n < to; n++)
+	{
+		if (row[n] == row[n+1])
+		{
+			next[n] = rank[n];
+			continue;
+		}
+		double sum = 0.0;
+		for (size_t k = row[n]; k < row[n+1]; k++)
+			sum += trans[k] * rank[col[k]];
+		double r = (1.0 - damping_factor) + damping_factor * sum;
+		delta = std::max(delta, fabs(r - rank[n]));
+		next[n] = r;
+	}
+	return delta;
+}
+
+// Below this many senses, starting threads costs more than it saves.
+#define PARALLEL_THRESHOLD 4096
+
+namespace {
+
+/**
+ * Blocks the threads calling wait() until all of them have, then lets
+ * them all go; reusable for the next round.
+ */
+class Barrier
+{
+	private:
+		std::mutex mtx;
+		std::condition_variable cv;
+		unsigned int count;
+		unsigned int waiting;
+		unsigned long generation;
+
+	public:
+		Barrier(unsigned int n) : count(n), waiting(0), generation(0) {}
+
+		void wait(void)
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			unsigned long gen = generation;
+			if (++waiting == count)
+			{
+				waiting = 0;
+				generation++;
+				cv.notify_all();
+				return;
+			}
+			cv.wait(lock, [&]() { return gen != generation; });
+		}
+};
+
+}
+
+/**
+ * Power iteration until no rank moves by more than the tolerance.
+ * Returns the number of iterations done.
+ *
+ * Large graphs are split in row blocks, one per thread. The threads
+ * are started once, and meet at a barrier after each step: the first
+ * one then swaps the ranks and decides whether to go on, while the
+ * others wait at a second barrier.
+ */
+unsigned int SenseRank::solve(void)
+{
+	size_t n = nodes.size();
+	std::vector<double> next(n);
+	unsigned int threads = (n < PARALLEL_THRESHOLD) ? 1 : n_threads;
+
+	unsigned int iter = 0;
+	if (1 == threads)
+	{
+		while (iter < max_iterations)
+		{
+			double delta = iterate(next, 0, n);
+			rank.swap(next);
+			iter++;
+			if (delta < tolerance) break;
+		}
+		return iter;
+	}
+
+	size_t chunk = (n + threads - 1) / threads;
+	std::vector<double> deltas(threads, 0.0);
+	Barrier stepped(threads), swapped(threads);
+	bool done = (0 == max_iterations);
+
+	auto work = [&](unsigned int t)
+	{
+		size_t from = std::min(n, t * chunk);
+		size_t to = std::min(n, from + chunk);
+		while (!done)
+		{
+			deltas[t] = iterate(next, from, to);
+			stepped.wait();
+			if (0 == t)
+			{
+				rank.swap(next);
+				iter++;
+				double delta = *std::max_element(deltas.begin(), deltas.end());
+				done = (delta < tolerance) || (max_iterations <= iter);
+			}
+			swapped.wait();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int t = 1; t < threads; t++)
+		workers.push_back(std::thread(work, t));
+	work(0);
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+	return iter;
+}
+
+void SenseRank::walk_document(const std::deque<Handle> &parse_list)
 {
 	// Iterate over list of parses making up a "document"
 	std::deque<Handle>::const_iterator i;
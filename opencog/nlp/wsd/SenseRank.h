@@ -13,6 +13,8 @@
 #include <opencog/atomspace/Handle.h>
 
 #include <deque>
+#include <vector>
+#include <unordered_map>
 
 namespace opencog {
 
@@ -47,6 +49,31 @@ class SenseRank
 
 		void log_bad_sense(const Handle&, const std::string&, bool);
 
+		// Snapshot of the sense graph of a document, in compressed
+		// sparse row form: the neighbours of node i are
+		// col[row[i]] .. col[row[i+1]-1], and trans[k] is the
+		// transition weight w_ab / (sum_c w_cb) from col[k] to i.
+		std::vector<Handle> nodes;
+		std::unordered_map<Handle, size_t, handle_hash> node_index;
+		std::vector<size_t> row;
+		std::vector<size_t> col;
+		std::vector<double> trans;
+		std::vector<double> rank;
+
+		std::vector<double> edge_weight;
+
+		size_t add_node(const Handle&);
+		bool collect_sense(const Handle&, const Handle&);
+		bool collect_word(const Handle&);
+		bool collect_edge(const Handle&, const Handle&);
+		void build_graph(const std::deque<Handle> &);
+		double iterate(std::vector<double> &, size_t, size_t) const;
+		unsigned int solve(void);
+
+		double tolerance;
+		unsigned int max_iterations;
+		unsigned int n_threads;
+
 	public:
 		SenseRank();
 		~SenseRank();
@@ -55,6 +82,13 @@ class SenseRank
 		void rank_sentence(const Handle&);
 		void rank_document(const std::deque<Handle> &);
 
+		/**
+		 * The original random-walk ranking of a document, kept for
+		 * comparison purposes: rank_document() solves the same
+		 * equations by power iteration over a snapshot of the graph.
+		 */
+		void walk_document(const std::deque<Handle> &);
+
 };
 
 } // namespace opencog
@@ -0,0 +1,301 @@
+/*
+ * SenseSimilarityStore.cc
+ *
+ * In-memory store of word-sense similarities: a memory-mapped table of
+ * precomputed similarities, an LRU cache, and the slow similarity
+ * measures as backfill.
+ *
+ * Copyright (c) 2014 OpenCog Foundation
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/nlp/wsd/SenseSimilarityStore.h>
+#include <opencog/util/Logger.h>
+
+using namespace opencog;
+
+static const char preload_magic[8] = { 'W', 'S', 'D', 'S', 'I', 'M', '1', '\n' };
+
+// Confidence given to the preloaded similarities, the same as the one
+// of the SQL tables they are typically dumped from.
+#define PRELOAD_CONFIDENCE 0.9f
+
+static inline uint64_t pair_key(uint32_t a, uint32_t b)
+{
+	return (((uint64_t) a) << 32) | b;
+}
+
+SenseSimilarityStore::SenseSimilarityStore(AtomSpace *_as, size_t cache_size,
+                                           uint32_t _max_new_senses)
+	: as(_as), next_id(0), max_new_senses(std::max(_max_new_senses, 2u)),
+	  map_addr(NULL), map_size(0), records(NULL), nrecords(0),
+	  preload_senses(0), capacity(cache_size),
+	  preload_hits(0), cache_hits(0), misses(0)
+{
+}
+
+SenseSimilarityStore::~SenseSimilarityStore()
+{
+	unmap();
+	for (size_t i = 0; i < providers.size(); i++)
+		delete providers[i];
+}
+
+void SenseSimilarityStore::add_provider(SenseSimilarity *p)
+{
+	providers.push_back(p);
+}
+
+void SenseSimilarityStore::unmap(void)
+{
+	if (map_addr) munmap(map_addr, map_size);
+	map_addr = NULL;
+	map_size = 0;
+	records = NULL;
+	nrecords = 0;
+}
+
+bool SenseSimilarityStore::preload(const std::string& filename)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		logger().error("SenseSimilarityStore: cannot open %s", filename.c_str());
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t) st.st_size < 32)
+	{
+		logger().error("SenseSimilarityStore: %s is too short", filename.c_str());
+		close(fd);
+		return false;
+	}
+	void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == addr)
+	{
+		logger().error("SenseSimilarityStore: cannot map %s", filename.c_str());
+		return false;
+	}
+
+	const char *base = (const char *) addr;
+	uint32_t nsenses;
+	uint64_t npairs, names_size;
+	memcpy(&nsenses, base + 8, sizeof(nsenses));
+	memcpy(&npairs, base + 16, sizeof(npairs));
+	memcpy(&names_size, base + 24, sizeof(names_size));
+	uint64_t names_end = 32 + names_size;
+	uint64_t records_start = (names_end + 3) & ~((uint64_t) 3);
+	if (memcmp(base, preload_magic, 8) ||
+	    records_start + npairs * sizeof(Record) != (uint64_t) st.st_size)
+	{
+		logger().error("SenseSimilarityStore: %s is not a sense similarity file",
+		               filename.c_str());
+		munmap(addr, st.st_size);
+		return false;
+	}
+
+	unmap();
+	map_addr = addr;
+	map_size = st.st_size;
+
+	// The senses of the file take the first ids, the ones seen so far
+	// are renumbered.
+	sense_ids.clear();
+	handle_ids.clear();
+	lru.clear();
+	cache.clear();
+	const char *name = base + 32;
+	for (uint32_t i = 0; i < nsenses && name < base + names_end; i++)
+	{
+		sense_ids[std::string(name)] = i;
+		name += strlen(name) + 1;
+	}
+	preload_senses = nsenses;
+	next_id = nsenses;
+
+	records = (const Record *) (base + records_start);
+	nrecords = npairs;
+
+	logger().info("SenseSimilarityStore: mapped %llu similarities of %u senses from %s",
+	              (unsigned long long) nrecords, nsenses, filename.c_str());
+	return true;
+}
+
+bool SenseSimilarityStore::write_preload_file(const std::string& filename,
+                                              const std::vector<Entry>& entries)
+{
+	std::vector<std::string> names;
+	std::unordered_map<std::string, uint32_t> ids;
+	std::vector<Record> recs;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const std::string *pair[2] = { &entries[i].first, &entries[i].second };
+		uint32_t pid[2];
+		for (int j = 0; j < 2; j++)
+		{
+			std::unordered_map<std::string, uint32_t>::const_iterator it =
+				ids.find(*pair[j]);
+			if (it == ids.end())
+			{
+				pid[j] = names.size();
+				ids[*pair[j]] = pid[j];
+				names.push_back(*pair[j]);
+			}
+			else pid[j] = it->second;
+		}
+		Record r = { pid[0], pid[1], entries[i].similarity };
+		recs.push_back(r);
+	}
+	std::sort(recs.begin(), recs.end(), [](const Record& a, const Record& b)
+	{
+		return pair_key(a.first, a.second) < pair_key(b.first, b.second);
+	});
+
+	std::string name_block;
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		name_block += names[i];
+		name_block.push_back('\0');
+	}
+
+	std::ofstream out(filename.c_str(), std::ios::binary);
+	if (!out) return false;
+	uint32_t nsenses = names.size();
+	uint32_t pad = 0;
+	uint64_t npairs = recs.size();
+	uint64_t names_size = name_block.size();
+	out.write(preload_magic, 8);
+	out.write((const char *) &nsenses, sizeof(nsenses));
+	out.write((const char *) &pad, sizeof(pad));
+	out.write((const char *) &npairs, sizeof(npairs));
+	out.write((const char *) &names_size, sizeof(names_size));
+	out.write(name_block.data(), name_block.size());
+	static const char zeros[4] = { 0, 0, 0, 0 };
+	out.write(zeros, (4 - names_size % 4) % 4);
+	if (!recs.empty())
+		out.write((const char *) &recs[0], recs.size() * sizeof(Record));
+	return out.good();
+}
+
+void SenseSimilarityStore::forget_new_senses(void)
+{
+	std::unordered_map<std::string, uint32_t>::iterator si = sense_ids.begin();
+	while (si != sense_ids.end())
+	{
+		if (si->second >= preload_senses) si = sense_ids.erase(si);
+		else ++si;
+	}
+	next_id = preload_senses;
+
+	// The handles and the cached pairs may refer to the ids forgotten.
+	handle_ids.clear();
+	lru.clear();
+	cache.clear();
+}
+
+uint32_t SenseSimilarityStore::sense_id(const Handle& h)
+{
+	std::unordered_map<Handle, uint32_t, handle_hash>::const_iterator hi =
+		handle_ids.find(h);
+	if (hi != handle_ids.end()) return hi->second;
+
+	// There is at most one handle per sense in an atomspace, but the
+	// handles of deleted atoms, or of other atomspaces, pile up too.
+	if (handle_ids.size() >= sense_ids.size() + max_new_senses)
+		handle_ids.clear();
+
+	uint32_t id;
+	const std::string &name = as->getName(h);
+	std::unordered_map<std::string, uint32_t>::const_iterator si =
+		sense_ids.find(name);
+	if (si != sense_ids.end()) id = si->second;
+	else
+	{
+		id = next_id++;
+		sense_ids[name] = id;
+	}
+	handle_ids[h] = id;
+	return id;
+}
+
+bool SenseSimilarityStore::find_preloaded(uint64_t key, float& sim) const
+{
+	const Record *end = records + nrecords;
+	const Record *r = std::lower_bound(records, end, key,
+		[](const Record& rec, uint64_t k)
+		{
+			return pair_key(rec.first, rec.second) < k;
+		});
+	if (r == end || pair_key(r->first, r->second) != key) return false;
+	sim = r->similarity;
+	return true;
+}
+
+SimpleTruthValuePtr SenseSimilarityStore::backfill(const Handle& first,
+                                                   const Handle& second)
+{
+	// As the SQL tables do, report no similarity if nobody knows.
+	SimpleTruthValuePtr tv = SimpleTruthValue::createSTV(0.0f, 0.9f);
+	for (size_t i = 0; i < providers.size(); i++)
+	{
+		tv = providers[i]->similarity(first, second);
+		if (0.0 < tv->getMean()) break;
+	}
+	return tv;
+}
+
+SimpleTruthValuePtr SenseSimilarityStore::similarity(const Handle& first,
+                                                     const Handle& second)
+{
+	// Make room for two new senses first, so that the ids of the pair
+	// are handed out between the same two forgets.
+	if (next_id - preload_senses + 2 > max_new_senses)
+		forget_new_senses();
+
+	uint32_t a = sense_id(first);
+	uint32_t b = sense_id(second);
+	uint64_t key = pair_key(a, b);
+
+	float sim;
+	if (a < preload_senses && b < preload_senses && find_preloaded(key, sim))
+	{
+		preload_hits++;
+		return SimpleTruthValue::createSTV(sim, PRELOAD_CONFIDENCE);
+	}
+
+	lru_map::iterator ci = cache.find(key);
+	if (ci != cache.end())
+	{
+		cache_hits++;
+		lru.splice(lru.begin(), lru, ci->second);
+		const CacheEntry &e = *ci->second;
+		return SimpleTruthValue::createSTV(e.mean, e.confidence);
+	}
+
+	misses++;
+	SimpleTruthValuePtr tv = backfill(first, second);
+	if (0 < capacity)
+	{
+		if (cache.size() >= capacity)
+		{
+			cache.erase(lru.back().key);
+			lru.pop_back();
+		}
+		CacheEntry e = { key, tv->getMean(), tv->getConfidence() };
+		lru.push_front(e);
+		cache[key] = lru.begin();
+	}
+	return tv;
+}
+
+/* ============================== END OF FILE ====================== */
@@ -0,0 +1,155 @@
+/*
+ * SenseSimilarityStore.h
+ *
+ * In-memory store of word-sense similarities, sitting in front of the
+ * slower similarity measures (SQL lookups, LCH computation).
+ *
+ * Copyright (c) 2014 OpenCog Foundation
+ */
+
+#ifndef _OPENCOG_SENSE_SIMILARITY_STORE_H
+#define _OPENCOG_SENSE_SIMILARITY_STORE_H
+
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atomspace/Handle.h>
+#include <opencog/atomspace/SimpleTruthValue.h>
+#include <opencog/nlp/wsd/SenseSimilarity.h>
+
+namespace opencog {
+
+class AtomSpace;
+
+/**
+ * Sense similarities are looked up in three tiers:
+ *
+ * 1) A precomputed similarity file (see write_preload_file() for the
+ *    format), memory-mapped and searched in place. Nothing is copied
+ *    but the sense names, so very large tables cost no heap and are
+ *    shared between processes by the page cache.
+ * 2) An LRU cache of the pairs obtained from the providers, keyed on
+ *    a pair of 32-bit sense ids packed into a 64-bit integer.
+ * 3) The backfill providers (e.g. SenseSimilaritySQL, then
+ *    SenseSimilarityLCH), asked in order until one of them reports a
+ *    non-zero similarity.
+ *
+ * Senses are identified by the name of their WordSenseNode, the same
+ * key as used by the SQL tables. Pairs are ordered, (a,b) and (b,a)
+ * are distinct entries.
+ */
+class SenseSimilarityStore :
+	public SenseSimilarity
+{
+	public:
+		struct Entry
+		{
+			std::string first;
+			std::string second;
+			float similarity;
+		};
+
+	private:
+		AtomSpace *as;
+
+		// Backfill providers, owned by the store.
+		std::vector<SenseSimilarity *> providers;
+
+		// Sense ids. Ids below preload_senses are the ones of the file,
+		// the others are handed out as new senses come up, up to
+		// max_new_senses of them; then they are all forgotten, with
+		// the cached pairs using them, and handed out anew.
+		std::unordered_map<std::string, uint32_t> sense_ids;
+		std::unordered_map<Handle, uint32_t, handle_hash> handle_ids;
+		uint32_t next_id;
+		uint32_t max_new_senses;
+		uint32_t sense_id(const Handle&);
+		void forget_new_senses(void);
+
+		// Memory-mapped preload file
+		struct Record
+		{
+			uint32_t first;
+			uint32_t second;
+			float similarity;
+		};
+		void *map_addr;
+		size_t map_size;
+		const Record *records;
+		uint64_t nrecords;
+		uint32_t preload_senses;
+		void unmap(void);
+		bool find_preloaded(uint64_t, float&) const;
+
+		// LRU tier
+		struct CacheEntry
+		{
+			uint64_t key;
+			float mean;
+			float confidence;
+		};
+		typedef std::list<CacheEntry> lru_list;
+		typedef std::unordered_map<uint64_t, lru_list::iterator> lru_map;
+		size_t capacity;
+		lru_list lru;
+		lru_map cache;
+
+		unsigned long preload_hits;
+		unsigned long cache_hits;
+		unsigned long misses;
+
+		SimpleTruthValuePtr backfill(const Handle&, const Handle&);
+
+	public:
+		/**
+		 * cache_size is the maximum number of pairs kept in the LRU
+		 * tier, 0 disables it. max_new_senses is the maximum number of
+		 * senses, not in the preload file, that are given an id.
+		 */
+		SenseSimilarityStore(AtomSpace *, size_t cache_size,
+		                     uint32_t max_new_senses = 1 << 20);
+		virtual ~SenseSimilarityStore();
+
+		/**
+		 * Append a backfill provider. The store takes ownership.
+		 */
+		void add_provider(SenseSimilarity *);
+
+		/**
+		 * Map a precomputed similarity file, replacing the previous
+		 * one, if any. Returns false if the file cannot be mapped or
+		 * is not a similarity file.
+		 */
+		bool preload(const std::string& filename);
+
+		/**
+		 * Write a file suitable for preload().
+		 *
+		 * Layout (native byte order): the 8 byte magic "WSDSIM1\n",
+		 * the number of senses (uint32), padding (uint32), the number
+		 * of pairs (uint64), the size of the name block (uint64), the
+		 * name block (null-terminated sense names, the position of a
+		 * name being its id) padded to 4 bytes, then the pairs as
+		 * (uint32 first id, uint32 second id, float similarity),
+		 * sorted by ids.
+		 */
+		static bool write_preload_file(const std::string& filename,
+		                               const std::vector<Entry>&);
+
+		virtual SimpleTruthValuePtr similarity(const Handle&, const Handle&);
+
+		unsigned long get_preload_hits(void) const { return preload_hits; }
+		unsigned long get_cache_hits(void) const { return cache_hits; }
+		unsigned long get_misses(void) const { return misses; }
+		size_t get_cache_size(void) const { return cache.size(); }
+		size_t get_sense_count(void) const { return sense_ids.size(); }
+		size_t get_handle_count(void) const { return handle_ids.size(); }
+		uint64_t get_preload_size(void) const { return nrecords; }
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_SENSE_SIMILARITY_STORE_H
@@ -0,0 +1,124 @@
+/*
+ * sense-rank-benchmark.cc
+ *
+ * Compare the random-walk ranking of SenseRank::walk_document() with
+ * the power iteration of SenseRank::rank_document() on a synthetic,
+ * but fixed, document. The graph has the shape Mihalcea::process_document
+ * builds: parses referencing a list of word instances, each with a few
+ * candidate word senses, and weighted cosense edges between the senses
+ * of nearby words.
+ *
+ * Copyright (c) 2014 OpenCog Foundation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/CountTruthValue.h>
+#include <opencog/atomspace/SimpleTruthValue.h>
+#include <opencog/nlp/types/atom_types.h>
+#include <opencog/nlp/wsd/SenseRank.h>
+
+using namespace opencog;
+
+static std::deque<Handle> make_document(AtomSpace *as, int n_parses,
+                                        int n_words, int n_senses, int window)
+{
+	std::deque<Handle> parse_list;
+	std::vector<std::vector<Handle> > senses;
+	char name[64];
+
+	for (int p = 0; p < n_parses; p++)
+	{
+		std::vector<Handle> words;
+		for (int w = 0; w < n_words; w++)
+		{
+			snprintf(name, sizeof(name), "word@%d_%d", p, w);
+			Handle word = as->addNode(WORD_INSTANCE_NODE, name);
+			words.push_back(word);
+
+			std::vector<Handle> word_senses;
+			for (int s = 0; s < n_senses; s++)
+			{
+				snprintf(name, sizeof(name), "sense%d%%%d", rand() % 1000, s);
+				std::vector<Handle> out;
+				out.push_back(word);
+				out.push_back(as->addNode(WORD_SENSE_NODE, name));
+				TruthValuePtr ctv(CountTruthValue::createTV(1.0f, 0.0f, 1.0f));
+				Handle sl = as->addLink(INHERITANCE_LINK, out);
+				sl->setTruthValue(ctv);
+				word_senses.push_back(sl);
+			}
+			senses.push_back(word_senses);
+		}
+
+		snprintf(name, sizeof(name), "parse_%d", p);
+		Handle parse = as->addNode(PARSE_NODE, name);
+		std::vector<Handle> ref;
+		ref.push_back(parse);
+		ref.push_back(as->addLink(LIST_LINK, words));
+		as->addLink(REFERENCE_LINK, ref);
+		parse_list.push_back(parse);
+	}
+
+	// Join the senses of words at most window words apart, crossing
+	// sentence boundaries, as MihalceaEdge does for adjacent sentences.
+	for (size_t i = 0; i < senses.size(); i++)
+	{
+		for (size_t j = i + 1; j < senses.size() && j <= i + window; j++)
+		{
+			for (size_t a = 0; a < senses[i].size(); a++)
+			{
+				for (size_t b = 0; b < senses[j].size(); b++)
+				{
+					double sim = (rand() % 1000) / 1000.0;
+					if (sim < 0.01) continue;
+					std::vector<Handle> out;
+					out.push_back(senses[i][a]);
+					out.push_back(senses[j][b]);
+					TruthValuePtr stv(SimpleTruthValue::createTV(sim, 1.0));
+					as->addLink(COSENSE_LINK, out)->setTruthValue(stv);
+				}
+			}
+		}
+	}
+	return parse_list;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+	return d.count();
+}
+
+int main(int argc, char *argv[])
+{
+	int n_parses = (1 < argc) ? atoi(argv[1]) : 50;
+	int n_words = 15;
+	int n_senses = 5;
+	int window = 6;
+
+	srand(42);
+	AtomSpace as;
+	std::deque<Handle> parse_list =
+		make_document(&as, n_parses, n_words, n_senses, window);
+	printf("Document of %d parses, %d senses\n",
+	       n_parses, n_parses * n_words * n_senses);
+
+	SenseRank ranker;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ranker.walk_document(parse_list);
+	printf("random walk:     %.3f seconds\n", seconds_since(start));
+
+	start = std::chrono::steady_clock::now();
+	ranker.rank_document(parse_list);
+	printf("power iteration: %.3f seconds\n", seconds_since(start));
+
+	return 0;
+}
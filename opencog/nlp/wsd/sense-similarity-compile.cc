@@ -0,0 +1,55 @@
+/*
+ * sense-similarity-compile.cc
+ *
+ * Convert a text dump of sense similarities into a file that can be
+ * memory-mapped by SenseSimilarityStore. The input has one pair per
+ * line: <first sense> <second sense> <similarity>, similarities being
+ * normalized to [0,1] as done in SenseSimilaritySQL. Such a dump can
+ * be produced from the SensePairScores table.
+ *
+ * Copyright (c) 2014 OpenCog Foundation
+ */
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <opencog/nlp/wsd/SenseSimilarityStore.h>
+
+using namespace opencog;
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <text dump> <output file>\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream in(argv[1]);
+	if (!in)
+	{
+		fprintf(stderr, "Cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	std::vector<SenseSimilarityStore::Entry> entries;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		std::istringstream ss(line);
+		SenseSimilarityStore::Entry e;
+		if (ss >> e.first >> e.second >> e.similarity)
+			entries.push_back(e);
+	}
+
+	if (!SenseSimilarityStore::write_preload_file(argv[2], entries))
+	{
+		fprintf(stderr, "Cannot write %s\n", argv[2]);
+		return 1;
+	}
+	printf("Wrote %zu sense similarities to %s\n", entries.size(), argv[2]);
+	return 0;
+}
@@ -33,12 +33,17 @@
 #include <opencog/atomspace/Atom.h>
 #include <opencog/spacetime/SpaceServer.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <cstdlib>
 
 using namespace opencog;
 
+// Marks a space map followed by its history; repositories saved before
+// the history was kept have none.
+static const char HISTORY_TAG[4] = {'H', 'I', 'S', 'T'};
+
 SpaceServerSavable::SpaceServerSavable()
 {
     server = NULL;
@@ -101,6 +106,8 @@ void SpaceServerSavable::saveRepository(FILE * fp) const
         fwrite(&floorHeight, sizeof(int), 1, fp);
 
         map->save(fp);
+        fwrite(HISTORY_TAG, sizeof(HISTORY_TAG), 1, fp);
+        map->getHistory().save(fp);
     }
     /*
     unsigned int persistentHandlesSize = server->persistentMapHandles.size();
@@ -144,6 +151,26 @@ void SpaceServerSavable::loadRepository(FILE* fp, HandMapPtr conv)
         SpaceServer::SpaceMap *map = new SpaceServer::SpaceMap(mapName,xMin,yMin,zMin,xDim,yDim,zDim,floorHeight);
         map->load(fp);
 
+        // the history refers to the atoms by their old handles; the atoms
+        // that were not saved are dropped from it
+        long historyPos = ftell(fp);
+        char tag[sizeof(HISTORY_TAG)];
+        if (fread(tag, sizeof(tag), 1, fp) == 1 &&
+            std::equal(tag, tag + sizeof(tag), HISTORY_TAG)) {
+            spatial::SpaceMapHistory& history = map->getHistory();
+            bool historyRead = history.load(fp);
+            OC_ASSERT(historyRead,
+                    "SpaceServerSavable - Failed read of space map history.");
+            history.updateHandles([&conv](const Handle& h) {
+                return conv->contains(h) ? conv->get(h)->getHandle() : Handle::UNDEFINED;
+            });
+        } else {
+            logger().info("SpaceServerSavable - No history saved for map %s.",
+                          mapName.c_str());
+            clearerr(fp);
+            fseek(fp, historyPos, SEEK_SET);
+        }
+
         OC_ASSERT(conv->contains(mapHandle),
                 "SpaceServerSavable - HandleMap conv does not contain mapHandle.");
         Handle newMapHandle = conv->get(mapHandle)->getHandle();
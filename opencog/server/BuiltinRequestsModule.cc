@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <fstream>
 #include <iomanip>
 
 #include <opencog/server/CogServer.h>
@@ -72,6 +73,7 @@ void BuiltinRequestsModule::registerAgentRequests()
     do_stopAgentLoop_register();
     do_listAgents_register();
     do_activeAgents_register();
+    do_profile_register();
 }
 
 void BuiltinRequestsModule::unregisterAgentRequests()
@@ -91,6 +93,7 @@ void BuiltinRequestsModule::unregisterAgentRequests()
     do_stopAgentLoop_unregister();
     do_listAgents_unregister();
     do_activeAgents_unregister();
+    do_profile_unregister();
 }
 
 void BuiltinRequestsModule::init()
@@ -328,3 +331,54 @@ std::string BuiltinRequestsModule::do_activeAgents(Request *dummy, std::list<std
 
     return oss.str();
 }
+
+std::string BuiltinRequestsModule::do_profile(Request *dummy, std::list<std::string> args)
+{
+    Profiler& profiler = _cogserver.systemActivityTable().profiler();
+    std::vector<std::string> argv(args.begin(), args.end());
+    std::string command = argv.empty() ? "text" : argv[0];
+
+    if (command == "text" && argv.size() <= 1)
+        return profiler.textSnapshot();
+    if (command == "json" && argv.size() == 1)
+        return profiler.jsonSnapshot();
+    if (command == "reset" && argv.size() == 1) {
+        profiler.reset();
+        return "Profile cleared\n";
+    }
+    if ((command == "on" || command == "off") && argv.size() == 1) {
+        profiler.setEnabled(command == "on");
+        return "Profiling " + command + "\n";
+    }
+
+    std::string mode = argv.size() > 1 ? argv[1] : "";
+    if (command == "trace" && mode == "start" && argv.size() <= 3) {
+        int events = argv.size() > 2 ? atoi(argv[2].c_str()) : 100000;
+        if (events <= 0)
+            return "profile: Error: invalid number of events\n";
+        profiler.setTraceCapacity(events);
+        std::ostringstream oss;
+        oss << "Tracing the last " << events << " runs\n";
+        return oss.str();
+    }
+    if (command == "trace" && mode == "stop" && argv.size() == 2) {
+        profiler.setTraceCapacity(0);
+        return "Tracing stopped\n";
+    }
+    if (command == "trace" && mode == "save" && argv.size() == 3) {
+        if (!profiler.hasTrace())
+            return "profile: Error: nothing traced, use 'profile trace start'\n";
+        std::ofstream out(argv[2].c_str());
+        if (!out.good())
+            return "profile: Error: can't write to " + argv[2] + "\n";
+        std::ostringstream oss;
+        oss << profiler.writeChromeTrace(out) << " events written to "
+            << argv[2] << "\n";
+        return oss.str();
+    }
+
+    return "profile: Error: invalid command syntax\n"
+           "Usage: profile [text|json]\n"
+           "       profile reset|on|off\n"
+           "       profile trace start [<events>]|stop|save <file>\n";
+}
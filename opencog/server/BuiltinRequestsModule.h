@@ -141,6 +141,19 @@ DECLARE_CMD_REQUEST(BuiltinRequestsModule, "agents-active", do_activeAgents,
        "List all the currently running agents, including their configuration parameters.\n",
        false, false)
 
+DECLARE_CMD_REQUEST(BuiltinRequestsModule, "profile", do_profile,
+       "Show the profile of the agents and requests",
+       "Usage: profile [text|json]\n"
+       "       profile reset|on|off\n"
+       "       profile trace start [<events>]|stop|save <file>\n\n"
+       "Print the histograms of the latency, atoms added and memory used by the\n"
+       "runs of each agent and request, and of the phases timed by the agents.\n"
+       "'reset' clears them, 'on' and 'off' switch the profiling on and off.\n"
+       "'trace start' also keeps the last <events> runs (default 100000), and\n"
+       "'trace save' writes them as a Chrome trace (chrome://tracing, Perfetto),\n"
+       "while tracing or after 'trace stop'.\n",
+       false, false)
+
     void registerAgentRequests();
     void unregisterAgentRequests();
 
@@ -189,6 +189,12 @@ void CogServer::serverLoop()
     time_t cycle_duration = config().get_int("SERVER_CYCLE_DURATION") * 1000;
 //    bool externalTickMode = config().get_bool("EXTERNAL_TICK_MODE");
 
+    Profiler& profiler = _systemActivityTable.profiler();
+    if (config().has("PROFILING"))
+        profiler.setEnabled(config().get_bool("PROFILING"));
+    if (config().has("PROFILE_TRACE_EVENTS"))
+        profiler.setTraceCapacity(config().get_int("PROFILE_TRACE_EVENTS"));
+
     logger().info("Starting CogServer loop.");
 
     gettimeofday(&timer_start, NULL);
@@ -293,7 +299,19 @@ void CogServer::processRequests(void)
     std::unique_lock<std::mutex> lock(processRequestsMutex);
     while (0 < getRequestQueueSize()) {
         Request* request = popRequest();
-        request->execute();
+        Profiler& profiler = _systemActivityTable.profiler();
+        if (profiler.enabled()) {
+            ProfileEntry& entry = profiler.entry("request/" + request->name());
+            size_t atoms_start = atomSpace->getSize();
+            {
+                ProfileScope scope(entry);
+                request->execute();
+            }
+            size_t atoms_end = atomSpace->getSize();
+            entry.atoms.record(atoms_end > atoms_start ? atoms_end - atoms_start : 0);
+        } else {
+            request->execute();
+        }
         delete request;
     }
 }
@@ -315,7 +333,16 @@ void CogServer::runAgent(AgentPtr agent)
                    agent->classinfo().id.c_str(),  this->cycleCount);
 
     agent->resetUtilizedHandleSets();
-    agent->run();
+    // the entry is only looked up (its name built and hashed) when profiling
+    Profiler& profiler = _systemActivityTable.profiler();
+    ProfileEntry* entry = NULL;
+    if (profiler.enabled()) {
+        entry = &profiler.entry("agent/" + agent->classinfo().id);
+        ProfileScope scope(*entry);
+        agent->run();
+    } else {
+        agent->run();
+    }
 
     gettimeofday(&timer_end, NULL);
     mem_end = getMemUsage();
@@ -340,6 +367,11 @@ void CogServer::runAgent(AgentPtr agent)
                    agent->classinfo().id.c_str(), 1.0*time_used/1000000, mem_used, atoms_used, this->cycleCount
                   );
 
+    if (entry) {
+        entry->atoms.record(atoms_used);
+        entry->memory.record(mem_used);
+    }
+
     _systemActivityTable.logActivity(agent, elapsed_time, mem_used,
                                             atoms_used);
 }
@@ -451,7 +483,9 @@ bool CogServer::unregisterRequest(const std::string& name)
 
 Request* CogServer::createRequest(const std::string& name)
 {
-    return Registry<Request>::create(*this, name);
+    Request* request = Registry<Request>::create(*this, name);
+    if (request) request->setName(name);
+    return request;
 }
 
 const RequestClassInfo& CogServer::requestInfo(const std::string& name) const
@@ -0,0 +1,330 @@
+/*
+ * opencog/server/Profiler.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Profiler.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+using namespace opencog;
+
+namespace
+{
+
+// small ids for the threads, in the order they first record a trace event
+uint32_t threadId()
+{
+    static std::atomic<uint32_t> next(0);
+    static thread_local uint32_t id = ++next;
+    return id;
+}
+
+std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string jsonHistogram(const ProfileHistogram::Snapshot& h)
+{
+    std::ostringstream out;
+    out << "{\"count\":" << h.count
+        << ",\"mean\":" << h.mean()
+        << ",\"p50\":" << h.percentile(50)
+        << ",\"p90\":" << h.percentile(90)
+        << ",\"p99\":" << h.percentile(99)
+        << ",\"max\":" << h.max << "}";
+    return out.str();
+}
+
+}
+
+uint64_t ProfileHistogram::Snapshot::percentile(double p) const
+{
+    if (count == 0) return 0;
+    uint64_t rank = (uint64_t) (p / 100.0 * count + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = (i == 0) ? 0 : (((uint64_t) 1) << i) - 1;
+            return std::min(upper, max);
+        }
+    }
+    return max;
+}
+
+void ProfileHistogram::reset()
+{
+    for (int i = 0; i < BUCKETS; i++)
+        _buckets[i].store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+ProfileHistogram::Snapshot ProfileHistogram::snapshot() const
+{
+    Snapshot s;
+    s.count = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        s.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        s.count += s.buckets[i];
+    }
+    s.sum = _sum.load(std::memory_order_relaxed);
+    s.max = _max.load(std::memory_order_relaxed);
+    return s;
+}
+
+Profiler::TraceBuffer::TraceBuffer(size_t _capacity)
+    : capacity(_capacity), next(0), events(new TraceEvent[_capacity])
+{
+    for (size_t i = 0; i < capacity; i++)
+        events[i].sequence.store(0, std::memory_order_relaxed);
+}
+
+Profiler::TraceBuffer::~TraceBuffer()
+{
+    delete[] events;
+}
+
+void Profiler::TraceBuffer::add(const ProfileEntry* entry, uint64_t start,
+                                uint64_t duration)
+{
+    uint64_t i = next.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& e = events[i % capacity];
+    e.sequence.store(2 * i + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.entry.store(entry, std::memory_order_relaxed);
+    e.start.store(start, std::memory_order_relaxed);
+    e.duration.store(duration, std::memory_order_relaxed);
+    e.thread.store(threadId(), std::memory_order_relaxed);
+    e.sequence.store(2 * i + 2, std::memory_order_release);
+}
+
+Profiler::Profiler() : _enabled(true), _trace(NULL), _writers(0), _stopped(NULL)
+{
+    for (size_t i = 0; i < MAX_ENTRIES; i++)
+        _slots[i].store(NULL, std::memory_order_relaxed);
+    _overflow = new ProfileEntry(*this, "(other)");
+}
+
+Profiler::~Profiler()
+{
+    for (size_t i = 0; i < MAX_ENTRIES; i++)
+        delete _slots[i].load();
+    delete _overflow;
+    delete _trace.load();
+    delete _stopped;
+}
+
+uint64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ProfileEntry& Profiler::entry(const std::string& name)
+{
+    size_t slot = std::hash<std::string>()(name) % MAX_ENTRIES;
+    ProfileEntry* created = NULL;
+    for (size_t probe = 0; probe < MAX_ENTRIES; probe++) {
+        std::atomic<ProfileEntry*>& s = _slots[(slot + probe) % MAX_ENTRIES];
+        ProfileEntry* e = s.load(std::memory_order_acquire);
+        if (e == NULL) {
+            if (created == NULL) created = new ProfileEntry(*this, name);
+            if (s.compare_exchange_strong(e, created,
+                                          std::memory_order_acq_rel))
+                return *created;
+            // another thread filled the slot first, e is its entry
+        }
+        if (e->name() == name) {
+            delete created;
+            return *e;
+        }
+    }
+    delete created;
+    return *_overflow;
+}
+
+std::vector<ProfileEntry*> Profiler::entries() const
+{
+    std::vector<ProfileEntry*> result;
+    for (size_t i = 0; i < MAX_ENTRIES; i++) {
+        ProfileEntry* e = _slots[i].load(std::memory_order_acquire);
+        if (e) result.push_back(e);
+    }
+    if (_overflow->latency.snapshot().count > 0)
+        result.push_back(_overflow);
+    std::sort(result.begin(), result.end(),
+              [](const ProfileEntry* a, const ProfileEntry* b) {
+                  return a->name() < b->name();
+              });
+    return result;
+}
+
+void Profiler::reset()
+{
+    std::vector<ProfileEntry*> all = entries();
+    for (size_t i = 0; i < all.size(); i++)
+        all[i]->reset();
+    _overflow->reset();
+}
+
+void Profiler::setTraceCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(_traceMutex);
+    TraceBuffer* buffer = capacity > 0 ? new TraceBuffer(capacity) : NULL;
+    TraceBuffer* old = _trace.exchange(buffer);
+    if (old == NULL) return;
+
+    // scopes ending right now may still write to the old buffer, they
+    // only take a few stores
+    while (_writers.load() != 0)
+        std::this_thread::yield();
+    delete _stopped;
+    _stopped = old;
+}
+
+bool Profiler::hasTrace() const
+{
+    std::lock_guard<std::mutex> lock(_traceMutex);
+    return _trace.load() != NULL || _stopped != NULL;
+}
+
+size_t Profiler::writeChromeTrace(std::ostream& out) const
+{
+    struct Event
+    {
+        const ProfileEntry* entry;
+        uint64_t start;
+        uint64_t duration;
+        uint32_t thread;
+        bool operator<(const Event& other) const { return start < other.start; }
+    };
+
+    std::vector<Event> events;
+    // the buffers are only freed under the lock
+    std::unique_lock<std::mutex> lock(_traceMutex);
+    TraceBuffer* buffer = _trace.load(std::memory_order_acquire);
+    if (buffer == NULL) buffer = _stopped;
+    if (buffer) {
+        for (size_t i = 0; i < buffer->capacity; i++) {
+            const TraceEvent& te = buffer->events[i];
+            uint64_t before = te.sequence.load(std::memory_order_acquire);
+            if (before == 0 || (before & 1)) continue;
+            Event e;
+            e.entry = te.entry.load(std::memory_order_relaxed);
+            e.start = te.start.load(std::memory_order_relaxed);
+            e.duration = te.duration.load(std::memory_order_relaxed);
+            e.thread = te.thread.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // skip the events overwritten while they were read
+            if (te.sequence.load(std::memory_order_relaxed) != before) continue;
+            events.push_back(e);
+        }
+    }
+    lock.unlock();
+    std::sort(events.begin(), events.end());
+
+    uint64_t origin = events.empty() ? 0 : events.front().start;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& e = events[i];
+        const std::string& name = e.entry->name();
+        char times[64];
+        snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f",
+                 (e.start - origin) / 1000.0, e.duration / 1000.0);
+        out << (i == 0 ? "\n" : ",\n")
+            << "{\"name\":" << jsonString(name)
+            << ",\"cat\":" << jsonString(name.substr(0, name.find('/')))
+            << ",\"ph\":\"X\"," << times
+            << ",\"pid\":1,\"tid\":" << e.thread << "}";
+    }
+    out << "\n]}\n";
+    return events.size();
+}
+
+std::string Profiler::textSnapshot() const
+{
+    std::vector<ProfileEntry*> all = entries();
+    std::ostringstream out;
+    char line[512];
+    snprintf(line, sizeof(line), "%-56s %8s %10s %10s %10s %10s %10s %9s %9s %10s\n",
+             "name", "runs", "mean us", "p50 us", "p90 us", "p99 us",
+             "max us", "atoms", "max atoms", "mem kB");
+    out << line;
+    for (size_t i = 0; i < all.size(); i++) {
+        ProfileHistogram::Snapshot l = all[i]->latency.snapshot();
+        if (l.count == 0) continue;
+        ProfileHistogram::Snapshot a = all[i]->atoms.snapshot();
+        ProfileHistogram::Snapshot m = all[i]->memory.snapshot();
+        snprintf(line, sizeof(line),
+                 "%-56s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %9.1f %9llu %10.1f\n",
+                 all[i]->name().c_str(), (unsigned long long) l.count,
+                 l.mean() / 1000.0, l.percentile(50) / 1000.0,
+                 l.percentile(90) / 1000.0, l.percentile(99) / 1000.0,
+                 l.max / 1000.0, a.mean(), (unsigned long long) a.max,
+                 m.mean() / 1024.0);
+        out << line;
+    }
+    return out.str();
+}
+
+std::string Profiler::jsonSnapshot() const
+{
+    std::vector<ProfileEntry*> all = entries();
+    std::ostringstream out;
+    out << "{\"entries\":[";
+    bool first = true;
+    for (size_t i = 0; i < all.size(); i++) {
+        ProfileHistogram::Snapshot l = all[i]->latency.snapshot();
+        if (l.count == 0) continue;
+        out << (first ? "" : ",")
+            << "{\"name\":" << jsonString(all[i]->name())
+            << ",\"latency_ns\":" << jsonHistogram(l)
+            << ",\"atoms\":" << jsonHistogram(all[i]->atoms.snapshot())
+            << ",\"memory_bytes\":" << jsonHistogram(all[i]->memory.snapshot())
+            << "}";
+        first = false;
+    }
+    out << "]}\n";
+    return out.str();
+}
@@ -0,0 +1,285 @@
+/*
+ * opencog/server/Profiler.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_PROFILER_H
+#define _OPENCOG_PROFILER_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_server
+ *  @{
+ */
+
+class Profiler;
+
+/**
+ * A histogram of unsigned values with power of two buckets: bucket 0 counts
+ * the zeros, bucket i the values in [2^(i-1), 2^i). Recording is lock-free
+ * and wait-free apart from the maximum, and costs a few relaxed atomic
+ * increments.
+ */
+class ProfileHistogram
+{
+public:
+    static const int BUCKETS = 64;
+
+    struct Snapshot
+    {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        uint64_t buckets[BUCKETS];
+
+        double mean() const { return count ? (double) sum / count : 0.0; }
+
+        /** Upper bound of the bucket holding the p-th percentile,
+         *  p in [0, 100], capped by the maximum. */
+        uint64_t percentile(double p) const;
+    };
+
+    ProfileHistogram() { reset(); }
+
+    void record(uint64_t value)
+    {
+        _buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (value > max &&
+               !_max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+    }
+
+    void reset();
+
+    /** Values recorded concurrently may be partially visible. */
+    Snapshot snapshot() const;
+
+    static int bucket(uint64_t value)
+    {
+        return value == 0 ? 0 : std::min(BUCKETS - 1, 64 - __builtin_clzll(value));
+    }
+
+private:
+    std::atomic<uint64_t> _buckets[BUCKETS];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _max;
+};
+
+/**
+ * The statistics of one profiled activity: an agent, a request, or a phase
+ * of one of them. Names are hierarchical, the levels being separated by
+ * '/', e.g. "agent/opencog::ImportanceUpdatingAgent/wages".
+ *
+ * Entries are created by Profiler::entry() and live as long as the
+ * profiler, so the references can be kept.
+ */
+class ProfileEntry
+{
+public:
+    ProfileEntry(Profiler& profiler, const std::string& name)
+        : _profiler(profiler), _name(name) {}
+
+    const std::string& name() const { return _name; }
+    Profiler& profiler() const { return _profiler; }
+
+    /** Wall clock time of each run, in nanoseconds. */
+    ProfileHistogram latency;
+    /** Atoms added by each run (the growth of the AtomSpace). */
+    ProfileHistogram atoms;
+    /** Memory allocated by each run, in bytes (the growth of the heap). */
+    ProfileHistogram memory;
+
+    void reset()
+    {
+        latency.reset();
+        atoms.reset();
+        memory.reset();
+    }
+
+private:
+    Profiler& _profiler;
+    const std::string _name;
+};
+
+/**
+ * The profiling surface of the CogServer, owned by its SystemActivityTable.
+ *
+ * The CogServer records the run of every agent and every request. Agents
+ * and modules can time their own phases with ProfileScope:
+ *
+ * @code
+ *     ProfileEntry& wages = _cogserver.systemActivityTable().profiler()
+ *         .entry("agent/opencog::ImportanceUpdatingAgent/wages");
+ *     ...
+ *     {
+ *         ProfileScope scope(wages);
+ *         calculateAtomWages(a, agents);
+ *     }
+ * @endcode
+ *
+ * Looking up an entry is lock-free, but hashes its name, so the entries
+ * of hot code should be looked up once and kept.
+ *
+ * When tracing is on, every scope is also stored in a ring buffer, which
+ * can be saved in the Chrome trace event format and loaded in
+ * chrome://tracing or Perfetto, or converted for other tools.
+ */
+class Profiler
+{
+public:
+    /** Maximum number of entries, further names share one entry. */
+    static const size_t MAX_ENTRIES = 4096;
+
+    Profiler();
+    ~Profiler();
+
+    bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { _enabled.store(enabled); }
+
+    /** Return the entry of this name, creating it if needed. */
+    ProfileEntry& entry(const std::string& name);
+
+    /** The entries, sorted by name. */
+    std::vector<ProfileEntry*> entries() const;
+
+    /** Reset the statistics of all the entries. */
+    void reset();
+
+    /** Nanoseconds on a monotonic clock. */
+    static uint64_t now();
+
+    /**
+     * Start recording the scopes in a ring buffer keeping the last
+     * capacity ones. Stop with capacity 0.
+     */
+    void setTraceCapacity(size_t capacity);
+    bool tracing() const
+    {
+        return _trace.load(std::memory_order_relaxed) != NULL;
+    }
+
+    /** Record a scope in the trace, if tracing. */
+    void trace(const ProfileEntry& entry, uint64_t start, uint64_t duration)
+    {
+        if (_trace.load(std::memory_order_relaxed) == NULL) return;
+        // setTraceCapacity waits for the writers before freeing a buffer
+        _writers.fetch_add(1);
+        TraceBuffer* buffer = _trace.load();
+        if (buffer) buffer->add(&entry, start, duration);
+        _writers.fetch_sub(1);
+    }
+
+    /**
+     * Write the traced scopes as Chrome trace event JSON: those of the
+     * current trace, or of the last one stopped. Return the number of
+     * events written.
+     */
+    size_t writeChromeTrace(std::ostream& out) const;
+
+    /** True if tracing, or if a trace was stopped that can be written. */
+    bool hasTrace() const;
+
+    /** A table of the entries, latencies in microseconds. */
+    std::string textSnapshot() const;
+    /** The entries as a JSON object. */
+    std::string jsonSnapshot() const;
+
+private:
+    struct TraceEvent
+    {
+        // 2 * index + 2 once written, odd while being written
+        std::atomic<uint64_t> sequence;
+        std::atomic<const ProfileEntry*> entry;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> duration;
+        std::atomic<uint32_t> thread;
+    };
+
+    class TraceBuffer
+    {
+    public:
+        TraceBuffer(size_t capacity);
+        ~TraceBuffer();
+
+        void add(const ProfileEntry* entry, uint64_t start, uint64_t duration);
+
+        size_t capacity;
+        std::atomic<uint64_t> next;
+        TraceEvent* events;
+    };
+
+    std::atomic<bool> _enabled;
+
+    // open addressing, slots are only ever filled
+    std::atomic<ProfileEntry*> _slots[MAX_ENTRIES];
+    ProfileEntry* _overflow;
+
+    std::atomic<TraceBuffer*> _trace;
+    // scopes writing to the buffer they loaded from _trace
+    std::atomic<unsigned int> _writers;
+    // the buffer of the last trace stopped, kept to be written
+    TraceBuffer* _stopped;
+    mutable std::mutex _traceMutex;
+};
+
+/**
+ * Time a scope into the latency histogram of an entry, until its end or
+ * stop(). Does nothing when the profiler is disabled.
+ */
+class ProfileScope
+{
+public:
+    ProfileScope(ProfileEntry& entry)
+        : _entry(entry),
+          _start(entry.profiler().enabled() ? Profiler::now() : 0) {}
+
+    ~ProfileScope() { stop(); }
+
+    /** End the timed phase before the end of the scope. */
+    void stop()
+    {
+        if (_start == 0) return;
+        uint64_t duration = Profiler::now() - _start;
+        _entry.latency.record(duration);
+        _entry.profiler().trace(_entry, _start, duration);
+        _start = 0;
+    }
+
+private:
+    ProfileEntry& _entry;
+    uint64_t _start;
+};
+
+/** @}*/
+}  // namespace
+
+#endif // _OPENCOG_PROFILER_H
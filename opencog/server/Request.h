@@ -256,6 +256,7 @@ protected:
     RequestResult*         _requestResult;
     std::list<std::string> _parameters;
     std::string            _mimeType;
+    std::string            _name;
 
 public:
 
@@ -286,6 +287,11 @@ public:
     /** adds a parameter to the commands parameter list. */
     virtual void addParameter(const std::string& param);
 
+    /** The command this request was created for, set by
+     *  CogServer::createRequest. Used to profile the requests. */
+    const std::string& name() const { return _name; }
+    void setName(const std::string& name) { _name = name; }
+
 };
 
 /** @}*/
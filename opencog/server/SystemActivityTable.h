@@ -31,6 +31,7 @@
 #include <vector>
 
 #include <opencog/server/Agent.h>
+#include <opencog/server/Profiler.h>
 #include <opencog/server/SystemActivityTable.h>
 #include <opencog/util/Logger.h>
 
@@ -80,6 +81,7 @@ protected:
     size_t _maxAgentActivityTableSeqSize;
     CogServer* _cogServer;
     boost::signals2::connection _conn;
+    Profiler _profiler;
 
     /** called by AtomSpace via a boost::signals2::signal when an atom is removed. */
     void atomRemoved(AtomPtr);
@@ -125,6 +127,14 @@ public:
     /** Clear all activity */
     void clearActivity();
 
+    /** Returns the profiler, that records histograms of the runs of the
+     *  agents and requests, and of the phases agents time themselves.
+     *  Unlike the activity table, it is lock-free and cheap enough to
+     *  be always on. */
+    Profiler& profiler() {
+        return _profiler;
+    }
+
 }; // class
 
 /** @}*/
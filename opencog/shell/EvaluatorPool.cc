@@ -0,0 +1,247 @@
+/*
+ * EvaluatorPool.cc
+ *
+ * A pool of language evaluators, each running in its own thread.
+ * Copyright (c) 2014 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/util/Logger.h>
+
+#include "GenericEval.h"
+#include "EvaluatorPool.h"
+
+using namespace opencog;
+
+EvaluatorPool::EvaluatorPool(Factory factory, size_t size)
+	: stopping(false)
+{
+	if (0 == size)
+		size = std::max(1u, std::thread::hardware_concurrency());
+
+	slots.resize(size);
+	for (Slot& slot : slots)
+	{
+		slot.evaluator = NULL;
+		slot.running = NULL;
+		slot.sticky = NULL;
+		slot.sessions = 0;
+	}
+
+	size_t ready = 0;
+	for (size_t i = 0; i < size; i++)
+		slots[i].thr = std::thread([this, i, factory, &ready]()
+		{
+			GenericEval* ev = NULL;
+			try
+			{
+				ev = factory();
+			}
+			catch (const std::exception& ex)
+			{
+				logger().error("[EvaluatorPool] cannot create evaluator: %s",
+				               ex.what());
+			}
+			{
+				std::lock_guard<std::mutex> lck(mtx);
+				slots[i].evaluator = ev;
+				ready++;
+			}
+			done_cv.notify_all();
+			if (ev) worker(slots[i]);
+		});
+
+	// The evaluators must exist before the first session is opened.
+	bool failed = false;
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		while (ready < size) done_cv.wait(lck);
+		for (Slot& slot : slots)
+			if (NULL == slot.evaluator) failed = true;
+	}
+	if (failed)
+	{
+		stop();
+		throw RuntimeException(TRACE_INFO,
+			"EvaluatorPool: failed to create the evaluators");
+	}
+}
+
+EvaluatorPool::~EvaluatorPool()
+{
+	stop();
+}
+
+void EvaluatorPool::stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		stopping = true;
+	}
+	work_cv.notify_all();
+	for (Slot& slot : slots)
+		if (slot.thr.joinable()) slot.thr.join();
+}
+
+/* ============================================================== */
+
+bool EvaluatorPool::next_job(Slot& slot, std::pair<const void*, Job>& job)
+{
+	std::unique_lock<std::mutex> lck(mtx);
+	while (not stopping)
+	{
+		// While the evaluator waits for the rest of an expression,
+		// only the session that started it may use it.
+		for (auto it = slot.jobs.begin(); it != slot.jobs.end(); it++)
+		{
+			if (slot.sticky and it->first != slot.sticky) continue;
+			job = *it;
+			slot.jobs.erase(it);
+			slot.running = job.first;
+			return true;
+		}
+		work_cv.wait(lck);
+	}
+	return false;
+}
+
+void EvaluatorPool::worker(Slot& slot)
+{
+	GenericEval& ev = *slot.evaluator;
+	std::pair<const void*, Job> job;
+	while (next_job(slot, job))
+	{
+		try
+		{
+			job.second(ev);
+		}
+		catch (const std::exception& ex)
+		{
+			logger().error("[EvaluatorPool] job failed: %s", ex.what());
+		}
+		catch (...)
+		{
+			logger().error("[EvaluatorPool] job failed");
+		}
+		// Don't keep whatever the job holds on to.
+		job.second = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			slot.running = NULL;
+			slot.sticky = (job.first and ev.input_pending()) ? job.first : NULL;
+		}
+		done_cv.notify_all();
+		// Jobs skipped while the evaluator was sticky may run now.
+		work_cv.notify_all();
+	}
+}
+
+/* ============================================================== */
+
+size_t EvaluatorPool::slot_of(const void* session)
+{
+	auto it = session_slot.find(session);
+	if (it != session_slot.end()) return it->second;
+
+	size_t best = 0;
+	for (size_t i = 1; i < slots.size(); i++)
+		if (slots[i].sessions < slots[best].sessions) best = i;
+
+	slots[best].sessions++;
+	session_slot[session] = best;
+	return best;
+}
+
+size_t EvaluatorPool::open_session(const void* session)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	return slot_of(session);
+}
+
+void EvaluatorPool::close_session(const void* session)
+{
+	std::unique_lock<std::mutex> lck(mtx);
+	auto it = session_slot.find(session);
+	if (it == session_slot.end()) return;
+	Slot& slot = slots[it->second];
+
+	for (auto jt = slot.jobs.begin(); jt != slot.jobs.end(); )
+	{
+		if (jt->first == session) jt = slot.jobs.erase(jt);
+		else jt++;
+	}
+	while (slot.running == session) done_cv.wait(lck);
+
+	// Don't leave half an expression behind, for the next session.
+	if (slot.sticky == session)
+	{
+		slot.sticky = NULL;
+		slot.jobs.push_front(std::make_pair((const void*) NULL,
+			Job([](GenericEval& ev) { ev.clear_pending(); })));
+		work_cv.notify_all();
+	}
+
+	slot.sessions--;
+	session_slot.erase(it);
+}
+
+void EvaluatorPool::submit(const void* session, const Job& job)
+{
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		slots[slot_of(session)].jobs.push_back(std::make_pair(session, job));
+	}
+	work_cv.notify_all();
+}
+
+void EvaluatorPool::run(const void* session, const Job& job)
+{
+	// The promise is broken, rather than left pending, if the job is
+	// dropped by close_session() or by the destructor.
+	auto done = std::make_shared<std::promise<void>>();
+	std::future<void> result = done->get_future();
+	submit(session, [job, done](GenericEval& ev)
+	{
+		try
+		{
+			job(ev);
+			done->set_value();
+		}
+		catch (...)
+		{
+			done->set_exception(std::current_exception());
+		}
+	});
+
+	try
+	{
+		result.get();
+	}
+	catch (const std::future_error&)
+	{
+		logger().warn("[EvaluatorPool] job dropped before it could run");
+	}
+}
+
+/* ===================== END OF FILE ============================ */
@@ -0,0 +1,133 @@
+/*
+ * EvaluatorPool.h
+ *
+ * A pool of language evaluators, each running in its own thread.
+ * Copyright (c) 2014 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_EVALUATOR_POOL_H
+#define _OPENCOG_EVALUATOR_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * The EvaluatorPool class runs a fixed number of evaluators, each one in
+ * its own worker thread. An evaluator is not thread-safe against itself,
+ * so it is only ever used by one job at a time, in the thread that
+ * created it (a job may run eval_expr() in a helper thread, so as to
+ * stream the output with poll_result(), but it must wait for it before
+ * returning); distinct evaluators run in parallel, so that a long
+ * evaluation in one shell does not hold up the others.
+ *
+ * Each shell session is bound to one evaluator for its whole life
+ * (session affinity): its expressions are run in the order they were
+ * submitted, and see the definitions and pending input left by the
+ * previous ones. New sessions go to the evaluator with the fewest
+ * sessions. When there are more sessions than evaluators, sessions
+ * share an evaluator; an evaluator that is left waiting for more input
+ * (e.g. for a closing paren) then only runs the jobs of that session,
+ * until the expression is complete.
+ */
+
+namespace opencog {
+/** \addtogroup grp_server
+ *  @{
+ */
+
+class GenericEval;
+
+class EvaluatorPool
+{
+	public:
+		/**
+		 * Creates an evaluator. Called once in each worker thread,
+		 * so that thread-specific setup can be done there. The pool
+		 * does not delete the evaluators.
+		 */
+		typedef std::function<GenericEval*(void)> Factory;
+		typedef std::function<void(GenericEval&)> Job;
+
+	private:
+		struct Slot
+		{
+			std::thread thr;
+			GenericEval* evaluator;
+			std::deque<std::pair<const void*, Job>> jobs;
+			// The session of the job being run, if any.
+			const void* running;
+			// The session whose input is incomplete, if any.
+			const void* sticky;
+			size_t sessions;
+		};
+
+		std::vector<Slot> slots;
+		std::map<const void*, size_t> session_slot;
+		bool stopping;
+
+		std::mutex mtx;
+		std::condition_variable work_cv;
+		std::condition_variable done_cv;
+
+		void worker(Slot&);
+		void stop(void);
+		bool next_job(Slot&, std::pair<const void*, Job>&);
+		size_t slot_of(const void*);
+
+	public:
+		/**
+		 * Start size evaluators. If size is zero, start one per core.
+		 */
+		EvaluatorPool(Factory, size_t size);
+		~EvaluatorPool();
+
+		size_t size(void) const { return slots.size(); }
+		GenericEval* evaluator(size_t slot) { return slots[slot].evaluator; }
+
+		/**
+		 * Bind a session to an evaluator, and return its slot.
+		 * Any unique pointer (e.g. the shell) may be used as a session.
+		 */
+		size_t open_session(const void*);
+
+		/**
+		 * Drop the jobs queued for the session, and wait for the one
+		 * that may be running. Must not be called from a job.
+		 */
+		void close_session(const void*);
+
+		/** Queue a job on the evaluator of the session, and return. */
+		void submit(const void*, const Job&);
+
+		/**
+		 * Queue a job on the evaluator of the session, and wait until
+		 * it has run, after the jobs queued before it. Exceptions
+		 * thrown by the job are passed on to the caller.
+		 */
+		void run(const void*, const Job&);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_EVALUATOR_POOL_H
@@ -26,6 +26,7 @@
 #include <opencog/util/Logger.h>
 #include <opencog/util/platform.h>
 
+#include "EvaluatorPool.h"
 #include "GenericEval.h"
 #include "GenericShell.h"
 
@@ -46,6 +47,16 @@ using namespace opencog;
 #define CAN 0x18  // cancel or ^X at keyboard.
 #define ESC 0x1b  // ecsape or ^[ at keyboard.
 
+// An isolated control-D, or a single period on a line by itself,
+// means "leave the shell" (unless the evaluator expects more input).
+// 0x4 is ASCII EOT, which is what ctrl-D at keybd becomes.
+static bool is_exit(const std::string &expr)
+{
+	size_t len = expr.length();
+	if (0 == len) return false;
+	return (EOT == expr[len-1]) || ((1 == len) && ('.' == expr[0]));
+}
+
 GenericShell::GenericShell(void)
 {
 	show_output = true;
@@ -61,12 +72,21 @@ GenericShell::GenericShell(void)
 	evaluator = NULL;
 	socket = NULL;
 	evalthr = NULL;
+	pool = NULL;
 	self_destruct = false;
 	do_async_output = false;
 }
 
 GenericShell::~GenericShell()
 {
+	// Drop the expressions still queued, and wait for the one being
+	// evaluated; it may be sending output to the socket.
+	if (pool)
+	{
+		pool->close_session(this);
+		pool = NULL;
+	}
+
 	if (evalthr)
 	{
 		evalthr->join();
@@ -153,6 +173,16 @@ void GenericShell::set_socket(ConsoleSocket *s)
 	socket->SetShell(this);
 }
 
+/**
+ * Bind this shell to one of the evaluators of the pool. It will be
+ * used for all of the expressions of this shell.
+ */
+void GenericShell::set_pool(EvaluatorPool *p)
+{
+	pool = p;
+	evaluator = pool->evaluator(pool->open_session(this));
+}
+
 /* ============================================================== */
 
 void GenericShell::eval(const std::string &expr, ConsoleSocket *s)
@@ -167,14 +197,30 @@ void GenericShell::eval(const std::string &expr, ConsoleSocket *s)
 		socket = s;
 	}
 
-	// Launch the evaluator, possibly in a different thread,
-	// and then send out whatever is reported back.
-	do_eval(expr);
-	std::string retstr = poll_output();
-	while (0 < retstr.size())
+	if (pool)
 	{
-		socket->Send(retstr);
-		retstr = poll_output();
+		// The expression is evaluated in the thread of the evaluator
+		// bound to this shell, which sends the output as soon as it is
+		// available. With async output, don't wait for it: the client
+		// may send more expressions, which are queued and evaluated in
+		// order. A request to leave the shell must be waited for, since
+		// the lines after it are no longer for this shell.
+		if (do_async_output and not is_exit(expr))
+		{
+			pool->submit(this, [this, expr](GenericEval&)
+			{
+				eval_and_send(expr);
+			});
+			return;
+		}
+		pool->run(this, [this, expr](GenericEval&)
+		{
+			eval_and_send(expr);
+		});
+	}
+	else
+	{
+		eval_and_send(expr);
 	}
 
 	// The user is exiting the shell. No one will ever call a method on
@@ -187,6 +233,30 @@ void GenericShell::eval(const std::string &expr, ConsoleSocket *s)
 	}
 }
 
+/**
+ * Launch the evaluator, possibly in a different thread, and then send
+ * out whatever is reported back.
+ */
+void GenericShell::eval_and_send(const std::string &expr)
+{
+	do_eval(expr);
+	std::string retstr = poll_output();
+	while (0 < retstr.size())
+	{
+		socket->Send(retstr);
+		retstr = poll_output();
+	}
+
+	// In a pool, the job must not end before the evaluation does: the
+	// pool checks for pending input, and runs the next job, right after.
+	if (pool and evalthr)
+	{
+		evalthr->join();
+		delete evalthr;
+		evalthr = NULL;
+	}
+}
+
 /* ============================================================== */
 /**
  * Evaluate the expression
@@ -250,9 +320,7 @@ void GenericShell::do_eval(const std::string &expr)
 		// Look for either an isolated control-D, or a single period on a line
 		// by itself. This means "leave the shell". We leave the shell by
 		// unsetting the shell pointer in the ConsoleSocket.
-		// 0x4 is ASCII EOT, which is what ctrl-D at keybd becomes.
-		if ((false == evaluator->input_pending()) &&
-		    ((EOT == expr[len-1]) || ((1 == len) && ('.' == expr[0]))))
+		if ((false == evaluator->input_pending()) && is_exit(expr))
 		{
 			self_destruct = true;
 			put_output("");
@@ -275,6 +343,10 @@ void GenericShell::do_eval(const std::string &expr)
 	std::string input = expr + "\n";
 	eval_done = false;
 	evaluator->begin_eval(); // must be called in same thread as result_poll
+
+	// Evaluate in another thread, while this one sends the output as it
+	// comes. With a pool, this one is the thread of the evaluator, which
+	// waits in eval_and_send() for the evaluation to finish.
 	if (do_async_output)
 	{
 		auto async_wrapper = [&](GenericShell* p, const std::string& in)
@@ -302,7 +374,8 @@ void GenericShell::do_eval(const std::string &expr)
 
 void GenericShell::thread_init(void)
 {
-	/* No-op. The Scheme shell sets the current atomspace here */
+	/* No-op. Called in the thread that runs eval_expr(), before it
+	 * does; the Scheme shell sets guile's current atomspace there. */
 }
 
 /* ============================================================== */
@@ -46,6 +46,7 @@ namespace opencog {
  */
 
 class ConsoleSocket;
+class EvaluatorPool;
 class GenericEval;
 
 class GenericShell
@@ -65,11 +66,17 @@ class GenericShell
 		GenericEval* evaluator;
 		std::thread* evalthr;
 
+		// If set, expressions are evaluated by the evaluator of the
+		// pool that this shell is bound to, in the pool's thread.
+		EvaluatorPool* pool;
+
 		virtual void set_socket(ConsoleSocket *);
+		virtual void set_pool(EvaluatorPool *);
 		virtual const std::string& get_prompt(void);
 
 		virtual void thread_init(void);
 		virtual void do_eval(const std::string &expr);
+		virtual void eval_and_send(const std::string &expr);
 
 		// Async output handling.
 		bool do_async_output;
@@ -31,7 +31,6 @@
  */
 #ifdef HAVE_CYTHON
 
-#include <opencog/cython/PythonEval.h>
 #include <opencog/server/ConsoleSocket.h>
 #include "PythonShell.h"
 
@@ -42,6 +41,10 @@ PythonShell::PythonShell()
     normal_prompt = "py> ";
     pending_prompt = "... ";
     abort_prompt += normal_prompt;
+
+    // The evaluator is only ever used in the thread of the pool of the
+    // PythonShellModule, so output can be async.
+    do_async_output = true;
     evaluator = NULL;
 }
 
@@ -51,18 +54,4 @@ PythonShell::~PythonShell()
     //	if (evaluator) delete evaluator;
 }
 
-/**
- * Register this shell with the console.
- */
-void PythonShell::set_socket(ConsoleSocket *s)
-{
-    // Let the generic shell do the basic work.
-    GenericShell::set_socket(s);
-
-    // We are using a singlton instance here, because the current
-    // Python evaluator isn't thread safe.  If/when it does become
-    // thread-safe, we should probably go multi-threaed, instead.
-    if (!evaluator) evaluator = &PythonEval::instance();
-}
-
 #endif
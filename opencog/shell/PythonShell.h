@@ -46,10 +46,7 @@ class PythonShellModule;
 
 class PythonShell: public GenericShell
 {
-    friend class PythonShellModule; // needs to call set_socket
-protected:
-    void set_socket(ConsoleSocket *);
-
+    friend class PythonShellModule; // needs to call set_socket, set_pool
 public:
     PythonShell(void);
     virtual ~PythonShell();
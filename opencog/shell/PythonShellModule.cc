@@ -31,10 +31,13 @@
  */
 #ifdef HAVE_CYTHON
 
+#include <memory>
+
 #include <opencog/cython/PythonEval.h>
 #include <opencog/server/ConsoleSocket.h>
 #include <opencog/util/Logger.h>
 #include <opencog/util/platform.h>
+#include "EvaluatorPool.h"
 #include "PythonShellModule.h"
 
 namespace opencog
@@ -44,16 +47,25 @@ DECLARE_MODULE(PythonShellModule);
 
 PythonShellModule::PythonShellModule(CogServer& cs) : Module(cs)
 {
+    _pool = NULL;
 }
 
 PythonShellModule::~PythonShellModule()
 {
     shellout_unregister();
     do_eval_unregister();
+    delete _pool;
+}
+
+static GenericEval* python_evaluator(void)
+{
+    return &PythonEval::instance();
 }
 
 void PythonShellModule::init(void)
 {
+    _pool = new EvaluatorPool(python_evaluator, 1);
+
     shellout_register();
     do_eval_register();
 }
@@ -67,14 +79,18 @@ std::string PythonShellModule::shellout(Request *req, std::list<std::string> arg
 
     PythonShell *sh = new PythonShell();
     sh->set_socket(s);
+    sh->set_pool(_pool);
 
     bool hush = false;
+    bool sync = false;
     if (!args.empty())
     {
         std::string &arg = args.front();
-        if (arg.compare("quiet") || arg.compare("hush")) hush = true;
+        if (arg == "quiet" || arg == "hush") hush = true;
+        if (arg == "sync") sync = true;
     }
     sh->hush_prompt(hush);
+    sh->sync_output(sync);
 
     if (hush) return "";
 
@@ -88,7 +104,6 @@ std::string PythonShellModule::do_eval(Request *req, std::list<std::string> args
 {
     // Needs to join the args back up into one string.
     std::string expr;
-    std::string out = "test";
 
     // Adds an extra space on the end, but that doesn't matter.
     for (std::string arg : args)
@@ -96,20 +111,37 @@ std::string PythonShellModule::do_eval(Request *req, std::list<std::string> args
         expr += arg + " ";
     }
 
-    PythonEval& eval = PythonEval::instance();
-    eval.begin_eval();
-    eval.eval_expr(expr);
-    out = eval.poll_result();
-    // May not be necessary since an error message and backtrace are provided.
-//	if (eval.eval_error()) {
-//		out += "An error occurred\n";
-//	}
-    if (eval.input_pending()) {
-        out += "Invalid Python expression: missing something";
-    }
-    eval.clear_pending();
-
-    return out;
+    // Run in the thread of the pool, so as not to race with the shells,
+    // but don't wait for it here: this is the thread of the server loop,
+    // and the evaluator may be busy, or held by a shell that left an
+    // expression unfinished. The result is sent when the job has run.
+    // The request no longer replies; the job holds on to its result
+    // object, and lets go of it when it is done with it, or dropped.
+    RequestResult* rr = req->getRequestResult();
+    if (NULL == rr) return "";
+    rr->get();
+    req->setRequestResult(NULL);
+    std::shared_ptr<RequestResult> reply(rr, [](RequestResult* r) { r->put(); });
+
+    _pool->submit(this, [expr, reply](GenericEval& eval)
+    {
+        eval.begin_eval();
+        eval.eval_expr(expr);
+        std::string out = eval.poll_result();
+        // May not be necessary since an error message and backtrace are provided.
+//      if (eval.eval_error()) {
+//          out += "An error occurred\n";
+//      }
+        if (eval.input_pending()) {
+            out += "Invalid Python expression: missing something";
+        }
+        eval.clear_pending();
+
+        reply->SendResult(out);
+        reply->OnRequestComplete();
+    });
+
+    return "";
 }
 
 }
@@ -47,18 +47,28 @@ namespace opencog
  *  @{
  */
 
+class EvaluatorPool;
+
 class PythonShellModule : public Module
 {
 private:
+    // A pool of a single evaluator: the python evaluator is a singleton,
+    // and isn't thread safe. The pool serializes its use by the shells
+    // and py-eval, without making the shells wait for each other's
+    // output.
+    EvaluatorPool* _pool;
+
     DECLARE_CMD_REQUEST(PythonShellModule, "py", shellout,
         "Enter the python shell",
-        "Usage: py [hush|quiet]\n\n"
+        "Usage: py [hush|quiet|sync]\n\n"
         "Enter the python interpreter shell. This shell provides a rich\n"
         "and easy-to-use environment for creating, deleting and manipulating\n"
         "OpenCog atoms and truth values.\n\n"
         "If 'hush' or 'quiet' is specified after the command, then the prompt\n"
         "will not be returned.  This is nice when catting large scripts using\n"
-        "netcat, as it avoids printing garbage when the scripts work well.\n",
+        "netcat, as it avoids printing garbage when the scripts work well.\n"
+        "If 'sync' is specified after the command, then the output is sync,\n"
+        "instead of async.\n",
         true, false)
 
     DECLARE_CMD_REQUEST(PythonShellModule, "py-eval", do_eval,
@@ -46,13 +46,8 @@ SchemeShell::SchemeShell(void)
 
 	do_async_output = true;
 
-	evaluator = SchemeEval::get_evaluator();
-
-	// Set the inital atomspace for this thread.
-	SchemeEval::set_scheme_as(&cogserver().getAtomSpace());
-	evaluator->begin_eval();
-	evaluator->eval_expr("(setlocale LC_CTYPE \"\")");
-	evaluator->poll_result();
+	// The evaluator is taken from the pool of the SchemeShellModule,
+	// by set_pool().
 }
 
 SchemeShell::~SchemeShell()
@@ -60,7 +55,9 @@ SchemeShell::~SchemeShell()
 }
 
 /**
- * Register this shell with the console.
+ * The expressions are evaluated in a helper thread of the pool's thread
+ * (see GenericShell::do_eval()); the current atomspace of guile is per
+ * thread, so it has to be set there too.
  */
 void SchemeShell::thread_init(void)
 {
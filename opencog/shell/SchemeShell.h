@@ -38,7 +38,7 @@ class SchemeShellModule;
 
 class SchemeShell : public GenericShell
 {
-	friend class SchemeShellModule; // needs to call set_socket()
+	friend class SchemeShellModule; // needs to call set_socket(), set_pool()
 	protected:
 		void thread_init();
 
@@ -24,8 +24,10 @@
 
 #include <opencog/guile/SchemeEval.h>
 #include <opencog/server/ConsoleSocket.h>
+#include <opencog/util/Config.h>
 #include <opencog/util/Logger.h>
 
+#include "EvaluatorPool.h"
 #include "SchemeShell.h"
 #include "SchemeShellModule.h"
 
@@ -35,16 +37,42 @@ DECLARE_MODULE(SchemeShellModule);
 
 SchemeShellModule::SchemeShellModule(CogServer& cs) : Module(cs)
 {
+	_pool = NULL;
+}
+
+/**
+ * Called in each thread of the pool. Scheme evaluators are per-thread,
+ * so that each thread gets an evaluator of its own.
+ */
+static GenericEval* new_evaluator(void)
+{
+	AtomSpace* as = &cogserver().getAtomSpace();
+
+	// Set the inital atomspace for this thread.
+	SchemeEval::set_scheme_as(as);
+	SchemeEval* evaluator = SchemeEval::get_evaluator(as);
+	evaluator->begin_eval();
+	evaluator->eval_expr("(setlocale LC_CTYPE \"\")");
+	evaluator->poll_result();
+	return evaluator;
 }
 
 void SchemeShellModule::init(void)
 {
+	// Zero means one evaluator per core.
+	size_t n_evaluators = 0;
+	if (config().has("SCM_EVALUATORS"))
+		n_evaluators = config().get_int("SCM_EVALUATORS");
+	_pool = new EvaluatorPool(new_evaluator, n_evaluators);
+	logger().info("[SchemeShellModule] %zu scheme evaluators", _pool->size());
+
 	shellout_register();
 }
 
 SchemeShellModule::~SchemeShellModule()
 {
 	shellout_unregister();
+	delete _pool;
 }
 
 /**
@@ -59,6 +87,7 @@ std::string SchemeShellModule::shellout(Request *req, std::list<std::string> arg
 
 	SchemeShell *sh = new SchemeShell();
 	sh->set_socket(s);
+	sh->set_pool(_pool);
 
 	bool hush = false;
 	bool sync = false;
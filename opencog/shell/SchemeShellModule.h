@@ -35,9 +35,15 @@ namespace opencog {
  *  @{
  */
 
+class EvaluatorPool;
+
 class SchemeShellModule : public Module
 {
 	private:
+		// The evaluators of the shells; see SCM_EVALUATORS in the
+		// config file.
+		EvaluatorPool* _pool;
+
 		DECLARE_CMD_REQUEST(SchemeShellModule, "scm", shellout,
 			"Enter the scheme shell",
 			"Usage: scm [hush|quiet|sync]\n\n"
@@ -49,7 +55,12 @@ class SchemeShellModule : public Module
 			"will not be returned.  This is nice when catting large scripts using\n"
 			"netcat, as it avoids printing garbage when the scripts work well.\n"
 			"If 'sync' is specified after the command, then the output is sync,\n"
-			"instead of async.\n",
+			"instead of async.\n\n"
+			"Each shell is bound to one of a pool of evaluators, which run in\n"
+			"their own threads, so that shells don't wait for each other.\n"
+			"With async output, expressions can be sent without waiting for\n"
+			"the previous results; they are evaluated in order, and their\n"
+			"results are sent back as soon as they are ready.\n",
 			true, false)
 
 	public:
@@ -0,0 +1,114 @@
+/*
+ * opencog/spacetime/LatestValueIndex.cc
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atomspace/Link.h>
+#include <opencog/atomspace/atom_types.h>
+
+#include "LatestValueIndex.h"
+
+using namespace opencog;
+
+int LatestValueIndex::getKeys(Handle timedAtom, Key keys[2])
+{
+    LinkPtr link(LinkCast(timedAtom));
+    if (NULL == link or link->getArity() != 2) return 0;
+
+    Handle first = link->getOutgoingAtom(0);
+    Handle second = link->getOutgoingAtom(1);
+    Type type = link->getType();
+
+    if (type == EVALUATION_LINK) {
+        if (first->getType() != PREDICATE_NODE) return 0;
+        keys[0] = Key(first, Handle::UNDEFINED);
+        LinkPtr args(LinkCast(second));
+        if (args and args->getType() == LIST_LINK and args->getArity() > 0) {
+            keys[1] = Key(first, args->getOutgoingAtom(0));
+            return 2;
+        }
+        return 1;
+    }
+
+    if (type == SIMILARITY_LINK) {
+        if (first->getType() == NUMBER_NODE) {
+            keys[0] = Key(second, Handle::UNDEFINED);
+            return 1;
+        }
+        if (second->getType() == NUMBER_NODE) {
+            keys[0] = Key(first, Handle::UNDEFINED);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void LatestValueIndex::add(Handle atTimeLink, Handle timedAtom,
+                           const Temporal& t)
+{
+    Key keys[2];
+    int n = getKeys(timedAtom, keys);
+    Bounds bounds(t.getLowerBound(), t.getUpperBound());
+    for (int i = 0; i < n; i++)
+        index[keys[i]].insert(History::value_type(bounds, atTimeLink));
+}
+
+void LatestValueIndex::remove(Handle atTimeLink, Handle timedAtom,
+                              const Temporal& t)
+{
+    Key keys[2];
+    int n = getKeys(timedAtom, keys);
+    Bounds bounds(t.getLowerBound(), t.getUpperBound());
+    for (int i = 0; i < n; i++) {
+        std::map<Key, History>::iterator it = index.find(keys[i]);
+        if (it == index.end()) continue;
+
+        History& history = it->second;
+        std::pair<History::iterator, History::iterator> range =
+            history.equal_range(bounds);
+        for (History::iterator h = range.first; h != range.second; ++h) {
+            if (h->second == atTimeLink) {
+                history.erase(h);
+                break;
+            }
+        }
+        if (history.empty()) index.erase(it);
+    }
+}
+
+void LatestValueIndex::clear()
+{
+    index.clear();
+}
+
+Handle LatestValueIndex::getLatest(Handle predicate, Handle subject,
+                                   octime_t time) const
+{
+    std::map<Key, History>::const_iterator it =
+        index.find(Key(predicate, subject));
+    if (it == index.end()) return Handle::UNDEFINED;
+
+    // The first value starting after time, then step back.
+    const History& history = it->second;
+    History::const_iterator h =
+        history.upper_bound(Bounds(time, OCTIME_MAX));
+    if (h == history.begin()) return Handle::UNDEFINED;
+    return (--h)->second;
+}
@@ -0,0 +1,110 @@
+/*
+ * opencog/spacetime/LatestValueIndex.h
+ *
+ * Copyright (C) 2014 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_LATEST_VALUE_INDEX_H
+#define _OPENCOG_LATEST_VALUE_INDEX_H
+
+#include <map>
+#include <utility>
+
+#include <opencog/atomspace/Handle.h>
+#include <opencog/spacetime/Temporal.h>
+
+namespace opencog
+{
+/** \addtogroup grp_spacetime
+ *  @{
+ */
+
+/**
+ * Index of the AtTimeLinks by (predicate, subject), sorted by time, so
+ * that the most recent value of a predicate for a subject, optionally
+ * at or before a given time, can be found in O(log n) instead of walking
+ * every EvaluationLink of the predicate.
+ *
+ * The keys of an AtTimeLink are taken from the atom it timestamps:
+ *
+ * <code>
+ *     AtTimeLink
+ *         TimeNode "t"
+ *         EvaluationLink
+ *             PredicateNode P
+ *             ListLink
+ *                 X
+ *                 ...
+ * </code>
+ * is indexed under (P, X) and under (P, Handle::UNDEFINED), that is, any
+ * subject;
+ * <code>
+ *     AtTimeLink
+ *         TimeNode "t"
+ *         SimilarityLink
+ *             NumberNode "value"
+ *             S
+ * </code>
+ * is indexed under (S, Handle::UNDEFINED). That is the way the demand,
+ * modulator and feeling levels are stored (S being their updater
+ * ExecutionOutputLink).
+ *
+ * The values of the same key are sorted like Temporal objects: by lower
+ * bound, then by upper bound. Values with the same bounds are kept in
+ * insertion order, the last one being the most recent.
+ *
+ * This class is not thread-safe. It is maintained by the TimeServer,
+ * which serializes its use.
+ */
+class LatestValueIndex
+{
+public:
+    /**
+     * Index an AtTimeLink, of the given Temporal. Atoms that have no key
+     * are ignored.
+     */
+    void add(Handle atTimeLink, Handle timedAtom, const Temporal& t);
+    void remove(Handle atTimeLink, Handle timedAtom, const Temporal& t);
+    void clear();
+
+    /**
+     * Return the most recent AtTimeLink of the key, among the ones that
+     * start at or before time, or Handle::UNDEFINED if there is none.
+     */
+    Handle getLatest(Handle predicate, Handle subject,
+                     octime_t time = OCTIME_MAX) const;
+
+    /** The number of keys. */
+    size_t size() const { return index.size(); }
+
+private:
+    typedef std::pair<Handle, Handle> Key;
+    typedef std::pair<octime_t, octime_t> Bounds;
+    typedef std::multimap<Bounds, Handle> History;
+
+    std::map<Key, History> index;
+
+    /** Put the keys of the timed atom in keys, and return their number. */
+    static int getKeys(Handle timedAtom, Key keys[2]);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_LATEST_VALUE_INDEX_H
@@ -517,12 +517,12 @@ bool SpaceServer::addSpaceInfo(Handle objectNode, bool isSelfObject, octime_t ti
     if (entityClass == "block")
     {
         // it's a block
-        curMap->addSolidUnitBlock(pos,objectNode, material);
+        curMap->addSolidUnitBlock(pos,objectNode, material, "", timestamp);
 
     }
     else
     {
-        curMap->addNoneBlockEntity(objectNode,pos,objWidth,objLength,objHeight,objYaw,objectName, entityClass,isSelfObject, true);
+        curMap->addNoneBlockEntity(objectNode,pos,objWidth,objLength,objHeight,objYaw,objectName, entityClass,isSelfObject, timestamp, isObstacle);
     }
     return true;
 }
@@ -567,11 +567,11 @@ void SpaceServer::removeSpaceInfo(Handle objectNode, octime_t timestamp)
 
     if (atomspace->getType(objectNode) == STRUCTURE_NODE)
     {
-        curMap->removeSolidUnitBlock(objectNode);
+        curMap->removeSolidUnitBlock(objectNode, timestamp);
     }
     else
     {
-        curMap->removeNoneBlockEntity(objectNode);
+        curMap->removeNoneBlockEntity(objectNode, timestamp);
     }
 
     logger().debug("%s(%s)\n", __FUNCTION__, atomspace->getName(objectNode).c_str());
@@ -41,6 +41,7 @@ using namespace opencog;
 void TimeServer::init()
 {
     table = new TemporalTable();
+    latestValues.clear();
     latestTimestamp = 0;
 }
 
@@ -92,6 +93,13 @@ octime_t TimeServer::getLatestTimestamp() const
     return latestTimestamp;
 }
 
+Handle TimeServer::getLatestAtTimeLink(Handle predicate, Handle subject,
+                                       octime_t time) const
+{
+    std::unique_lock<std::mutex> lock(ts_mutex);
+    return latestValues.getLatest(predicate, subject, time);
+}
+
 TimeServer& TimeServer::operator=(const TimeServer& other)
 {
     throw opencog::RuntimeException(TRACE_INFO, 
@@ -216,6 +224,8 @@ void TimeServer::atomAdded(Handle h)
                 Temporal t = Temporal::getFromTimeNodeName(timeNodeName.c_str());
                 Handle timed_h = lll->getOutgoingAtom(1);
                 add(timed_h, t);
+                std::unique_lock<std::mutex> lock(ts_mutex);
+                latestValues.add(h, timed_h, t);
             } else logger().warn("TimeServer::atomAdded: Invalid atom type "
                     "at the first element in an AtTimeLink's outgoing: "
                     "%s\n", classserver().getTypeName(timeNode->getType()).c_str());
@@ -249,5 +259,8 @@ void TimeServer::atomRemoved(AtomPtr atom)
        spaceServer->removeMap(atom->getHandle());
 #endif
     NodePtr nnn(NodeCast(timeNode));
-    remove(timedAtom->getHandle(), Temporal::getFromTimeNodeName(nnn->getName().c_str()));
+    Temporal t = Temporal::getFromTimeNodeName(nnn->getName().c_str());
+    remove(timedAtom->getHandle(), t);
+    std::unique_lock<std::mutex> lock(ts_mutex);
+    latestValues.remove(atom->getHandle(), timedAtom->getHandle(), t);
 }
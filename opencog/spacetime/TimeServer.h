@@ -30,6 +30,7 @@
 #include <boost/signals2.hpp>
 
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/spacetime/LatestValueIndex.h>
 #include <opencog/spacetime/SpaceServer.h>
 #include <opencog/spacetime/TemporalTable.h>
 
@@ -129,6 +130,25 @@ public:
      */
     octime_t getLatestTimestamp() const;
 
+    /**
+     * Get the most recent AtTimeLink holding the value of a predicate for
+     * a subject, in O(log n). See LatestValueIndex for the atoms indexed.
+     *
+     * @param predicate The PredicateNode of an EvaluationLink, or the
+     *        atom compared to a NumberNode in a SimilarityLink.
+     * @param subject The first argument of the EvaluationLink, or
+     *        Handle::UNDEFINED for any.
+     * @param time If given, only the values starting at or before time
+     *        are considered.
+     * @return The AtTimeLink, or Handle::UNDEFINED if there is none.
+     *
+     * @note Only the entries added through AtTimeLinks (e.g. by
+     *       addTimeInfo()) are indexed, not those added by add().
+     */
+    Handle getLatestAtTimeLink(Handle predicate,
+                               Handle subject = Handle::UNDEFINED,
+                               octime_t time = OCTIME_MAX) const;
+
     void clear();
 
     /**
@@ -351,6 +371,11 @@ private:
      */
     TemporalTable* table;
 
+    /**
+     * The AtTimeLinks by (predicate, subject), for getLatestAtTimeLink()
+     */
+    LatestValueIndex latestValues;
+
     /**
      * The timestamp of the more recent upper bound of Temporal object already inserted into this TimeServer
      */
@@ -36,6 +36,8 @@
 using namespace opencog;
 using namespace opencog::spatial;
 
+unsigned long Octree3DMapManager::lastRevision = 0;
+
 Octree3DMapManager::Octree3DMapManager(std::string _mapName,int _xMin, int _yMin, int _zMin, int _xDim, int _yDim, int _zDim, int _floorHeight):
     mMapName(_mapName), mFloorHeight(_floorHeight)
 {
@@ -51,6 +53,8 @@ Octree3DMapManager::Octree3DMapManager(std::string _mapName,int _xMin, int _yMin
     //default agent height is 1
     mAgentHeight = 1;
 
+    _changeRevision();
+
     // get the biggest edge among x, y ,z
     int offSet = _xDim;
     if (_yDim > offSet)
@@ -89,7 +93,7 @@ Octree3DMapManager::Octree3DMapManager(std::string _mapName,int _xMin, int _yMin
     updateBlockEntityList.clear();
     updateSuperBlockEntityList.clear();
 
-    nonBlockEntitieshistoryLocations.clear();
+    mHistory.clear();
 
     enable_BlockEntity_Segmentation = false;
 
@@ -154,7 +158,8 @@ Octree3DMapManager* Octree3DMapManager::clone()
 {
 
     Octree3DMapManager* cloneMap = new Octree3DMapManager(enable_BlockEntity_Segmentation, mTotalDepthOfOctree,mMapName, mRootOctree,mFloorHeight,mAgentHeight,mTotalUnitBlockNum,mMapBoundingBox,selfAgentEntity,
-                                    mAllUnitAtomsToBlocksMap, mAllUnitBlocksToAtomsMap,mBlockEntityList, mAllNoneBlockEntities,nonBlockEntitieshistoryLocations);
+                                    mAllUnitAtomsToBlocksMap, mAllUnitBlocksToAtomsMap,mBlockEntityList, mAllNoneBlockEntities,mHistory);
+    cloneMap->mRevision = mRevision;
     return cloneMap;
 }
 
@@ -190,6 +195,8 @@ BlockEntity* Octree3DMapManager::findBlockEntityByHandle(const Handle entityNode
 void Octree3DMapManager::addNoneBlockEntity(const Handle &entityNode, BlockVector _centerPosition,
                                             int _width, int _lenght, int _height, double yaw, std::string _entityName, std::string _entityClass,bool isSelfObject,unsigned long timestamp,bool is_obstacle)
 {
+    _changeRevision();
+
     map<Handle, Entity3D*>::iterator it;
     multimap<BlockVector, Entity3D*>::iterator biter;
     multimap<BlockVector, Entity3D*>::iterator eiter;
@@ -233,43 +240,26 @@ void Octree3DMapManager::addNoneBlockEntity(const Handle &entityNode, BlockVecto
 }
 void Octree3DMapManager::_addNonBlockEntityHistoryLocation(Handle entityHandle, BlockVector newLocation, unsigned long timestamp)
 {
-    map< Handle, vector< pair<unsigned long,BlockVector> > >::iterator it = nonBlockEntitieshistoryLocations.find(entityHandle);
-    if (it == nonBlockEntitieshistoryLocations.end())
-    {
-        vector< pair<unsigned long,BlockVector> > newVector;
-        newVector.push_back(pair<unsigned long,BlockVector>(timestamp,newLocation));
-        nonBlockEntitieshistoryLocations.insert(map< Handle, vector< pair<unsigned long,BlockVector> > >::value_type(entityHandle,newVector));
-    }
-    else
-    {
-        vector< pair<unsigned long,BlockVector> >& oneEntityHistories = it->second;
-        if (newLocation == (oneEntityHistories.back()).second)
-            return; // no location changed
-        else
-            oneEntityHistories.push_back(pair<unsigned long,BlockVector>(timestamp,newLocation));
-    }
+    mHistory.recordEntityMoved(timestamp, entityHandle, newLocation);
+    _updateHistoryKeyframe();
+}
 
+void Octree3DMapManager::_updateHistoryKeyframe()
+{
+    if (mHistory.keyframeDue())
+        mHistory.addKeyframe(mAllUnitBlocksToAtomsMap);
 }
 
 BlockVector Octree3DMapManager::getLastAppearedLocation(Handle entityHandle)
 {
-    map< Handle, vector< pair<unsigned long,BlockVector> > >::iterator it = nonBlockEntitieshistoryLocations.find(entityHandle);
-    if (it == nonBlockEntitieshistoryLocations.end())
-        return BlockVector::ZERO;
-    else
-    {
-        vector< pair<unsigned long,BlockVector> >& oneEntityHistories = it->second;
-        if (oneEntityHistories.size() == 0)
-            return BlockVector::ZERO;
-        else
-            return (oneEntityHistories.back()).second;
-    }
-
+    return mHistory.getLastLocation(entityHandle);
 }
 
 
 void Octree3DMapManager::updateNoneBLockEntityLocation(const Handle &entityNode, BlockVector _newpos, unsigned long timestamp, bool is_standLocation)
 {
+    _changeRevision();
+
     map<Handle, Entity3D*>::iterator it = mAllNoneBlockEntities.find(entityNode);
     multimap<BlockVector, Entity3D*>::iterator biter;
     multimap<BlockVector, Entity3D*>::iterator eiter;
@@ -306,8 +296,10 @@ void Octree3DMapManager::updateNoneBLockEntityLocation(const Handle &entityNode,
 
 
 // currently we consider all the none block entities has no collision, agents can get through them
-void Octree3DMapManager::removeNoneBlockEntity(const Handle &entityNode)
+void Octree3DMapManager::removeNoneBlockEntity(const Handle &entityNode, unsigned long timestamp)
 {
+    _changeRevision();
+
     map<Handle, Entity3D*>::iterator it;
     it = mAllNoneBlockEntities.find(entityNode);
     if (it != mAllNoneBlockEntities.end())
@@ -333,10 +325,15 @@ void Octree3DMapManager::removeNoneBlockEntity(const Handle &entityNode)
         mAllNoneBlockEntities.erase(it);
         delete entity;
     }
+
+    mHistory.recordEntityRemoved(timestamp, entityNode);
+    _updateHistoryKeyframe();
 }
 
-void Octree3DMapManager:: addSolidUnitBlock(BlockVector _pos, const Handle &_unitBlockAtom, std::string _materialType, std::string _color)
+void Octree3DMapManager:: addSolidUnitBlock(BlockVector _pos, const Handle &_unitBlockAtom, std::string _materialType, std::string _color, unsigned long timestamp)
 {
+    _changeRevision();
+
     // First, check if this _pos is inside the map boundary
     if (! mMapBoundingBox.isUnitBlockInsideMe(_pos))
     {
@@ -358,6 +355,8 @@ void Octree3DMapManager:: addSolidUnitBlock(BlockVector _pos, const Handle &_uni
     {
         mAllUnitAtomsToBlocksMap.insert(map<Handle, BlockVector>::value_type(_unitBlockAtom, _pos));
         mAllUnitBlocksToAtomsMap.insert(map<BlockVector,Handle>::value_type(_pos, _unitBlockAtom));
+        mHistory.recordBlockAdded(timestamp, _pos, _unitBlockAtom);
+        _updateHistoryKeyframe();
     }
     mTotalUnitBlockNum ++;
 
@@ -412,8 +411,10 @@ void Octree3DMapManager:: addSolidUnitBlock(BlockVector _pos, const Handle &_uni
     }
 }
 
-void Octree3DMapManager::removeSolidUnitBlock(const Handle &blockNode)
+void Octree3DMapManager::removeSolidUnitBlock(const Handle &blockNode, unsigned long timestamp)
 {
+    _changeRevision();
+
     map<Handle, BlockVector>::iterator it;
     it = mAllUnitAtomsToBlocksMap.find(blockNode);
     if (it == mAllUnitAtomsToBlocksMap.end())
@@ -441,6 +442,9 @@ void Octree3DMapManager::removeSolidUnitBlock(const Handle &blockNode)
     mAllUnitBlocksToAtomsMap.erase(itp);
     mTotalUnitBlockNum --;
 
+    mHistory.recordBlockRemoved(timestamp, _pos, blockNode);
+    _updateHistoryKeyframe();
+
     BlockEntity* myEntity = block->mBlockEntity;
 
     if (myEntity == 0)
@@ -585,6 +589,8 @@ BlockVector Octree3DMapManager::getPositionFromUnitBlockHandle(const Handle &h)
 
 void Octree3DMapManager::findAllBlockEntitiesOnTheMap()
 {
+    _changeRevision();
+
     if (! enable_BlockEntity_Segmentation)
         return;
 
@@ -1344,9 +1350,9 @@ std::set<SPATIAL_RELATION> Octree3DMapManager::computeSpatialRelations( const Ax
 Octree3DMapManager::Octree3DMapManager(bool _enable_BlockEntity_Segmentation,int _TotalDepthOfOctree,string _MapName, Octree *_RootOctree, int _FloorHeight,
                  int _AgentHeight,int _TotalUnitBlockNum,AxisAlignedBox &_MapBoundingBox,Entity3D *_selfAgentEntity,
                  map<Handle, BlockVector> &_AllUnitAtomsToBlocksMap,map<BlockVector, Handle> &_AllUnitBlocksToAtomsMap,map<int, BlockEntity *> &_BlockEntityList,
-                 map<Handle, Entity3D *> &_AllNoneBlockEntities, map<Handle, vector<pair<unsigned long, BlockVector> > > _nonBlockEntitieshistoryLocations):
+                 map<Handle, Entity3D *> &_AllNoneBlockEntities, const SpaceMapHistory& _history):
                 enable_BlockEntity_Segmentation(_enable_BlockEntity_Segmentation),mTotalDepthOfOctree(_TotalDepthOfOctree), mMapName(_MapName),mFloorHeight(_FloorHeight),
-                mAgentHeight(_AgentHeight),mTotalUnitBlockNum(_TotalUnitBlockNum), mMapBoundingBox(_MapBoundingBox), selfAgentEntity(_selfAgentEntity)
+                mAgentHeight(_AgentHeight),mTotalUnitBlockNum(_TotalUnitBlockNum), mMapBoundingBox(_MapBoundingBox), selfAgentEntity(_selfAgentEntity), mHistory(_history)
 
  {
     // the clone order should not be change here:
@@ -1383,6 +1389,4 @@ Octree3DMapManager::Octree3DMapManager(bool _enable_BlockEntity_Segmentation,int
 
     }
 
-    nonBlockEntitieshistoryLocations = _nonBlockEntitieshistoryLocations;
-
  }
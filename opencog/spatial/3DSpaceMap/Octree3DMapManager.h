@@ -38,6 +38,7 @@
 #include "Block3DMapUtil.h"
 #include "Block3D.h"
 #include "Octree.h"
+#include "SpaceMapHistory.h"
 
 using namespace std;
 
@@ -145,13 +146,13 @@ namespace opencog
 
             void updateNoneBLockEntityLocation(const Handle &entityNode, BlockVector _newpos, unsigned long timestamp, bool is_standLocation = false);
 
-            void removeNoneBlockEntity(const Handle &entityNode);
+            void removeNoneBlockEntity(const Handle &entityNode, unsigned long timestamp = 0);
 
-            void addSolidUnitBlock(BlockVector _pos, const Handle &_unitBlockAtom = opencog::Handle::UNDEFINED,  std::string _materialType = "", std::string _color = "" );
+            void addSolidUnitBlock(BlockVector _pos, const Handle &_unitBlockAtom = opencog::Handle::UNDEFINED,  std::string _materialType = "", std::string _color = "", unsigned long timestamp = 0);
 
             // return the BlockEntity occupied this position, then the atomspace can update the predicates for this Entity
             // But if this entity is disappear during this process, then will return 0
-            void removeSolidUnitBlock(const Handle &blockNode);
+            void removeSolidUnitBlock(const Handle &blockNode, unsigned long timestamp = 0);
 
             // Given a posititon, find all the blocks in the BlockEntity this posititon belongs to.
             BlockEntity* findAllBlocksInBlockEntity(BlockVector& _pos);
@@ -302,7 +303,7 @@ namespace opencog
             void computeAllAdjacentBlockClusters();
 
             int getAgentHeight(){return mAgentHeight;}
-            void setAgentHeight(int _height){mAgentHeight = _height;}
+            void setAgentHeight(int _height){mAgentHeight = _height; _changeRevision();}
 
             bool checkIsSolid(BlockVector& pos);
             bool checkIsSolid(int x, int y, int z);
@@ -319,13 +320,19 @@ namespace opencog
 
             bool isAvatarEntity(const Entity3D* entity) const;
 
-            // to recoard all the history locations/ centerPosition for all the nonBlockEntities, the lastest one is push_back
-            // map <EntityHandle, vector< pair < timestamp, location> >
-            map< Handle, vector< pair<unsigned long,BlockVector> > > nonBlockEntitieshistoryLocations;
-
             // get the last location this nonBlockEntity appeared
             BlockVector getLastAppearedLocation(Handle entityHandle);
 
+            // the recorded changes of this map: unit blocks added / removed
+            // and nonBlockEntities moved / removed, queryable at any time
+            const SpaceMapHistory& getHistory() const {return mHistory;}
+            SpaceMapHistory& getHistory() {return mHistory;}
+
+            // changes every time this map is changed, and never goes back to a previous value,
+            // so it can be used as a key to cache what is computed from this map.
+            // A clone has the revision of its original until one of them is changed.
+            unsigned long getRevision() const {return mRevision;}
+
         protected:
 
             int mTotalDepthOfOctree;
@@ -357,15 +364,25 @@ namespace opencog
             map<Handle, Entity3D*> mAllAvatarList;
             multimap<BlockVector, Entity3D*> mPosToNoneBlockEntityMap;
 
+            SpaceMapHistory mHistory;
+
+            unsigned long mRevision;
+            static unsigned long lastRevision;
+
+            void _changeRevision() {mRevision = ++lastRevision;}
+
             bool getUnitBlockHandlesOfABlock(const BlockVector& _nearLeftPos, int _blockLevel, HandleSeq &handles);
 
             void _addNonBlockEntityHistoryLocation(Handle entityHandle,BlockVector newLocation, unsigned long timestamp);
 
+            // take a keyframe of the history when enough changes were recorded
+            void _updateHistoryKeyframe();
+
             // this constructor is only used for clone
             Octree3DMapManager(bool _enable_BlockEntity_Segmentation, int _TotalDepthOfOctree,std::string  _MapName,Octree* _RootOctree, int _FloorHeight, int _AgentHeight,
                                int _TotalUnitBlockNum,AxisAlignedBox& _MapBoundingBox,Entity3D* _selfAgentEntity,map<Handle, BlockVector>& _AllUnitAtomsToBlocksMap,
                                map<BlockVector,Handle>& _AllUnitBlocksToAtomsMap,map<int,BlockEntity*>& _BlockEntityList,map<Handle,
-                               Entity3D*>& _AllNoneBlockEntities, map<Handle, vector<pair<unsigned long, BlockVector> > > _nonBlockEntitieshistoryLocations);
+                               Entity3D*>& _AllNoneBlockEntities, const SpaceMapHistory& _history);
 
 
 /*
@@ -24,6 +24,7 @@
 #include "Pathfinder3D.h"
 #include <set>
 #include <map>
+#include <deque>
 #include <iterator>
 #include <algorithm>
 
@@ -268,3 +269,72 @@ bool Pathfinder3D::checkNeighbourAccessable(Octree3DMapManager *mapManager, Bloc
 
     return true;
 }
+
+int Pathfinder3D::findReachableTargets(Octree3DMapManager* mapManager, const BlockVector& begin, const vector<BlockVector>& targets,
+                                       vector<bool>& reachable)
+{
+    reachable.assign(targets.size(), false);
+
+    // the targets still to reach, and where they are in the targets vector
+    multimap<BlockVector, size_t> toReach;
+    for (size_t t = 0; t < targets.size(); t ++)
+    {
+        if (mapManager->checkStandable(targets[t]))
+            toReach.insert(pair<BlockVector, size_t>(targets[t], t));
+    }
+
+    if ((toReach.size() == 0) || (! mapManager->checkStandable(begin)))
+        return 0;
+
+    int reachedNum = 0;
+    set<BlockVector> searchedList;
+    deque<BlockVector> toSearch;
+    searchedList.insert(begin);
+    toSearch.push_back(begin);
+
+    // the same moves as AStar3DPathFinder, so a target is reachable here if and only if it finds a path to it
+    while ((toSearch.size() != 0) && (toReach.size() != 0))
+    {
+        BlockVector lastPos = toSearch.front();
+        toSearch.pop_front();
+
+        pair<multimap<BlockVector, size_t>::iterator, multimap<BlockVector, size_t>::iterator> reached = toReach.equal_range(lastPos);
+        for (multimap<BlockVector, size_t>::iterator it = reached.first; it != reached.second; ++ it)
+        {
+            reachable[it->second] = true;
+            reachedNum ++;
+        }
+        toReach.erase(reached.first, reached.second);
+
+        for (int i = -1; i < 2; i ++)
+        {
+            for (int j = -1; j < 2; j ++)
+            {
+                for (int k = -1; k < 2; k ++)
+                {
+                    if ( (i == 0) && (j == 0))
+                        continue;
+
+                    BlockVector curPos(lastPos.x + i, lastPos.y + j, lastPos.z + k);
+                    if (searchedList.find(curPos) != searchedList.end())
+                        continue;
+
+                    if (! mapManager->checkStandable(curPos))
+                    {
+                        searchedList.insert(curPos);
+                        continue;
+                    }
+
+                    // whether it is accessable depends on where it is accessed from, so it is only marked as searched once accessed
+                    if ( ! checkNeighbourAccessable(mapManager, lastPos, i, j, k))
+                        continue;
+
+                    searchedList.insert(curPos);
+                    toSearch.push_back(curPos);
+                }
+            }
+        }
+    }
+
+    return reachedNum;
+}
@@ -48,6 +48,12 @@ namespace opencog
                                           vector<BlockVector>& path, BlockVector& nearestPos,BlockVector& bestPos, bool getNearestPos = false, bool getBestPos = false, bool tryOptimal = false);
             static double calculateCostByDistance(const BlockVector& begin,const BlockVector& target,const BlockVector& pos,float &nearestDis,BlockVector& nearestPos,float& bestHeuristic, BlockVector& bestPos);
             static bool checkNeighbourAccessable(Octree3DMapManager *mapManager, BlockVector& lastPos, int i, int j, int k);
+
+            // Answer if there is a path from begin to each of the targets with one breadth first search,
+            // which stops as soon as all the targets are reached, instead of one AStar3DPathFinder per target.
+            // reachable[i] is for targets[i]. Return how many targets are reachable.
+            static int findReachableTargets(Octree3DMapManager* mapManager, const BlockVector& begin, const vector<BlockVector>& targets,
+                                            vector<bool>& reachable);
         };
     }
 /** @}*/
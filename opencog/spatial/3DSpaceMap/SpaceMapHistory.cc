@@ -0,0 +1,586 @@
+/*
+ * opencog/spatial/3DSpaceMap/SpaceMapHistory.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "SpaceMapHistory.h"
+
+using namespace opencog;
+using namespace opencog::spatial;
+
+// The saved history is a header followed by records, each starting with
+// its type: a keyframe, one of the DeltaType, or the end of a snapshot.
+static const char HISTORY_MAGIC[4] = {'S', 'M', 'H', 1};
+static const char KEYFRAME_RECORD = 'K';
+static const char END_RECORD = 'E';
+
+namespace
+{
+
+// Unsigned numbers are written 7 bits per byte, least significant first;
+// signed ones are zigzag encoded first so small negatives stay short.
+
+bool putVarint(FILE* fp, uint64_t value)
+{
+    unsigned char bytes[10];
+    int n = 0;
+    do {
+        bytes[n] = value & 0x7f;
+        value >>= 7;
+        if (value != 0)
+            bytes[n] |= 0x80;
+        ++n;
+    } while (value != 0);
+    return fwrite(bytes, 1, n, fp) == (size_t) n;
+}
+
+bool getVarint(FILE* fp, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(fp);
+        if (c == EOF)
+            return false;
+        value |= (uint64_t) (c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool putSigned(FILE* fp, int value)
+{
+    int64_t v = value;
+    return putVarint(fp, (uint64_t) ((v << 1) ^ (v >> 63)));
+}
+
+bool getSigned(FILE* fp, int& value)
+{
+    uint64_t v;
+    if (!getVarint(fp, v))
+        return false;
+    value = (int) ((int64_t) (v >> 1) ^ -(int64_t) (v & 1));
+    return true;
+}
+
+bool putPosition(FILE* fp, const BlockVector& pos)
+{
+    return putSigned(fp, pos.x) && putSigned(fp, pos.y) && putSigned(fp, pos.z);
+}
+
+bool getPosition(FILE* fp, BlockVector& pos)
+{
+    return getSigned(fp, pos.x) && getSigned(fp, pos.y) && getSigned(fp, pos.z);
+}
+
+bool putHandle(FILE* fp, const Handle& h)
+{
+    return putVarint(fp, h.value());
+}
+
+bool getHandle(FILE* fp, Handle& h)
+{
+    uint64_t uuid;
+    if (!getVarint(fp, uuid))
+        return false;
+    h = Handle((UUID) uuid);
+    return true;
+}
+
+template<typename Pair>
+bool lessFirst(const Pair& a, const Pair& b)
+{
+    return a.first < b.first;
+}
+
+}
+
+SpaceMapHistory::SpaceMapHistory(unsigned int keyframeInterval, unsigned int maxKeyframes) :
+    mKeyframeInterval(std::max(1u, keyframeInterval)), mMaxKeyframes(std::max(1u, maxKeyframes))
+{
+    clear();
+}
+
+void SpaceMapHistory::clear()
+{
+    mDeltas.clear();
+    mKeyframes.clear();
+    mDeltaBase = 0;
+    mKeyframeBase = 0;
+    mLatestTimestamp = 0;
+    mEntities.clear();
+    mLastLocations.clear();
+    mFlushedDeltas = 0;
+    mFlushedKeyframes = 0;
+    mFlushedTimestamp = 0;
+
+    // the empty map the history starts from
+    mKeyframes.push_back(Keyframe());
+    mKeyframes.back().timestamp = 0;
+    mKeyframes.back().deltaIndex = 0;
+}
+
+void SpaceMapHistory::_record(char type, unsigned long timestamp, const Handle& handle, const BlockVector& pos)
+{
+    if (timestamp > mLatestTimestamp)
+        mLatestTimestamp = timestamp;
+
+    Delta delta;
+    delta.timestamp = mLatestTimestamp;
+    delta.handle = handle;
+    delta.pos = pos;
+    delta.type = type;
+    mDeltas.push_back(delta);
+}
+
+void SpaceMapHistory::recordBlockAdded(unsigned long timestamp, const BlockVector& pos, const Handle& blockNode)
+{
+    _record(BLOCK_ADDED, timestamp, blockNode, pos);
+}
+
+void SpaceMapHistory::recordBlockRemoved(unsigned long timestamp, const BlockVector& pos, const Handle& blockNode)
+{
+    _record(BLOCK_REMOVED, timestamp, blockNode, pos);
+}
+
+void SpaceMapHistory::recordEntityMoved(unsigned long timestamp, const Handle& entityNode, const BlockVector& pos)
+{
+    std::map<Handle, BlockVector>::iterator it = mEntities.find(entityNode);
+    if (it != mEntities.end() && it->second == pos)
+        return; // no location changed
+
+    _record(ENTITY_MOVED, timestamp, entityNode, pos);
+    mEntities[entityNode] = pos;
+    mLastLocations[entityNode] = pos;
+}
+
+void SpaceMapHistory::recordEntityRemoved(unsigned long timestamp, const Handle& entityNode)
+{
+    if (mEntities.erase(entityNode) == 0)
+        return;
+
+    _record(ENTITY_REMOVED, timestamp, entityNode, BlockVector::ZERO);
+}
+
+bool SpaceMapHistory::keyframeDue() const
+{
+    return mDeltaBase + mDeltas.size() - mKeyframes.back().deltaIndex >= mKeyframeInterval;
+}
+
+void SpaceMapHistory::addKeyframe(const std::map<BlockVector, Handle>& blocks)
+{
+    Keyframe keyframe;
+    keyframe.timestamp = mLatestTimestamp;
+    keyframe.deltaIndex = mDeltaBase + mDeltas.size();
+    keyframe.blocks.assign(blocks.begin(), blocks.end());
+    keyframe.entities.assign(mEntities.begin(), mEntities.end());
+
+    if (mKeyframes.back().deltaIndex == keyframe.deltaIndex)
+        std::swap(mKeyframes.back(), keyframe);
+    else
+        mKeyframes.push_back(keyframe);
+
+    _forgetOldHistory();
+}
+
+void SpaceMapHistory::_forgetOldHistory()
+{
+    if (mKeyframes.size() <= mMaxKeyframes)
+        return;
+
+    size_t forgottenKeyframes = mKeyframes.size() - mMaxKeyframes;
+
+    // once flush() started a log, what it has not written yet is kept
+    // until it has, or the log would silently miss it
+    if (mFlushedKeyframes > 0) {
+        while (forgottenKeyframes > 0 &&
+               (mKeyframes[forgottenKeyframes].deltaIndex > mFlushedDeltas ||
+                mKeyframeBase + forgottenKeyframes > mFlushedKeyframes))
+            --forgottenKeyframes;
+        if (forgottenKeyframes == 0)
+            return;
+    }
+
+    size_t firstDelta = mKeyframes[forgottenKeyframes].deltaIndex;
+    mKeyframes.erase(mKeyframes.begin(), mKeyframes.begin() + forgottenKeyframes);
+    mDeltas.erase(mDeltas.begin(), mDeltas.begin() + (firstDelta - mDeltaBase));
+    mKeyframeBase += forgottenKeyframes;
+    mDeltaBase = firstDelta;
+}
+
+unsigned long SpaceMapHistory::getStartTime() const
+{
+    return mKeyframes.front().timestamp;
+}
+
+bool SpaceMapHistory::_findState(unsigned long timestamp, const Keyframe*& keyframe, size_t& end) const
+{
+    if (timestamp < getStartTime())
+        return false;
+
+    // the deltas up to the given time...
+    std::vector<Delta>::const_iterator last = mDeltas.begin();
+    size_t count = mDeltas.size();
+    while (count > 0) {
+        size_t step = count / 2;
+        if ((last + step)->timestamp <= timestamp) {
+            last += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    end = mDeltaBase + (last - mDeltas.begin());
+
+    // ...starting from the last keyframe before them
+    size_t first = 0;
+    count = mKeyframes.size();
+    while (count > 0) {
+        size_t step = count / 2;
+        if (mKeyframes[first + step].deltaIndex <= end) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    keyframe = &mKeyframes[first - 1];
+    return true;
+}
+
+bool SpaceMapHistory::getEntityLocation(const Handle& entityNode, unsigned long timestamp, BlockVector& pos) const
+{
+    const Keyframe* keyframe;
+    size_t end;
+    if (!_findState(timestamp, keyframe, end))
+        return false;
+
+    bool found = false;
+    std::vector< std::pair<Handle, BlockVector> >::const_iterator it =
+        std::lower_bound(keyframe->entities.begin(), keyframe->entities.end(),
+                         std::make_pair(entityNode, BlockVector::ZERO),
+                         lessFirst< std::pair<Handle, BlockVector> >);
+    if (it != keyframe->entities.end() && it->first == entityNode) {
+        found = true;
+        pos = it->second;
+    }
+
+    for (size_t i = keyframe->deltaIndex - mDeltaBase; i < end - mDeltaBase; ++i) {
+        const Delta& delta = mDeltas[i];
+        if (delta.handle != entityNode)
+            continue;
+        if (delta.type == ENTITY_MOVED) {
+            found = true;
+            pos = delta.pos;
+        } else if (delta.type == ENTITY_REMOVED) {
+            found = false;
+        }
+    }
+    return found;
+}
+
+Handle SpaceMapHistory::getBlock(const BlockVector& pos, unsigned long timestamp) const
+{
+    const Keyframe* keyframe;
+    size_t end;
+    if (!_findState(timestamp, keyframe, end))
+        return Handle::UNDEFINED;
+
+    Handle block = Handle::UNDEFINED;
+    std::vector< std::pair<BlockVector, Handle> >::const_iterator it =
+        std::lower_bound(keyframe->blocks.begin(), keyframe->blocks.end(),
+                         std::make_pair(pos, Handle::UNDEFINED),
+                         lessFirst< std::pair<BlockVector, Handle> >);
+    if (it != keyframe->blocks.end() && it->first == pos)
+        block = it->second;
+
+    for (size_t i = keyframe->deltaIndex - mDeltaBase; i < end - mDeltaBase; ++i) {
+        const Delta& delta = mDeltas[i];
+        if (delta.type == BLOCK_ADDED && delta.pos == pos)
+            block = delta.handle;
+        else if (delta.type == BLOCK_REMOVED && delta.pos == pos)
+            block = Handle::UNDEFINED;
+    }
+    return block;
+}
+
+bool SpaceMapHistory::getBlocks(unsigned long timestamp, std::map<BlockVector, Handle>& blocks) const
+{
+    const Keyframe* keyframe;
+    size_t end;
+    if (!_findState(timestamp, keyframe, end))
+        return false;
+
+    blocks.clear();
+    blocks.insert(keyframe->blocks.begin(), keyframe->blocks.end());
+    for (size_t i = keyframe->deltaIndex - mDeltaBase; i < end - mDeltaBase; ++i) {
+        const Delta& delta = mDeltas[i];
+        if (delta.type == BLOCK_ADDED)
+            blocks[delta.pos] = delta.handle;
+        else if (delta.type == BLOCK_REMOVED)
+            blocks.erase(delta.pos);
+    }
+    return true;
+}
+
+bool SpaceMapHistory::getEntityLocations(unsigned long timestamp, std::map<Handle, BlockVector>& locations) const
+{
+    const Keyframe* keyframe;
+    size_t end;
+    if (!_findState(timestamp, keyframe, end))
+        return false;
+
+    locations.clear();
+    locations.insert(keyframe->entities.begin(), keyframe->entities.end());
+    for (size_t i = keyframe->deltaIndex - mDeltaBase; i < end - mDeltaBase; ++i) {
+        const Delta& delta = mDeltas[i];
+        if (delta.type == ENTITY_MOVED)
+            locations[delta.handle] = delta.pos;
+        else if (delta.type == ENTITY_REMOVED)
+            locations.erase(delta.handle);
+    }
+    return true;
+}
+
+BlockVector SpaceMapHistory::getLastLocation(const Handle& entityNode) const
+{
+    std::map<Handle, BlockVector>::const_iterator it = mLastLocations.find(entityNode);
+    if (it == mLastLocations.end())
+        return BlockVector::ZERO;
+    return it->second;
+}
+
+bool SpaceMapHistory::_writeRecords(FILE* fp, size_t fromDelta, size_t fromKeyframe, unsigned long& timestamp) const
+{
+    size_t k = std::max(fromKeyframe, mKeyframeBase) - mKeyframeBase;
+    size_t endDelta = mDeltaBase + mDeltas.size();
+    for (size_t d = std::max(fromDelta, mDeltaBase); d <= endDelta; ++d) {
+        // the keyframes come before the first delta after them
+        for (; k < mKeyframes.size() && mKeyframes[k].deltaIndex <= d; ++k) {
+            const Keyframe& keyframe = mKeyframes[k];
+            if (fputc(KEYFRAME_RECORD, fp) == EOF ||
+                !putVarint(fp, keyframe.timestamp - timestamp) ||
+                !putVarint(fp, keyframe.blocks.size()))
+                return false;
+            timestamp = keyframe.timestamp;
+
+            // blocks are sorted: write each position relative to the previous one
+            BlockVector previous = BlockVector::ZERO;
+            for (size_t i = 0; i < keyframe.blocks.size(); ++i) {
+                const BlockVector& pos = keyframe.blocks[i].first;
+                if (!putPosition(fp, BlockVector(pos.x - previous.x, pos.y - previous.y, pos.z - previous.z)) ||
+                    !putHandle(fp, keyframe.blocks[i].second))
+                    return false;
+                previous = pos;
+            }
+
+            if (!putVarint(fp, keyframe.entities.size()))
+                return false;
+            for (size_t i = 0; i < keyframe.entities.size(); ++i) {
+                if (!putHandle(fp, keyframe.entities[i].first) ||
+                    !putPosition(fp, keyframe.entities[i].second))
+                    return false;
+            }
+        }
+        if (d == endDelta)
+            break;
+
+        const Delta& delta = mDeltas[d - mDeltaBase];
+        if (fputc(delta.type, fp) == EOF ||
+            !putVarint(fp, delta.timestamp - timestamp) ||
+            !putHandle(fp, delta.handle))
+            return false;
+        timestamp = delta.timestamp;
+        if (delta.type != ENTITY_REMOVED && !putPosition(fp, delta.pos))
+            return false;
+    }
+    return true;
+}
+
+bool SpaceMapHistory::save(FILE* fp) const
+{
+    unsigned long timestamp = 0;
+    return fwrite(HISTORY_MAGIC, sizeof(HISTORY_MAGIC), 1, fp) == 1 &&
+           _writeRecords(fp, mDeltaBase, mKeyframeBase, timestamp) &&
+           fputc(END_RECORD, fp) != EOF;
+}
+
+bool SpaceMapHistory::flush(FILE* fp)
+{
+    if (mFlushedDeltas == 0 && mFlushedKeyframes == 0) {
+        if (fwrite(HISTORY_MAGIC, sizeof(HISTORY_MAGIC), 1, fp) != 1)
+            return false;
+        mFlushedTimestamp = 0;
+    }
+    if (!_writeRecords(fp, mFlushedDeltas, mFlushedKeyframes, mFlushedTimestamp))
+        return false;
+    mFlushedDeltas = mDeltaBase + mDeltas.size();
+    mFlushedKeyframes = mKeyframeBase + mKeyframes.size();
+    // what was kept for the log can go now
+    _forgetOldHistory();
+    return fflush(fp) == 0;
+}
+
+bool SpaceMapHistory::load(FILE* fp)
+{
+    char magic[sizeof(HISTORY_MAGIC)];
+    if (fread(magic, sizeof(magic), 1, fp) != 1 ||
+        !std::equal(magic, magic + sizeof(magic), HISTORY_MAGIC))
+        return false;
+
+    std::vector<Delta> deltas;
+    std::vector<Keyframe> keyframes;
+    unsigned long timestamp = 0;
+    uint64_t value;
+    int type;
+    while ((type = fgetc(fp)) != EOF && type != END_RECORD) {
+        if (!getVarint(fp, value))
+            return false;
+        timestamp += value;
+
+        if (type == KEYFRAME_RECORD) {
+            keyframes.push_back(Keyframe());
+            Keyframe& keyframe = keyframes.back();
+            keyframe.timestamp = timestamp;
+            keyframe.deltaIndex = deltas.size();
+
+            BlockVector pos = BlockVector::ZERO;
+            if (!getVarint(fp, value))
+                return false;
+            keyframe.blocks.resize(value);
+            for (size_t i = 0; i < keyframe.blocks.size(); ++i) {
+                BlockVector offset;
+                if (!getPosition(fp, offset) || !getHandle(fp, keyframe.blocks[i].second))
+                    return false;
+                pos += offset;
+                keyframe.blocks[i].first = pos;
+            }
+
+            if (!getVarint(fp, value))
+                return false;
+            keyframe.entities.resize(value);
+            for (size_t i = 0; i < keyframe.entities.size(); ++i) {
+                if (!getHandle(fp, keyframe.entities[i].first) ||
+                    !getPosition(fp, keyframe.entities[i].second))
+                    return false;
+            }
+        } else if (type == BLOCK_ADDED || type == BLOCK_REMOVED ||
+                   type == ENTITY_MOVED || type == ENTITY_REMOVED) {
+            Delta delta;
+            delta.type = (char) type;
+            delta.timestamp = timestamp;
+            delta.pos = BlockVector::ZERO;
+            if (!getHandle(fp, delta.handle) ||
+                (type != ENTITY_REMOVED && !getPosition(fp, delta.pos)))
+                return false;
+            deltas.push_back(delta);
+        } else {
+            return false;
+        }
+    }
+    if (keyframes.empty() || keyframes.front().deltaIndex != 0)
+        return false;
+
+    mDeltas.swap(deltas);
+    mKeyframes.swap(keyframes);
+    mDeltaBase = 0;
+    mKeyframeBase = 0;
+    mLatestTimestamp = timestamp;
+
+    // the entities now, and where each one was last seen
+    getEntityLocations(mLatestTimestamp, mEntities);
+    mLastLocations.clear();
+    mLastLocations.insert(mKeyframes.front().entities.begin(), mKeyframes.front().entities.end());
+    for (size_t i = 0; i < mDeltas.size(); ++i) {
+        if (mDeltas[i].type == ENTITY_MOVED)
+            mLastLocations[mDeltas[i].handle] = mDeltas[i].pos;
+    }
+
+    // what was loaded is already on disk
+    mFlushedDeltas = mDeltas.size();
+    mFlushedKeyframes = mKeyframes.size();
+    mFlushedTimestamp = mLatestTimestamp;
+    return true;
+}
+
+void SpaceMapHistory::updateHandles(const std::function<Handle (const Handle&)>& update)
+{
+    // drop the deltas of the atoms that are gone (a block removal is known
+    // by its position, so it stays), and renumber the kept ones
+    std::vector<size_t> newIndex(mDeltas.size() + 1);
+    size_t kept = 0;
+    for (size_t i = 0; i < mDeltas.size(); ++i) {
+        newIndex[i] = mDeltaBase + kept;
+        Delta& delta = mDeltas[i];
+        delta.handle = update(delta.handle);
+        if (delta.handle == Handle::UNDEFINED && delta.type != BLOCK_REMOVED)
+            continue;
+        mDeltas[kept++] = delta;
+    }
+    newIndex[mDeltas.size()] = mDeltaBase + kept;
+    mDeltas.resize(kept);
+    if (mFlushedDeltas >= mDeltaBase)
+        mFlushedDeltas = newIndex[mFlushedDeltas - mDeltaBase];
+
+    for (size_t k = 0; k < mKeyframes.size(); ++k) {
+        Keyframe& keyframe = mKeyframes[k];
+        keyframe.deltaIndex = newIndex[keyframe.deltaIndex - mDeltaBase];
+
+        std::vector< std::pair<BlockVector, Handle> > blocks;
+        for (size_t i = 0; i < keyframe.blocks.size(); ++i) {
+            Handle h = update(keyframe.blocks[i].second);
+            if (h != Handle::UNDEFINED)
+                blocks.push_back(std::make_pair(keyframe.blocks[i].first, h));
+        }
+        keyframe.blocks.swap(blocks);
+
+        std::vector< std::pair<Handle, BlockVector> > entities;
+        for (size_t i = 0; i < keyframe.entities.size(); ++i) {
+            Handle h = update(keyframe.entities[i].first);
+            if (h != Handle::UNDEFINED)
+                entities.push_back(std::make_pair(h, keyframe.entities[i].second));
+        }
+        // the new handles may not sort as the old ones
+        std::sort(entities.begin(), entities.end(),
+                  lessFirst< std::pair<Handle, BlockVector> >);
+        keyframe.entities.swap(entities);
+    }
+
+    std::map<Handle, BlockVector> entities;
+    std::map<Handle, BlockVector>::const_iterator it;
+    for (it = mEntities.begin(); it != mEntities.end(); ++it) {
+        Handle h = update(it->first);
+        if (h != Handle::UNDEFINED)
+            entities[h] = it->second;
+    }
+    mEntities.swap(entities);
+
+    std::map<Handle, BlockVector> lastLocations;
+    for (it = mLastLocations.begin(); it != mLastLocations.end(); ++it) {
+        Handle h = update(it->first);
+        if (h != Handle::UNDEFINED)
+            lastLocations[h] = it->second;
+    }
+    mLastLocations.swap(lastLocations);
+}
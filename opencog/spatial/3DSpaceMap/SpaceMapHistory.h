@@ -0,0 +1,199 @@
+/*
+ * opencog/spatial/3DSpaceMap/SpaceMapHistory.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SPATIAL_SPACEMAPHISTORY_H
+#define _SPATIAL_SPACEMAPHISTORY_H
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <opencog/atomspace/Handle.h>
+
+#include "Block3DMapUtil.h"
+
+namespace opencog
+{
+/** \addtogroup grp_spatial
+ *  @{
+ */
+    namespace spatial
+    {
+
+        /**
+         * The history of a space map: every unit block added or removed and
+         * every move or removal of a non-block entity is recorded as a small
+         * delta, in timestamp order. Every keyframeInterval deltas, a
+         * keyframe holds the whole state (blocks and entity locations), so
+         * the state at any time T is the nearest keyframe before T plus at
+         * most keyframeInterval deltas, without cloning the map.
+         *
+         * Only the latest maxKeyframes keyframes (and the deltas after the
+         * first of them) are kept; older history is forgotten, except what
+         * a log started by flush() has not received yet.
+         *
+         * The history is saved in a compact binary format (variable length
+         * integers, timestamps and keyframe positions relative to the
+         * previous ones). save() writes a self-contained snapshot; flush()
+         * appends to a log only what was recorded since the previous
+         * flush(), so the history can be streamed to disk as it grows.
+         */
+        class SpaceMapHistory
+        {
+        public:
+
+            SpaceMapHistory(unsigned int keyframeInterval = 1024, unsigned int maxKeyframes = 64);
+
+            /**
+             * Record the changes. A timestamp of 0 stands for the time of the
+             * latest change; timestamps earlier than it are taken as it.
+             */
+            void recordBlockAdded(unsigned long timestamp, const BlockVector& pos, const Handle& blockNode);
+            void recordBlockRemoved(unsigned long timestamp, const BlockVector& pos, const Handle& blockNode);
+            void recordEntityMoved(unsigned long timestamp, const Handle& entityNode, const BlockVector& pos);
+            void recordEntityRemoved(unsigned long timestamp, const Handle& entityNode);
+
+            /**
+             * True when enough deltas were recorded since the last keyframe:
+             * the owner should then call addKeyframe with its current blocks.
+             */
+            bool keyframeDue() const;
+
+            void addKeyframe(const std::map<BlockVector, Handle>& blocks);
+
+            /**
+             * Where was the entity at the given time? Return false if it was
+             * not on the map, or if the time is before the kept history.
+             */
+            bool getEntityLocation(const Handle& entityNode, unsigned long timestamp, BlockVector& pos) const;
+
+            // the unit block at the given position and time, or Handle::UNDEFINED
+            Handle getBlock(const BlockVector& pos, unsigned long timestamp) const;
+
+            // the whole state of the map at the given time
+            bool getBlocks(unsigned long timestamp, std::map<BlockVector, Handle>& blocks) const;
+            bool getEntityLocations(unsigned long timestamp, std::map<Handle, BlockVector>& locations) const;
+
+            // the last location of an entity, even if it is gone, or BlockVector::ZERO
+            BlockVector getLastLocation(const Handle& entityNode) const;
+
+            // earliest time the kept history can answer for
+            unsigned long getStartTime() const;
+
+            unsigned long getLatestTime() const {return mLatestTimestamp;}
+
+            size_t getNumberOfDeltas() const {return mDeltas.size();}
+            size_t getNumberOfKeyframes() const {return mKeyframes.size();}
+
+            void clear();
+
+            /**
+             * Write the whole kept history. Return false on a write error.
+             */
+            bool save(FILE* fp) const;
+
+            /**
+             * Append to a log started by a previous flush (or start it) the
+             * changes recorded since then. Return false on a write error.
+             */
+            bool flush(FILE* fp);
+
+            /**
+             * Read a history written by save(), or a log written by flush().
+             * Return false if the data is not a valid history.
+             */
+            bool load(FILE* fp);
+
+            /**
+             * Replace every handle of the history (e.g. by the one of the
+             * atom loaded from a saved AtomSpace). The entities and blocks
+             * mapped to Handle::UNDEFINED are dropped from the history.
+             */
+            void updateHandles(const std::function<Handle (const Handle&)>& update);
+
+        private:
+
+            enum DeltaType
+            {
+                BLOCK_ADDED = 'A',
+                BLOCK_REMOVED = 'R',
+                ENTITY_MOVED = 'M',
+                ENTITY_REMOVED = 'X'
+            };
+
+            struct Delta
+            {
+                unsigned long timestamp;
+                Handle handle;
+                BlockVector pos;
+                char type;
+            };
+
+            struct Keyframe
+            {
+                unsigned long timestamp;
+                // the keyframe is the state before this delta
+                size_t deltaIndex;
+                // sorted
+                std::vector< std::pair<BlockVector, Handle> > blocks;
+                std::vector< std::pair<Handle, BlockVector> > entities;
+            };
+
+            unsigned int mKeyframeInterval;
+            unsigned int mMaxKeyframes;
+
+            // Deltas and keyframes are numbered since the beginning of the
+            // history: mDeltas[0] is the delta number mDeltaBase
+            std::vector<Delta> mDeltas;
+            std::vector<Keyframe> mKeyframes;
+            size_t mDeltaBase;
+            size_t mKeyframeBase;
+
+            unsigned long mLatestTimestamp;
+
+            // entities on the map now, and the last location of every entity
+            std::map<Handle, BlockVector> mEntities;
+            std::map<Handle, BlockVector> mLastLocations;
+
+            // what flush() has already written
+            size_t mFlushedDeltas;
+            size_t mFlushedKeyframes;
+            unsigned long mFlushedTimestamp;
+
+            void _record(char type, unsigned long timestamp, const Handle& handle, const BlockVector& pos);
+
+            // the keyframe to start from and the end of the deltas to apply
+            // to it to get the state at the given time
+            bool _findState(unsigned long timestamp, const Keyframe*& keyframe, size_t& end) const;
+
+            void _forgetOldHistory();
+
+            bool _writeRecords(FILE* fp, size_t fromDelta, size_t fromKeyframe, unsigned long& timestamp) const;
+        };
+
+    }
+/** @}*/
+}
+
+#endif // _SPATIAL_SPACEMAPHISTORY_H
@@ -24,12 +24,16 @@
 #include <opencog/spatial/HPASearch.h>
 #include <cmath>
 #include <map>
+#include <set>
 #include <opencog/util/Logger.h>
 #include <opencog/spatial/QuadTree.h>
 
 using namespace opencog;
 using namespace opencog::spatial;
 
+// the path cache is dropped when it grows past this number of paths
+static const unsigned int MAX_CACHED_PATHS = 1024;
+
 HPASearch::Level::Level( LocalSpaceMap2D* map, unsigned int level, unsigned int maximumClusters )
 {
     this->map = map;
@@ -39,7 +43,11 @@ HPASearch::Level::Level( LocalSpaceMap2D* map, unsigned int level, unsigned int
     this->numberOfRows = maximumClusters * level;
     this->clusterDimension.width = ( this->map->xMax( ) - this->map->xMin( ) ) / numberOfCols;
     this->clusterDimension.height = ( this->map->yMax( ) - this->map->yMin( ) ) / numberOfRows;
-    this->abstractGraph = new Graph( this->map->xDim( ) * this->map->yDim( ) );
+    this->clusterCellCols =
+        static_cast<unsigned int>( clusterDimension.width / this->map->xGridWidth( ) );
+    this->clusterCellRows =
+        static_cast<unsigned int>( clusterDimension.height / this->map->yGridWidth( ) );
+    this->abstractGraph = new Graph( );
     this->needsUpdate = true;
 }
 
@@ -75,249 +83,287 @@ unsigned int HPASearch::Level::getClusterId( const GridPoint& gridPoint ) const
     return ( ( row * numberOfRows ) + col );
 }
 
-void HPASearch::Level::buildClusters( void )
+void HPASearch::Level::invalidate( const std::vector<GridPoint>& cells )
 {
+    unsigned int i;
+    for ( i = 0; i < cells.size( ); ++i ) {
+        unsigned int row = std::min( cells[i].second / clusterCellRows, numberOfRows - 1 );
+        unsigned int col = std::min( cells[i].first / clusterCellCols, numberOfCols - 1 );
+        this->dirtyClusters.insert( row * numberOfCols + col );
+    } // for
+}
 
-    unsigned int clusterCols =
-        static_cast<unsigned int>( clusterDimension.width / this->map->xGridWidth( ) );
-    unsigned int clusterRows =
-        static_cast<unsigned int>( clusterDimension.height / this->map->yGridWidth( ) );
-
+unsigned int HPASearch::Level::update( void )
+{
+    unsigned int numberOfClusters = numberOfRows * numberOfCols;
     unsigned int row;
     unsigned int col;
 
-    // build all cluster entrances
-    for ( row = 0; row < numberOfRows; ++row ) {
-        for ( col = 0; col < numberOfCols; ++col ) {
-            buildEntrance( row, col, true );
-            buildEntrance( row, col, false );
+    if ( this->needsUpdate ) {
+        this->clusterGraphs.assign( numberOfClusters, ClusterGraph( ) );
+        this->borderEntrances.assign( numberOfClusters * 2, std::vector<Edge>( ) );
+        this->pathCache.clear( );
+        for ( row = 0; row < numberOfClusters; ++row ) {
+            this->dirtyClusters.insert( row );
         } // for
-    } // for
-
-    // boost::property_map<Graph, HPASearch::VertexPosition>::type position =
-    boost::get( HPASearch::VertexPosition( ), *this->abstractGraph );
-
-
-    for ( row = 0; row < numberOfRows; ++row ) {
-        for ( col = 0; col < numberOfCols; ++col ) {
-            unsigned int rowClusterOffset = clusterRows * row;
-            unsigned int colClusterOffset = clusterCols * col;
-
-            unsigned int beforeVertexCounter = this->vertexCounter;
-            QuadTree( this, GridPoint( colClusterOffset, rowClusterOffset ), clusterCols, this->abstractGraph ).connectEdges( );
-            unsigned int numberOfClusterVertices = this->vertexCounter - beforeVertexCounter;
-
-            unsigned int clusterId = getClusterId( GridPoint( colClusterOffset, rowClusterOffset ) );
-            clustersVertexRange[ clusterId ].first = beforeVertexCounter;
-            clustersVertexRange[ clusterId ].second = numberOfClusterVertices;
-
-            std::vector< GridPoint >& nearestEntrances =
-                clusterEntrances[ clusterId ];
-
-            unsigned int i;
-            unsigned int j;
-            if ( numberOfClusterVertices > 0 ) {
-
-                std::vector<float> distances(nearestEntrances.size( ));
-                std::vector<unsigned int> nearestVertex(nearestEntrances.size( ));
-                std::fill_n( distances.begin( ), nearestEntrances.size( ),  ( map->xDim( ) * map->yDim( ) ) );
-
-                for ( j = 0; j < numberOfClusterVertices; ++j ) {
-                    unsigned int vertexId = beforeVertexCounter + j;
-                    math::Vector2 position = boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, vertexId );
-
-                    for ( i = 0; i < nearestEntrances.size( ); ++i ) {
-                        math::Vector2 entrancePosition = boost::get( HPASearch::VertexPosition( ),
-                                                         *this->abstractGraph,
-                                                         this->graphVertices[ nearestEntrances[ i ] ] );
-
-                        float candidateDistance = ( position - entrancePosition ).length( );
-
-                        if ( candidateDistance < distances[ i ] ) {
-                            distances[ i ] = candidateDistance;
-                            nearestVertex[ i ] = vertexId;
-                        } // if
-
-                    } // for
-                } // for
-
-                // connect all entrances to the inner graph
-                for ( i = 0; i < nearestEntrances.size( ); ++i ) {
-                    boost::add_edge( this->graphVertices[ nearestEntrances[ i ] ],
-                                     nearestVertex[ i ], distances[ i ], *this->abstractGraph );
-                } // for
-
-            } else {
-                // there is no obstacle inside cluster, so
-                // inter-connect all entrances
-                for ( i = 0; i < nearestEntrances.size( ); ++i ) {
-                    for ( j = i + 1; j < nearestEntrances.size( ); ++j ) {
-
-                        unsigned int vertex1 = this->graphVertices[ nearestEntrances[ i ] ];
-                        unsigned int vertex2 = this->graphVertices[ nearestEntrances[ j ] ];
-                        math::Vector2 position1 = boost::get( HPASearch::VertexPosition( ),
-                                                              *this->abstractGraph,
-                                                              vertex1 );
-
-                        math::Vector2 position2 = boost::get( HPASearch::VertexPosition( ),
-                                                              *this->abstractGraph,
-                                                              vertex2 );
-
-                        boost::add_edge( vertex1, vertex2,
-                                         ( position1 - position2 ).length( ), *this->abstractGraph );
-                    } // for
-                } // for
+        this->needsUpdate = false;
+    } // if
 
-            } // else
+    if ( this->dirtyClusters.empty( ) ) {
+        return 0;
+    } // if
 
+    // drop the cached paths that cross a changed cluster; the paths that
+    // were not found may exist now
+    std::map< std::pair<GridPoint, GridPoint>, CachedPath >::iterator it = this->pathCache.begin( );
+    while ( it != this->pathCache.end( ) ) {
+        bool valid = it->second.found;
+        unsigned int i;
+        for ( i = 0; valid && i < it->second.cells.size( ); ++i ) {
+            const GridPoint& cell = it->second.cells[i];
+            row = std::min( cell.second / clusterCellRows, numberOfRows - 1 );
+            col = std::min( cell.first / clusterCellCols, numberOfCols - 1 );
+            valid = this->dirtyClusters.find( row * numberOfCols + col ) == this->dirtyClusters.end( );
         } // for
-    } // for
-
-    // connect all intra cluster entrances
-    unsigned int i;
-    for ( i = 0; i < this->entrances.size( ); ++i ) {
-        unsigned int vertex1 = this->graphVertices[ this->entrances[ i ].first ];
-        unsigned int vertex2 = this->graphVertices[ this->entrances[ i ].second ];
-        boost::add_edge( vertex1, vertex2, clusterDimension.width, *this->abstractGraph );
-    } // for
-
-    // make a reduced copy of the graph
-    if ( boost::num_vertices( *this->abstractGraph ) / 2 > this->vertexCounter ) {
-
-        Graph* oldGraph = this->abstractGraph;
-        this->abstractGraph = new Graph( this->vertexCounter );
-
-        boost::property_map<Graph, HPASearch::VertexPosition>::type position =
-            boost::get( HPASearch::VertexPosition( ), *this->abstractGraph );
+        if ( valid ) {
+            ++it;
+        } else {
+            this->pathCache.erase( it++ );
+        } // else
+    } // while
 
-        // copy vertices
-        unsigned int i;
-        for ( i = 0; i < this->vertexCounter; ++i ) {
-            math::Vector2 realPosition =
-                boost::get( HPASearch::VertexPosition( ), *oldGraph, i );
-            boost::put( position, i, realPosition );
+    // rebuild the changed clusters and all their borders, then relink the
+    // entrances of the clusters that share those borders
+    std::set<unsigned int> borders;
+    std::set<unsigned int> linkedClusters;
+    std::set<unsigned int>::const_iterator cluster;
+    for ( cluster = this->dirtyClusters.begin( ); cluster != this->dirtyClusters.end( ); ++cluster ) {
+        row = *cluster / numberOfCols;
+        col = *cluster % numberOfCols;
+        buildCluster( row, col );
+
+        borders.insert( *cluster * 2 );
+        borders.insert( *cluster * 2 + 1 );
+        linkedClusters.insert( *cluster );
+        if ( col > 0 ) {
+            borders.insert( ( *cluster - 1 ) * 2 );
+            linkedClusters.insert( *cluster - 1 );
         } // if
+        if ( col + 1 < numberOfCols ) {
+            linkedClusters.insert( *cluster + 1 );
+        } // if
+        if ( row > 0 ) {
+            borders.insert( ( *cluster - numberOfCols ) * 2 + 1 );
+            linkedClusters.insert( *cluster - numberOfCols );
+        } // if
+        if ( row + 1 < numberOfRows ) {
+            linkedClusters.insert( *cluster + numberOfCols );
+        } // if
+    } // for
 
-        // copy edges
-        EdgeIterator it = boost::edges( *oldGraph );
-        while ( it.first != it.second ) {
-
-            VertexDescriptor v1 = boost::source( *it.first, *oldGraph );
-            VertexDescriptor v2 = boost::target( *it.first, *oldGraph );
-
-            boost::add_edge( v1, v2, 0, *this->abstractGraph );
-            ++it.first;
-        } // while
-
-        delete oldGraph;
-
-    } // if
-
+    std::set<unsigned int>::const_iterator border;
+    for ( border = borders.begin( ); border != borders.end( ); ++border ) {
+        buildEntrance( ( *border / 2 ) / numberOfCols, ( *border / 2 ) % numberOfCols, ( *border % 2 ) == 0 );
+    } // for
+    for ( cluster = linkedClusters.begin( ); cluster != linkedClusters.end( ); ++cluster ) {
+        linkEntrances( *cluster / numberOfCols, *cluster % numberOfCols );
+    } // for
 
+    assembleGraph( );
 
+    unsigned int rebuiltClusters = this->dirtyClusters.size( );
+    this->dirtyClusters.clear( );
+    return rebuiltClusters;
 }
 
-void HPASearch::Level::setupVertex( const GridPoint& gridPoint )
+void HPASearch::Level::buildCluster( unsigned int row, unsigned int col )
 {
-    boost::property_map<Graph, HPASearch::VertexPosition>::type position =
-        boost::get( HPASearch::VertexPosition( ), *this->abstractGraph );
+    ClusterGraph& cluster = this->clusterGraphs[ row * numberOfCols + col ];
+    cluster.vertices.clear( );
+    cluster.innerEdges.clear( );
 
-    Point realPosition = map->unsnap( gridPoint );
-    math::Vector2 cellCenterPosition( realPosition.first, realPosition.second );
-    this->graphVertices[ gridPoint ] = vertexCounter;
-    boost::put( position, vertexCounter, cellCenterPosition );
-    vertexCounter++;
+    QuadTree( this, GridPoint( clusterCellCols * col, clusterCellRows * row ), clusterCellCols, &cluster ).connectEdges( );
 }
 
-void HPASearch::Level::buildEntrance( unsigned int row, unsigned int col, bool horizontal )
+void HPASearch::Level::linkEntrances( unsigned int row, unsigned int col )
 {
-    float numberOfCols = clusterDimension.width / map->xGridWidth( );
-    float numberOfRows = clusterDimension.height / map->yGridWidth( );
-
-    if ( horizontal ) {
-        unsigned int topLeftCluster1Col = static_cast<unsigned int>
-                                          ( ( col * numberOfCols ) + numberOfCols - 1 );
-        unsigned int topLeftCluster1Row = static_cast<unsigned int>( row * numberOfRows );
-        unsigned int topRightCluster2Col = topLeftCluster1Col + 1;
-        unsigned int topRightCluster2Row = topLeftCluster1Row;
+    unsigned int clusterIndex = row * numberOfCols + col;
+    ClusterGraph& cluster = this->clusterGraphs[ clusterIndex ];
+    cluster.entranceEdges.clear( );
 
+    std::vector< GridPoint > nearestEntrances;
+    unsigned int i;
+    unsigned int j;
+    for ( i = 0; i < this->borderEntrances[ clusterIndex * 2 ].size( ); ++i ) {
+        nearestEntrances.push_back( this->borderEntrances[ clusterIndex * 2 ][ i ].first );
+    } // for
+    for ( i = 0; i < this->borderEntrances[ clusterIndex * 2 + 1 ].size( ); ++i ) {
+        nearestEntrances.push_back( this->borderEntrances[ clusterIndex * 2 + 1 ][ i ].first );
+    } // for
+    if ( col > 0 ) {
+        const std::vector<Edge>& left = this->borderEntrances[ ( clusterIndex - 1 ) * 2 ];
+        for ( i = 0; i < left.size( ); ++i ) {
+            nearestEntrances.push_back( left[ i ].second );
+        } // for
+    } // if
+    if ( row > 0 ) {
+        const std::vector<Edge>& top = this->borderEntrances[ ( clusterIndex - numberOfCols ) * 2 + 1 ];
+        for ( i = 0; i < top.size( ); ++i ) {
+            nearestEntrances.push_back( top[ i ].second );
+        } // for
+    } // if
 
-        std::vector< std::pair<GridPoint, GridPoint> > localEntrances;
-        unsigned int i;
+    if ( cluster.vertices.size( ) > 0 ) {
+        // connect all entrances to the nearest vertex of the inner graph
+        for ( i = 0; i < nearestEntrances.size( ); ++i ) {
+            Point entrancePoint = map->unsnap( nearestEntrances[ i ] );
+            math::Vector2 entrancePosition( entrancePoint.first, entrancePoint.second );
+            float distance = map->xDim( ) * map->yDim( );
+            GridPoint nearestVertex = cluster.vertices[ 0 ];
+
+            for ( j = 0; j < cluster.vertices.size( ); ++j ) {
+                Point vertexPoint = map->unsnap( cluster.vertices[ j ] );
+                float candidateDistance = ( math::Vector2( vertexPoint.first, vertexPoint.second ) - entrancePosition ).length( );
+                if ( candidateDistance < distance ) {
+                    distance = candidateDistance;
+                    nearestVertex = cluster.vertices[ j ];
+                } // if
+            } // for
+            cluster.entranceEdges.push_back( CellEdge( nearestEntrances[ i ], nearestVertex, distance ) );
+        } // for
 
-        for ( i = 0; i < numberOfRows; ++i ) {
-            GridPoint cell1( topLeftCluster1Col, topLeftCluster1Row + i );
-            GridPoint cell2( topRightCluster2Col, topRightCluster2Row + i );
+    } else {
+        // there is no obstacle inside cluster, so
+        // inter-connect all entrances
+        for ( i = 0; i < nearestEntrances.size( ); ++i ) {
+            Point position1 = map->unsnap( nearestEntrances[ i ] );
+            for ( j = i + 1; j < nearestEntrances.size( ); ++j ) {
+                Point position2 = map->unsnap( nearestEntrances[ j ] );
+                cluster.entranceEdges.push_back( CellEdge( nearestEntrances[ i ], nearestEntrances[ j ],
+                                                           LocalSpaceMap2D::eucDist( position1, position2 ) ) );
+            } // for
+        } // for
+    } // else
+}
 
-            if ( !map->gridIllegal( cell1 ) && !map->gridIllegal( cell2 ) ) {
-                localEntrances.push_back( std::pair<GridPoint, GridPoint>( cell1, cell2 ) );
-            } else if ( localEntrances.size( ) > 0 ) {
-                unsigned int selectedIndex = ( localEntrances.size( ) ) / 2;
-                std::pair<GridPoint, GridPoint>& entrance = localEntrances[ selectedIndex ];
-                this->entrances.push_back( entrance );
+void HPASearch::Level::assembleGraph( void )
+{
+    this->graphVertices.clear( );
+    this->vertexCells.clear( );
+    this->clustersVertexRange.clear( );
+    this->clusterEntrances.clear( );
+    this->entrances.clear( );
+    this->vertexCounter = 0;
 
-                this->clusterEntrances[ getClusterId( entrance.first ) ].push_back( entrance.first );
-                this->clusterEntrances[ getClusterId( entrance.second ) ].push_back( entrance.second );
+    unsigned int row;
+    unsigned int col;
+    unsigned int i;
 
-                setupVertex( entrance.first );
-                setupVertex( entrance.second );
-            } // else
+    // the quad tree vertices of each cluster get a contiguous range of ids
+    for ( row = 0; row < numberOfRows; ++row ) {
+        for ( col = 0; col < numberOfCols; ++col ) {
+            const ClusterGraph& cluster = this->clusterGraphs[ row * numberOfCols + col ];
+            unsigned int clusterId = getClusterId( GridPoint( clusterCellCols * col, clusterCellRows * row ) );
+            clustersVertexRange[ clusterId ].first = this->vertexCounter;
+            for ( i = 0; i < cluster.vertices.size( ); ++i ) {
+                setupVertex( cluster.vertices[ i ] );
+            } // for
+            clustersVertexRange[ clusterId ].second = this->vertexCounter - clustersVertexRange[ clusterId ].first;
         } // for
+    } // for
 
-        if ( localEntrances.size( ) > 0 ) {
-            unsigned int selectedIndex = ( localEntrances.size( ) ) / 2;
-            std::pair<GridPoint, GridPoint>& entrance = localEntrances[ selectedIndex ];
+    // then the entrances, unless they are on a quad tree vertex
+    for ( i = 0; i < this->borderEntrances.size( ); ++i ) {
+        unsigned int j;
+        for ( j = 0; j < this->borderEntrances[ i ].size( ); ++j ) {
+            const Edge& entrance = this->borderEntrances[ i ][ j ];
             this->entrances.push_back( entrance );
 
             this->clusterEntrances[ getClusterId( entrance.first ) ].push_back( entrance.first );
             this->clusterEntrances[ getClusterId( entrance.second ) ].push_back( entrance.second );
 
-            setupVertex( entrance.first );
-            setupVertex( entrance.second );
-        } // if
-    } else {
-        unsigned int bottomLeftCluster1Col = static_cast<unsigned int>( col * numberOfCols );
-        unsigned int bottomLeftCluster1Row = static_cast<unsigned int>
-                                             ( ( row * numberOfRows ) + numberOfRows - 1 );
-        unsigned int topLeftCluster2Col = bottomLeftCluster1Col;
-        unsigned int topLeftCluster2Row = bottomLeftCluster1Row + 1;
+            if ( this->graphVertices.find( entrance.first ) == this->graphVertices.end( ) ) {
+                setupVertex( entrance.first );
+            } // if
+            if ( this->graphVertices.find( entrance.second ) == this->graphVertices.end( ) ) {
+                setupVertex( entrance.second );
+            } // if
+        } // for
+    } // for
 
-        std::vector< std::pair<GridPoint, GridPoint > > localEntrances;
-        unsigned int i;
-        for ( i = 0; i < numberOfRows; ++i ) {
-            GridPoint cell1( bottomLeftCluster1Col + i, bottomLeftCluster1Row );
-            GridPoint cell2( topLeftCluster2Col + i, topLeftCluster2Row );
+    delete this->abstractGraph;
+    this->abstractGraph = new Graph( this->vertexCounter );
 
-            if ( !map->gridIllegal( cell1 ) && !map->gridIllegal( cell2 ) ) {
-                localEntrances.push_back( std::pair<GridPoint, GridPoint>( cell1, cell2 ) );
-            } else if ( localEntrances.size( ) > 0 ) {
-                unsigned int selectedIndex = ( localEntrances.size( ) ) / 2;
-                std::pair<GridPoint, GridPoint>& entrance = localEntrances[ selectedIndex ];
-                this->entrances.push_back( entrance );
+    boost::property_map<Graph, HPASearch::VertexPosition>::type position =
+        boost::get( HPASearch::VertexPosition( ), *this->abstractGraph );
+    for ( i = 0; i < this->vertexCounter; ++i ) {
+        Point realPosition = map->unsnap( this->vertexCells[ i ] );
+        boost::put( position, i, math::Vector2( realPosition.first, realPosition.second ) );
+    } // for
 
-                this->clusterEntrances[ getClusterId( entrance.first ) ].push_back( entrance.first );
-                this->clusterEntrances[ getClusterId( entrance.second ) ].push_back( entrance.second );
+    for ( i = 0; i < this->clusterGraphs.size( ); ++i ) {
+        const ClusterGraph& cluster = this->clusterGraphs[ i ];
+        std::vector<CellEdge>::const_iterator edge;
+        for ( edge = cluster.innerEdges.begin( ); edge != cluster.innerEdges.end( ); ++edge ) {
+            boost::add_edge( this->graphVertices[ edge->cell1 ], this->graphVertices[ edge->cell2 ],
+                             edge->weight, *this->abstractGraph );
+        } // for
+        for ( edge = cluster.entranceEdges.begin( ); edge != cluster.entranceEdges.end( ); ++edge ) {
+            boost::add_edge( this->graphVertices[ edge->cell1 ], this->graphVertices[ edge->cell2 ],
+                             edge->weight, *this->abstractGraph );
+        } // for
+    } // for
 
-                setupVertex( entrance.first );
-                setupVertex( entrance.second );
-            } // else
+    // connect all intra cluster entrances
+    for ( i = 0; i < this->entrances.size( ); ++i ) {
+        unsigned int vertex1 = this->graphVertices[ this->entrances[ i ].first ];
+        unsigned int vertex2 = this->graphVertices[ this->entrances[ i ].second ];
+        boost::add_edge( vertex1, vertex2, clusterDimension.width, *this->abstractGraph );
+    } // for
+}
 
-        } // for
+void HPASearch::Level::setupVertex( const GridPoint& gridPoint )
+{
+    this->graphVertices[ gridPoint ] = vertexCounter;
+    this->vertexCells.push_back( gridPoint );
+    vertexCounter++;
+}
 
-        if ( localEntrances.size( ) > 0 ) {
-            unsigned int selectedIndex = ( localEntrances.size( ) ) / 2;
-            std::pair<GridPoint, GridPoint>& entrance = localEntrances[ selectedIndex ];
-            this->entrances.push_back( entrance );
+void HPASearch::Level::buildEntrance( unsigned int row, unsigned int col, bool horizontal )
+{
+    float numberOfCols = clusterDimension.width / map->xGridWidth( );
+    float numberOfRows = clusterDimension.height / map->yGridWidth( );
 
-            this->clusterEntrances[ getClusterId( entrance.first ) ].push_back( entrance.first );
-            this->clusterEntrances[ getClusterId( entrance.second ) ].push_back( entrance.second );
+    std::vector<Edge>& border = this->borderEntrances[ ( row * this->numberOfCols + col ) * 2 + ( horizontal ? 0 : 1 ) ];
+    border.clear( );
 
-            setupVertex( entrance.first );
-            setupVertex( entrance.second );
-        } // if
+    // each run of free cells along the border gives an entrance at its middle
+    std::vector< std::pair<GridPoint, GridPoint> > localEntrances;
+    unsigned int i;
+    for ( i = 0; i < numberOfRows; ++i ) {
+        GridPoint cell1;
+        GridPoint cell2;
+        if ( horizontal ) {
+            cell1 = GridPoint( static_cast<unsigned int>( ( col * numberOfCols ) + numberOfCols - 1 ),
+                               static_cast<unsigned int>( row * numberOfRows ) + i );
+            cell2 = GridPoint( cell1.first + 1, cell1.second );
+        } else {
+            cell1 = GridPoint( static_cast<unsigned int>( col * numberOfCols ) + i,
+                               static_cast<unsigned int>( ( row * numberOfRows ) + numberOfRows - 1 ) );
+            cell2 = GridPoint( cell1.first, cell1.second + 1 );
+        } // else
 
-    } // else
+        if ( !map->gridIllegal( cell1 ) && !map->gridIllegal( cell2 ) ) {
+            localEntrances.push_back( std::pair<GridPoint, GridPoint>( cell1, cell2 ) );
+        } else if ( localEntrances.size( ) > 0 ) {
+            border.push_back( localEntrances[ localEntrances.size( ) / 2 ] );
+            localEntrances.clear( );
+        } // else
+    } // for
 
+    if ( localEntrances.size( ) > 0 ) {
+        border.push_back( localEntrances[ localEntrances.size( ) / 2 ] );
+    } // if
 }
 
 GridPoint HPASearch::Level::getNearestEntrance( unsigned int clusterId, const math::Vector2& position )
@@ -372,10 +418,7 @@ bool HPASearch::Level::processPath( const math::Vector2& startPoint, const math:
 
     this->processedPath.clear( );
 
-    if ( this->needsUpdate ) {
-        buildClusters( );
-        this->needsUpdate = false;
-    } // if
+    update( );
 
     bool invalidStartPoint = map->illegal( Point( startPoint.x, startPoint.y ) );
     bool invalidEndPoint = map->illegal( Point( endPoint.x, endPoint.y ) );
@@ -428,42 +471,27 @@ bool HPASearch::Level::processPath( const math::Vector2& startPoint, const math:
 
 
         // find a path inter-clusters
-        std::vector< VertexDescriptor > predecessors( boost::num_vertices( *this->abstractGraph ) );
-        std::vector< float > distances( boost::num_vertices( *this->abstractGraph ) );
-
-        try {
-
-            AStarDistanceHeuristic heuristic( boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, endWaypoint ), *this->abstractGraph );
-
-            boost::astar_search( *this->abstractGraph,
-                                 startWaypoint, heuristic,
-                                 boost::predecessor_map( &predecessors[0] ).
-                                 distance_map( &distances[0] ).
-                                 visitor( AStarGoalVisitor( endWaypoint ) ) );
-
+        const CachedPath& abstractPath = findAbstractPath( startWaypoint, endWaypoint );
+        if ( !abstractPath.found ) {
             // ignore start point this->processedPath.push_back( startPoint );
             this->processedPath.push_back( endPoint );
 
             return false;
-        } catch ( FoundGoal& ex ) {
-            unsigned int i;
-
-            if ( endPoint != boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, endWaypoint ) ) {
-                this->processedPath.push_back( endPoint );
-            } // if
+        } // if
 
-            bool running = true;
-            for ( i = endWaypoint; running ; i = predecessors[ i ] ) {
-                math::Vector2 wayPoint = boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, i );
-                this->processedPath.insert( this->processedPath.begin( ), wayPoint );
-                running = ( predecessors[ i ] != i );
-            } // for
+        if ( startPoint != boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, startWaypoint ) ) {
+            this->processedPath.push_back( startPoint );
+        } // if
 
-            if ( startPoint != boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, startWaypoint ) ) {
-                this->processedPath.insert( this->processedPath.begin( ), startPoint );
-            } // if
+        unsigned int i;
+        for ( i = 0; i < abstractPath.cells.size( ); ++i ) {
+            Point wayPoint = map->unsnap( abstractPath.cells[ i ] );
+            this->processedPath.push_back( math::Vector2( wayPoint.first, wayPoint.second ) );
+        } // for
 
-        } // catch
+        if ( endPoint != boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, endWaypoint ) ) {
+            this->processedPath.push_back( endPoint );
+        } // if
     } // else
 
     smoothPath( );
@@ -472,6 +500,47 @@ bool HPASearch::Level::processPath( const math::Vector2& startPoint, const math:
     return true;
 }
 
+const HPASearch::Level::CachedPath& HPASearch::Level::findAbstractPath( unsigned int startWaypoint, unsigned int endWaypoint )
+{
+    std::pair<GridPoint, GridPoint> key( this->vertexCells[ startWaypoint ], this->vertexCells[ endWaypoint ] );
+    std::map< std::pair<GridPoint, GridPoint>, CachedPath >::iterator it = this->pathCache.find( key );
+    if ( it != this->pathCache.end( ) ) {
+        return it->second;
+    } // if
+
+    if ( this->pathCache.size( ) >= MAX_CACHED_PATHS ) {
+        this->pathCache.clear( );
+    } // if
+    CachedPath& path = this->pathCache[ key ];
+    path.found = false;
+
+    std::vector< VertexDescriptor > predecessors( boost::num_vertices( *this->abstractGraph ) );
+    std::vector< float > distances( boost::num_vertices( *this->abstractGraph ) );
+
+    try {
+
+        AStarDistanceHeuristic heuristic( boost::get( HPASearch::VertexPosition( ), *this->abstractGraph, endWaypoint ), *this->abstractGraph );
+
+        boost::astar_search( *this->abstractGraph,
+                             startWaypoint, heuristic,
+                             boost::predecessor_map( &predecessors[0] ).
+                             distance_map( &distances[0] ).
+                             visitor( AStarGoalVisitor( endWaypoint ) ) );
+
+    } catch ( FoundGoal& ex ) {
+        path.found = true;
+
+        unsigned int i;
+        bool running = true;
+        for ( i = endWaypoint; running ; i = predecessors[ i ] ) {
+            path.cells.insert( path.cells.begin( ), this->vertexCells[ i ] );
+            running = ( predecessors[ i ] != i );
+        } // for
+    } // catch
+
+    return path;
+}
+
 const std::vector<math::Vector2>& HPASearch::Level::getProcessedPath( void ) const
 {
     return this->processedPath;
@@ -564,12 +633,16 @@ HPASearch::HPASearch( LocalSpaceMap2D* map, unsigned int numberOfLevels, unsigne
     for ( i = 1; i <= numberOfLevels; ++i ) {
         this->levels.push_back( new Level( map, i, maximumClusters ) );
     } // for
+    this->map->addOccupancyListener( this );
     logger().debug("HPASearch - end building clusters");
 
 }
 
 HPASearch::~HPASearch(void)
 {
+    if ( this->map != NULL ) {
+        this->map->removeOccupancyListener( this );
+    } // if
     unsigned int i;
     for ( i = 0; i < this->levels.size( ); ++i ) {
         delete this->levels[ i ];
@@ -600,3 +673,21 @@ const std::vector<math::Vector2>& HPASearch::getProcessedPath( unsigned int leve
 {
     return getLevel( levelId )->getProcessedPath( );
 }
+
+void HPASearch::invalidate( const std::vector<GridPoint>& cells )
+{
+    unsigned int i;
+    for ( i = 0; i < this->levels.size( ); ++i ) {
+        this->levels[ i ]->invalidate( cells );
+    } // for
+}
+
+void HPASearch::occupancyChanged( const std::vector<GridPoint>& cells )
+{
+    invalidate( cells );
+}
+
+void HPASearch::mapDestroyed( void )
+{
+    this->map = NULL;
+}
@@ -27,6 +27,9 @@
 #include <opencog/spatial/LocalSpaceMap2D.h>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/astar_search.hpp>
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <set>
 #include <string>
 #include <opencog/spatial/Prerequisites.h>
 #include <opencog/spatial/math/Dimension2.h>
@@ -48,8 +51,15 @@ namespace opencog
          * Each two sibbling clusters may or may not has entrances. An entrance is the way
          * to cross from on cluster to another. The pathfinding is the execution of the A* on
          * the abstract graph.
+         *
+         * The abstraction is repaired incrementally: the search listens to the occupancy
+         * of its map and invalidate()s the cells of the obstacles added, removed or
+         * updated, so only the clusters that contain them get their entrances and
+         * intra-cluster edges recomputed. One search can then be kept for the life of
+         * its map. Abstract paths are cached and reused until a cluster they cross
+         * changes.
          */
-        class HPASearch
+        class HPASearch : public OccupancyListener
         {
         public:
 
@@ -122,7 +132,7 @@ namespace opencog
 
             private:
                 math::Vector2 goalPosition;
-                Graph graph;
+                const Graph& graph;
             };
 
             /**
@@ -134,6 +144,30 @@ namespace opencog
             {
             public:
 
+                /**
+                 * Abstract graph edge between the vertices of two cells. Edges are
+                 * kept by cell because the vertex ids change every time the abstract
+                 * graph is assembled.
+                 */
+                struct CellEdge {
+                    CellEdge( const GridPoint& cell1, const GridPoint& cell2, float weight ) :
+                        cell1( cell1 ), cell2( cell2 ), weight( weight ) { }
+                    GridPoint cell1;
+                    GridPoint cell2;
+                    float weight;
+                };
+
+                /**
+                 * The part of the abstract graph owned by a cluster: the vertices of
+                 * its quad tree, the edges between them and the edges that link them
+                 * to the cluster entrances
+                 */
+                struct ClusterGraph {
+                    std::vector<GridPoint> vertices;
+                    std::vector<CellEdge> innerEdges;
+                    std::vector<CellEdge> entranceEdges;
+                };
+
                 Level( LocalSpaceMap2D* map, unsigned int level, unsigned int maximumClusters );
 
                 virtual ~Level( );
@@ -152,11 +186,31 @@ namespace opencog
 
                 unsigned int getClusterId( const GridPoint& gridPoint ) const;
 
+                // mark the clusters that contain the given cells as changed
+                void invalidate( const std::vector<GridPoint>& cells );
+
+                // rebuild the changed clusters (all of them the first time) and
+                // reassemble the abstract graph. Return the number of rebuilt clusters
+                unsigned int update( void );
+
             protected:
 
-                void buildClusters( void );
+                struct CachedPath {
+                    bool found;
+                    std::vector<GridPoint> cells;
+                };
+
+                void buildCluster( unsigned int row, unsigned int col );
 
                 void buildEntrance( unsigned int row, unsigned int col, bool horizontal );
+
+                // link the entrances of a cluster to its quad tree vertices
+                void linkEntrances( unsigned int row, unsigned int col );
+
+                void assembleGraph( void );
+
+                const CachedPath& findAbstractPath( unsigned int startWaypoint, unsigned int endWaypoint );
+
                 GridPoint getNearestEntrance( unsigned int clusterId, const math::Vector2& position );
 
                 GridPoint getNearestVertex( unsigned int clusterId, const math::Vector2& position );
@@ -171,9 +225,17 @@ namespace opencog
                 std::vector<math::Vector2> processedPath;
 
                 LocalSpaceMap2D* map;
+                // per cluster (row * numberOfCols + col) parts of the abstract graph
+                std::vector<ClusterGraph> clusterGraphs;
+                // entrances to the right (2 * cluster) and bottom (2 * cluster + 1) neighbours
+                std::vector< std::vector<Edge> > borderEntrances;
+                std::set<unsigned int> dirtyClusters;
+                std::map< std::pair<GridPoint, GridPoint>, CachedPath > pathCache;
+
                 std::vector< std::pair<GridPoint, GridPoint> > entrances;
                 std::map< unsigned int, std::vector< GridPoint > > clusterEntrances;
-                std::map< GridPoint, unsigned int > graphVertices;
+                boost::unordered_map< GridPoint, unsigned int, boost::hash<GridPoint> > graphVertices;
+                std::vector< GridPoint > vertexCells;
                 std::map< unsigned int, std::pair< unsigned int, unsigned int> > clustersVertexRange;
                 math::Dimension2 clusterDimension;
                 Graph* abstractGraph;
@@ -184,6 +246,10 @@ namespace opencog
                 unsigned int numberOfCols;
                 unsigned int numberOfRows;
 
+                // grid cells per cluster side
+                unsigned int clusterCellCols;
+                unsigned int clusterCellRows;
+
                 bool needsUpdate;
 
                 friend class Cluster;
@@ -197,6 +263,13 @@ namespace opencog
 
             const std::vector<math::Vector2>& getProcessedPath( unsigned int levelId ) const throw( opencog::RuntimeException );
 
+            // notify all the levels that the given cells of the map have changed
+            void invalidate( const std::vector<GridPoint>& cells );
+
+            // OccupancyListener
+            void occupancyChanged( const std::vector<GridPoint>& cells );
+            void mapDestroyed( void );
+
             virtual ~HPASearch(void);
 
             Level* getLevel( unsigned int levelId ) const throw( opencog::RuntimeException );
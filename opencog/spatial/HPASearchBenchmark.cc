@@ -0,0 +1,129 @@
+/*
+ * opencog/spatial/HPASearchBenchmark.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Compares the cost of repairing the HPA* abstraction incrementally with
+ * rebuilding it, for increasing amounts of map churn:
+ *
+ *     hpa_benchmark [grid size] [number of objects] [number of clusters]
+ *
+ * For each churn level, that many objects are moved, the map tells the
+ * search which cells changed and the abstraction is repaired; then a new
+ * HPASearch is built from scratch over the same map. Paths are then
+ * queried twice to show the effect of the abstract path cache.
+ */
+
+#include <opencog/spatial/HPASearch.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+using namespace opencog;
+using namespace opencog::spatial;
+
+static double elapsed(clock_t start)
+{
+    return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double randomCoordinate(double max)
+{
+    return max * (double(rand()) / RAND_MAX);
+}
+
+static ObjectMetaData randomObject(double mapSize)
+{
+    return ObjectMetaData(randomCoordinate(mapSize), randomCoordinate(mapSize), 0.0,
+                          1.0 + randomCoordinate(mapSize / 40.0), 1.0,
+                          1.0 + randomCoordinate(mapSize / 40.0), 0.0);
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned int gridSize = 512;
+    unsigned int objects = 200;
+    unsigned int clusters = 16;
+    try {
+        if (argc > 1) gridSize = boost::lexical_cast<unsigned int>(argv[1]);
+        if (argc > 2) objects = boost::lexical_cast<unsigned int>(argv[2]);
+        if (argc > 3) clusters = boost::lexical_cast<unsigned int>(argv[3]);
+    } catch (boost::bad_lexical_cast &) {
+        fprintf(stderr, "Usage: %s [grid size] [number of objects] [number of clusters]\n", argv[0]);
+        return 1;
+    }
+    srand(42);
+
+    double mapSize = gridSize / 4.0;
+    LocalSpaceMap2D map(0, mapSize, gridSize, 0, mapSize, gridSize, 0.354);
+    std::vector<std::string> ids;
+    for (unsigned int i = 0; i < objects; ++i) {
+        ids.push_back("obj" + boost::lexical_cast<std::string>(i));
+        map.addObject(ids.back(), randomObject(mapSize), true);
+    }
+
+    HPASearch search(&map, 1, clusters);
+    clock_t start = clock();
+    search.getLevel(1)->update();
+    printf("initial build: %.3f s (%u clusters)\n", elapsed(start), clusters * clusters);
+
+    std::vector<math::Vector2> queries;
+    for (unsigned int i = 0; i < 200; ++i) {
+        queries.push_back(math::Vector2(randomCoordinate(mapSize), randomCoordinate(mapSize)));
+    }
+
+    printf("%8s %10s %12s %12s %12s %12s\n", "moved", "clusters", "repair (s)",
+           "rebuild (s)", "paths (s)", "cached (s)");
+    unsigned int churn[] = { 1, 4, 16, 64 };
+    for (unsigned int c = 0; c < sizeof(churn) / sizeof(churn[0]); ++c) {
+        for (unsigned int i = 0; i < churn[c]; ++i) {
+            const std::string& id = ids[rand() % ids.size()];
+            map.updateObject(id, randomObject(mapSize), true);
+        }
+
+        start = clock();
+        unsigned int rebuilt = search.getLevel(1)->update();
+        double repair = elapsed(start);
+
+        start = clock();
+        HPASearch fresh(&map, 1, clusters);
+        fresh.getLevel(1)->update();
+        double rebuild = elapsed(start);
+
+        double paths[2];
+        for (unsigned int pass = 0; pass < 2; ++pass) {
+            start = clock();
+            for (unsigned int i = 0; i + 1 < queries.size(); i += 2) {
+                search.processPath(queries[i], queries[i + 1]);
+            }
+            paths[pass] = elapsed(start);
+        }
+
+        printf("%8u %10u %12.4f %12.4f %12.4f %12.4f\n", churn[c], rebuilt,
+               repair, rebuild, paths[0], paths[1]);
+    }
+    return 0;
+}
@@ -167,7 +167,8 @@ LocalSpaceMap2D& LocalSpaceMap2D::operator=(const LocalSpaceMap2D& other)
             "LocalSpaceMap2D - Cannot copy an object of this class");
 }
 
-LocalSpaceMap2D::LocalSpaceMap2D(const LocalSpaceMap2D& other) 
+LocalSpaceMap2D::LocalSpaceMap2D(const LocalSpaceMap2D& other) :
+        _occupancy(0, 0)
 {
     throw opencog::RuntimeException(TRACE_INFO, 
             "LocalSpaceMap2D - Cannot copy an object of this class");
@@ -181,6 +182,7 @@ LocalSpaceMap2D::LocalSpaceMap2D(spatial::Distance xMin, spatial::Distance xMax,
                                  spatial::Distance yMin, spatial::Distance yMax, unsigned int yDim,
                                  spatial::Distance radius,spatial::Distance agentHeight,
                                  spatial::Distance floor):
+        _occupancy(xDim, yDim),
         _xMin(xMin), _xMax(xMax), _xDim(xDim),
         _yMin(yMin), _yMax(yMax), _yDim(yDim),
         _radius(radius)
@@ -194,12 +196,16 @@ LocalSpaceMap2D::LocalSpaceMap2D(spatial::Distance xMin, spatial::Distance xMax,
 
 LocalSpaceMap2D::~LocalSpaceMap2D()
 {
+    std::vector<OccupancyListener*>::const_iterator it;
+    for ( it = _occupancyListeners.begin( ); it != _occupancyListeners.end( ); ++it ) {
+        (*it)->mapDestroyed( );
+    } // for
 }
 
 LocalSpaceMap2D* LocalSpaceMap2D::clone() const
 {
     LocalSpaceMap2D* clonedMap = new LocalSpaceMap2D(_xMin, _xMax, _xDim,
-            _yMin, _yMax, _xDim, _radius, _agentHeight, _floorHeight);
+            _yMin, _yMax, _yDim, _radius, _agentHeight, _floorHeight);
     //clonedMap->objects = objects;
     LongEntityPtrHashMap::const_iterator it1;
     for ( it1 = this->entities.begin( ); it1 != this->entities.end( ); ++it1 ) {
@@ -211,8 +217,9 @@ LocalSpaceMap2D* LocalSpaceMap2D::clone() const
         clonedMap->superEntities.push_back( (*it)->clone( ) );
     } // for
 
-    clonedMap->gridPoints = this->gridPoints;
+    clonedMap->objectSpans = this->objectSpans;
     clonedMap->_grid = _grid;
+    clonedMap->_occupancy = _occupancy;
     clonedMap->_grid_nonObstacle = _grid_nonObstacle;
 
     return clonedMap;
@@ -386,81 +393,25 @@ spatial::Point LocalSpaceMap2D::getNearestFreePoint(const spatial::Point& pt) co
     if (!gridIllegal(gp)) {
         return pt;
     }
-    bool foundFreePoint = false;
-    Point nearestFreePoint;
-    double nearestDistance = 0.0;
-    unsigned int limit = std::max(_xDim, _yDim);
-    for (unsigned int step = 1; !foundFreePoint && (step < limit); step++) {
-        bool valid_lower_x = step <= gp.first;
-        bool valid_lower_y = step <= gp.second;
-        bool valid_upper_x = step < (_xDim - gp.first);
-        bool valid_upper_y = step < (_yDim - gp.second);
-        if (!valid_lower_x && !valid_lower_y && !valid_upper_x && !valid_upper_y) {
-            break;
-        }
-        unsigned int lower_x = valid_lower_x ? (gp.first - step) : 0;
-        unsigned int lower_y = valid_lower_y ? (gp.second - step) : 0;
-        unsigned int upper_x = valid_upper_x ? (gp.first + step) : _xDim - 1;
-        unsigned int upper_y = valid_upper_y ? (gp.second + step) : _yDim - 1;
-        if (valid_lower_x) {
-            for (unsigned int y = lower_y; y <= upper_y; y++) {
-                if (!gridIllegal(lower_x, y)) {
-                    Point freePoint = unsnap(GridPoint(lower_x, y));
-                    double distance = sqrt(pow(freePoint.first - pt.first, 2) + pow(freePoint.second - pt.second, 2));
-                    if (!foundFreePoint || (distance < nearestDistance)) {
-                        nearestFreePoint = freePoint;
-                        nearestDistance = distance;
-                        foundFreePoint = true;
-                    }
-                }
-            }
-        }
-        if (valid_lower_y) {
-            for (unsigned int x = lower_x; x <= upper_x; x++) {
-                if (!gridIllegal(x, lower_y)) {
-                    Point freePoint = unsnap(GridPoint(x, lower_y));
-                    double distance = sqrt(pow(freePoint.first - pt.first, 2) + pow(freePoint.second - pt.second, 2));
-                    if (!foundFreePoint || (distance < nearestDistance)) {
-                        nearestFreePoint = freePoint;
-                        nearestDistance = distance;
-                        foundFreePoint = true;
-                    }
-                }
-            }
-        }
-        if (valid_upper_x) {
-            for (unsigned int y = lower_y; y <= upper_y; y++) {
-                if (!gridIllegal(upper_x, y)) {
-                    Point freePoint = unsnap(GridPoint(upper_x, y));
-                    double distance = sqrt(pow(freePoint.first - pt.first, 2) + pow(freePoint.second - pt.second, 2));
-                    if (!foundFreePoint || (distance < nearestDistance)) {
-                        nearestFreePoint = freePoint;
-                        nearestDistance = distance;
-                        foundFreePoint = true;
-                    }
-                }
-            }
-        }
-        if (valid_upper_y) {
-            for (unsigned int x = lower_x; x <= upper_x; x++) {
-                if (!gridIllegal(x, upper_y)) {
-                    Point freePoint = unsnap(GridPoint(x, upper_y));
-                    double distance = sqrt(pow(freePoint.first - pt.first, 2) + pow(freePoint.second - pt.second, 2));
-                    if (!foundFreePoint || (distance < nearestDistance)) {
-                        nearestFreePoint = freePoint;
-                        nearestDistance = distance;
-                        foundFreePoint = true;
-                    }
-                }
-            }
-        }
-    }
-    if (!foundFreePoint) {
+    // snap() clamps to the grid, so gp is occupied here and the distance
+    // field of the occupancy grid holds its nearest free cell
+    unsigned int freeX, freeY;
+    if (!_occupancy.nearestFree(gp.first, gp.second, freeX, freeY)) {
         throw opencog::RuntimeException(TRACE_INFO,
                                         "LocalSpaceMap2D - Could not find the nearest valid grid point from (%u,%u)",
-                                        pt.first, pt.second, gp.first, gp.second);
+                                        gp.first, gp.second);
+    }
+    return unsnap(GridPoint(freeX, freeY));
+}
+
+spatial::Distance LocalSpaceMap2D::obstacleDistance(const spatial::Point& pt) const
+{
+    GridPoint gp = snap(pt);
+    unsigned int obstacleX, obstacleY;
+    if (!_occupancy.nearestOccupied(gp.first, gp.second, obstacleX, obstacleY)) {
+        return -1.0;
     }
-    return nearestFreePoint;
+    return eucDist(pt, unsnap(GridPoint(obstacleX, obstacleY)));
 }
 
 spatial::Point3D LocalSpaceMap2D::getNearestFree3DPoint(const spatial::Point3D& pt, double delta) const throw (opencog::RuntimeException, std::bad_exception)
@@ -642,8 +593,7 @@ bool LocalSpaceMap2D::gridIllegal(unsigned int i, unsigned int j) const
 
 bool LocalSpaceMap2D::gridOccupied(const spatial::GridPoint& gp) const
 {
-    spatial::GridMap::const_iterator itr = _grid.find(gp);
-    return (itr != _grid.end() && !(itr->second.empty()));
+    return _occupancy.occupied(gp.first, gp.second);
 }
 
 bool LocalSpaceMap2D::gridOccupied(unsigned int i, unsigned int j) const
@@ -794,14 +744,21 @@ bool LocalSpaceMap2D::isNonObstacle(const spatial::ObjectID& id) const
     return !isObstacle( id );
 }
 
-const std::vector<spatial::GridPoint>& LocalSpaceMap2D::getObjectPoints(const spatial::ObjectID& id) const  throw(opencog::NotFoundException)
+std::vector<spatial::GridPoint> LocalSpaceMap2D::getObjectPoints(const spatial::ObjectID& id) const  throw(opencog::NotFoundException)
 {
     long idHash = boost::hash<std::string>()( id );
-    LongGridPointVectorHashMap::const_iterator it = this->gridPoints.find( idHash );
-    if ( it == this->gridPoints.end( ) ) {
+    LongGridSpanVectorHashMap::const_iterator it = this->objectSpans.find( idHash );
+    if ( it == this->objectSpans.end( ) ) {
         throw opencog::NotFoundException( TRACE_INFO, "LocalSpaceMap2D - There is no object %s", id.c_str() );
     } // if
-    return it->second;
+    std::vector<spatial::GridPoint> points;
+    std::vector<GridSpan>::const_iterator span;
+    for ( span = it->second.begin( ); span != it->second.end( ); ++span ) {
+        for ( unsigned int x = span->x0; x <= span->x1; ++x ) {
+            points.push_back( spatial::GridPoint( x, span->y ) );
+        } // for
+    } // for
+    return points;
 }
 
 spatial::Point LocalSpaceMap2D::getNearestObjectPoint( const spatial::Point& referencePoint, const spatial::ObjectID& objectID ) const throw (opencog::NotFoundException)
@@ -878,35 +835,39 @@ void LocalSpaceMap2D::removeObject(const spatial::ObjectID& id)
     bool isObstacle = it->second->getBooleanProperty( Entity::OBSTACLE );
 
     // removing object grid points
-    //std::vector<GridPoint>::const_iterator itPoints;
-    //for( itPoints = it->second.gridPoints.begin( ); itPoints != it->second.gridPoints.end( ); ++itPoints ) {
-    LongGridPointVectorHashMap::const_iterator it2 = gridPoints.find( it->first );
-    const std::vector<GridPoint>& entityGridPoints = it2->second;
+    LongGridSpanVectorHashMap::iterator it2 = objectSpans.find( it->first );
+    const std::vector<GridSpan>& entitySpans = it2->second;
 
     ObjectInfo info(internalId, true);
-    unsigned int i;
-    for ( i = 0; i < entityGridPoints.size( ); ++i ) {
-        //if ( it->second.isObstacle ) {
-        if ( isObstacle ) {
-            ObjectInfoSet::iterator obj_info_it = _grid[ entityGridPoints[i] ].find(info);
-            if (obj_info_it != _grid[ entityGridPoints[i] ].end()) {
-                _grid[ entityGridPoints[i] ].erase(obj_info_it);
-            }
-            if ( _grid[ entityGridPoints[i] ].size( ) == 0 ) {
-                _grid.erase( entityGridPoints[i] );
-            } // if
-        } else {
-            ObjectInfoSet::iterator obj_info_it = _grid_nonObstacle[ entityGridPoints[i] ].find(info);
-            if (obj_info_it != _grid_nonObstacle[ entityGridPoints[i] ].end()) {
-                _grid_nonObstacle[ entityGridPoints[i] ].erase(obj_info_it);
-            }
-            if ( _grid_nonObstacle[ entityGridPoints[i] ].size( ) == 0 ) {
-                _grid_nonObstacle.erase( entityGridPoints[i] );
-            } // if
-        } // else
+    std::vector<GridSpan>::const_iterator span;
+    for ( span = entitySpans.begin( ); span != entitySpans.end( ); ++span ) {
+        for ( unsigned int x = span->x0; x <= span->x1; ++x ) {
+            GridPoint gp( x, span->y );
+            if ( isObstacle ) {
+                ObjectInfoSet::iterator obj_info_it = _grid[ gp ].find(info);
+                if (obj_info_it != _grid[ gp ].end()) {
+                    _grid[ gp ].erase(obj_info_it);
+                }
+                if ( _grid[ gp ].size( ) == 0 ) {
+                    _grid.erase( gp );
+                } // if
+            } else {
+                ObjectInfoSet::iterator obj_info_it = _grid_nonObstacle[ gp ].find(info);
+                if (obj_info_it != _grid_nonObstacle[ gp ].end()) {
+                    _grid_nonObstacle[ gp ].erase(obj_info_it);
+                }
+                if ( _grid_nonObstacle[ gp ].size( ) == 0 ) {
+                    _grid_nonObstacle.erase( gp );
+                } // if
+            } // else
+        } // for
     } // for
 
-    this->gridPoints.erase( idHash );
+    if ( isObstacle ) {
+        updateOccupancy( entitySpans );
+    } // if
+
+    this->objectSpans.erase( it2 );
     this->entities.erase( it );
 
     std::list<SuperEntityPtr>::iterator it3;
@@ -941,9 +902,9 @@ void LocalSpaceMap2D::removeObject(const spatial::ObjectID& id)
 
 Distance LocalSpaceMap2D::minDist(const spatial::ObjectID& id, const spatial::Point& p) const
 {
-    std::vector<spatial::Point> all;
-    allPoints(id, back_inserter(all));
-    if (all.empty()) {
+    long idHash = boost::hash<std::string>()( id );
+    LongGridSpanVectorHashMap::const_iterator it = this->objectSpans.find( idHash );
+    if (it == this->objectSpans.end() || it->second.empty()) {
         logger().error(
                      "LocalSpaceMap2D::minDist(): No point associated to obj '%s'.",
                      id.c_str());
@@ -951,10 +912,16 @@ Distance LocalSpaceMap2D::minDist(const spatial::ObjectID& id, const spatial::Po
         // return a huge distance soh this object is discarded
         return (HUGE_DISTANCE);
     }
-    //TB_ASSERT(!all.empty());
-    Distance d = eucDist(p, all.front());
-    for (std::vector<spatial::Point>::const_iterator it = ++all.begin();it != all.end();++it) {
-        d = std::min(d, eucDist(p, *it));
+
+    // the point of a span nearest to p is the cell center nearest to p.first
+    double column = (p.first - _xMin) / xGridWidth() - 0.5;
+    Distance d = HUGE_DISTANCE;
+    std::vector<GridSpan>::const_iterator span;
+    for (span = it->second.begin(); span != it->second.end(); ++span) {
+        unsigned int x = column <= span->x0 ? span->x0 :
+                         column >= span->x1 ? span->x1 :
+                         (unsigned int)(column + 0.5);
+        d = std::min(d, eucDist(p, unsnap(GridPoint(x, span->y))));
     }
     return d;
 }
@@ -1201,24 +1168,31 @@ void LocalSpaceMap2D::addObject( const spatial::ObjectID& id, const spatial::Obj
     bottomSegments.push_back( math::LineSegment( bb.getCorner( math::BoundingBox::NEAR_RIGHT_BOTTOM ), bb.getCorner( math::BoundingBox::NEAR_LEFT_BOTTOM ) ) );
     bottomSegments.push_back( math::LineSegment( bb.getCorner( math::BoundingBox::NEAR_LEFT_BOTTOM ), bb.getCorner( math::BoundingBox::FAR_LEFT_BOTTOM ) ) );
 
-    calculateObjectPoints( gridPoints[idHash], bottomSegments );
+    std::vector<GridPoint> entityGridPoints;
+    calculateObjectPoints( entityGridPoints, bottomSegments );
+    std::vector<GridSpan>& entitySpans = this->objectSpans[idHash];
+    toSpans( entityGridPoints, entitySpans );
     this->entities.insert( LongEntityPtrHashMap::value_type( idHash, entity ) );
 
     const char* internalId = entity->getName( ).c_str( );
     logger().debug("LocalSpaceMap - Adding internal points to grid..." );
 
-    const std::vector<GridPoint>& entityGridPoints = this->gridPoints[idHash];
-
-    unsigned int i;
-    for ( i = 0; i < entityGridPoints.size( ); ++i ) {
-        ObjectInfo info(internalId, false);
-        if ( isObstacle ) {
-            _grid[ entityGridPoints[i] ].insert(info);
-        } else {
-            _grid_nonObstacle[ entityGridPoints[i] ].insert(info);
-        } // else
+    ObjectInfo info(internalId, false);
+    std::vector<GridSpan>::const_iterator span;
+    for ( span = entitySpans.begin( ); span != entitySpans.end( ); ++span ) {
+        for ( unsigned int x = span->x0; x <= span->x1; ++x ) {
+            if ( isObstacle ) {
+                _grid[ GridPoint( x, span->y ) ].insert(info);
+            } else {
+                _grid_nonObstacle[ GridPoint( x, span->y ) ].insert(info);
+            } // else
+        } // for
     } // for
 
+    if ( isObstacle ) {
+        updateOccupancy( entitySpans );
+    } // if
+
 }
 
 void LocalSpaceMap2D::addBlock(const ObjectID& id, const ObjectMetaData& metadata)
@@ -1255,10 +1229,9 @@ void LocalSpaceMap2D::addBlock(const ObjectID& id, const ObjectMetaData& metadat
     bottomSegments.push_back( math::LineSegment( expansionBounding.getCorner( math::BoundingBox::NEAR_RIGHT_BOTTOM ), expansionBounding.getCorner( math::BoundingBox::NEAR_LEFT_BOTTOM ) ) );
     bottomSegments.push_back( math::LineSegment( expansionBounding.getCorner( math::BoundingBox::NEAR_LEFT_BOTTOM ), expansionBounding.getCorner( math::BoundingBox::FAR_LEFT_BOTTOM ) ) );
 
-    calculateObjectPoints(gridPoints[idHash], bottomSegments);
-
     // the total area that the object occupies with expansion boundary.
-    const std::vector<spatial::GridPoint>& totalArea = this->gridPoints[idHash];
+    std::vector<spatial::GridPoint> totalArea;
+    calculateObjectPoints(totalArea, bottomSegments);
     // Calculate the expansion area.
     std::set_difference(solidArea.begin(), solidArea.end(), totalArea.begin(), totalArea.end(), expansionArea.begin());
     this->entities.insert(LongEntityPtrHashMap::value_type(idHash, entity));
@@ -1275,6 +1248,70 @@ void LocalSpaceMap2D::addBlock(const ObjectID& id, const ObjectMetaData& metadat
         ObjectInfo info(internalId, true);
         _grid[expansionArea[i]].insert(info);
     } // for
+
+    std::vector<GridSpan>& entitySpans = this->objectSpans[idHash];
+    toSpans(totalArea, entitySpans);
+    updateOccupancy(entitySpans);
+}
+
+void LocalSpaceMap2D::updateOccupancy( const std::vector<GridSpan>& spans )
+{
+    std::vector<GridSpan>::const_iterator span;
+    for ( span = spans.begin( ); span != spans.end( ); ++span ) {
+        for ( unsigned int x = span->x0; x <= span->x1; ++x ) {
+            spatial::GridMap::const_iterator itr = _grid.find( GridPoint( x, span->y ) );
+            _occupancy.setOccupied( x, span->y, itr != _grid.end( ) && !itr->second.empty( ) );
+        } // for
+    } // for
+    _occupancy.update( );
+
+    if ( _occupancyListeners.empty( ) ) {
+        return;
+    } // if
+    std::vector<GridPoint> cells;
+    for ( span = spans.begin( ); span != spans.end( ); ++span ) {
+        for ( unsigned int x = span->x0; x <= span->x1; ++x ) {
+            cells.push_back( GridPoint( x, span->y ) );
+        } // for
+    } // for
+    std::vector<OccupancyListener*>::const_iterator it;
+    for ( it = _occupancyListeners.begin( ); it != _occupancyListeners.end( ); ++it ) {
+        (*it)->occupancyChanged( cells );
+    } // for
+}
+
+void LocalSpaceMap2D::addOccupancyListener( OccupancyListener* listener )
+{
+    _occupancyListeners.push_back( listener );
+}
+
+void LocalSpaceMap2D::removeOccupancyListener( OccupancyListener* listener )
+{
+    _occupancyListeners.erase( std::remove( _occupancyListeners.begin( ),
+                                            _occupancyListeners.end( ), listener ),
+                               _occupancyListeners.end( ) );
+}
+
+// orders grid points row by row, as the spans are stored
+struct GridPointRowOrder {
+    bool operator()( const spatial::GridPoint& a, const spatial::GridPoint& b ) const {
+        return a.second < b.second || ( a.second == b.second && a.first < b.first );
+    }
+};
+
+void LocalSpaceMap2D::toSpans( std::vector<spatial::GridPoint>& points, std::vector<GridSpan>& spans )
+{
+    std::sort( points.begin( ), points.end( ), GridPointRowOrder( ) );
+    spans.clear( );
+    std::vector<spatial::GridPoint>::const_iterator it;
+    for ( it = points.begin( ); it != points.end( ); ++it ) {
+        if ( !spans.empty( ) && spans.back( ).y == it->second &&
+             it->first <= spans.back( ).x1 + 1 ) {
+            spans.back( ).x1 = std::max( spans.back( ).x1, it->first );
+        } else {
+            spans.push_back( GridSpan( it->second, it->first, it->first ) );
+        } // else
+    } // for
 }
 
 void LocalSpaceMap2D::updateObject( const spatial::ObjectID& id, const spatial::ObjectMetaData& metadata, bool isObstacle )
@@ -32,6 +32,7 @@
 #include <opencog/util/mt19937ar.h>
 
 #include <opencog/spatial/LocalSpaceMap2DUtil.h>
+#include <opencog/spatial/OccupancyGrid.h>
 
 #include <iostream>
 #include <exception>
@@ -58,6 +59,24 @@ namespace opencog
 
         class LocalSpaceMap2D;
 
+        /**
+         * Told of the grid cells whose occupancy may have changed each time
+         * an obstacle is added to or removed from a LocalSpaceMap2D it
+         * listens to (updateObject does both). Structures built from the
+         * occupancy of the map, like the HPASearch abstraction, use it to
+         * stay up to date without being rebuilt.
+         */
+        class OccupancyListener
+        {
+        public:
+            virtual ~OccupancyListener( ) { }
+
+            virtual void occupancyChanged( const std::vector<GridPoint>& cells ) = 0;
+
+            // the map is being destroyed, it must not be used any more
+            virtual void mapDestroyed( void ) = 0;
+        };
+
         /**
          * Struct rec_find
          */
@@ -111,10 +130,22 @@ namespace opencog
 
             std::list<SuperEntityPtr> superEntities;
             LongEntityPtrHashMap entities;
-            LongGridPointVectorHashMap gridPoints;
+            LongGridSpanVectorHashMap objectSpans;
+
+            // Occupancy of _grid, with the distance fields of its cells
+            OccupancyGrid _occupancy;
+
+            // told of the changes of _occupancy, not copied by clone()
+            std::vector<OccupancyListener*> _occupancyListeners;
 
             bool addToSuperEntity( const EntityPtr& entity );
 
+            // Copy the occupancy of the given spans from _grid to _occupancy
+            void updateOccupancy( const std::vector<GridSpan>& spans );
+
+            // Sort the points by row and merge them into spans
+            static void toSpans( std::vector<GridPoint>& points, std::vector<GridSpan>& spans );
+
         private:
             Distance _xMin;
             Distance _xMax;
@@ -213,10 +244,16 @@ namespace opencog
             bool illegal(const Point& pt) const;
 
             // Get the nearest free (not occupied or out of bounds)
-            // point from the given point
+            // point from the given point, in O(1)
             Point getNearestFreePoint(const Point& pt) const throw (opencog::RuntimeException, std::bad_exception);
             Point3D getNearestFree3DPoint(const Point3D& pt, double delta) const throw (opencog::RuntimeException, std::bad_exception);
 
+            // Distance from the given point to the nearest obstacle
+            // point, in O(1), or a negative value if there is no obstacle.
+            // The obstacle is the one nearest to the grid cell of the point,
+            // so the distance is exact to within a cell.
+            Distance obstacleDistance(const Point& pt) const;
+
             // Get the proper altitude of a given grid point in order 
             // to reach a target 3D point with a limited delta upwards height.
             double getProperFreePointAltitude(const GridPoint& gp, const Point3D& dest, double delta) const;
@@ -248,7 +285,7 @@ namespace opencog
             bool isNonObstacle(const ObjectID& id) const;
 
             // Gets the grid points occupied by the object with the given id
-            const std::vector<GridPoint>& getObjectPoints(const ObjectID& id) const throw(opencog::NotFoundException);
+            std::vector<GridPoint> getObjectPoints(const ObjectID& id) const throw(opencog::NotFoundException);
 
             /*
              * Threshold to consider an entity near another
@@ -291,6 +328,11 @@ namespace opencog
             //remove an object from the map entirely
             void removeObject(const ObjectID& id);
 
+            // Tell the listener of the cells whose occupancy changes, until
+            // it is removed or the map destroyed. The map does not own it.
+            void addOccupancyListener( OccupancyListener* listener );
+            void removeOccupancyListener( OccupancyListener* listener );
+
             //find the IDs of all objects within distance d of a certain point
             //same code use in findNearestFiltered
             template<typename Out>
@@ -421,16 +463,14 @@ namespace opencog
                 Out allPoints(const ObjectID& id, Out out) const {
                 std::vector<Point> points;
 
-                //ObjectHashMap::const_iterator it = this->objects.find( id );
                 long idHash = boost::hash<std::string>()( id );
-                LongGridPointVectorHashMap::const_iterator it = this->gridPoints.find( idHash );
-                //if ( it != this->objects.end( ) ) {
-                if ( it != this->gridPoints.end( ) ) {
-                    unsigned int i;
-                    //for( i = 0; i < it->second.gridPoints.size( ); ++i ) {
-                    for ( i = 0; i < it->second.size( ); ++i ) {
-                        //points.push_back( unsnap( it->second.gridPoints[ i ] ) );
-                        points.push_back( unsnap( it->second[ i ] ) );
+                LongGridSpanVectorHashMap::const_iterator it = this->objectSpans.find( idHash );
+                if ( it != this->objectSpans.end( ) ) {
+                    std::vector<GridSpan>::const_iterator span;
+                    for ( span = it->second.begin( ); span != it->second.end( ); ++span ) {
+                        for ( unsigned int x = span->x0; x <= span->x1; ++x ) {
+                            points.push_back( unsnap( GridPoint( x, span->y ) ) );
+                        } // for
                     } // for
                 } // if
 
@@ -106,6 +106,25 @@ namespace opencog
         //typedef boost::unordered_map<GridPoint, ObjectIDSet, boost::hash<GridPoint> > GridMap;
         typedef boost::unordered_map<long, std::vector<GridPoint>, boost::hash<long> > LongGridPointVectorHashMap;
 
+        /**
+         * A run of the grid points of row y, from x0 to x1 (inclusive).
+         * Object footprints are stored as lists of spans, sorted by row.
+         */
+        struct GridSpan {
+            unsigned int y;
+            unsigned int x0;
+            unsigned int x1;
+
+            GridSpan(unsigned int y_, unsigned int x0_, unsigned int x1_) :
+                y(y_), x0(x0_), x1(x1_) {}
+
+            bool operator==(const GridSpan& rh) const {
+                return y == rh.y && x0 == rh.x0 && x1 == rh.x1;
+            }
+        };
+
+        typedef boost::unordered_map<long, std::vector<GridSpan>, boost::hash<long> > LongGridSpanVectorHashMap;
+
         /**
          * Represents the object geometry
          */
@@ -0,0 +1,216 @@
+/*
+ * opencog/spatial/OccupancyGrid.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/spatial/OccupancyGrid.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace opencog;
+using namespace opencog::spatial;
+
+static const int NO_SITE = -1;
+static const int INFINITE_DISTANCE = std::numeric_limits<int>::max( );
+
+OccupancyGrid::DistanceField::DistanceField( unsigned int xDim, unsigned int yDim, bool allSites ) :
+    _xDim( xDim ), _yDim( yDim ),
+    _site( xDim * yDim, NO_SITE ),
+    _distance2( xDim * yDim, INFINITE_DISTANCE ),
+    _raise( xDim * yDim, 0 )
+{
+    if ( allSites ) {
+        for ( unsigned int i = 0; i < _site.size( ); ++i ) {
+            _site[i] = i;
+            _distance2[i] = 0;
+        } // for
+    } // if
+}
+
+void OccupancyGrid::DistanceField::addSite( int cell )
+{
+    _site[cell] = cell;
+    _distance2[cell] = 0;
+    _raise[cell] = 0;
+    _open.push( Entry( 0, cell ) );
+}
+
+void OccupancyGrid::DistanceField::removeSite( int cell )
+{
+    clear( cell );
+    _raise[cell] = 1;
+    _open.push( Entry( 0, cell ) );
+}
+
+void OccupancyGrid::DistanceField::clear( int cell )
+{
+    _site[cell] = NO_SITE;
+    _distance2[cell] = INFINITE_DISTANCE;
+}
+
+void OccupancyGrid::DistanceField::update( const std::vector<unsigned char>& cells, bool sitesOccupied )
+{
+    while ( !_open.empty( ) ) {
+        int cell = _open.top( ).second;
+        _open.pop( );
+
+        if ( _raise[cell] ) {
+            raise( cell, cells, sitesOccupied );
+        } else if ( _site[cell] != NO_SITE &&
+                    ( cells[ _site[cell] ] != 0 ) == sitesOccupied ) {
+            lower( cell );
+        } // else if
+    } // while
+}
+
+/**
+ * The site of the cell is gone: clear the neighbours that relied on a
+ * site that is gone too, and let the others propagate their site again.
+ */
+void OccupancyGrid::DistanceField::raise( int cell, const std::vector<unsigned char>& cells, bool sitesOccupied )
+{
+    int x = cell % _xDim;
+    int y = cell / _xDim;
+    for ( int dy = -1; dy <= 1; ++dy ) {
+        for ( int dx = -1; dx <= 1; ++dx ) {
+            int nx = x + dx, ny = y + dy;
+            if ( ( dx == 0 && dy == 0 ) || nx < 0 || ny < 0 ||
+                 nx >= (int)_xDim || ny >= (int)_yDim ) {
+                continue;
+            } // if
+            int neighbour = nx + ny * _xDim;
+            if ( _site[neighbour] == NO_SITE || _raise[neighbour] ) {
+                continue;
+            } // if
+            int distance2 = _distance2[neighbour];
+            if ( ( cells[ _site[neighbour] ] != 0 ) != sitesOccupied ) {
+                clear( neighbour );
+                _raise[neighbour] = 1;
+            } // if
+            _open.push( Entry( distance2, neighbour ) );
+        } // for
+    } // for
+    _raise[cell] = 0;
+}
+
+/**
+ * Offer the site of the cell to its neighbours.
+ */
+void OccupancyGrid::DistanceField::lower( int cell )
+{
+    int site = _site[cell];
+    int sx = site % _xDim;
+    int sy = site / _xDim;
+    int x = cell % _xDim;
+    int y = cell / _xDim;
+    for ( int dy = -1; dy <= 1; ++dy ) {
+        for ( int dx = -1; dx <= 1; ++dx ) {
+            int nx = x + dx, ny = y + dy;
+            if ( ( dx == 0 && dy == 0 ) || nx < 0 || ny < 0 ||
+                 nx >= (int)_xDim || ny >= (int)_yDim ) {
+                continue;
+            } // if
+            int neighbour = nx + ny * _xDim;
+            if ( _raise[neighbour] ) {
+                continue;
+            } // if
+            int distance2 = ( nx - sx ) * ( nx - sx ) + ( ny - sy ) * ( ny - sy );
+            if ( distance2 < _distance2[neighbour] ) {
+                _distance2[neighbour] = distance2;
+                _site[neighbour] = site;
+                _open.push( Entry( distance2, neighbour ) );
+            } // if
+        } // for
+    } // for
+}
+
+OccupancyGrid::OccupancyGrid( unsigned int xDim, unsigned int yDim ) :
+    _xDim( xDim ), _yDim( yDim ), _cells( xDim * yDim, 0 ),
+    _toOccupied( xDim, yDim, false ), _toFree( xDim, yDim, true )
+{
+}
+
+void OccupancyGrid::setOccupied( unsigned int x, unsigned int y, bool occupied )
+{
+    if ( x >= _xDim || y >= _yDim ) {
+        return;
+    } // if
+    int cell = x + y * _xDim;
+    if ( ( _cells[cell] != 0 ) == occupied ) {
+        return;
+    } // if
+    _cells[cell] = occupied ? 1 : 0;
+    if ( occupied ) {
+        _toOccupied.addSite( cell );
+        _toFree.removeSite( cell );
+    } else {
+        _toFree.addSite( cell );
+        _toOccupied.removeSite( cell );
+    } // else
+}
+
+void OccupancyGrid::update( void )
+{
+    _toOccupied.update( _cells, true );
+    _toFree.update( _cells, false );
+}
+
+bool OccupancyGrid::nearestFree( unsigned int x, unsigned int y,
+                                 unsigned int& freeX, unsigned int& freeY ) const
+{
+    if ( x >= _xDim || y >= _yDim ) {
+        return false;
+    } // if
+    int site = _toFree.site( x + y * _xDim );
+    if ( site == NO_SITE ) {
+        return false;
+    } // if
+    freeX = site % _xDim;
+    freeY = site / _xDim;
+    return true;
+}
+
+bool OccupancyGrid::nearestOccupied( unsigned int x, unsigned int y,
+                                     unsigned int& occupiedX, unsigned int& occupiedY ) const
+{
+    if ( x >= _xDim || y >= _yDim ) {
+        return false;
+    } // if
+    int site = _toOccupied.site( x + y * _xDim );
+    if ( site == NO_SITE ) {
+        return false;
+    } // if
+    occupiedX = site % _xDim;
+    occupiedY = site / _xDim;
+    return true;
+}
+
+double OccupancyGrid::obstacleDistance( unsigned int x, unsigned int y ) const
+{
+    if ( x >= _xDim || y >= _yDim ) {
+        return -1.0;
+    } // if
+    int distance2 = _toOccupied.distance2( x + y * _xDim );
+    if ( distance2 == INFINITE_DISTANCE ) {
+        return -1.0;
+    } // if
+    return std::sqrt( (double)distance2 );
+}
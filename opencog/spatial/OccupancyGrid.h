@@ -0,0 +1,155 @@
+/*
+ * opencog/spatial/OccupancyGrid.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SPATIAL_OCCUPANCY_GRID_H_
+#define _SPATIAL_OCCUPANCY_GRID_H_
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_spatial
+ *  @{
+ */
+    namespace spatial
+    {
+
+        /**
+         * Dense occupancy of a grid, stored row-major (cell x + y * xDim),
+         * together with two distance fields kept up to date as cells
+         * change: the nearest occupied cell and the nearest free cell of
+         * every cell. Both can then be read in O(1).
+         *
+         * The fields are maintained by the dynamic brushfire algorithm
+         * (Lau, Sprunk and Burgard, "Efficient grid-based spatial
+         * representations for robot navigation in dynamic environments",
+         * 2013): a change only propagates to the cells whose nearest site
+         * it changes. Sites are propagated through the 8 neighbours of
+         * each cell, so the distances are Euclidean up to a small error.
+         *
+         * setOccupied() only records the change; call update() once a
+         * batch of changes (e.g. an object) has been made, before reading
+         * the fields.
+         */
+        class OccupancyGrid
+        {
+
+        public:
+
+            OccupancyGrid( unsigned int xDim, unsigned int yDim );
+
+            inline unsigned int xDim( void ) const {
+                return this->_xDim;
+            }
+            inline unsigned int yDim( void ) const {
+                return this->_yDim;
+            }
+
+            /**
+             * Is the cell occupied? Cells outside the grid are not.
+             */
+            inline bool occupied( unsigned int x, unsigned int y ) const {
+                return x < _xDim && y < _yDim && _cells[ x + y * _xDim ] != 0;
+            }
+
+            void setOccupied( unsigned int x, unsigned int y, bool occupied );
+
+            /**
+             * Propagate the changes made by setOccupied to the distance
+             * fields
+             */
+            void update( void );
+
+            /**
+             * Get the free cell nearest to the given one (itself if it is
+             * free). Return false if the whole grid is occupied.
+             */
+            bool nearestFree( unsigned int x, unsigned int y,
+                              unsigned int& freeX, unsigned int& freeY ) const;
+
+            /**
+             * Get the occupied cell nearest to the given one (itself if it
+             * is occupied). Return false if no cell is occupied.
+             */
+            bool nearestOccupied( unsigned int x, unsigned int y,
+                                  unsigned int& occupiedX, unsigned int& occupiedY ) const;
+
+            /**
+             * Distance, in cells, to the nearest occupied cell, or a
+             * negative value if no cell is occupied
+             */
+            double obstacleDistance( unsigned int x, unsigned int y ) const;
+
+        private:
+
+            /**
+             * For every cell, the nearest site and the squared distance
+             * to it. The sites are the occupied cells, or the free ones.
+             */
+            class DistanceField
+            {
+            public:
+                DistanceField( unsigned int xDim, unsigned int yDim, bool allSites );
+
+                void addSite( int cell );
+                void removeSite( int cell );
+                void update( const std::vector<unsigned char>& cells, bool sitesOccupied );
+
+                inline int site( int cell ) const {
+                    return this->_site[ cell ];
+                }
+                inline int distance2( int cell ) const {
+                    return this->_distance2[ cell ];
+                }
+
+            private:
+                typedef std::pair<int, int> Entry; // (distance2, cell)
+
+                unsigned int _xDim;
+                unsigned int _yDim;
+                std::vector<int> _site;       // -1 if none
+                std::vector<int> _distance2;
+                std::vector<unsigned char> _raise;
+                std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > _open;
+
+                void clear( int cell );
+                void raise( int cell, const std::vector<unsigned char>& cells, bool sitesOccupied );
+                void lower( int cell );
+            };
+
+            unsigned int _xDim;
+            unsigned int _yDim;
+            std::vector<unsigned char> _cells;
+
+            DistanceField _toOccupied;
+            DistanceField _toFree;
+
+        }; // OccupancyGrid
+
+    } // spatial
+/** @}*/
+} // opencog
+
+#endif // _SPATIAL_OCCUPANCY_GRID_H_
@@ -26,11 +26,11 @@
 using namespace opencog;
 using namespace opencog::spatial;
 
-QuadTree::QuadTree( HPASearch::Level* level, const GridPoint& cellPosition, unsigned int clusterSideSize, HPASearch::Graph* graph, QuadTree* parentQuad,  GridPoint* currentPosition )
+QuadTree::QuadTree( HPASearch::Level* level, const GridPoint& cellPosition, unsigned int clusterSideSize, HPASearch::Level::ClusterGraph* cluster, QuadTree* parentQuad,  GridPoint* currentPosition )
 {
 
     this->hasFreeCenter = false;
-    this->graph = graph;
+    this->cluster = cluster;
     this->level = level;
     this->clusterSideSize = clusterSideSize;
     bool splitted = false;
@@ -74,16 +74,16 @@ QuadTree::QuadTree( HPASearch::Level* level, const GridPoint& cellPosition, unsi
                     // split on four quads
                     unsigned int nextNumberOfColumns = clusterSideSize / 2;
                     // quad 1
-                    QuadTree* quad1 = new QuadTree( level, cellPosition, nextNumberOfColumns, graph, this, &currentPosition );
+                    QuadTree* quad1 = new QuadTree( level, cellPosition, nextNumberOfColumns, cluster, this, &currentPosition );
 
                     // quad 2
-                    QuadTree* quad2 = new QuadTree( level, GridPoint( cellPosition.first + nextNumberOfColumns, cellPosition.second ), nextNumberOfColumns, graph, this, &currentPosition );
+                    QuadTree* quad2 = new QuadTree( level, GridPoint( cellPosition.first + nextNumberOfColumns, cellPosition.second ), nextNumberOfColumns, cluster, this, &currentPosition );
 
                     // quad 3
-                    QuadTree* quad3 = new QuadTree( level, GridPoint( cellPosition.first, cellPosition.second + nextNumberOfColumns ), nextNumberOfColumns, graph, this, &currentPosition );
+                    QuadTree* quad3 = new QuadTree( level, GridPoint( cellPosition.first, cellPosition.second + nextNumberOfColumns ), nextNumberOfColumns, cluster, this, &currentPosition );
 
                     // quad 4
-                    QuadTree* quad4 = new QuadTree( level, GridPoint( cellPosition.first + nextNumberOfColumns, cellPosition.second + nextNumberOfColumns ), nextNumberOfColumns, graph, this, &currentPosition );
+                    QuadTree* quad4 = new QuadTree( level, GridPoint( cellPosition.first + nextNumberOfColumns, cellPosition.second + nextNumberOfColumns ), nextNumberOfColumns, cluster, this, &currentPosition );
 
                     quads[ TOP_LEFT ].reset( quad1 );
                     quads[ TOP_RIGHT ].reset( quad2 );
@@ -105,16 +105,8 @@ QuadTree::QuadTree( HPASearch::Level* level, const GridPoint& cellPosition, unsi
             this->hasFreeCenter = true;
 
             if ( parentQuad ) {
-
-                boost::property_map<HPASearch::Graph, HPASearch::VertexPosition>::type position =
-                    boost::get( HPASearch::VertexPosition( ), *graph );
-
-                Point realPosition = level->map->unsnap( this->centerCellPosition );
-                boost::put( position, level->vertexCounter, math::Vector2( realPosition.first, realPosition.second ) );
-                this->vertexId = level->vertexCounter;
-                level->graphVertices[ this->centerCellPosition ] = this->vertexId;
-                ++level->vertexCounter;
-
+                this->vertexId = cluster->vertices.size( );
+                cluster->vertices.push_back( this->centerCellPosition );
             } // if
 
         } // if
@@ -124,15 +116,8 @@ QuadTree::QuadTree( HPASearch::Level* level, const GridPoint& cellPosition, unsi
         this->hasFreeCenter = true;
 
         if ( parentQuad ) {
-            boost::property_map<HPASearch::Graph, HPASearch::VertexPosition>::type position =
-                boost::get( HPASearch::VertexPosition( ), *graph );
-
-            Point realPosition = level->map->unsnap( cellPosition );
-            boost::put( position, level->vertexCounter, math::Vector2( realPosition.first, realPosition.second ) );
-
-            this->vertexId = level->vertexCounter;
-            level->graphVertices[ cellPosition ] = this->vertexId;
-            ++level->vertexCounter;
+            this->vertexId = cluster->vertices.size( );
+            cluster->vertices.push_back( cellPosition );
         } // if
     } // else
 
@@ -207,13 +192,8 @@ void QuadTree::processVertices( const std::vector<unsigned int>& vertices1, cons
     {
         for ( j = 0; j < vertices2.size( ); ++j )
         {
-            // math::Vector2 position1 =
-            boost::get(HPASearch::VertexPosition(), *this->graph, vertices1[i]);
-
-            // math::Vector2 position2 =
-            boost::get(HPASearch::VertexPosition(), *this->graph, vertices2[j]);
-
-            boost::add_edge(vertices1[i], vertices2[j], 1, *graph);
+            cluster->innerEdges.push_back(HPASearch::Level::CellEdge(
+                cluster->vertices[vertices1[i]], cluster->vertices[vertices2[j]], 1));
         }
     }
 }
@@ -55,7 +55,7 @@ namespace opencog
             };
 
             QuadTree( HPASearch::Level* level, const GridPoint& cellPosition, 
-                unsigned int clusterSideSize, HPASearch::Graph* graph, 
+                unsigned int clusterSideSize, HPASearch::Level::ClusterGraph* cluster, 
                     QuadTree* parentQuad = 0, GridPoint* currentPosition = 0 );
 
             virtual ~QuadTree( void ) { }
@@ -73,6 +73,7 @@ namespace opencog
             std::vector<unsigned int> getVerticesFrom( POSITION position );
 
             // if this quad has a free center position, vertexId will be defined
+            // (index of the vertex in the cluster graph)
             unsigned int vertexId;
             unsigned int clusterSideSize;
             // cell positioned at the center of quad
@@ -82,7 +83,7 @@ namespace opencog
 
             std::map<POSITION, boost::shared_ptr<QuadTree> > quads;
 
-            HPASearch::Graph* graph;
+            HPASearch::Level::ClusterGraph* cluster;
             HPASearch::Level* level;
         };
 
@@ -0,0 +1,130 @@
+/*
+ * opencog/spatial/SpaceMapBenchmark.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/**
+ * Times the LocalSpaceMap2D updates and queries on a large map:
+ *
+ *     spacemap_benchmark [grid size] [number of objects] [number of queries]
+ *
+ * The map is a square of grid size x grid size cells (1000 by default)
+ * filled with random obstacles, of which a tenth are then moved.
+ */
+
+#include <opencog/spatial/LocalSpaceMap2D.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+using namespace opencog;
+using namespace opencog::spatial;
+
+static double elapsed(clock_t start)
+{
+    return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double randomCoordinate(double max)
+{
+    return max * (double(rand()) / RAND_MAX);
+}
+
+static ObjectMetaData randomObject(double mapSize)
+{
+    double length = 2.0 + randomCoordinate(mapSize / 50.0);
+    double width = 2.0 + randomCoordinate(mapSize / 50.0);
+    return ObjectMetaData(randomCoordinate(mapSize), randomCoordinate(mapSize), 0.0,
+                          length, width, 1.0, randomCoordinate(3.14), "benchmark");
+}
+
+static void report(const char* what, unsigned int count, double seconds)
+{
+    printf("%-24s %8u in %8.3f s (%10.2f us each)\n",
+           what, count, seconds, count > 0 ? 1e6 * seconds / count : 0.0);
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned int gridSize = 1000;
+    unsigned int objects = 2000;
+    unsigned int queries = 100000;
+    try {
+        if (argc > 1) gridSize = boost::lexical_cast<unsigned int>(argv[1]);
+        if (argc > 2) objects = boost::lexical_cast<unsigned int>(argv[2]);
+        if (argc > 3) queries = boost::lexical_cast<unsigned int>(argv[3]);
+    } catch (boost::bad_lexical_cast &) {
+        fprintf(stderr, "Usage: %s [grid size] [number of objects] [number of queries]\n", argv[0]);
+        return 1;
+    }
+    srand(42);
+
+    double mapSize = gridSize;
+    LocalSpaceMap2D map(0, mapSize, gridSize, 0, mapSize, gridSize, 0.5, 1.6, 0.0);
+    std::vector<std::string> ids;
+
+    clock_t start = clock();
+    for (unsigned int i = 0; i < objects; ++i) {
+        ids.push_back("obj" + boost::lexical_cast<std::string>(i));
+        map.addObject(ids.back(), randomObject(mapSize), true);
+    }
+    report("addObject", objects, elapsed(start));
+
+    unsigned int moved = objects / 10;
+    start = clock();
+    for (unsigned int i = 0; i < moved; ++i) {
+        const std::string& id = ids[rand() % ids.size()];
+        map.removeObject(id);
+        map.addObject(id, randomObject(mapSize), true);
+    }
+    report("removeObject+addObject", moved, elapsed(start));
+
+    std::vector<Point> points;
+    for (unsigned int i = 0; i < queries; ++i) {
+        points.push_back(Point(randomCoordinate(mapSize), randomCoordinate(mapSize)));
+    }
+
+    double checksum = 0.0;
+    start = clock();
+    for (unsigned int i = 0; i < queries; ++i) {
+        checksum += map.getNearestFreePoint(points[i]).first;
+    }
+    report("getNearestFreePoint", queries, elapsed(start));
+
+    start = clock();
+    for (unsigned int i = 0; i < queries; ++i) {
+        checksum += map.obstacleDistance(points[i]);
+    }
+    report("obstacleDistance", queries, elapsed(start));
+
+    start = clock();
+    for (unsigned int i = 0; i < queries; ++i) {
+        checksum += map.minDist(ids[i % ids.size()], points[i]);
+    }
+    report("minDist", queries, elapsed(start));
+
+    printf("checksum %f\n", checksum);
+    return 0;
+}
@@ -25,8 +25,11 @@
 #include <opencog/spatial/math/Rectangle.h>
 
 #include <opencog/util/Logger.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <limits>
 
 #include <boost/scoped_ptr.hpp>
 
@@ -34,40 +37,41 @@ using namespace opencog;
 using namespace opencog::spatial;
 
 /// Start Class Tile
-VisibilityMap::Tile::Tile( double x, double y, int row, int col, const math::Vector3& normal, double tileSideSize ) :
-        tileSideSize( tileSideSize ), visible( false ), discoveringTime( 0 ),
-        row( row ), col( col ), normal( normal ), center( x, 0, y ) { }
+VisibilityMap::Tile::Tile( VisibilityMap* map, int row, int col ) :
+        map( map ), row( row ), col( col ) { }
 
-const math::Vector3& VisibilityMap::Tile::getNormal( void )
+math::Vector3 VisibilityMap::Tile::getNormal( void )
 {
-    return this->normal;
+    return math::Vector3( 0, 1, 0 );
 }
 
-const math::Vector3& VisibilityMap::Tile::getCenter( void )
+math::Vector3 VisibilityMap::Tile::getCenter( void )
 {
-    return this->center;
+    return this->map->getTileCenter( this->row, this->col );
 }
 
 std::vector<math::Vector3> VisibilityMap::Tile::getCorners( void )
 {
     std::vector<math::Vector3> corners;
+    math::Vector3 center = getCenter( );
+    double tileSideSize = this->map->tileSideSize;
 
-    corners.push_back( math::Vector3( this->center.x - tileSideSize / 2, 0, this->center.z + tileSideSize / 2 ) );
-    corners.push_back( math::Vector3( this->center.x + tileSideSize / 2, 0, this->center.z + tileSideSize / 2 ) );
-    corners.push_back( math::Vector3( this->center.x + tileSideSize / 2, 0, this->center.z - tileSideSize / 2 ) );
-    corners.push_back( math::Vector3( this->center.x - tileSideSize / 2, 0, this->center.z - tileSideSize / 2 ) );
+    corners.push_back( math::Vector3( center.x - tileSideSize / 2, 0, center.z + tileSideSize / 2 ) );
+    corners.push_back( math::Vector3( center.x + tileSideSize / 2, 0, center.z + tileSideSize / 2 ) );
+    corners.push_back( math::Vector3( center.x + tileSideSize / 2, 0, center.z - tileSideSize / 2 ) );
+    corners.push_back( math::Vector3( center.x - tileSideSize / 2, 0, center.z - tileSideSize / 2 ) );
 
     return corners;
 }
 
 void VisibilityMap::Tile::setVisibility( bool visible )
 {
-    this->visible = visible;
+    this->map->setVisibility( this->row, this->col, visible );
 }
 
 bool VisibilityMap::Tile::isVisible( void )
 {
-    return this->visible;
+    return this->map->isVisible( this->row, this->col );
 }
 
 int VisibilityMap::Tile::getRow( void ) const
@@ -164,48 +168,93 @@ bool VisibilityMap::NearestTileVisitor::operator( )( const VisibilityMap::TilePt
 /// End Class TileVisitor
 
 /// Start Class VisibilityMap
-VisibilityMap::VisibilityMap( const math::Vector3& minimumExtent, const math::Vector3& maximumExtent, unsigned int numberOfTiles ) : numberOfTiles( numberOfTiles ), minimumExtent( minimumExtent ), maximumExtent( maximumExtent )
-{
-
-    unsigned int x;
-    unsigned int y;
 
-    this->tileSideSize = ( maximumExtent.x - minimumExtent.x ) / static_cast<double>( numberOfTiles );
+const unsigned int VisibilityMap::BLOCK_SIDE;
 
-    this->tiles.reserve( numberOfTiles );
-    unsigned int tilesCounter = 0;
-    for ( y = 0; y < numberOfTiles; ++y ) {
-        std::vector<VisibilityMap::TilePtr> rowTiles;
-        rowTiles.reserve( numberOfTiles );
-        for ( x = 0; x < numberOfTiles; ++x ) {
-            double centerX = minimumExtent.x + (x * tileSideSize) + tileSideSize / 2;
-            double centerY = minimumExtent.z + (y * tileSideSize) + tileSideSize / 2;
-            ++tilesCounter;
-            rowTiles.push_back( TilePtr( new VisibilityMap::Tile( centerX, centerY, y, x, math::Vector3( 0, 1, 0 ), this->tileSideSize ) ) );
-        } // for
-        tiles.push_back( rowTiles );
+/**
+ * Liang-Barsky clipping: does the segment (x0, y0)-(x1, y1) cross the box
+ * [minX, maxX] x [minY, maxY]?
+ */
+static bool segmentCrossesBox( double x0, double y0, double x1, double y1,
+                               double minX, double minY, double maxX, double maxY )
+{
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x0 - minX, maxX - x0, y0 - minY, maxY - y0 };
+    double t0 = 0.0;
+    double t1 = 1.0;
+    unsigned int i;
+    for ( i = 0; i < 4; ++i ) {
+        if ( p[i] == 0 ) {
+            if ( q[i] < 0 ) {
+                return false;
+            } // if
+            continue;
+        } // if
+        double t = q[i] / p[i];
+        if ( p[i] < 0 ) {
+            t0 = std::max( t0, t );
+        } else {
+            t1 = std::min( t1, t );
+        } // else
+        if ( t0 > t1 ) {
+            return false;
+        } // if
     } // for
+    return true;
+}
 
-    logger().debug("VisibilityMap - Created tiles #: %d", tilesCounter );
+VisibilityMap::VisibilityMap( const math::Vector3& minimumExtent, const math::Vector3& maximumExtent, unsigned int numberOfTiles ) :
+        numberOfTiles( numberOfTiles ),
+        tileSideSize( ( maximumExtent.x - minimumExtent.x ) / static_cast<double>( numberOfTiles ) ),
+        visible( numberOfTiles * numberOfTiles, 0 ), opaque( numberOfTiles * numberOfTiles, 0 ),
+        tiles( numberOfTiles * numberOfTiles ),
+        blocksPerSide( ( numberOfTiles + BLOCK_SIDE - 1 ) / BLOCK_SIDE ),
+        blockVisibleTiles( blocksPerSide * blocksPerSide, 0 ), visibleTiles( 0 ),
+        lastObserverRow( -1 ), lastObserverCol( -1 ), lastViewDistance( 0 ),
+        minimumExtent( minimumExtent ), maximumExtent( maximumExtent )
+{
+    logger().debug("VisibilityMap - Created tiles #: %d", numberOfTiles * numberOfTiles );
 
     logger().debug("VisibilityMap - Max extents: min[%s] max[%s]", minimumExtent.toString( ).c_str( ), maximumExtent.toString( ).c_str( ) );
-    logger().debug("VisibilityMap - Total rows created: %d", tiles.size( ) );
+    logger().debug("VisibilityMap - Total rows created: %d", numberOfTiles );
     logger().debug("VisibilityMap - #number of tiles per side: %d, tile side size: %f", numberOfTiles, tileSideSize );
 }
 
-const VisibilityMap::TilePtr& VisibilityMap::getTile( const math::Vector3& position ) const throw( opencog::NotFoundException )
+math::Vector3 VisibilityMap::getTileCenter( unsigned int row, unsigned int col ) const
 {
-    if ( position.x >= this->minimumExtent.x &&
-            position.x <= this->maximumExtent.x &&
-            position.z >= this->minimumExtent.z &&
-            position.z <= this->maximumExtent.z ) {
-        // position is inside map
-        double xOffset = std::fabs( position.x - this->minimumExtent.x );
-        double zOffset = std::fabs( position.z - this->minimumExtent.z );
+    return math::Vector3( this->minimumExtent.x + ( col * tileSideSize ) + tileSideSize / 2, 0,
+                          this->minimumExtent.z + ( row * tileSideSize ) + tileSideSize / 2 );
+}
 
-        int col = ((int)std::ceil( xOffset / tileSideSize )) - 1;
-        int row = ((int)std::ceil( zOffset / tileSideSize )) - 1;
+bool VisibilityMap::getTilePosition( const math::Vector3& position, unsigned int& row, unsigned int& col ) const
+{
+    if ( position.x < this->minimumExtent.x ||
+            position.x > this->maximumExtent.x ||
+            position.z < this->minimumExtent.z ||
+            position.z > this->maximumExtent.z ) {
+        return false;
+    } // if
+    // position is inside map
+    double xOffset = std::fabs( position.x - this->minimumExtent.x );
+    double zOffset = std::fabs( position.z - this->minimumExtent.z );
+
+    int x = ((int)std::ceil( xOffset / tileSideSize )) - 1;
+    int z = ((int)std::ceil( zOffset / tileSideSize )) - 1;
+    if ( x < 0 || z < 0 || x >= (int)numberOfTiles || z >= (int)numberOfTiles ) {
+        return false;
+    } // if
+    row = z;
+    col = x;
+    return true;
+}
 
+const VisibilityMap::TilePtr& VisibilityMap::getTile( const math::Vector3& position ) const throw( opencog::NotFoundException )
+{
+    unsigned int row;
+    unsigned int col;
+    if ( getTilePosition( position, row, col ) ) {
         return getTile( row, col );
     } // if
     throw opencog::NotFoundException( "Visibility Map - There is no tile at position[%s]", TRACE_INFO, position.toString( ).c_str( ) );
@@ -213,79 +262,376 @@ const VisibilityMap::TilePtr& VisibilityMap::getTile( const math::Vector3& posit
 
 const VisibilityMap::TilePtr& VisibilityMap::getTile( unsigned int row, unsigned int column ) const throw( opencog::NotFoundException )
 {
-    if ( this->tiles.size( ) > row && this->tiles[row].size( ) > column ) {
-        return this->tiles[row][column];
+    if ( row < this->numberOfTiles && column < this->numberOfTiles ) {
+        TilePtr& tile = this->tiles[ row * this->numberOfTiles + column ];
+        if ( tile.get( ) == NULL ) {
+            tile.reset( new Tile( const_cast<VisibilityMap*>( this ), row, column ) );
+        } // if
+        return tile;
     } // if
     throw opencog::NotFoundException( "Visibility Map - There is no tile at row[%d] column[%d]", TRACE_INFO, row, column );
 }
 
+bool VisibilityMap::isVisible( unsigned int row, unsigned int column ) const throw( opencog::NotFoundException )
+{
+    if ( row >= this->numberOfTiles || column >= this->numberOfTiles ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no tile at row[%d] column[%d]", TRACE_INFO, row, column );
+    } // if
+    return this->visible[ row * this->numberOfTiles + column ] != 0;
+}
+
+void VisibilityMap::setVisibility( unsigned int row, unsigned int column, bool visible ) throw( opencog::NotFoundException )
+{
+    if ( row >= this->numberOfTiles || column >= this->numberOfTiles ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no tile at row[%d] column[%d]", TRACE_INFO, row, column );
+    } // if
+    if ( changeVisibility( row, column, visible ) && !visible ) {
+        // the next castVisibility must check whether the tile is still seen
+        this->changedBlocks.insert( getBlock( row, column ) );
+    } // if
+}
+
+bool VisibilityMap::changeVisibility( unsigned int row, unsigned int col, bool visible )
+{
+    unsigned char& tile = this->visible[ row * this->numberOfTiles + col ];
+    if ( ( tile != 0 ) == visible ) {
+        return false;
+    } // if
+    tile = visible ? 1 : 0;
+    unsigned int& blockCount = this->blockVisibleTiles[ getBlock( row, col ) ];
+    if ( visible ) {
+        ++blockCount;
+        ++this->visibleTiles;
+    } else {
+        --blockCount;
+        --this->visibleTiles;
+    } // else
+    return true;
+}
+
+bool VisibilityMap::isOpaque( unsigned int row, unsigned int column ) const throw( opencog::NotFoundException )
+{
+    if ( row >= this->numberOfTiles || column >= this->numberOfTiles ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no tile at row[%d] column[%d]", TRACE_INFO, row, column );
+    } // if
+    return this->opaque[ row * this->numberOfTiles + column ] != 0;
+}
+
+void VisibilityMap::setOpaque( unsigned int row, unsigned int column, bool opaque ) throw( opencog::NotFoundException )
+{
+    if ( row >= this->numberOfTiles || column >= this->numberOfTiles ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no tile at row[%d] column[%d]", TRACE_INFO, row, column );
+    } // if
+    unsigned char& tile = this->opaque[ row * this->numberOfTiles + column ];
+    if ( ( tile != 0 ) != opaque ) {
+        tile = opaque ? 1 : 0;
+        this->changedBlocks.insert( getBlock( row, column ) );
+    } // if
+}
+
 void VisibilityMap::resetTiles( void )
 {
-    unsigned int row;
-    unsigned int col;
-    for ( row = 0; row < this->tiles.size( ); ++row ) {
-        std::vector<VisibilityMap::TilePtr>& rowTiles = this->tiles[row];
-        for ( col = 0; col < rowTiles.size( ); ++col ) {
-            rowTiles[col]->setVisibility( false );
-        } // for
+    std::fill( this->visible.begin( ), this->visible.end( ), 0 );
+    std::fill( this->blockVisibleTiles.begin( ), this->blockVisibleTiles.end( ), 0 );
+    this->visibleTiles = 0;
+
+    // nothing is left from the previous cast
+    this->lastObserverRow = -1;
+    this->lastObserverCol = -1;
+    this->changedBlocks.clear( );
+}
+
+/**
+ * Amanatides and Woo traversal of the tiles crossed by the segment that
+ * links the centers of the two tiles. Tile (row, col) covers
+ * [col, col + 1] x [row, row + 1] in tile units.
+ */
+unsigned int VisibilityMap::castRay( int fromRow, int fromCol, int toRow, int toCol, double maximumDistance )
+{
+    int dx = toCol - fromCol;
+    int dy = toRow - fromRow;
+    int stepX = ( dx > 0 ) ? 1 : -1;
+    int stepY = ( dy > 0 ) ? 1 : -1;
+    double infinity = std::numeric_limits<double>::max( );
+    double tDeltaX = ( dx != 0 ) ? 1.0 / std::abs( dx ) : infinity;
+    double tDeltaY = ( dy != 0 ) ? 1.0 / std::abs( dy ) : infinity;
+    double tMaxX = ( dx != 0 ) ? 0.5 * tDeltaX : infinity;
+    double tMaxY = ( dy != 0 ) ? 0.5 * tDeltaY : infinity;
+    double maximumDistance2 = maximumDistance * maximumDistance;
+
+    unsigned int newTiles = 0;
+    int row = fromRow;
+    int col = fromCol;
+    while ( true ) {
+        if ( row < 0 || col < 0 || row >= (int)numberOfTiles || col >= (int)numberOfTiles ) {
+            break;
+        } // if
+        int distanceX = col - fromCol;
+        int distanceY = row - fromRow;
+        if ( distanceX * distanceX + distanceY * distanceY > maximumDistance2 ) {
+            break;
+        } // if
+        if ( changeVisibility( row, col, true ) ) {
+            ++newTiles;
+        } // if
+        if ( ( row != fromRow || col != fromCol ) &&
+                this->opaque[ row * this->numberOfTiles + col ] != 0 ) {
+            break;
+        } // if
+        if ( row == toRow && col == toCol ) {
+            break;
+        } // if
+
+        if ( tMaxX < tMaxY ) {
+            col += stepX;
+            tMaxX += tDeltaX;
+        } else if ( tMaxY < tMaxX ) {
+            row += stepY;
+            tMaxY += tDeltaY;
+        } else {
+            // the ray passes through a corner
+            col += stepX;
+            row += stepY;
+            tMaxX += tDeltaX;
+            tMaxY += tDeltaY;
+        } // else
+    } // while
+    return newTiles;
+}
+
+unsigned int VisibilityMap::castVisibility( const math::Vector3& observerPosition, double viewDistance ) throw( opencog::NotFoundException )
+{
+    unsigned int observerRow;
+    unsigned int observerCol;
+    if ( !getTilePosition( observerPosition, observerRow, observerCol ) ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no tile at position[%s]", TRACE_INFO, observerPosition.toString( ).c_str( ) );
+    } // if
+
+    bool fullCast = ( (int)observerRow != this->lastObserverRow ||
+                      (int)observerCol != this->lastObserverCol ||
+                      viewDistance != this->lastViewDistance );
+    if ( !fullCast && this->changedBlocks.empty( ) ) {
+        // nothing the observer sees can have changed
+        return 0;
+    } // if
+
+    double distance = std::max( 0.0, viewDistance / this->tileSideSize );
+    int radius = static_cast<int>( std::ceil( distance ) );
+
+    // the rays end at the border of the square around the observer
+    std::vector< std::pair<int, int> > targets;
+    int i;
+    for ( i = -radius; i <= radius; ++i ) {
+        targets.push_back( std::make_pair( (int)observerRow - radius, (int)observerCol + i ) );
+        if ( radius > 0 ) {
+            targets.push_back( std::make_pair( (int)observerRow + radius, (int)observerCol + i ) );
+        } // if
+        if ( i != -radius && i != radius ) {
+            targets.push_back( std::make_pair( (int)observerRow + i, (int)observerCol - radius ) );
+            targets.push_back( std::make_pair( (int)observerRow + i, (int)observerCol + radius ) );
+        } // if
+    } // for
+
+    double fromX = observerCol + 0.5;
+    double fromY = observerRow + 0.5;
+    unsigned int newTiles = 0;
+    unsigned int j;
+    for ( j = 0; j < targets.size( ); ++j ) {
+        if ( !fullCast ) {
+            // only the rays that cross a changed block may see something else
+            double toX = targets[j].second + 0.5;
+            double toY = targets[j].first + 0.5;
+            bool changed = false;
+            std::set<unsigned int>::const_iterator it;
+            for ( it = this->changedBlocks.begin( ); !changed && it != this->changedBlocks.end( ); ++it ) {
+                double minX = ( *it % this->blocksPerSide ) * BLOCK_SIDE;
+                double minY = ( *it / this->blocksPerSide ) * BLOCK_SIDE;
+                changed = segmentCrossesBox( fromX, fromY, toX, toY,
+                                             minX, minY, minX + BLOCK_SIDE, minY + BLOCK_SIDE );
+            } // for
+            if ( !changed ) {
+                continue;
+            } // if
+        } // if
+        newTiles += castRay( observerRow, observerCol, targets[j].first, targets[j].second, distance );
     } // for
+
+    this->lastObserverRow = observerRow;
+    this->lastObserverCol = observerCol;
+    this->lastViewDistance = viewDistance;
+    this->changedBlocks.clear( );
+    return newTiles;
 }
 
 bool VisibilityMap::hasHiddenTile( void )
 {
-    try {
-        getNextHiddenTile( );
-        return true;
-    } catch ( ... ) {
-        return false;
-    } // catch
+    return this->visibleTiles < this->visible.size( );
 }
 
 void  VisibilityMap::visitTiles( VisibilityMap::TileVisitor* visitor )
 {
-    unsigned int areasPerSide = static_cast<unsigned int>( std::sqrt( visitor->getNumberOfAreas( ) ) );
-    unsigned int cellsPerAreaSide = this->tiles.size( ) / areasPerSide;
-
     unsigned int row;
     unsigned int col;
-    unsigned int startCol = 0;
-    unsigned int startRow = 0;
-    unsigned int endRow = this->tiles.size( );
-    unsigned int endCol = endRow;
+    unsigned int startRow;
+    unsigned int startCol;
+    unsigned int endRow;
+    unsigned int endCol;
+    getAreaLimits( visitor->getAreaNumber( ), visitor->getNumberOfAreas( ), startRow, startCol, endRow, endCol );
+
+    for ( row = startRow; row < endRow; ++row ) {
+        for ( col = startCol; col < endCol; ++col ) {
+            if ( (*visitor)( getTile( row, col ) ) ) {
+                return;
+            } // if
+        } // for
+    } // for
+}
+
+void VisibilityMap::getAreaLimits( unsigned int areaNumber, unsigned int numberOfAreas,
+                                   unsigned int& startRow, unsigned int& startCol,
+                                   unsigned int& endRow, unsigned int& endCol ) const
+{
+    startCol = 0;
+    startRow = 0;
+    endRow = this->numberOfTiles;
+    endCol = endRow;
 
     // TODO: FIX the case when numberOfAreas == 1
-    if ( visitor->getNumberOfAreas( ) > 1 ) {
-        startCol = ( visitor->getAreaNumber( ) % areasPerSide ) * cellsPerAreaSide;
-        //startRow = ( areasPerSide - ( visitor->getAreaNumber( ) / areasPerSide ) ) * cellsPerAreaSide;
-        startRow = ( visitor->getAreaNumber( ) / areasPerSide ) * cellsPerAreaSide;
-        endRow = startRow + cellsPerAreaSide;
-        endCol = startCol + cellsPerAreaSide;
+    if ( numberOfAreas > 1 ) {
+        unsigned int areasPerSide = static_cast<unsigned int>( std::sqrt( numberOfAreas ) );
+        unsigned int cellsPerAreaSide = this->numberOfTiles / areasPerSide;
+        startCol = ( areaNumber % areasPerSide ) * cellsPerAreaSide;
+        startRow = ( areaNumber / areasPerSide ) * cellsPerAreaSide;
+        endRow = std::min( this->numberOfTiles, startRow + cellsPerAreaSide );
+        endCol = std::min( this->numberOfTiles, startCol + cellsPerAreaSide );
     } // if
+}
 
-    //std::cout << " AreaNumber: " << visitor->getAreaNumber( ) << " NumberOfAreas: " << visitor->getNumberOfAreas( ) << " StartRow: " << startRow << " StartCol: " << startCol << " EndRow: " << endRow << " EndCol: " << endCol << " AreasPerSide: " << areasPerSide << " CellsPerAreaSide: " << cellsPerAreaSide << " NumberOfTiles: " << this->tiles.size( ) << std::endl;
+unsigned int VisibilityMap::countBlockTiles( unsigned int blockRow, unsigned int blockCol, bool visibility ) const
+{
+    unsigned int visibleCount = this->blockVisibleTiles[ blockRow * this->blocksPerSide + blockCol ];
+    if ( visibility ) {
+        return visibleCount;
+    } // if
+    unsigned int rows = std::min( BLOCK_SIDE, this->numberOfTiles - blockRow * BLOCK_SIDE );
+    unsigned int cols = std::min( BLOCK_SIDE, this->numberOfTiles - blockCol * BLOCK_SIDE );
+    return rows * cols - visibleCount;
+}
+
+bool VisibilityMap::findNextTile( bool visibility, unsigned int areaNumber, unsigned int numberOfAreas,
+                                  unsigned int& row, unsigned int& col ) const
+{
+    unsigned int startRow;
+    unsigned int startCol;
+    unsigned int endRow;
+    unsigned int endCol;
+    getAreaLimits( areaNumber, numberOfAreas, startRow, startCol, endRow, endCol );
 
     for ( row = startRow; row < endRow; ++row ) {
-        std::vector<VisibilityMap::TilePtr>& rowTiles = this->tiles[row];
-        for ( col = startCol; col < endCol; ++col ) {
-            //std::cout << "Col: " << col << " Row: " << row << " r: " << (*visitor)( rowTiles[col] ) << std::endl;
-            if ( (*visitor)( rowTiles[col] ) ) {
-                return;
+        col = startCol;
+        while ( col < endCol ) {
+            unsigned int blockEnd = std::min( endCol, ( col / BLOCK_SIDE + 1 ) * BLOCK_SIDE );
+            if ( countBlockTiles( row / BLOCK_SIDE, col / BLOCK_SIDE, visibility ) == 0 ) {
+                col = blockEnd;
+                continue;
             } // if
+            for ( ; col < blockEnd; ++col ) {
+                if ( ( this->visible[ row * this->numberOfTiles + col ] != 0 ) == visibility ) {
+                    return true;
+                } // if
+            } // for
+        } // while
+    } // for
+    return false;
+}
+
+/**
+ * The blocks that have tiles of the given visibility are visited by
+ * increasing distance to the reference position, until the nearest block
+ * left is farther than the nearest tile found. Distances are measured in
+ * tile units. Between tiles at the same distance, the first one in
+ * row-major order is kept.
+ */
+bool VisibilityMap::findNearestTile( const math::Vector3& referencePosition, bool visibility,
+                                     unsigned int startRow, unsigned int startCol,
+                                     unsigned int endRow, unsigned int endCol,
+                                     unsigned int& row, unsigned int& col ) const
+{
+    if ( startRow >= endRow || startCol >= endCol ) {
+        return false;
+    } // if
+    double x = ( referencePosition.x - this->minimumExtent.x ) / this->tileSideSize - 0.5;
+    double y = ( referencePosition.z - this->minimumExtent.z ) / this->tileSideSize - 0.5;
+
+    std::vector< std::pair<double, unsigned int> > blocks;
+    unsigned int blockRow;
+    unsigned int blockCol;
+    for ( blockRow = startRow / BLOCK_SIDE; blockRow <= ( endRow - 1 ) / BLOCK_SIDE; ++blockRow ) {
+        for ( blockCol = startCol / BLOCK_SIDE; blockCol <= ( endCol - 1 ) / BLOCK_SIDE; ++blockCol ) {
+            if ( countBlockTiles( blockRow, blockCol, visibility ) == 0 ) {
+                continue;
+            } // if
+            // nearest tile center of the block part inside the area
+            double minX = std::max( blockCol * BLOCK_SIDE, startCol );
+            double maxX = std::min( ( blockCol + 1 ) * BLOCK_SIDE, endCol ) - 1;
+            double minY = std::max( blockRow * BLOCK_SIDE, startRow );
+            double maxY = std::min( ( blockRow + 1 ) * BLOCK_SIDE, endRow ) - 1;
+            double dx = x - std::max( minX, std::min( maxX, x ) );
+            double dy = y - std::max( minY, std::min( maxY, y ) );
+            blocks.push_back( std::make_pair( dx * dx + dy * dy, blockRow * this->blocksPerSide + blockCol ) );
         } // for
     } // for
+    std::sort( blocks.begin( ), blocks.end( ) );
+
+    bool found = false;
+    double bestDistance = 0;
+    unsigned int bestIndex = 0;
+    unsigned int i;
+    for ( i = 0; i < blocks.size( ); ++i ) {
+        if ( found && blocks[i].first > bestDistance ) {
+            break;
+        } // if
+        blockRow = blocks[i].second / this->blocksPerSide;
+        blockCol = blocks[i].second % this->blocksPerSide;
+        unsigned int r;
+        unsigned int c;
+        unsigned int rowEnd = std::min( ( blockRow + 1 ) * BLOCK_SIDE, endRow );
+        unsigned int colEnd = std::min( ( blockCol + 1 ) * BLOCK_SIDE, endCol );
+        for ( r = std::max( blockRow * BLOCK_SIDE, startRow ); r < rowEnd; ++r ) {
+            for ( c = std::max( blockCol * BLOCK_SIDE, startCol ); c < colEnd; ++c ) {
+                unsigned int index = r * this->numberOfTiles + c;
+                if ( ( this->visible[index] != 0 ) != visibility ) {
+                    continue;
+                } // if
+                double distance = ( c - x ) * ( c - x ) + ( r - y ) * ( r - y );
+                if ( !found || distance < bestDistance ||
+                        ( distance == bestDistance && index < bestIndex ) ) {
+                    found = true;
+                    bestDistance = distance;
+                    bestIndex = index;
+                } // if
+            } // for
+        } // for
+    } // for
+
+    if ( found ) {
+        row = bestIndex / this->numberOfTiles;
+        col = bestIndex % this->numberOfTiles;
+    } // if
+    return found;
 }
 
 const VisibilityMap::TilePtr& VisibilityMap::getNextHiddenTile( unsigned int areaNumber, unsigned int numberOfAreas ) throw (opencog::NotFoundException, opencog::InvalidParamException)
 {
-
-    HiddenTileVisitor* visitor = new HiddenTileVisitor( areaNumber, numberOfAreas );
-    visitTiles( visitor );
-    const TilePtr& tile = visitor->getLastValidTile( );
-    delete visitor;
-    if ( tile.get( ) == NULL ) {
+    if ( numberOfAreas == 0 ) {
+        throw opencog::InvalidParamException( "Visibility Map - The number of areas should be greater than 0 and lesser then tileSide. numberOfAreas[%d] ", TRACE_INFO, numberOfAreas );
+    } // if
+    unsigned int row;
+    unsigned int col;
+    if ( !findNextTile( false, areaNumber, numberOfAreas, row, col ) ) {
         throw opencog::NotFoundException( "Visibility Map - There is no hidden tiles at the given area", TRACE_INFO );
     } // if
-    return tile;
+    return getTile( row, col );
 }
 
 unsigned int VisibilityMap::getNumberOfTiles( void ) const
@@ -300,44 +646,53 @@ double VisibilityMap::getTileSideSize( void ) const
 
 const VisibilityMap::TilePtr& VisibilityMap::getNextVisibleTile( unsigned int areaNumber, unsigned int numberOfAreas ) throw (opencog::NotFoundException, opencog::InvalidParamException)
 {
-    VisibleTileVisitor* visitor = new VisibleTileVisitor( areaNumber, numberOfAreas );
-    visitTiles( visitor );
-    const TilePtr& tile = visitor->getLastValidTile( );
-    delete visitor;
-    if ( tile.get( ) == NULL ) {
+    if ( numberOfAreas == 0 ) {
+        throw opencog::InvalidParamException( "Visibility Map - The number of areas should be greater than 0 and lesser then tileSide. numberOfAreas[%d] ", TRACE_INFO, numberOfAreas );
+    } // if
+    unsigned int row;
+    unsigned int col;
+    if ( !findNextTile( true, areaNumber, numberOfAreas, row, col ) ) {
         throw opencog::NotFoundException( "Visibility Map - There is no visible tiles at the given area", TRACE_INFO );
     } // if
-    return tile;
+    return getTile( row, col );
 }
 
 const VisibilityMap::TilePtr&  VisibilityMap::getNearestHiddenTile( const spatial::math::Vector3& referencePosition, unsigned int areaNumber, unsigned int numberOfAreas ) throw (opencog::NotFoundException)
 {
-    NearestTileVisitor* visitor = new NearestTileVisitor( referencePosition, false, areaNumber, numberOfAreas );
-    visitTiles( visitor );
-    const TilePtr& tile = visitor->getLastValidTile( );
-    delete visitor;
-    if ( tile.get( ) == NULL ) {
-        throw opencog::NotFoundException( "Visibility Map - There is no visible tiles at the given area", TRACE_INFO );
+    unsigned int startRow;
+    unsigned int startCol;
+    unsigned int endRow;
+    unsigned int endCol;
+    getAreaLimits( areaNumber, numberOfAreas, startRow, startCol, endRow, endCol );
+
+    unsigned int row;
+    unsigned int col;
+    if ( !findNearestTile( referencePosition, false, startRow, startCol, endRow, endCol, row, col ) ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no hidden tiles at the given area", TRACE_INFO );
     } // if
-    return tile;
+    return getTile( row, col );
 }
 
 const VisibilityMap::TilePtr&  VisibilityMap::getNearestVisibleTile( const spatial::math::Vector3& referencePosition, unsigned int areaNumber, unsigned int numberOfAreas ) throw (opencog::NotFoundException)
 {
-    NearestTileVisitor* visitor = new NearestTileVisitor( referencePosition, true, areaNumber, numberOfAreas );
-    visitTiles( visitor );
-    const TilePtr& tile = visitor->getLastValidTile( );
-    delete visitor;
-    if ( tile.get( ) == NULL ) {
+    unsigned int startRow;
+    unsigned int startCol;
+    unsigned int endRow;
+    unsigned int endCol;
+    getAreaLimits( areaNumber, numberOfAreas, startRow, startCol, endRow, endCol );
+
+    unsigned int row;
+    unsigned int col;
+    if ( !findNearestTile( referencePosition, true, startRow, startCol, endRow, endCol, row, col ) ) {
         throw opencog::NotFoundException( "Visibility Map - There is no visible tiles at the given area", TRACE_INFO );
     } // if
-    return tile;
+    return getTile( row, col );
 }
 
 spatial::math::Vector3 VisibilityMap::getAreaCenter( unsigned int areaNumber, unsigned int numberOfAreas ) throw (opencog::NotFoundException)
 {
     unsigned int areasPerSide = static_cast<unsigned int>( std::sqrt( numberOfAreas ) );
-    unsigned int cellsPerAreaSide = this->tiles.size( ) / areasPerSide;
+    unsigned int cellsPerAreaSide = this->numberOfTiles / areasPerSide;
 
     unsigned int startCol = ( areaNumber % areasPerSide ) * cellsPerAreaSide;
     //unsigned int startRow = ( areasPerSide - (areaNumber / areasPerSide) ) * cellsPerAreaSide;
@@ -352,11 +707,11 @@ bool VisibilityMap::isInsideArea( const spatial::Entity& entity, unsigned int ar
 {
 
     unsigned int areasPerSide = static_cast<unsigned int>( std::sqrt( numberOfAreas ) );
-    unsigned int cellsPerAreaSide = this->tiles.size( ) / areasPerSide;
+    unsigned int cellsPerAreaSide = this->numberOfTiles / areasPerSide;
 
     unsigned int startCol = 0;
     unsigned int startRow = 0;
-    unsigned int endRow = this->tiles.size( ) - 1;
+    unsigned int endRow = this->numberOfTiles - 1;
     unsigned int endCol = endRow;
 
     // TODO: FIX the case when numberOfAreas == 1
@@ -368,7 +723,7 @@ bool VisibilityMap::isInsideArea( const spatial::Entity& entity, unsigned int ar
         endCol = startCol + cellsPerAreaSide;
     } // if
 
-    //std::cout << "TargetPosition: " << entity.getPosition( ).toString( ) << " AreaNumber: " << areaNumber << " NumberOfAreas: " << numberOfAreas << " StartRow: " << startRow << " StartCol: " << startCol << " EndRow: " << endRow << " EndCol: " << endCol << " AreasPerSide: " << areasPerSide << " CellsPerAreaSide: " << cellsPerAreaSide << " NumberOfTiles: " << this->tiles.size( ) << std::endl;
+    //std::cout << "TargetPosition: " << entity.getPosition( ).toString( ) << " AreaNumber: " << areaNumber << " NumberOfAreas: " << numberOfAreas << " StartRow: " << startRow << " StartCol: " << startCol << " EndRow: " << endRow << " EndCol: " << endCol << " AreasPerSide: " << areasPerSide << " CellsPerAreaSide: " << cellsPerAreaSide << " NumberOfTiles: " << this->numberOfTiles << std::endl;
 
     spatial::math::Vector3 center1 = getTile( startRow, startCol )->getCenter( );
     spatial::math::Vector3 center2 = getTile( endRow, endCol )->getCenter( );
@@ -398,80 +753,17 @@ bool VisibilityMap::isInsideArea( const spatial::Entity& entity, unsigned int ar
 
 const VisibilityMap::TilePtr& VisibilityMap::getNearestVisibleTileToPosition( const spatial::math::Vector3& referencePosition ) throw (opencog::NotFoundException)
 {
-
-    const TilePtr& tile = getTile( referencePosition );
-    if ( tile.get( ) == NULL ) {
+    unsigned int row;
+    unsigned int col;
+    if ( !getTilePosition( referencePosition, row, col ) ) {
         throw opencog::NotFoundException( "Visibility Map - The given position[%s] does not correspond to a tile.", TRACE_INFO, referencePosition.toString( ).c_str( ) );
     } // if
 
-    if ( tile->isVisible( ) ) {
-        return tile;
+    if ( !this->visible[ row * this->numberOfTiles + col ] &&
+            !findNearestTile( getTileCenter( row, col ), true, 0, 0, this->numberOfTiles, this->numberOfTiles, row, col ) ) {
+        throw opencog::NotFoundException( "Visibility Map - There is no visible tiles near to the reference point[%s]", TRACE_INFO, referencePosition.toString( ).c_str( ) );
     } // if
-
-    int step = 1;
-
-    int direction = 3; // 0 - right | 1 - top | 2 - left | 3 - down
-
-    int currRow = tile->getRow( );
-    int currCol = tile->getCol( );
-
-    int maxTiles = static_cast<int>( tiles.size( ) );
-
-    int leftSteps = 1;
-    int* current = &currCol;
-    int signal = 0;
-
-    while ( std::abs(step) < (maxTiles*2) + 1 ) {
-        if ( leftSteps == 0 ) {
-            switch ( direction ) {
-            case 0: {
-                direction = 1;
-                current = &currRow;
-                signal = 1;
-            }
-            break;
-            case 1: {
-                direction = 2;
-                current = &currCol;
-                signal = -1;
-            }
-            break;
-            case 2: {
-                direction = 3;
-                current = &currRow;
-                signal = -1;
-            }
-            break;
-            case 3: {
-                direction = 0;
-                current = &currCol;
-                signal = 1;
-            }
-            break;
-            };
-
-            leftSteps = step;
-
-            if ( (direction % 2) == 1 ) {
-                ++step;
-            } // if
-
-        } // if
-
-        *current += signal;
-        --leftSteps;
-
-        if ( currRow < 0 || currCol < 0 || currRow > maxTiles - 1 || currCol > maxTiles - 1 ) {
-            continue;
-        } // if
-
-        const TilePtr& currentTile = getTile( currRow, currCol );
-        if ( currentTile->isVisible( ) ) {
-            return currentTile;
-        } // if
-    } // while
-
-    throw opencog::NotFoundException( "Visibility Map - There is no visible tiles near to the reference point[%s]", TRACE_INFO, referencePosition.toString( ).c_str( ) );
+    return getTile( row, col );
 }
 
 bool VisibilityMap::saveToFile( const std::string& fileName, const VisibilityMap& visMap )
@@ -484,14 +776,11 @@ bool VisibilityMap::saveToFile( const std::string& fileName, const VisibilityMap
     file << " ";
     file << visMap.maximumExtent.toString( );
     file << " ";
-    file << visMap.tiles.size( );
+    file << visMap.numberOfTiles;
     file << " ";
-    unsigned int row;
-    unsigned int col;
-    for ( row = 0; row < visMap.tiles.size( ); ++row ) {
-        for ( col = 0; col < visMap.tiles[row].size( ); ++col ) {
-            file << visMap.tiles[row][col]->isVisible( ) << " ";
-        } // for
+    unsigned int i;
+    for ( i = 0; i < visMap.visible.size( ); ++i ) {
+        file << ( visMap.visible[i] != 0 ) << " ";
     } // for
     file.close( );
     return true;
@@ -512,8 +801,6 @@ VisibilityMapPtr VisibilityMap::loadFromFile( const std::string& fileName ) thro
     file >> minExtent.x >> minExtent.y >> minExtent.z;
     file >> maxExtent.x >> maxExtent.y >> maxExtent.z;
 
-    //  std::cout << minExtent.toString( ) << " - " << maxExtent.toString( ) << std::endl;
-
     file >> tilesSide;
     VisibilityMapPtr visMap( new VisibilityMap( minExtent, maxExtent, tilesSide ) );
 
@@ -524,7 +811,7 @@ VisibilityMapPtr VisibilityMap::loadFromFile( const std::string& fileName ) thro
         for ( col = 0; col < tilesSide; ++col ) {
             bool visibility = false;
             file >> visibility;
-            visMap->tiles[row][col]->setVisibility( visibility );
+            visMap->changeVisibility( row, col, visibility );
         } // for
     } // for
 
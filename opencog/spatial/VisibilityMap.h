@@ -27,6 +27,7 @@
 #include <opencog/spatial/math/Vector3.h>
 #include <opencog/spatial/Entity.h>
 #include <opencog/util/exceptions.h>
+#include <set>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -43,6 +44,13 @@ namespace opencog
          * Visibility map is a class to keep track of the already visible areas.
          * When the agent is exploring new areas, the tiles corresponding to these areas
          * is been marked as visible.
+         *
+         * The tile state is kept in row-major arrays (row * numberOfTiles + col). The
+         * number of visible tiles of each block of tiles is counted, so the queries for
+         * the next or nearest hidden/visible tile skip the blocks that have none.
+         * castVisibility() marks the tiles seen from an observer by casting rays over
+         * the tiles, stopped by the opaque ones, and recasts only the rays whose line of
+         * sight may have changed since the previous call.
          */
         class VisibilityMap;
         typedef boost::shared_ptr<VisibilityMap> VisibilityMapPtr;
@@ -53,13 +61,14 @@ namespace opencog
         public:
 
             /**
-             * A tile covers a specific area of the VisibilityMap
+             * A tile covers a specific area of the VisibilityMap. It is a handle to
+             * the tile state kept by the map.
              */
             class Tile
             {
             public:
 
-                Tile( double x, double y, int row, int col, const math::Vector3& normal, double tileSideSize );
+                Tile( VisibilityMap* map, int row, int col );
 
                 inline virtual ~Tile( void ) { };
 
@@ -69,22 +78,18 @@ namespace opencog
 
                 bool isVisible( void );
 
-                const math::Vector3& getNormal( void );
+                math::Vector3 getNormal( void );
 
-                const math::Vector3& getCenter( void );
+                math::Vector3 getCenter( void );
 
                 int getRow( void ) const;
 
                 int getCol( void ) const;
 
             private:
-                double tileSideSize;
-                bool visible;
-                long discoveringTime;
+                VisibilityMap* map;
                 int row;
                 int col;
-                math::Vector3 normal;
-                math::Vector3 center;
             }; // Tile
             typedef boost::shared_ptr<Tile> TilePtr;
 
@@ -176,6 +181,31 @@ namespace opencog
 
             void resetTiles( void );
 
+            bool isVisible( unsigned int row, unsigned int column ) const throw( opencog::NotFoundException );
+
+            void setVisibility( unsigned int row, unsigned int column, bool visible ) throw( opencog::NotFoundException );
+
+            /**
+             * Opaque tiles (walls, big objects) stop the line of sight in castVisibility
+             */
+            bool isOpaque( unsigned int row, unsigned int column ) const throw( opencog::NotFoundException );
+
+            void setOpaque( unsigned int row, unsigned int column, bool opaque ) throw( opencog::NotFoundException );
+
+            /**
+             * Mark as visible the tiles seen from the observer position, up to the
+             * given distance. Rays are cast from the observer tile to the tiles at the
+             * border of the view; each one marks the tiles it crosses until it reaches
+             * an opaque tile (which is marked too).
+             *
+             * If the observer is on the same tile and has the same view distance as in
+             * the previous call, only the rays that cross the tiles changed since then
+             * (opacity, or hidden again by setVisibility) are cast again.
+             *
+             * Return the number of tiles that became visible.
+             */
+            unsigned int castVisibility( const math::Vector3& observerPosition, double viewDistance ) throw( opencog::NotFoundException );
+
             bool hasHiddenTile( void );
 
             TilePtr& nextHiddenTile( void );
@@ -187,7 +217,7 @@ namespace opencog
             void visitTiles( TileVisitor* visitor );
 
             inline unsigned int getNumberOfTilesPerRow( void ) const {
-                return this->tiles.size( );
+                return this->numberOfTiles;
             };
 
 
@@ -219,9 +249,64 @@ namespace opencog
             static VisibilityMapPtr loadFromFile( const std::string& fileName ) throw( opencog::NotFoundException );
 
         private:
+
+            math::Vector3 getTileCenter( unsigned int row, unsigned int col ) const;
+
+            // row and column of the tile that contains the given position
+            bool getTilePosition( const math::Vector3& position, unsigned int& row, unsigned int& col ) const;
+
+            inline unsigned int getBlock( unsigned int row, unsigned int col ) const {
+                return ( row / BLOCK_SIDE ) * this->blocksPerSide + col / BLOCK_SIDE;
+            }
+
+            // set the visibility of a tile, keeping the block counts. Return true if it changed
+            bool changeVisibility( unsigned int row, unsigned int col, bool visible );
+
+            // rows and columns [start, end) of the given area
+            void getAreaLimits( unsigned int areaNumber, unsigned int numberOfAreas,
+                                unsigned int& startRow, unsigned int& startCol,
+                                unsigned int& endRow, unsigned int& endCol ) const;
+
+            // number of tiles of the given visibility in an index block
+            unsigned int countBlockTiles( unsigned int blockRow, unsigned int blockCol, bool visibility ) const;
+
+            // first tile of the given visibility in the area, in row-major order
+            bool findNextTile( bool visibility, unsigned int areaNumber, unsigned int numberOfAreas,
+                               unsigned int& row, unsigned int& col ) const;
+
+            // nearest tile of the given visibility in [startRow, endRow) x [startCol, endCol)
+            bool findNearestTile( const math::Vector3& referencePosition, bool visibility,
+                                  unsigned int startRow, unsigned int startCol,
+                                  unsigned int endRow, unsigned int endCol,
+                                  unsigned int& row, unsigned int& col ) const;
+
+            // cast a ray from the center of a tile to the center of another one
+            unsigned int castRay( int fromRow, int fromCol, int toRow, int toCol, double maximumDistance );
+
+            // side, in tiles, of the blocks of the spatial index
+            static const unsigned int BLOCK_SIDE = 16;
+
             unsigned int numberOfTiles;
             double tileSideSize;
-            std::vector< std::vector<TilePtr> > tiles;
+
+            // tile state, row-major
+            std::vector<unsigned char> visible;
+            std::vector<unsigned char> opaque;
+
+            // Tile handles given by getTile, created on demand
+            mutable std::vector<TilePtr> tiles;
+
+            // visible tiles per index block
+            unsigned int blocksPerSide;
+            std::vector<unsigned int> blockVisibleTiles;
+            unsigned int visibleTiles;
+
+            // last castVisibility call and the blocks changed since then
+            int lastObserverRow;
+            int lastObserverCol;
+            double lastViewDistance;
+            std::set<unsigned int> changedBlocks;
+
             math::Vector3 minimumExtent;
             math::Vector3 maximumExtent;
         }; // VisibilityMap
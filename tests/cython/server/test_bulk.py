@@ -0,0 +1,59 @@
+from unittest import TestCase
+from array import array
+
+from opencog.atomspace import AtomSpace, types
+from opencog.bulk import get_tv, set_tv, get_av, set_av, add_nodes, add_links
+
+class BulkTest(TestCase):
+
+    def setUp(self):
+        self.space = AtomSpace()
+
+    def tearDown(self):
+        del self.space
+
+    def test_add_nodes_and_links(self):
+        uuids = array('l', [0] * 3)
+        self.assertEqual(add_nodes(self.space, types.ConceptNode,
+                                   ["a", "b", "c"], uuids), 3)
+        a = self.space.add_node(types.ConceptNode, "a")
+        self.assertEqual(uuids[0], a.h.value())
+
+        # The last row holds an invalid UUID
+        outgoing = array('l', [uuids[0], uuids[1],
+                               uuids[1], uuids[2],
+                               uuids[2], -1])
+        links = array('l', [0] * 3)
+        self.assertEqual(add_links(self.space, types.ListLink,
+                                   outgoing, 2, links), 2)
+        self.assertEqual(links[2], -1)
+        ab = self.space.add_link(types.ListLink,
+                                 [a, self.space.add_node(types.ConceptNode, "b")])
+        self.assertEqual(links[0], ab.h.value())
+
+    def test_tv_and_av(self):
+        uuids = array('l', [0] * 2)
+        add_nodes(self.space, types.ConceptNode, ["x", "y"], uuids)
+
+        set_tv(self.space, uuids, array('d', [0.25, 0.75]),
+               array('d', [0.5, 0.5]))
+        mean = array('d', [0.0] * 2)
+        confidence = array('d', [0.0] * 2)
+        self.assertEqual(get_tv(self.space, uuids, mean, confidence), 2)
+        self.assertAlmostEqual(mean[0], 0.25, 5)
+        self.assertAlmostEqual(mean[1], 0.75, 5)
+        self.assertAlmostEqual(confidence[1], 0.5, 3)
+
+        set_av(self.space, uuids, array('h', [10, -5]), array('h', [1, 2]),
+               array('H', [0, 1]))
+        sti = array('h', [0] * 2)
+        lti = array('h', [0] * 2)
+        vlti = array('H', [0] * 2)
+        self.assertEqual(get_av(self.space, uuids, sti, lti, vlti), 2)
+        self.assertEqual(list(sti), [10, -5])
+        self.assertEqual(list(lti), [1, 2])
+        self.assertEqual(list(vlti), [0, 1])
+
+        # Arrays too short for the atoms are refused
+        self.assertRaises(ValueError, get_av, self.space, uuids,
+                          array('h', [0]), lti, vlti)